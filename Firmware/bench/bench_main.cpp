@@ -0,0 +1,452 @@
+/**
+ * @file bench_main.cpp
+ * @brief On-device benchmark and self-test of the hot paths
+ *
+ * Built instead of main.cpp by the bench environment (pio run -e bench).
+ * Runs each signal, packing, render and transport path on synthetic
+ * data and prints one machine-readable line per result:
+ *
+ *   bench_begin,<cpu_mhz>,<sdk>,<build>
+ *   bench,<name>,<unit>,<count>,<elapsed_us>,<per_s>,<ns_per_unit>
+ *   check,<name>,<pass|fail>
+ *   bench_end,<runs>,<failed checks>
+ *
+ * Lines start at column 0 so a host can keep only those starting with
+ * "bench" or "check" (the serial transport run writes binary frames in
+ * between). Send any character to run the suite again.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "signal_processing.h"
+#include "filter_chain.h"
+#include "window_stats.h"
+#include "stream_frame.h"
+#include "ble_service.h"
+#include "display.h"
+#include "waveform.h"
+#include "spectrum.h"
+
+// Build label in the summary, e.g. -DGSENSOR_BUILD_ID=\"v1.4-rc1\"
+#ifndef GSENSOR_BUILD_ID
+#define GSENSOR_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+// Synthetic signal period: a whole number of 50 Hz and 370 Hz cycles at 3200 Hz
+constexpr size_t BENCH_SIGNAL_LENGTH = 640;
+constexpr uint32_t BENCH_RATE_HZ = ADXL_RATE_3200HZ;
+constexpr uint32_t BENCH_SAMPLE_PERIOD_US = 1000000 / BENCH_RATE_HZ;
+
+// Every stage on: the worst case for the filter chain
+constexpr FilterConfig BENCH_FILTER = {true, 10, 400, 10};
+
+Display display;
+BleService bleService;
+WaveformBuffer waveform;
+SpectrumResult spectrum;  // Too large for the loop stack
+RawAccel signalCounts[BENCH_SIGNAL_LENGTH];
+
+bool displayOk = false;
+uint32_t runCount = 0;
+uint32_t failedChecks = 0;
+
+// Results must reach the serial line, so the compiler cannot drop the
+// loops that produce them
+volatile int32_t benchSink = 0;
+
+/**
+ * @brief Fill the synthetic signal: 1 g on Z, 50 Hz and 370 Hz vibration, noise
+ */
+void buildSignal() {
+    uint32_t noise = 12345;
+    for (size_t i = 0; i < BENCH_SIGNAL_LENGTH; i++) {
+        float t = static_cast<float>(i) / BENCH_RATE_HZ;
+        float low = 2.0f * sinf(2.0f * PI * 50.0f * t);
+        float high = 0.8f * sinf(2.0f * PI * 370.0f * t);
+
+        // LCG noise, +/- 0.1 g
+        noise = noise * 1664525u + 1013904223u;
+        float n = (static_cast<int32_t>(noise >> 16) - 32768) / 327680.0f;
+
+        signalCounts[i].x = gToCounts(low + n);
+        signalCounts[i].y = gToCounts(0.5f * low - high);
+        signalCounts[i].z = gToCounts(1.0f + high + n);
+    }
+}
+
+/**
+ * @brief Print one result
+ *
+ * @param name Benchmark name
+ * @param unit What count counts (samples, frames, bytes...)
+ * @param count Units processed
+ * @param elapsedUs Time taken
+ */
+void report(const char* name, const char* unit, uint32_t count, uint32_t elapsedUs) {
+    runCount++;
+    if (elapsedUs == 0) {
+        elapsedUs = 1;
+    }
+    float perSecond = static_cast<float>(count) * 1000000.0f / elapsedUs;
+    float nsPerUnit = count > 0 ? static_cast<float>(elapsedUs) * 1000.0f / count : 0.0f;
+    Serial.printf("bench,%s,%s,%u,%u,%.0f,%.1f\n", name, unit, count, elapsedUs, perSecond, nsPerUnit);
+}
+
+/**
+ * @brief Print one self-test result
+ */
+void check(const char* name, bool passed) {
+    if (!passed) {
+        failedChecks++;
+    }
+    Serial.printf("check,%s,%s\n", name, passed ? "pass" : "fail");
+}
+
+/**
+ * @brief Print a skipped run (unit count 0)
+ */
+void skip(const char* name, const char* reason) {
+    Serial.printf("bench,%s,skipped,0,0,0,0 (%s)\n", name, reason);
+}
+
+// ==================== Signal Path ====================
+
+void benchBoxcar() {
+    // 10 ms at 3200 Hz, as in the filter chain
+    BoxcarAverage<int32_t, FILTER_AVERAGE_MAX_SAMPLES> fixedAverage;
+    fixedAverage.setLength(32);
+    int32_t fixedOut = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        fixedOut = fixedAverage.process(AccelFixed::fromCounts(signalCounts[i % BENCH_SIGNAL_LENGTH]).z);
+    }
+    report("boxcar_q4", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+    benchSink = fixedOut;
+
+    BoxcarAverage<float, FILTER_AVERAGE_MAX_SAMPLES> floatAverage;
+    floatAverage.setLength(32);
+    float floatOut = 0.0f;
+    start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        floatOut = floatAverage.process(signalCounts[i % BENCH_SIGNAL_LENGTH].z * ADXL375_SCALE_FACTOR);
+    }
+    report("boxcar_float", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+    benchSink = static_cast<int32_t>(floatOut);
+
+    // A constant input must average to itself
+    BoxcarAverage<int32_t, FILTER_AVERAGE_MAX_SAMPLES> constant;
+    constant.setLength(FILTER_AVERAGE_MAX_SAMPLES);
+    int32_t out = 0;
+    for (size_t i = 0; i < 2 * FILTER_AVERAGE_MAX_SAMPLES; i++) {
+        out = constant.process(-1234);
+    }
+    check("boxcar_constant", out == -1234);
+}
+
+void benchFilterChain() {
+    FilterChain<int32_t> fixedChain;
+    fixedChain.configure(BENCH_FILTER, BENCH_RATE_HZ);
+    int32_t fixedOut = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        fixedOut = fixedChain.process(AccelFixed::fromCounts(signalCounts[i % BENCH_SIGNAL_LENGTH]).x);
+    }
+    report("filter_chain_q4", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+    benchSink = fixedOut;
+
+    FilterChain<float> floatChain;
+    floatChain.configure(BENCH_FILTER, BENCH_RATE_HZ);
+    float floatOut = 0.0f;
+    start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        floatOut = floatChain.process(signalCounts[i % BENCH_SIGNAL_LENGTH].x * ADXL375_SCALE_FACTOR);
+    }
+    report("filter_chain_float", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+    benchSink = static_cast<int32_t>(floatOut);
+
+    // Both paths filter the same signal, so they must end up close
+    check("filter_chain_q4_matches_float", fabsf(fixedToG(fixedOut) - floatOut) < 0.05f);
+}
+
+void benchSignalProcessor() {
+    FixedSignalProcessor fixedProcessor;
+    fixedProcessor.configure(BENCH_FILTER, BENCH_RATE_HZ);
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        fixedProcessor.process(AccelFixed::fromCounts(signalCounts[i % BENCH_SIGNAL_LENGTH]));
+    }
+    report("processor_q4", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+
+    SignalProcessor floatProcessor;
+    floatProcessor.configure(BENCH_FILTER, BENCH_RATE_HZ);
+    start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        const RawAccel& counts = signalCounts[i % BENCH_SIGNAL_LENGTH];
+        AccelData g = {counts.x * ADXL375_SCALE_FACTOR, counts.y * ADXL375_SCALE_FACTOR,
+                       counts.z * ADXL375_SCALE_FACTOR};
+        floatProcessor.process(g);
+    }
+    report("processor_float", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+
+    float fixedPeak = fixedToG(fixedProcessor.getPeakMagnitude());
+    float floatPeak = floatProcessor.getPeakMagnitude();
+    benchSink = fixedProcessor.getPeakMagnitude();
+    check("processor_peak_q4_matches_float", fabsf(fixedPeak - floatPeak) < 0.1f);
+
+    // The sampler runs the statistics on every processed sample
+    WindowStats stats;
+    int32_t thresholdQ4 = gToCounts(IMPACT_DEFAULT_THRESHOLD_G) << ACCEL_FIXED_FRAC_BITS;
+    start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        AccelFixed sample = AccelFixed::fromCounts(signalCounts[i % BENCH_SIGNAL_LENGTH]);
+        stats.addSample(i * BENCH_SAMPLE_PERIOD_US, sample, sample.magnitude(), thresholdQ4, BENCH_RATE_HZ);
+    }
+    report("window_stats", "samples", BENCH_SAMPLE_COUNT, micros() - start);
+}
+
+// ==================== Packing ====================
+
+/**
+ * @brief Check a finished frame's CRC
+ */
+bool frameCrcValid(const uint8_t* frame, size_t length) {
+    if (length < STREAM_FRAME_HEADER_SIZE + STREAM_FRAME_CRC_SIZE) {
+        return false;
+    }
+    uint16_t crc = crc16Ccitt(&frame[2], length - 2 - STREAM_FRAME_CRC_SIZE);
+    return frame[length - 2] == (crc & 0xFF) && frame[length - 1] == (crc >> 8);
+}
+
+void benchPacking() {
+    // One BLE batch at the preferred MTU
+    uint8_t buffer[BLE_PREFERRED_MTU - BLE_ATT_NOTIFY_OVERHEAD];
+    StreamFrameWriter writer(buffer, sizeof(buffer));
+    uint32_t frames = 0;
+    uint32_t bytes = 0;
+    bool crcOk = false;
+
+    writer.begin(BENCH_RATE_HZ);
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+        if (!writer.add(i * BENCH_SAMPLE_PERIOD_US, signalCounts[i % BENCH_SIGNAL_LENGTH])) {
+            size_t length = writer.finish();
+            if (frames == 0) {
+                // Checked before the next sample overwrites the frame
+                crcOk = frameCrcValid(buffer, length);
+            }
+            bytes += length;
+            frames++;
+            writer.begin(BENCH_RATE_HZ);
+            writer.add(i * BENCH_SAMPLE_PERIOD_US, signalCounts[i % BENCH_SIGNAL_LENGTH]);
+        }
+    }
+    uint32_t elapsed = micros() - start;
+    report("frame_pack", "samples", BENCH_SAMPLE_COUNT, elapsed);
+    report("frame_pack_bytes", "bytes", bytes, elapsed);
+    check("frame_pack_crc", frames > 0 && crcOk);
+
+    // Characteristic values (packing plus the NimBLE copy; no client needed)
+    StatsSummary summary = {};
+    summary.sequence = 1;
+    summary.windowMs = 1000;
+    summary.rateHz = BENCH_RATE_HZ;
+    const uint32_t packets = 1000;
+    start = micros();
+    for (uint32_t i = 0; i < packets; i++) {
+        summary.sequence = i + 1;
+        bleService.notifyStats(summary, summary);
+    }
+    report("ble_pack_stats", "packets", packets, micros() - start);
+}
+
+// ==================== Rendering ====================
+
+void benchDisplay() {
+    if (!displayOk) {
+        skip("display_gauge", "display init failed");
+        return;
+    }
+
+    // Gauge screen: partial redraws with moving values
+    display.prepareScreen();
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_DISPLAY_FRAMES; i++) {
+        float magnitude = 5.0f + 45.0f * (0.5f + 0.5f * sinf(i * 0.2f));
+        AccelData data = {magnitude * 0.6f, -magnitude * 0.3f, magnitude * 0.74f};
+        display.update(data, magnitude, 50.0f);
+    }
+    report("display_gauge", "frames", BENCH_DISPLAY_FRAMES, micros() - start);
+
+    // Full redraw after a screen switch
+    const uint32_t redraws = BENCH_DISPLAY_FRAMES / 10;
+    AccelData still = {0.0f, 0.0f, 1.0f};
+    start = micros();
+    for (uint32_t i = 0; i < redraws; i++) {
+        display.prepareScreen();
+        display.update(still, 1.0f, 1.0f);
+    }
+    report("display_redraw", "frames", redraws, micros() - start);
+
+    // Waveform: one new column per frame, as at DISPLAY_UPDATE_INTERVAL_MS
+    const uint32_t samplesPerColumn = BENCH_RATE_HZ * WAVEFORM_COLUMN_MS / 1000;
+    waveform.reset();
+    display.prepareScreen();
+    uint32_t drawUs = 0;
+    uint32_t sample = 0;
+    for (uint32_t i = 0; i < BENCH_DISPLAY_FRAMES; i++) {
+        for (uint32_t k = 0; k < samplesPerColumn; k++, sample++) {
+            waveform.addSample(signalCounts[sample % BENCH_SIGNAL_LENGTH], BENCH_RATE_HZ);
+        }
+        start = micros();
+        display.drawWaveform(waveform);
+        drawUs += micros() - start;
+    }
+    report("display_waveform", "frames", BENCH_DISPLAY_FRAMES, drawUs);
+
+    // Spectrum: a new result every frame so every bar is redrawn
+    spectrum = {};
+    spectrum.rateHz = BENCH_RATE_HZ;
+    spectrum.frames = 1;
+    for (size_t b = 0; b <= SPECTRUM_BAND_COUNT; b++) {
+        spectrum.bandEdgesHz[b] = SPECTRUM_DEFAULT_BAND_EDGES_HZ[b];
+    }
+    display.prepareScreen();
+    drawUs = 0;
+    for (uint32_t i = 0; i < BENCH_DISPLAY_FRAMES; i++) {
+        spectrum.sequence = i + 1;
+        for (size_t bin = 0; bin < SPECTRUM_BINS; bin++) {
+            spectrum.bins[bin] = static_cast<uint16_t>(((bin * 37 + i * 11) % 97) * 16);
+        }
+        start = micros();
+        display.drawSpectrum(spectrum);
+        drawUs += micros() - start;
+    }
+    report("display_spectrum", "frames", BENCH_DISPLAY_FRAMES, drawUs);
+}
+
+// ==================== Transports ====================
+
+void benchSerial() {
+    // Binary frames as streamed with the 'b' command
+    uint8_t buffer[streamFrameSize(SERIAL_BINARY_BATCH_SAMPLES)];
+    StreamFrameWriter writer(buffer, sizeof(buffer));
+    uint32_t bytes = 0;
+    uint32_t sample = 0;
+
+    Serial.println();
+    uint32_t start = micros();
+    while (micros() - start < BENCH_TRANSPORT_MS * 1000) {
+        writer.begin(BENCH_RATE_HZ);
+        while (!writer.isFull()) {
+            writer.add(sample * BENCH_SAMPLE_PERIOD_US, signalCounts[sample % BENCH_SIGNAL_LENGTH]);
+            sample++;
+        }
+        size_t length = writer.finish();
+        bytes += Serial.write(buffer, length);
+    }
+    uint32_t elapsed = micros() - start;
+    Serial.flush();
+    Serial.println();
+    report("serial_binary", "bytes", bytes, elapsed);
+}
+
+void benchBle() {
+    if (!bleService.isConnected()) {
+        Serial.printf("bench_wait,ble,%u\n", BENCH_BLE_CONNECT_WAIT_MS);
+        uint32_t waitStart = millis();
+        while (!bleService.isConnected() && millis() - waitStart < BENCH_BLE_CONNECT_WAIT_MS) {
+            delay(10);
+        }
+    }
+    if (!bleService.isConnected()) {
+        skip("ble_legacy", "no client");
+        skip("ble_batched", "no client");
+        return;
+    }
+    delay(1000);  // Let the client negotiate MTU and connection parameters
+
+    // Legacy packets: CPU cost per notification, paced at the max
+    // notification rate so the stack's buffers do not fill
+    bleService.setStreamFormat(BleStreamFormat::LEGACY);
+    const uint32_t packets = BENCH_TRANSPORT_MS * BLE_MAX_NOTIFY_RATE_HZ / 1000;
+    uint32_t notifyUs = 0;
+    for (uint32_t i = 0; i < packets && bleService.isConnected(); i++) {
+        AccelData data = {0.1f, -0.2f, 1.0f};
+        uint32_t start = micros();
+        bleService.notifyAccelData(millis(), data, 1.02f);
+        notifyUs += micros() - start;
+        delay(1000 / BLE_MAX_NOTIFY_RATE_HZ);
+    }
+    report("ble_legacy", "packets", packets, notifyUs);
+
+    // Batched frames paced at 3200 Hz, the stream's real load
+    bleService.setStreamFormat(BleStreamFormat::BATCHED);
+    delay(500);  // Faster connection interval
+    uint32_t samples = 0;
+    uint32_t start = micros();
+    while (micros() - start < BENCH_TRANSPORT_MS * 1000 && bleService.isConnected()) {
+        uint32_t due = (micros() - start) / BENCH_SAMPLE_PERIOD_US;
+        while (samples < due) {
+            bleService.addBatchSample(samples * BENCH_SAMPLE_PERIOD_US,
+                                      signalCounts[samples % BENCH_SIGNAL_LENGTH], BENCH_RATE_HZ);
+            samples++;
+        }
+        bleService.flushBatch();
+        delay(1);
+    }
+    uint32_t elapsed = micros() - start;
+
+    // Frames fill the MTU, so the per-sample cost follows from its size
+    size_t perFrame = (bleService.getMtu() - BLE_ATT_NOTIFY_OVERHEAD - STREAM_FRAME_HEADER_SIZE
+                       - STREAM_FRAME_CRC_SIZE) / STREAM_FRAME_SAMPLE_SIZE;
+    if (perFrame < 1) {
+        perFrame = 1;
+    }
+    report("ble_batched", "samples", samples, elapsed);
+    report("ble_batched_bytes", "bytes", samples / perFrame * streamFrameSize(perFrame), elapsed);
+    bleService.setStreamFormat(BleStreamFormat::LEGACY);
+}
+
+/**
+ * @brief Run the whole suite
+ */
+void runSuite() {
+    runCount = 0;
+    failedChecks = 0;
+    Serial.printf("bench_begin,%u,%s,%s\n", getCpuFrequencyMhz(), ESP.getSdkVersion(), GSENSOR_BUILD_ID);
+
+    benchBoxcar();
+    benchFilterChain();
+    benchSignalProcessor();
+    benchPacking();
+    benchDisplay();
+    benchSerial();
+    benchBle();
+
+    Serial.printf("bench_end,%u,%u\n", runCount, failedChecks);
+}
+
+void setup() {
+    Serial.begin(SERIAL_BAUD_RATE);
+    delay(2000);  // Give the host time to open the port
+
+    Serial.println();
+    Serial.println("[Bench] gSENSOR benchmark build");
+
+    buildSignal();
+    displayOk = display.begin();
+    bleService.begin();
+
+    runSuite();
+}
+
+void loop() {
+    if (Serial.available()) {
+        while (Serial.available()) {
+            Serial.read();
+        }
+        runSuite();
+    }
+    delay(10);
+}
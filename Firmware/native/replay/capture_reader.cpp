@@ -0,0 +1,259 @@
+/**
+ * @file capture_reader.cpp
+ * @brief Capture file parsing for the host replay tool
+ */
+
+#include "capture_reader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "flash_logger.h"
+#include "stream_frame.h"
+
+const char* captureFormatName(CaptureFormat format) {
+    switch (format) {
+        case CaptureFormat::CSV:           return "csv";
+        case CaptureFormat::STREAM_FRAMES: return "frames";
+        case CaptureFormat::FLASH_LOG:     return "flash_log";
+    }
+    return "unknown";
+}
+
+static uint16_t readUint16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t readUint32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+         | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// ==================== Flash Log ====================
+
+/**
+ * @brief Check a sector holds a valid log block (same test as FlashLogger)
+ */
+static bool validLogBlock(const uint8_t* sector, LogBlock& block) {
+    std::memcpy(&block, sector, sizeof(block));
+    if (block.header.magic != LOG_BLOCK_MAGIC || block.header.version != LOG_BLOCK_VERSION
+        || block.header.sequence == 0 || block.header.sampleCount > LOG_SAMPLES_PER_BLOCK
+        || block.header.rateHz == 0) {
+        return false;
+    }
+    uint16_t crc = crc16Ccitt(sector, offsetof(LogBlockHeader, crc));
+    crc = crc16Ccitt(sector + sizeof(LogBlockHeader), block.header.sampleCount * sizeof(RawAccel), crc);
+    return crc == block.header.crc;
+}
+
+static bool looksLikeFlashLog(const std::vector<uint8_t>& data) {
+    for (size_t offset = 0; offset + sizeof(LogBlockHeader) <= data.size(); offset += LOG_BLOCK_SIZE) {
+        if (readUint32(&data[offset]) == LOG_BLOCK_MAGIC) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void parseFlashLog(const std::vector<uint8_t>& data, Capture& out) {
+    // Blocks are written round-robin, so order them by sequence number
+    std::vector<LogBlock> blocks;
+    LogBlock block;
+    for (size_t offset = 0; offset + sizeof(LogBlock) <= data.size(); offset += LOG_BLOCK_SIZE) {
+        if (validLogBlock(&data[offset], block)) {
+            blocks.push_back(block);
+        } else if (readUint32(&data[offset]) != 0xFFFFFFFF) {
+            out.skipped++;  // Not just an erased sector
+        }
+    }
+    std::sort(blocks.begin(), blocks.end(), [](const LogBlock& a, const LogBlock& b) {
+        return a.header.sequence < b.header.sequence;
+    });
+
+    for (const LogBlock& b : blocks) {
+        const LogBlockHeader& h = b.header;
+        for (uint16_t i = 0; i < h.sampleCount; i++) {
+            CaptureSample sample;
+            sample.timestampUs = h.startTimestampUs
+                               + static_cast<uint32_t>(static_cast<uint64_t>(i) * 1000000 / h.rateHz);
+            sample.counts.x = static_cast<int16_t>(b.samples[i].x - h.offsetX);
+            sample.counts.y = static_cast<int16_t>(b.samples[i].y - h.offsetY);
+            sample.counts.z = static_cast<int16_t>(b.samples[i].z - h.offsetZ);
+            sample.rateHz = h.rateHz;
+            out.samples.push_back(sample);
+        }
+    }
+}
+
+// ==================== Stream Frames ====================
+
+/**
+ * @brief Length of a valid frame starting at offset (0 if none)
+ */
+static size_t frameAt(const std::vector<uint8_t>& data, size_t offset) {
+    if (offset + STREAM_FRAME_HEADER_SIZE + STREAM_FRAME_CRC_SIZE > data.size()
+        || data[offset] != STREAM_FRAME_SYNC_0 || data[offset + 1] != STREAM_FRAME_SYNC_1
+        || data[offset + 2] != STREAM_FRAME_VERSION) {
+        return 0;
+    }
+    size_t length = streamFrameSize(data[offset + 3]);
+    if (offset + length > data.size()) {
+        return 0;
+    }
+    uint16_t crc = crc16Ccitt(&data[offset + 2], length - 2 - STREAM_FRAME_CRC_SIZE);
+    return crc == readUint16(&data[offset + length - STREAM_FRAME_CRC_SIZE]) ? length : 0;
+}
+
+static bool looksLikeStreamFrames(const std::vector<uint8_t>& data) {
+    for (size_t offset = 0; offset + 1 < data.size(); offset++) {
+        if (frameAt(data, offset) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void parseStreamFrames(const std::vector<uint8_t>& data, Capture& out) {
+    // Frames may be interleaved with console text; resync on the sync word
+    size_t offset = 0;
+    while (offset < data.size()) {
+        size_t length = frameAt(data, offset);
+        if (length == 0) {
+            offset++;
+            continue;
+        }
+
+        const uint8_t* frame = &data[offset];
+        uint8_t count = frame[3];
+        uint32_t timestampUs = readUint32(&frame[6]);
+        uint16_t rateHz = readUint16(&frame[10]);
+        for (uint8_t i = 0; i < count; i++) {
+            const uint8_t* p = &frame[STREAM_FRAME_HEADER_SIZE + i * STREAM_FRAME_SAMPLE_SIZE];
+            timestampUs += readUint16(&p[0]);
+
+            CaptureSample sample;
+            sample.timestampUs = timestampUs;
+            sample.counts.x = static_cast<int16_t>(readUint16(&p[2]));
+            sample.counts.y = static_cast<int16_t>(readUint16(&p[4]));
+            sample.counts.z = static_cast<int16_t>(readUint16(&p[6]));
+            sample.rateHz = rateHz;
+            out.samples.push_back(sample);
+        }
+        offset += length;
+    }
+}
+
+// ==================== CSV ====================
+
+static void parseCsv(const std::vector<uint8_t>& data, uint32_t rateHz, Capture& out) {
+    std::vector<uint32_t> timesMs;
+    std::vector<RawAccel> counts;
+
+    std::string text(data.begin(), data.end());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        unsigned rate;
+        if (std::sscanf(line.c_str(), "# Sample Rate: %u Hz", &rate) == 1) {
+            if (rateHz == 0) {
+                rateHz = rate;
+            }
+            continue;
+        }
+
+        // Data rows only; the header row and device messages do not parse.
+        // Binary-mode recordings from the plotter have fractional ms.
+        double timeMs;
+        float x, y, z;
+        char tail;
+        int fields = std::sscanf(line.c_str(), "%lf,%f,%f,%f%c", &timeMs, &x, &y, &z, &tail);
+        if (fields < 4 || timeMs < 0.0 || (fields == 5 && tail != ',' && tail != '\r')) {
+            // Comments, the column header and blank lines are expected
+            bool expected = line.empty() || line[0] == '#' || line.compare(0, 9, "timestamp") == 0
+                         || line.find_first_not_of(" \r") == std::string::npos;
+            if (!expected) {
+                out.skipped++;
+            }
+            continue;
+        }
+        timesMs.push_back(static_cast<uint32_t>(timeMs));
+        counts.push_back({gToCounts(x), gToCounts(y), gToCounts(z)});
+    }
+
+    if (counts.empty()) {
+        return;
+    }
+
+    // Reason: millisecond timestamps cannot resolve rates above 1 kHz, so
+    // samples are re-timed evenly at the recorded (or inferred) rate
+    if (rateHz == 0 && counts.size() > 1) {
+        uint32_t spanMs = timesMs.back() - timesMs.front();
+        rateHz = spanMs > 0 ? static_cast<uint32_t>((counts.size() - 1) * 1000ULL / spanMs) : 0;
+    }
+    if (rateHz == 0) {
+        rateHz = ADXL_DEFAULT_SAMPLE_RATE_HZ;
+    }
+
+    uint32_t startUs = timesMs.front() * 1000;
+    for (size_t i = 0; i < counts.size(); i++) {
+        CaptureSample sample;
+        sample.timestampUs = startUs + static_cast<uint32_t>(static_cast<uint64_t>(i) * 1000000 / rateHz);
+        sample.counts = counts[i];
+        sample.rateHz = static_cast<uint16_t>(rateHz);
+        out.samples.push_back(sample);
+    }
+}
+
+bool loadCapture(const char* path, uint32_t rateHz, Capture& out, std::string& error) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        error = "cannot read file";
+        return false;
+    }
+
+    out.samples.clear();
+    out.skipped = 0;
+    if (looksLikeFlashLog(data)) {
+        out.format = CaptureFormat::FLASH_LOG;
+        parseFlashLog(data, out);
+    } else if (looksLikeStreamFrames(data)) {
+        out.format = CaptureFormat::STREAM_FRAMES;
+        parseStreamFrames(data, out);
+    } else {
+        out.format = CaptureFormat::CSV;
+        parseCsv(data, rateHz, out);
+    }
+
+    // An explicit rate overrides the recorded one
+    if (rateHz != 0 && out.format != CaptureFormat::CSV) {
+        for (CaptureSample& sample : out.samples) {
+            sample.rateHz = static_cast<uint16_t>(rateHz);
+        }
+    }
+
+    if (out.samples.empty()) {
+        error = "no samples found";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file capture_reader.h
+ * @brief Load recorded captures for the host replay tool
+ *
+ * Three formats are recognised from the file contents:
+ *
+ *   - CSV saved by tools/serial_plotter.py (or a raw log of the serial
+ *     CSV stream): timestamp_ms,x,y,z,... in g
+ *   - Binary serial stream captures ('b' command): stream frames,
+ *     resynchronised on the sync word and checked by CRC
+ *   - Flash log partition dumps (esptool.py read_flash of the gslog
+ *     partition): LogBlock sectors, replayed in sequence order
+ */
+
+#ifndef CAPTURE_READER_H
+#define CAPTURE_READER_H
+
+#include <string>
+#include <vector>
+#include "signal_processing.h"
+
+/**
+ * @brief Format of a loaded capture
+ */
+enum class CaptureFormat : uint8_t {
+    CSV = 0,
+    STREAM_FRAMES,
+    FLASH_LOG
+};
+
+/**
+ * @brief One recorded sample
+ */
+struct CaptureSample {
+    uint32_t timestampUs;
+    RawAccel counts;   // Calibrated counts
+    uint16_t rateHz;   // Sample rate when recorded
+};
+
+/**
+ * @brief A whole capture in memory
+ */
+struct Capture {
+    CaptureFormat format;
+    std::vector<CaptureSample> samples;
+    uint32_t skipped;  // Unparseable lines, bad frames or invalid blocks
+};
+
+/**
+ * @brief Get a format's name
+ */
+const char* captureFormatName(CaptureFormat format);
+
+/**
+ * @brief Load a capture file
+ *
+ * @param path File to read
+ * @param rateHz Sample rate for CSV files without a "# Sample Rate"
+ *               comment (0 = infer from the timestamps)
+ * @param out Destination
+ * @param error Reason when loading fails
+ * @return true if at least one sample was loaded
+ */
+bool loadCapture(const char* path, uint32_t rateHz, Capture& out, std::string& error);
+
+#endif // CAPTURE_READER_H
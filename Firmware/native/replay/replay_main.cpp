@@ -0,0 +1,195 @@
+/**
+ * @file replay_main.cpp
+ * @brief Host replay of recorded captures through the signal pipeline
+ *
+ * Built by the native environment (pio run -e native). Feeds every
+ * sample of a capture through the same objects the sampler task runs
+ * (filter chain and peak tracking, window statistics, impact capture)
+ * as fast as the host allows, then prints machine-readable results:
+ *
+ *   replay,<file>,<format>,<samples>,<skipped>,<rate_hz>
+ *   event,<seq>,<trigger_us>,<peak_g>,<peak_offset_us>,<above_us>
+ *   stats,<seq>,<end_us>,<rms_x>,<rms_y>,<rms_z>,<rms_mag>,<max_mag>   (--stats)
+ *   summary,<samples>,<events>,<peak_g>,<elapsed_ms>,<samples_per_s>
+ *
+ * Usage: program [options] <capture>
+ *   --preset N        Filter preset (default FILTER_DEFAULT_PRESET)
+ *   --filter D,H,L,A  Custom filter: DC block 0/1, high-pass Hz, low-pass Hz, average ms
+ *   --threshold G     Impact threshold in g (default IMPACT_DEFAULT_THRESHOLD_G)
+ *   --rate HZ         Override the recorded sample rate
+ *   --repeat N        Replay the capture N times back to back (throughput runs)
+ *   --stats           Print every 1 s window summary
+ *   --quiet           Print only the summary
+ *   --expect-events N Exit with status 1 unless exactly N events are captured
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "config.h"
+#include "signal_processing.h"
+#include "filter_chain.h"
+#include "window_stats.h"
+#include "impact_capture.h"
+#include "capture_reader.h"
+
+struct ReplayOptions {
+    const char* path = nullptr;
+    FilterConfig filter = {};
+    float thresholdG = IMPACT_DEFAULT_THRESHOLD_G;
+    uint32_t rateHz = 0;
+    uint32_t repeat = 1;
+    bool stats = false;
+    bool quiet = false;
+    long expectEvents = -1;
+};
+
+// Pipeline objects are large (event buffers), so they live outside main()
+static FixedSignalProcessor processor;
+static WindowStats windowStats;
+static ImpactCapture capture;
+
+static void usage() {
+    std::fprintf(stderr,
+        "Usage: program [--preset N] [--filter D,H,L,A] [--threshold G] [--rate HZ]\n"
+        "               [--repeat N] [--stats] [--quiet] [--expect-events N] <capture>\n");
+}
+
+static bool parseOptions(int argc, char** argv, ReplayOptions& options) {
+    filterPreset(FILTER_DEFAULT_PRESET, options.filter);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--preset") == 0 && hasValue) {
+            if (!filterPreset(static_cast<uint8_t>(std::atoi(argv[++i])), options.filter)) {
+                std::fprintf(stderr, "Invalid preset (0-%d)\n", FILTER_PRESET_COUNT - 1);
+                return false;
+            }
+        } else if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+            unsigned dc, high, low, average;
+            if (std::sscanf(argv[++i], "%u,%u,%u,%u", &dc, &high, &low, &average) != 4) {
+                std::fprintf(stderr, "--filter takes dc,highpass_hz,lowpass_hz,average_ms\n");
+                return false;
+            }
+            options.filter = {dc != 0, static_cast<uint16_t>(high), static_cast<uint16_t>(low),
+                              static_cast<uint16_t>(average)};
+            if (!options.filter.isValid()) {
+                std::fprintf(stderr, "Filter out of range\n");
+                return false;
+            }
+        } else if (std::strcmp(arg, "--threshold") == 0 && hasValue) {
+            options.thresholdG = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            options.rateHz = static_cast<uint32_t>(std::atol(argv[++i]));
+        } else if (std::strcmp(arg, "--repeat") == 0 && hasValue) {
+            options.repeat = static_cast<uint32_t>(std::atol(argv[++i]));
+        } else if (std::strcmp(arg, "--stats") == 0) {
+            options.stats = true;
+        } else if (std::strcmp(arg, "--quiet") == 0) {
+            options.quiet = true;
+        } else if (std::strcmp(arg, "--expect-events") == 0 && hasValue) {
+            options.expectEvents = std::atol(argv[++i]);
+        } else if (arg[0] != '-' && options.path == nullptr) {
+            options.path = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.path != nullptr && options.repeat > 0;
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    Capture recording;
+    std::string error;
+    if (!loadCapture(options.path, options.rateHz, recording, error)) {
+        std::fprintf(stderr, "%s: %s\n", options.path, error.c_str());
+        return 2;
+    }
+    if (!capture.setThresholdG(options.thresholdG)) {
+        std::fprintf(stderr, "Invalid threshold %.1f g\n", options.thresholdG);
+        return 2;
+    }
+
+    const std::vector<CaptureSample>& samples = recording.samples;
+    uint32_t rateHz = samples.front().rateHz;
+    processor.configure(options.filter, rateHz);
+    std::printf("replay,%s,%s,%zu,%u,%u\n", options.path, captureFormatName(recording.format),
+                samples.size(), recording.skipped, rateHz);
+
+    // Repeats continue the timeline after the end of the capture
+    uint32_t spanUs = samples.back().timestampUs - samples.front().timestampUs + 1000000 / rateHz;
+    int32_t thresholdQ4 = capture.getThresholdFixed();
+    uint32_t events = 0;
+    uint32_t statsSeen = 0;
+    int32_t peakQ4 = 0;
+    uint64_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < options.repeat; pass++) {
+        uint32_t offsetUs = pass * spanUs;
+        for (const CaptureSample& sample : samples) {
+            // As in Sampler::applySampleRate()
+            if (sample.rateHz != rateHz) {
+                rateHz = sample.rateHz;
+                processor.configure(options.filter, rateHz);
+                windowStats.reset();
+                capture.reset();
+            }
+
+            uint32_t timestampUs = sample.timestampUs + offsetUs;
+
+            // Same order of work as Sampler::drainFifo()
+            AccelFixed filtered = processor.process(AccelFixed::fromCounts(sample.counts));
+            windowStats.addSample(timestampUs, filtered, processor.getFilteredMagnitude(), thresholdQ4, rateHz);
+            capture.addSample(timestampUs, sample.counts, rateHz);
+            total++;
+
+            if (capture.eventCount() != events) {
+                events = capture.eventCount();
+                ImpactStats stats;
+                if (capture.latestStats(stats)) {
+                    if (stats.peakMagnitude > peakQ4) {
+                        peakQ4 = stats.peakMagnitude;
+                    }
+                    if (!options.quiet) {
+                        std::printf("event,%u,%u,%.2f,%u,%u\n", stats.sequence, stats.triggerUs,
+                                    stats.peakG(), stats.peakOffsetUs, stats.aboveThresholdUs);
+                    }
+                }
+            }
+
+            if (options.stats && !options.quiet && windowStats.summaryCount() != statsSeen) {
+                statsSeen = windowStats.summaryCount();
+                StatsSummary summary;
+                if (windowStats.latest(StatsWindow::SHORT, summary)) {
+                    const ChannelStats* ch = summary.channels;
+                    std::printf("stats,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", summary.sequence, summary.endUs,
+                                fixedToG(ch[0].rms), fixedToG(ch[1].rms), fixedToG(ch[2].rms),
+                                fixedToG(ch[3].rms), fixedToG(ch[3].max));
+                }
+            }
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double elapsedMs = std::chrono::duration<double, std::milli>(elapsed).count();
+    double perSecond = elapsedMs > 0.0 ? total * 1000.0 / elapsedMs : 0.0;
+
+    std::printf("summary,%llu,%u,%.2f,%.1f,%.0f\n", static_cast<unsigned long long>(total), events,
+                fixedToG(peakQ4), elapsedMs, perSecond);
+
+    if (options.expectEvents >= 0 && static_cast<long>(events) != options.expectEvents) {
+        std::fprintf(stderr, "Expected %ld events, captured %u\n", options.expectEvents, events);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file ring_check_main.cpp
+ * @brief Host checks of the lock-free sample buffers
+ *
+ * Built by the native_ring environment (pio run -e native_ring). Runs
+ * SampleRing and DoubleBuffered through empty, partial, full and lapped
+ * readers (producer and reader on the same thread), and prints one line
+ * per check:
+ *
+ *   check,<name>,ok|FAIL
+ *   summary,<checks>,<failed>
+ *
+ * Exits with status 1 if any check fails. A read() that never returns
+ * is reported as a failure after CHECK_TIMEOUT_MS instead of hanging.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "sample_ring.h"
+
+using Ring = SampleRing<int, 8>;
+
+constexpr uint32_t CHECK_TIMEOUT_MS = 2000;
+
+static uint32_t checks = 0;
+static uint32_t failed = 0;
+
+static void report(const char* name, bool ok) {
+    checks++;
+    if (!ok) {
+        failed++;
+    }
+    std::printf("check,%s,%s\n", name, ok ? "ok" : "FAIL");
+}
+
+/**
+ * @brief Read everything pending, in order
+ *
+ * @param reader Reader to drain
+ * @param out Destination for the samples
+ * @param capacity Size of out
+ * @return size_t Samples read
+ */
+static size_t drain(Ring::Reader& reader, int* out, size_t capacity) {
+    size_t count = 0;
+    int value;
+    while (count < capacity && reader.read(value)) {
+        out[count++] = value;
+    }
+    return count;
+}
+
+static bool isSequence(const int* values, size_t count, int first) {
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] != first + static_cast<int>(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void checkEmpty() {
+    Ring ring;
+    Ring::Reader reader(ring);
+    int value;
+    report("empty_read", !reader.read(value) && reader.available() == 0);
+    report("empty_latest", !ring.latest(value));
+}
+
+static void checkInOrder() {
+    Ring ring;
+    Ring::Reader reader(ring);
+    for (int i = 0; i < 5; i++) {
+        ring.push(i);
+    }
+
+    int values[Ring::capacity()];
+    report("available", reader.available() == 5);
+    size_t count = drain(reader, values, Ring::capacity());
+    report("in_order", count == 5 && isSequence(values, count, 0) && reader.dropped() == 0);
+
+    int latest = -1;
+    report("latest", ring.latest(latest) && latest == 4);
+}
+
+static void checkFull() {
+    Ring ring;
+    Ring::Reader reader(ring);
+    for (int i = 0; i < static_cast<int>(Ring::capacity()); i++) {
+        ring.push(i);
+    }
+
+    // The oldest slot is the next one written, so one sample is dropped
+    int values[Ring::capacity()];
+    report("full_available", reader.available() == Ring::capacity() - 1);
+    size_t count = drain(reader, values, Ring::capacity());
+    report("full_read", count == Ring::capacity() - 1 && isSequence(values, count, 1)
+                        && reader.dropped() == 1);
+}
+
+static void checkLapped() {
+    Ring ring;
+    Ring::Reader reader(ring);
+    for (int i = 0; i < 20; i++) {
+        ring.push(i);
+    }
+
+    int values[Ring::capacity()];
+    size_t count = drain(reader, values, Ring::capacity());
+    report("lapped_read", count == Ring::capacity() - 1 && isSequence(values, count, 13)
+                          && reader.dropped() == 13);
+
+    // Keeps working after the lap, also when lapped again
+    ring.push(20);
+    count = drain(reader, values, Ring::capacity());
+    report("lapped_resume", count == 1 && values[0] == 20);
+
+    for (int i = 21; i < 100; i++) {
+        ring.push(i);
+    }
+    count = drain(reader, values, Ring::capacity());
+    report("lapped_again", count == Ring::capacity() - 1 && isSequence(values, count, 93)
+                           && reader.dropped() == 13 + 72);
+}
+
+static void checkSkip() {
+    Ring ring;
+    Ring::Reader reader(ring);
+    for (int i = 0; i < 3; i++) {
+        ring.push(i);
+    }
+    reader.skipToLatest();
+    int value;
+    report("skip_to_latest", !reader.read(value) && reader.dropped() == 0);
+}
+
+struct Pair {
+    int value[2];
+};
+
+static void checkDoubleBuffered() {
+    DoubleBuffered<Pair> buffered;
+    Pair out = {{-1, -1}};
+    report("double_empty", !buffered.read(out) && buffered.sequence() == 0);
+
+    for (int i = 1; i <= 3; i++) {
+        report("double_next_sequence", buffered.nextSequence() == static_cast<uint32_t>(i));
+        Pair& slot = buffered.next();
+        slot.value[0] = i;
+        slot.value[1] = i * 10;
+        buffered.publish();
+    }
+    report("double_read", buffered.read(out) && out.value[0] == 3 && out.value[1] == 30
+                          && buffered.sequence() == 3);
+
+    int part = -1;
+    report("double_read_part", buffered.read(part, [](const Pair& pair) -> const int& {
+        return pair.value[1];
+    }) && part == 30);
+
+    // Unpublished writes stay invisible
+    buffered.next().value[0] = 99;
+    report("double_unpublished", buffered.read(out) && out.value[0] == 3);
+}
+
+static void runChecks() {
+    checkEmpty();
+    checkInOrder();
+    checkFull();
+    checkLapped();
+    checkSkip();
+    checkDoubleBuffered();
+}
+
+int main() {
+    // A read() that spins is the failure this guards against, so run the
+    // checks on a thread and give up on it after the timeout
+    std::atomic<bool> done(false);
+    std::thread worker([&done]() {
+        runChecks();
+        done.store(true);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    while (!done.load()) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(CHECK_TIMEOUT_MS)) {
+            std::printf("check,timeout,FAIL\n");
+            std::fflush(stdout);
+            std::_Exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    worker.join();
+
+    std::printf("summary,%u,%u\n", checks, failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino / FreeRTOS shim for the native (host) build
+ *
+ * Only what the hardware-independent sources need: fixed-width types,
+ * math and the FreeRTOS types named in config.h. Anything that touches
+ * a peripheral, a task or the clock is deliberately missing, so a
+ * hardware dependency creeping into the signal-processing core fails
+ * the native build.
+ */
+
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define IRAM_ATTR
+
+// FreeRTOS types used by config.h and the task-owning headers
+typedef unsigned int UBaseType_t;
+typedef int BaseType_t;
+typedef void* TaskHandle_t;
+#define configMAX_PRIORITIES 25
+
+#endif // ARDUINO_SHIM_H
@@ -0,0 +1,15 @@
+/**
+ * @file esp_partition.h
+ * @brief Opaque partition types for the native build
+ *
+ * Lets flash_logger.h be included for the log block layout; the logger
+ * itself is not built on the host.
+ */
+
+#ifndef ESP_PARTITION_SHIM_H
+#define ESP_PARTITION_SHIM_H
+
+typedef int esp_err_t;
+typedef struct esp_partition_t esp_partition_t;
+
+#endif // ESP_PARTITION_SHIM_H
@@ -4,51 +4,106 @@
  */
 
 #include "accelerometer.h"
+#include "time_sync.h"
+
+// ADXL375 register addresses
+constexpr uint8_t ADXL375_REG_DEVID       = 0x00;
+constexpr uint8_t ADXL375_REG_THRESH_SHOCK = 0x1D;
+constexpr uint8_t ADXL375_REG_OFSX        = 0x1E;
+constexpr uint8_t ADXL375_REG_OFSY        = 0x1F;
+constexpr uint8_t ADXL375_REG_OFSZ        = 0x20;
+constexpr uint8_t ADXL375_REG_DUR         = 0x21;
+constexpr uint8_t ADXL375_REG_LATENT      = 0x22;
+constexpr uint8_t ADXL375_REG_WINDOW      = 0x23;
+constexpr uint8_t ADXL375_REG_SHOCK_AXES  = 0x2A;
+constexpr uint8_t ADXL375_REG_BW_RATE     = 0x2C;
+constexpr uint8_t ADXL375_REG_POWER_CTL   = 0x2D;
+constexpr uint8_t ADXL375_REG_INT_ENABLE  = 0x2E;
+constexpr uint8_t ADXL375_REG_INT_MAP     = 0x2F;
+constexpr uint8_t ADXL375_REG_INT_SOURCE  = 0x30;
+constexpr uint8_t ADXL375_REG_DATA_FORMAT = 0x31;
+constexpr uint8_t ADXL375_REG_DATAX0      = 0x32;
+constexpr uint8_t ADXL375_REG_FIFO_CTL    = 0x38;
+constexpr uint8_t ADXL375_REG_FIFO_STATUS = 0x39;
+
+// Register bit fields
+constexpr uint8_t ADXL375_DEVICE_ID          = 0xE5;
+constexpr uint8_t ADXL375_POWER_CTL_MEASURE  = 0x08;
+constexpr uint8_t ADXL375_DATA_FORMAT_DEFAULT = 0x0B;  // Right-justified; D3, D1, D0 must be set
+constexpr uint8_t ADXL375_INT_SINGLE_SHOCK   = 0x40;
+constexpr uint8_t ADXL375_INT_WATERMARK      = 0x02;
+constexpr uint8_t ADXL375_SHOCK_AXES_XYZ     = 0x07;
+constexpr float ADXL375_SHOCK_THRESH_G_PER_LSB = 0.780f;
+constexpr uint32_t ADXL375_SHOCK_DUR_US_PER_LSB = 625;
+constexpr uint8_t ADXL375_FIFO_MODE_BYPASS   = 0x00;
+constexpr uint8_t ADXL375_FIFO_MODE_STREAM   = 0x80;
+constexpr uint8_t ADXL375_FIFO_SAMPLES_MASK  = 0x1F;
+constexpr uint8_t ADXL375_FIFO_ENTRIES_MASK  = 0x3F;
+
+// Re-anchor the FIFO timestamps when the rebuilt clock is this many sample
+// periods away from the synced clock (e.g. after a FIFO overflow lost
+// samples, or the first time sync stepped the clock)
+constexpr int32_t FIFO_RESYNC_PERIODS = 8;
+
+// Register reads that must all verify before the fast I2C clock is kept
+constexpr uint8_t I2C_PROBE_READS = 16;
 
 Accelerometer::Accelerometer()
     : i2cBus_(0)  // Use I2C bus 0 (ESP32-C3 has one hardware I2C)
-    , adxl_(nullptr)
-    , initialized_(false) {
+    , initialized_(false)
+    , deviceId_(0)
+    , i2cClockHz_(ADXL_I2C_CLOCK_HZ)
+    , interruptMask_(ADXL375_INT_WATERMARK)
+    , residualQ4_{0, 0, 0}
+    , residualCounts_{0, 0, 0}
+    , sampleRateHz_(ADXL_DEFAULT_SAMPLE_RATE_HZ)
+    , samplePeriodQ8_((1000000ULL << 8) / ADXL_DEFAULT_SAMPLE_RATE_HZ)
+    , nextTimestampQ8_(0)
+    , timestampValid_(false) {
 }
 
 bool Accelerometer::begin() {
     // Initialize I2C on custom pins (JST connector)
     // Reason: ESP32-C3 Wire library allows specifying custom SDA/SCL pins
-    if (!i2cBus_.begin(PIN_ADXL_SDA, PIN_ADXL_SCL, 400000)) {
+    if (!i2cBus_.begin(PIN_ADXL_SDA, PIN_ADXL_SCL, ADXL_I2C_CLOCK_HZ)) {
         if (DEBUG_ENABLED) {
             Serial.println("ERROR: Failed to initialize I2C bus");
         }
         return false;
     }
+    i2cClockHz_ = ADXL_I2C_CLOCK_HZ;
 
-    // Create ADXL375 instance with custom I2C bus
-    adxl_ = new Adafruit_ADXL375(12345, &i2cBus_);
-
-    // Initialize sensor
-    if (!adxl_->begin(ADXL375_I2C_ADDR)) {
+    // Verify device ID
+    if (!readRegisters(ADXL375_REG_DEVID, &deviceId_, 1) || deviceId_ != ADXL375_DEVICE_ID) {
         if (DEBUG_ENABLED) {
             Serial.print("ERROR: ADXL375 not found at address 0x");
             Serial.println(ADXL375_I2C_ADDR, HEX);
         }
-        delete adxl_;
-        adxl_ = nullptr;
         return false;
     }
 
-    // Verify device ID
-    uint8_t deviceId = getDeviceID();
-    if (deviceId != 0xE5) {
+    // Configure in standby, then start measuring
+    // Reason: the datasheet recommends changing BW_RATE/FIFO settings
+    // while the part is not measuring
+    bool ok = writeRegister(ADXL375_REG_POWER_CTL, 0x00);
+    ok &= writeRegister(ADXL375_REG_DATA_FORMAT, ADXL375_DATA_FORMAT_DEFAULT);
+    ok &= writeRegister(ADXL375_REG_INT_ENABLE, 0x00);
+    ok &= writeRegister(ADXL375_REG_FIFO_CTL, ADXL375_FIFO_MODE_BYPASS);
+    if (!ok) {
         if (DEBUG_ENABLED) {
-            Serial.print("WARNING: Unexpected device ID: 0x");
-            Serial.println(deviceId, HEX);
+            Serial.println("ERROR: ADXL375 configuration failed");
         }
+        return false;
     }
 
     // Configure sensor for high-speed operation
     // Reason: We want responsive readings for impact detection
-    adxl_->setDataRate(ADXL3XX_DATARATE_100_HZ);
-
     initialized_ = true;
+    setHardwareOffsets(0, 0, 0);
+    setDataRate(Adxl375DataRate::RATE_100_HZ);
+    writeRegister(ADXL375_REG_POWER_CTL, ADXL375_POWER_CTL_MEASURE);
+
+    probeFastClock();
 
     if (DEBUG_ENABLED) {
         Serial.println("ADXL375 initialized successfully");
@@ -59,70 +114,326 @@ bool Accelerometer::begin() {
         Serial.print("  Address: 0x");
         Serial.println(ADXL375_I2C_ADDR, HEX);
         Serial.print("  Device ID: 0x");
-        Serial.println(deviceId, HEX);
+        Serial.println(deviceId_, HEX);
+        Serial.print("  I2C clock: ");
+        Serial.print(i2cClockHz_ / 1000);
+        Serial.println(" kHz");
     }
 
     return true;
 }
 
+void Accelerometer::probeFastClock() {
+    if (ADXL_I2C_FAST_CLOCK_HZ <= ADXL_I2C_CLOCK_HZ) {
+        return;
+    }
+
+    i2cBus_.setClock(ADXL_I2C_FAST_CLOCK_HZ);
+
+    // Device ID and BW_RATE read-back must match on every try
+    uint8_t expectedRate = static_cast<uint8_t>(Adxl375DataRate::RATE_100_HZ);
+    bool reliable = true;
+    for (uint8_t i = 0; i < I2C_PROBE_READS && reliable; i++) {
+        uint8_t id = 0;
+        uint8_t rate = 0;
+        reliable = readRegisters(ADXL375_REG_DEVID, &id, 1) && id == ADXL375_DEVICE_ID
+                && readRegisters(ADXL375_REG_BW_RATE, &rate, 1) && rate == expectedRate;
+    }
+
+    if (reliable) {
+        i2cClockHz_ = ADXL_I2C_FAST_CLOCK_HZ;
+    } else {
+        i2cBus_.setClock(ADXL_I2C_CLOCK_HZ);
+        if (DEBUG_ENABLED) {
+            Serial.println("WARNING: I2C unreliable at fast clock, using 400 kHz");
+        }
+    }
+}
+
 bool Accelerometer::read(AccelData& data) {
-    if (!initialized_ || adxl_ == nullptr) {
+    RawAccel raw;
+    if (!readRaw(raw)) {
         data = {0.0f, 0.0f, 0.0f};
         return false;
     }
 
-    sensors_event_t event;
-    if (!adxl_->getEvent(&event)) {
+    // Scale straight from counts to g
+    // Reason: going through the Adafruit m/s^2 event costs extra soft-float
+    // conversions and I2C transactions on an FPU-less core
+    RawAccel counts = calibrate(raw);
+    data.x = counts.x * ADXL375_SCALE_FACTOR;
+    data.y = counts.y * ADXL375_SCALE_FACTOR;
+    data.z = counts.z * ADXL375_SCALE_FACTOR;
+
+    return true;
+}
+
+bool Accelerometer::readRaw(RawAccel& raw) {
+    uint8_t buf[6];
+    if (!initialized_ || !readRegisters(ADXL375_REG_DATAX0, buf, sizeof(buf))) {
+        raw = {0, 0, 0};
         return false;
     }
 
-    // Convert from m/s^2 to g
-    // Reason: The Adafruit library returns values in m/s^2, but for
-    // impact/vibration analysis, g-force is more intuitive
-    constexpr float MS2_TO_G = 1.0f / 9.80665f;
+    raw.x = static_cast<int16_t>(buf[0] | (buf[1] << 8));
+    raw.y = static_cast<int16_t>(buf[2] | (buf[3] << 8));
+    raw.z = static_cast<int16_t>(buf[4] | (buf[5] << 8));
+    return true;
+}
 
-    // Apply calibration offsets to remove sensor bias
-    data.x = (event.acceleration.x * MS2_TO_G) - OFFSET_X;
-    data.y = (event.acceleration.y * MS2_TO_G) - OFFSET_Y;
-    data.z = (event.acceleration.z * MS2_TO_G) - OFFSET_Z;
+RawAccel Accelerometer::calibrate(const RawAccel& raw) const {
+    return {
+        static_cast<int16_t>(raw.x - residualCounts_.x),
+        static_cast<int16_t>(raw.y - residualCounts_.y),
+        static_cast<int16_t>(raw.z - residualCounts_.z)
+    };
+}
 
-    return true;
+AccelFixed Accelerometer::toFixed(const RawAccel& raw) const {
+    AccelFixed fixed = AccelFixed::fromCounts(raw);
+    fixed.x -= residualQ4_.x;
+    fixed.y -= residualQ4_.y;
+    fixed.z -= residualQ4_.z;
+    return fixed;
+}
+
+bool Accelerometer::setCalibration(const AccelCalibration& calibration) {
+    residualQ4_ = {calibration.residualQ4[0], calibration.residualQ4[1], calibration.residualQ4[2]};
+    residualCounts_ = calibration.residualCounts();
+    return setHardwareOffsets(calibration.hardware[0], calibration.hardware[1], calibration.hardware[2]);
 }
 
 bool Accelerometer::isConnected() const {
-    return initialized_ && adxl_ != nullptr;
+    return initialized_;
 }
 
 uint8_t Accelerometer::getDeviceID() const {
-    if (adxl_ == nullptr) {
-        return 0;
+    return deviceId_;
+}
+
+void Accelerometer::setDataRate(Adxl375DataRate rate) {
+    if (!initialized_) {
+        return;
     }
-    return adxl_->getDeviceID();
+
+    uint8_t code = static_cast<uint8_t>(rate);
+    writeRegister(ADXL375_REG_BW_RATE, code);
+
+    // Rate codes double per step, with 0b1111 = 3200 Hz
+    sampleRateHz_ = 3200UL >> (static_cast<uint8_t>(Adxl375DataRate::RATE_3200_HZ) - code);
+    samplePeriodQ8_ = (1000000ULL << 8) / sampleRateHz_;
+    timestampValid_ = false;
 }
 
-void Accelerometer::setDataRate(adxl3xx_dataRate_t rate) {
-    if (adxl_ != nullptr) {
-        adxl_->setDataRate(rate);
+uint32_t Accelerometer::getSampleRateHz() const {
+    return sampleRateHz_;
+}
+
+bool Accelerometer::setHardwareOffsets(int8_t x, int8_t y, int8_t z) {
+    if (!initialized_) {
+        return false;
     }
+
+    bool ok = writeRegister(ADXL375_REG_OFSX, static_cast<uint8_t>(x));
+    ok &= writeRegister(ADXL375_REG_OFSY, static_cast<uint8_t>(y));
+    ok &= writeRegister(ADXL375_REG_OFSZ, static_cast<uint8_t>(z));
+    return ok;
 }
 
-void Accelerometer::getRawValues(int16_t& x, int16_t& y, int16_t& z) {
-    if (adxl_ == nullptr) {
-        x = y = z = 0;
+uint32_t Accelerometer::getI2cClockHz() const {
+    return i2cClockHz_;
+}
+
+bool Accelerometer::enableFifoStream(uint8_t watermark) {
+    if (!initialized_) {
+        return false;
+    }
+
+    if (watermark < 1) {
+        watermark = 1;
+    } else if (watermark > ADXL375_FIFO_DEPTH - 1) {
+        watermark = ADXL375_FIFO_DEPTH - 1;
+    }
+
+    // Interrupts must be mapped before they are enabled (datasheet).
+    // INT_MAP bit clear = INT1, so watermark goes to INT1.
+    bool ok = writeRegister(ADXL375_REG_INT_ENABLE, 0x00);
+    ok &= writeRegister(ADXL375_REG_INT_MAP, 0x00);
+
+    // Passing through bypass mode flushes any stale entries
+    ok &= writeRegister(ADXL375_REG_FIFO_CTL, ADXL375_FIFO_MODE_BYPASS);
+    ok &= writeRegister(ADXL375_REG_FIFO_CTL,
+                        ADXL375_FIFO_MODE_STREAM | (watermark & ADXL375_FIFO_SAMPLES_MASK));
+    ok &= writeRegister(ADXL375_REG_INT_ENABLE, interruptMask_);
+
+    timestampValid_ = false;
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("ADXL375 FIFO stream mode, watermark %d\n", watermark);
+    }
+
+    return ok;
+}
+
+bool Accelerometer::configureShock(float thresholdG, uint32_t maxDurationUs) {
+    if (!initialized_) {
+        return false;
+    }
+
+    uint32_t threshold = static_cast<uint32_t>(thresholdG / ADXL375_SHOCK_THRESH_G_PER_LSB);
+    uint32_t duration = maxDurationUs / ADXL375_SHOCK_DUR_US_PER_LSB;
+    threshold = threshold < 1 ? 1 : (threshold > 255 ? 255 : threshold);
+    duration = duration < 1 ? 1 : (duration > 255 ? 255 : duration);
+
+    bool ok = writeRegister(ADXL375_REG_THRESH_SHOCK, static_cast<uint8_t>(threshold));
+    ok &= writeRegister(ADXL375_REG_DUR, static_cast<uint8_t>(duration));
+    ok &= writeRegister(ADXL375_REG_LATENT, 0x00);
+    ok &= writeRegister(ADXL375_REG_WINDOW, 0x00);
+    ok &= writeRegister(ADXL375_REG_SHOCK_AXES, ADXL375_SHOCK_AXES_XYZ);
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("ADXL375 shock threshold %.2f g per axis\n",
+                      threshold * ADXL375_SHOCK_THRESH_G_PER_LSB);
+    }
+
+    return ok;
+}
+
+bool Accelerometer::setInterrupts(bool watermark, bool shock) {
+    interruptMask_ = (watermark ? ADXL375_INT_WATERMARK : 0)
+                   | (shock ? ADXL375_INT_SINGLE_SHOCK : 0);
+    if (!initialized_) {
+        return false;
+    }
+
+    // Interrupts must be mapped before they are enabled; all map to INT1
+    bool ok = writeRegister(ADXL375_REG_INT_ENABLE, 0x00);
+    ok &= writeRegister(ADXL375_REG_INT_MAP, 0x00);
+    readShockStatus();  // Drop a stale latch so the next shock raises a fresh edge
+    ok &= writeRegister(ADXL375_REG_INT_ENABLE, interruptMask_);
+    return ok;
+}
+
+bool Accelerometer::readShockStatus() {
+    uint8_t source = 0;
+    if (!initialized_ || !readRegisters(ADXL375_REG_INT_SOURCE, &source, 1)) {
+        return false;
+    }
+    return (source & ADXL375_INT_SINGLE_SHOCK) != 0;
+}
+
+void Accelerometer::disableFifo() {
+    if (!initialized_) {
         return;
     }
+    writeRegister(ADXL375_REG_INT_ENABLE, 0x00);
+    writeRegister(ADXL375_REG_FIFO_CTL, ADXL375_FIFO_MODE_BYPASS);
+}
 
-    // Read raw values directly from registers
-    // Reason: Useful for debugging and calibration
-    sensors_event_t event;
-    adxl_->getEvent(&event);
+uint8_t Accelerometer::fifoEntries() {
+    uint8_t status = 0;
+    if (!initialized_ || !readRegisters(ADXL375_REG_FIFO_STATUS, &status, 1)) {
+        return 0;
+    }
+    return status & ADXL375_FIFO_ENTRIES_MASK;
+}
 
-    // Convert back from m/s^2 to raw counts for debugging
-    // ADXL375 sensitivity: 49 mg/LSB
-    constexpr float G_TO_LSB = 1.0f / ADXL375_SCALE_FACTOR;
-    constexpr float MS2_TO_G = 1.0f / 9.80665f;
+size_t Accelerometer::readFifo(AccelSample* out, size_t maxSamples) {
+    size_t count = fifoEntries();
+    if (count > maxSamples) {
+        count = maxSamples;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // Each 6-byte burst from DATAX0 pops one X/Y/Z frame.
+    // Reason: reading past DATAZ1 continues into FIFO_CTL rather than the
+    // next entry, so the FIFO has to be drained one frame per transaction.
+    size_t read = 0;
+    for (; read < count; read++) {
+        uint8_t buf[6];
+        if (!readRegisters(ADXL375_REG_DATAX0, buf, sizeof(buf))) {
+            break;
+        }
+
+        RawAccel& raw = out[read].raw;
+        raw.x = static_cast<int16_t>(buf[0] | (buf[1] << 8));
+        raw.y = static_cast<int16_t>(buf[2] | (buf[3] << 8));
+        raw.z = static_cast<int16_t>(buf[4] | (buf[5] << 8));
+
+        out[read].counts = calibrate(raw);
+    }
 
-    x = static_cast<int16_t>(event.acceleration.x * MS2_TO_G * G_TO_LSB);
-    y = static_cast<int16_t>(event.acceleration.y * MS2_TO_G * G_TO_LSB);
-    z = static_cast<int16_t>(event.acceleration.z * MS2_TO_G * G_TO_LSB);
+    if (read == 0) {
+        return 0;
+    }
+
+    // Rebuild timestamps from the ODR
+    // Reason: the drain time says nothing about when each entry was taken.
+    // The newest entry is assumed to be "now"; between drains the clock
+    // free-runs at the sample period and is nudged 1/16 of the way
+    // towards the synced clock (micros() until a host syncs it) to track
+    // crystal drift between sensor and reference.
+    uint32_t nowUs = timeSync.nowUs();
+    uint32_t spanUs = static_cast<uint32_t>(((read - 1) * samplePeriodQ8_) >> 8);
+
+    if (timestampValid_) {
+        uint32_t predictedUs = static_cast<uint32_t>(
+            (nextTimestampQ8_ + (read - 1) * samplePeriodQ8_) >> 8);
+        int32_t errorUs = static_cast<int32_t>(nowUs - predictedUs);
+        int32_t limitUs = static_cast<int32_t>((FIFO_RESYNC_PERIODS * samplePeriodQ8_) >> 8);
+
+        if (errorUs > limitUs || errorUs < -limitUs) {
+            timestampValid_ = false;
+        } else {
+            nextTimestampQ8_ += static_cast<int64_t>(errorUs) * 16;
+        }
+    }
+
+    if (!timestampValid_) {
+        nextTimestampQ8_ = static_cast<uint64_t>(nowUs - spanUs) << 8;
+        timestampValid_ = true;
+    }
+
+    for (size_t i = 0; i < read; i++) {
+        out[i].timestampUs = static_cast<uint32_t>(nextTimestampQ8_ >> 8);
+        nextTimestampQ8_ += samplePeriodQ8_;
+    }
+
+    return read;
+}
+
+bool Accelerometer::writeRegister(uint8_t reg, uint8_t value) {
+    i2cBus_.beginTransmission(ADXL375_I2C_ADDR);
+    i2cBus_.write(reg);
+    i2cBus_.write(value);
+    return i2cBus_.endTransmission() == 0;
+}
+
+bool Accelerometer::readRegisters(uint8_t reg, uint8_t* buffer, size_t length) {
+    i2cBus_.beginTransmission(ADXL375_I2C_ADDR);
+    i2cBus_.write(reg);
+    if (i2cBus_.endTransmission(false) != 0) {
+        return false;
+    }
+
+    if (i2cBus_.requestFrom(ADXL375_I2C_ADDR, length, true) != length) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        buffer[i] = i2cBus_.read();
+    }
+    return true;
+}
+
+void Accelerometer::getRawValues(int16_t& x, int16_t& y, int16_t& z) {
+    // Read raw values directly from registers
+    // Reason: Useful for debugging and calibration
+    RawAccel raw;
+    readRaw(raw);
+    x = raw.x;
+    y = raw.y;
+    z = raw.z;
 }
@@ -2,7 +2,7 @@
  * @file accelerometer.h
  * @brief ADXL375 accelerometer driver
  *
- * Wrapper around Adafruit ADXL375 library with custom I2C bus support.
+ * Register-level driver for the ADXL375 on a custom I2C bus.
  */
 
 #ifndef ACCELEROMETER_H
@@ -10,15 +10,32 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_ADXL375.h>
 #include "config.h"
 #include "signal_processing.h"
+#include "calibration.h"
+
+/**
+ * @brief ADXL375 output data rate codes (BW_RATE register, normal power)
+ *
+ * Each step doubles the rate.
+ */
+enum class Adxl375DataRate : uint8_t {
+    RATE_25_HZ   = 0x08,
+    RATE_50_HZ   = 0x09,
+    RATE_100_HZ  = 0x0A,
+    RATE_200_HZ  = 0x0B,
+    RATE_400_HZ  = 0x0C,
+    RATE_800_HZ  = 0x0D,
+    RATE_1600_HZ = 0x0E,
+    RATE_3200_HZ = 0x0F
+};
 
 /**
  * @brief ADXL375 accelerometer interface
  *
  * Manages initialization and reading of the ADXL375 high-g accelerometer
- * connected via software I2C on the JST connector pins.
+ * connected via I2C on the JST connector pins. Talks to the registers
+ * directly: one burst read per sample, no heap allocation.
  */
 class Accelerometer {
 public:
@@ -46,6 +63,47 @@ public:
      */
     bool read(AccelData& data);
 
+    /**
+     * @brief Read the current sample as raw counts
+     *
+     * One 6-byte burst from DATAX0; no floating point.
+     *
+     * @param raw Output raw counts
+     * @return true if read successful
+     */
+    bool readRaw(RawAccel& raw);
+
+    /**
+     * @brief Remove the software part of the calibration from raw counts
+     *
+     * The hardware part is already applied by the sensor. The remainder
+     * is rounded to whole counts.
+     *
+     * @param raw Raw sensor counts
+     * @return RawAccel Calibrated counts
+     */
+    RawAccel calibrate(const RawAccel& raw) const;
+
+    /**
+     * @brief Calibrated fixed-point sample, keeping the sub-count remainder
+     *
+     * @param raw Raw sensor counts
+     * @return AccelFixed Calibrated Q4 counts
+     */
+    AccelFixed toFixed(const RawAccel& raw) const;
+
+    /**
+     * @brief Apply a calibration
+     *
+     * Programs the offset registers and keeps the remainder for
+     * calibrate() and toFixed(). Samples already in the FIFO were taken
+     * with the previous register values.
+     *
+     * @param calibration Register values and remainder
+     * @return true if the registers were written
+     */
+    bool setCalibration(const AccelCalibration& calibration);
+
     /**
      * @brief Check if accelerometer is connected and responding
      *
@@ -63,9 +121,111 @@ public:
     /**
      * @brief Set data rate
      *
-     * @param rate Data rate enum from Adafruit library
+     * Also updates the sample period used to rebuild FIFO timestamps.
+     *
+     * @param rate Output data rate code
+     */
+    void setDataRate(Adxl375DataRate rate);
+
+    /**
+     * @brief Get the configured output data rate
+     *
+     * @return uint32_t Sample rate in Hz
+     */
+    uint32_t getSampleRateHz() const;
+
+    /**
+     * @brief Write the hardware offset registers (OFSX/OFSY/OFSZ)
+     *
+     * The sensor adds these to every output sample before it reaches
+     * the data registers and FIFO. 0.196 g per LSB.
+     *
+     * @param x X offset (two's complement)
+     * @param y Y offset
+     * @param z Z offset
+     * @return true if the registers were written
+     */
+    bool setHardwareOffsets(int8_t x, int8_t y, int8_t z);
+
+    /**
+     * @brief Get the I2C clock chosen at begin()
+     *
+     * @return uint32_t Clock in Hz
+     */
+    uint32_t getI2cClockHz() const;
+
+    /**
+     * @brief Put the FIFO in stream mode with a watermark
+     *
+     * The FIFO keeps the newest 32 samples. The watermark interrupt is
+     * mapped to INT1 and asserts once `watermark` samples are queued
+     * (unless setInterrupts() turned it off).
+     *
+     * @param watermark Number of queued samples that raises INT1 (1-31)
+     * @return true if the registers were written
+     */
+    bool enableFifoStream(uint8_t watermark);
+
+    /**
+     * @brief Configure on-chip single-shock detection
+     *
+     * Shock detection compares each enabled axis against the threshold
+     * independently. Double-shock detection is left off (LATENT and
+     * WINDOW are zero).
+     *
+     * @param thresholdG Per-axis threshold (780 mg steps)
+     * @param maxDurationUs Longest event still counted as a shock (625 us steps)
+     * @return true if the registers were written
+     */
+    bool configureShock(float thresholdG, uint32_t maxDurationUs);
+
+    /**
+     * @brief Choose which interrupts drive INT1
+     *
+     * Both sources share INT1 so one GPIO serves either; read the cause
+     * with readShockStatus().
+     *
+     * @param watermark FIFO watermark interrupt
+     * @param shock Single-shock interrupt
+     * @return true if the register was written
+     */
+    bool setInterrupts(bool watermark, bool shock);
+
+    /**
+     * @brief Read and clear the shock interrupt status
+     *
+     * Reading INT_SOURCE releases INT1 so the next shock raises a new edge.
+     *
+     * @return true if a single shock was detected since the last read
+     */
+    bool readShockStatus();
+
+    /**
+     * @brief Return the FIFO to bypass mode (one sample register)
+     */
+    void disableFifo();
+
+    /**
+     * @brief Get number of samples waiting in the FIFO
+     *
+     * @return uint8_t Queued X/Y/Z frames (0-32)
      */
-    void setDataRate(adxl3xx_dataRate_t rate);
+    uint8_t fifoEntries();
+
+    /**
+     * @brief Drain queued samples from the FIFO
+     *
+     * Reads each queued frame with a 6-byte burst from DATAX0 and
+     * assigns timestamps spaced by the output data rate on the synced
+     * clock (see time_sync.h). Samples carry
+     * raw and calibrated counts only; conversion to g is left to the
+     * consumer.
+     *
+     * @param out Output array for drained samples
+     * @param maxSamples Capacity of out
+     * @return size_t Number of samples written to out
+     */
+    size_t readFifo(AccelSample* out, size_t maxSamples);
 
     /**
      * @brief Get raw sensor values for debugging
@@ -78,8 +238,25 @@ public:
 
 private:
     TwoWire i2cBus_;           // Custom I2C bus instance
-    Adafruit_ADXL375* adxl_;   // Adafruit driver instance
     bool initialized_;
+    uint8_t deviceId_;         // DEVID read at begin()
+    uint32_t i2cClockHz_;      // Bus clock in use
+    uint8_t interruptMask_;    // INT_ENABLE bits restored after FIFO restarts
+    AccelFixed residualQ4_;    // Calibration remainder after the offset registers
+    RawAccel residualCounts_;  // Same, rounded to whole counts
+
+    uint32_t sampleRateHz_;    // Current output data rate
+    uint64_t samplePeriodQ8_;  // Sample period in 1/256 us
+    uint64_t nextTimestampQ8_; // Expected time of next FIFO sample (1/256 us)
+    bool timestampValid_;      // False until the first drain anchors the clock
+
+    bool writeRegister(uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t length);
+
+    /**
+     * @brief Switch to the fast I2C clock if the bus is reliable at it
+     */
+    void probeFastClock();
 };
 
 #endif // ACCELEROMETER_H
@@ -12,11 +12,50 @@ BleService::BleService()
     , pPeakChar_(nullptr)
     , pControlChar_(nullptr)
     , pConfigChar_(nullptr)
+    , pBatchChar_(nullptr)
+    , pImpactChar_(nullptr)
+    , pStatsChar_(nullptr)
+    , pSpectrumChar_(nullptr)
+    , pDiagnosticsChar_(nullptr)
+    , pSyncChar_(nullptr)
+    , pLogChar_(nullptr)
+    , pCommandChar_(nullptr)
     , pAdvertising_(nullptr)
-    , deviceConnected_(false)
     , bleEnabled_(false)
+    , powerProfile_(PowerProfile::PERFORMANCE)
+    , commandCallback_(nullptr)
     , notificationRateHz_(BLE_DEFAULT_NOTIFY_RATE_HZ)
-    , commandCallback_(nullptr) {
+    , streamFormat_(BleStreamFormat::LEGACY)
+    , linkProfile_(BleLinkProfile::LOW_POWER)
+    , clients_{}
+    , clientsChanged_(false)
+    , nextClient_(0)
+    , batchClients_(0)
+    , lastIntervalCheckMs_(0)
+    , batchBuffer_{}
+    , batchWriter_(batchBuffer_, sizeof(batchBuffer_))
+    , batchStartMs_(0)
+    , batchMtu_(BLE_DEFAULT_MTU)
+    , syncRequest_{}
+    , syncRequestLength_(0)
+    , syncReceivedUs_(0)
+    , syncConnHandle_(BLE_HS_CONN_HANDLE_NONE)
+    , syncPending_(false)
+    , replyConnHandle_(BLE_HS_CONN_HANDLE_NONE)
+    , logRequest_{}
+    , logRequestLength_(0)
+    , logRequestHandle_(BLE_HS_CONN_HANDLE_NONE)
+    , logPending_(false)
+    , logConnHandle_(BLE_HS_CONN_HANDLE_NONE)
+    , commandRequest_{}
+    , commandRequestLength_(0)
+    , commandRequestHandle_(BLE_HS_CONN_HANDLE_NONE)
+    , commandPending_(false)
+    , commandConnHandle_(BLE_HS_CONN_HANDLE_NONE) {
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        clients_[i].connHandle = BLE_HS_CONN_HANDLE_NONE;
+    }
+    batchWriter_.setFrameLimit(BLE_DEFAULT_MTU - BLE_ATT_NOTIFY_OVERHEAD);
 }
 
 bool BleService::begin(const char* deviceName) {
@@ -27,8 +66,8 @@ bool BleService::begin(const char* deviceName) {
     // Initialize NimBLE
     NimBLEDevice::init(deviceName);
 
-    // Set power level (ESP32-C3 supports up to +20 dBm)
-    NimBLEDevice::setPower(ESP_PWR_LVL_P9);  // +9 dBm - good balance of range and power
+    // Offer a large ATT MTU so batched frames carry many samples
+    NimBLEDevice::setMTU(BLE_PREFERRED_MTU);
 
     // Create GATT server
     pServer_ = NimBLEDevice::createServer();
@@ -65,8 +104,66 @@ bool BleService::begin(const char* deviceName) {
     );
     pConfigChar_->setCallbacks(this);
 
+    // Create batched sample characteristic (notify)
+    pBatchChar_ = pService_->createCharacteristic(
+        BLE_CHAR_BATCH_UUID,
+        NIMBLE_PROPERTY::NOTIFY
+    );
+    pBatchChar_->setCallbacks(this);
+
+    // Create impact event characteristic (read + notify)
+    pImpactChar_ = pService_->createCharacteristic(
+        BLE_CHAR_IMPACT_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+    );
+    pImpactChar_->setCallbacks(this);
+
+    // Create window statistics characteristic (read + notify)
+    pStatsChar_ = pService_->createCharacteristic(
+        BLE_CHAR_STATS_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+    );
+    pStatsChar_->setCallbacks(this);
+
+    // Create spectrum summary characteristic (read + notify)
+    pSpectrumChar_ = pService_->createCharacteristic(
+        BLE_CHAR_SPECTRUM_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+    );
+    pSpectrumChar_->setCallbacks(this);
+
+#if GSENSOR_PROFILING
+    // Create timing diagnostics characteristic (read + notify)
+    pDiagnosticsChar_ = pService_->createCharacteristic(
+        BLE_CHAR_DIAGNOSTICS_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+    );
+    pDiagnosticsChar_->setCallbacks(this);
+#endif
+
+    // Create time sync characteristic (read + write + notify)
+    pSyncChar_ = pService_->createCharacteristic(
+        BLE_CHAR_SYNC_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR | NIMBLE_PROPERTY::NOTIFY
+    );
+    pSyncChar_->setCallbacks(this);
+
+    // Create log transfer characteristic (write + notify)
+    pLogChar_ = pService_->createCharacteristic(
+        BLE_CHAR_LOG_UUID,
+        NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR | NIMBLE_PROPERTY::NOTIFY
+    );
+    pLogChar_->setCallbacks(this);
+
+    // Create command protocol characteristic (write + notify)
+    pCommandChar_ = pService_->createCharacteristic(
+        BLE_CHAR_COMMAND_UUID,
+        NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR | NIMBLE_PROPERTY::NOTIFY
+    );
+    pCommandChar_->setCallbacks(this);
+
     // Set initial config value
-    pConfigChar_->setValue(&notificationRateHz_, 1);
+    updateConfigValue(nullptr);
 
     // Start service
     pService_->start();
@@ -77,6 +174,7 @@ bool BleService::begin(const char* deviceName) {
     pAdvertising_->setScanResponse(true);
     pAdvertising_->setMinPreferred(0x06);  // For iOS compatibility
     pAdvertising_->setMaxPreferred(0x12);
+    applyRadioProfile();
     pAdvertising_->start();
 
     if (DEBUG_ENABLED) {
@@ -93,7 +191,10 @@ void BleService::stop() {
         pAdvertising_->stop();
     }
     NimBLEDevice::deinit(true);
-    deviceConnected_ = false;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        clients_[i].connHandle = BLE_HS_CONN_HANDLE_NONE;
+    }
+    clientsChanged_.store(true, std::memory_order_release);
     bleEnabled_ = false;
 
     // Reset pointers after deinit
@@ -103,6 +204,14 @@ void BleService::stop() {
     pPeakChar_ = nullptr;
     pControlChar_ = nullptr;
     pConfigChar_ = nullptr;
+    pBatchChar_ = nullptr;
+    pImpactChar_ = nullptr;
+    pStatsChar_ = nullptr;
+    pSpectrumChar_ = nullptr;
+    pDiagnosticsChar_ = nullptr;
+    pSyncChar_ = nullptr;
+    pLogChar_ = nullptr;
+    pCommandChar_ = nullptr;
     pAdvertising_ = nullptr;
 
     if (DEBUG_ENABLED) {
@@ -129,13 +238,219 @@ bool BleService::isEnabled() const {
 }
 
 bool BleService::isConnected() const {
-    return deviceConnected_;
+    return clientCount() > 0;
+}
+
+size_t BleService::clientCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients_[i].connHandle != BLE_HS_CONN_HANDLE_NONE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool BleService::getClient(size_t index, BleClient& out) const {
+    if (index >= BLE_MAX_CLIENTS || clients_[index].connHandle == BLE_HS_CONN_HANDLE_NONE) {
+        return false;
+    }
+    out = clients_[index];
+    return true;
+}
+
+bool BleService::hasStreamClients(BleStreamFormat format) const {
+    BleChannel channel = format == BleStreamFormat::BATCHED ? BleChannel::BATCH : BleChannel::ACCEL;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        const BleClient& client = clients_[i];
+        if (client.connHandle != BLE_HS_CONN_HANDLE_NONE && client.streamFormat == format
+            && client.subscribed(channel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t BleService::getFastestNotificationRate() const {
+    uint8_t fastest = 0;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        const BleClient& client = clients_[i];
+        if (client.connHandle != BLE_HS_CONN_HANDLE_NONE && client.streamFormat == BleStreamFormat::LEGACY
+            && client.subscribed(BleChannel::ACCEL) && client.notificationRateHz > fastest) {
+            fastest = client.notificationRateHz;
+        }
+    }
+    return fastest != 0 ? fastest : notificationRateHz_;
+}
+
+void BleService::update(uint32_t now) {
+    refreshClients();
+
+    // Reason: NimBLE has no callback for a central's parameter update, so
+    // the budgets follow the negotiated interval by polling
+    if (now - lastIntervalCheckMs_ < BLE_CONN_INTERVAL_CHECK_MS) {
+        return;
+    }
+    lastIntervalCheckMs_ = now;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        BleClient& client = clients_[i];
+        uint16_t handle = client.connHandle;
+        ble_gap_conn_desc desc;
+        if (handle != BLE_HS_CONN_HANDLE_NONE && ble_gap_conn_find(handle, &desc) == 0) {
+            client.interval = desc.conn_itvl;
+        }
+    }
+}
+
+void BleService::refreshClients() {
+    if (!clientsChanged_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    // Slower legacy clients average whole groups of the fastest packets
+    uint8_t fastest = getFastestNotificationRate();
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        BleClient& client = clients_[i];
+        uint8_t rate = client.notificationRateHz != 0 ? client.notificationRateHz : fastest;
+        uint8_t group = static_cast<uint8_t>((fastest + rate / 2) / rate);
+        group = group < 1 ? 1 : group;
+        if (group != client.legacyGroup) {
+            client.legacyGroup = group;
+            client.legacyCount = 0;
+            memset(client.legacySum, 0, sizeof(client.legacySum));
+        }
+    }
+
+    // Batch frames fit the smallest MTU among the clients that take them
+    size_t batchClients = 0;
+    uint16_t batchMtu = 0;
+    uint16_t anyMtu = 0;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        const BleClient& client = clients_[i];
+        if (client.connHandle == BLE_HS_CONN_HANDLE_NONE) {
+            continue;
+        }
+        anyMtu = anyMtu == 0 || client.mtu < anyMtu ? client.mtu : anyMtu;
+        if (client.streamFormat == BleStreamFormat::BATCHED && client.subscribed(BleChannel::BATCH)) {
+            batchMtu = batchMtu == 0 || client.mtu < batchMtu ? client.mtu : batchMtu;
+            batchClients++;
+        }
+    }
+    if (batchMtu == 0) {
+        batchMtu = anyMtu != 0 ? anyMtu : BLE_DEFAULT_MTU;
+    }
+
+    if (batchClients == 0) {
+        batchWriter_.finish();  // Discard any partial batch
+    } else if (batchMtu != batchMtu_ && batchWriter_.count() > 0) {
+        sendBatch();  // Sent at the old size to the clients it still fits
+    }
+    batchClients_ = batchClients;
+    if (batchMtu != batchMtu_) {
+        batchMtu_ = batchMtu;
+        batchWriter_.setFrameLimit(batchMtu_ - BLE_ATT_NOTIFY_OVERHEAD);
+        if (DEBUG_ENABLED) {
+            Serial.printf("BLE batch MTU: %d (%d samples per batch)\n",
+                          batchMtu_, streamFrameCapacity(batchMtu_ - BLE_ATT_NOTIFY_OVERHEAD));
+        }
+    }
+}
+
+BleClient* BleService::findClient(uint16_t connHandle) {
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (connHandle != BLE_HS_CONN_HANDLE_NONE && clients_[i].connHandle == connHandle) {
+            return &clients_[i];
+        }
+    }
+    return nullptr;
+}
+
+NimBLECharacteristic* BleService::channelCharacteristic(BleChannel channel) const {
+    switch (channel) {
+        case BleChannel::ACCEL:       return pAccelChar_;
+        case BleChannel::PEAK:        return pPeakChar_;
+        case BleChannel::BATCH:       return pBatchChar_;
+        case BleChannel::IMPACT:      return pImpactChar_;
+        case BleChannel::STATS:       return pStatsChar_;
+        case BleChannel::SPECTRUM:    return pSpectrumChar_;
+        case BleChannel::DIAGNOSTICS: return pDiagnosticsChar_;
+        case BleChannel::SYNC:        return pSyncChar_;
+        case BleChannel::LOG:         return pLogChar_;
+        case BleChannel::COMMAND:     return pCommandChar_;
+        default:                      return nullptr;
+    }
+}
+
+void BleService::refillTokens(BleClient& client, uint32_t now) {
+    uint32_t elapsed = now - client.refillMs;
+    if (elapsed > 1000) {
+        elapsed = 1000;  // Keeps the product below in range; the bucket is full by then
+    }
+
+    // Packets per ms = packets per event / (interval * 1.25 ms), in Q8
+    uint32_t interval = client.interval != 0 ? client.interval : BLE_IDLE_CONN_INTERVAL_MIN;
+    uint32_t added = elapsed * BLE_NOTIFY_PACKETS_PER_EVENT * 256 * 4 / (interval * 5);
+    if (added == 0) {
+        return;  // Leave the fraction to accumulate
+    }
+    client.refillMs = now;
+    client.tokensQ8 += added;
+    if (client.tokensQ8 > BLE_NOTIFY_BURST_PACKETS * 256) {
+        client.tokensQ8 = BLE_NOTIFY_BURST_PACKETS * 256;
+    }
+}
+
+bool BleService::sendTo(BleClient& client, BleChannel channel, const uint8_t* data, size_t length,
+                        bool retry) {
+    // Reason: read once, the NimBLE task frees the slot on disconnect
+    uint16_t handle = client.connHandle;
+    NimBLECharacteristic* characteristic = channelCharacteristic(channel);
+    if (handle == BLE_HS_CONN_HANDLE_NONE || !characteristic || !client.subscribed(channel)) {
+        return false;
+    }
+
+    // Reason: a notification longer than MTU - 3 would arrive truncated
+    if (length + BLE_ATT_NOTIFY_OVERHEAD > client.mtu) {
+        return false;
+    }
+
+    refillTokens(client, millis());
+    if (client.tokensQ8 < 256) {
+        client.dropped += retry ? 0 : 1;
+        return false;
+    }
+
+    // The stack copies the value into its own buffer; the notification
+    // goes to this connection only, whatever the characteristic's value
+    os_mbuf* om = ble_hs_mbuf_from_flat(data, length);
+    if (!om) {
+        client.dropped += retry ? 0 : 1;
+        return false;
+    }
+    if (ble_gattc_notify_custom(handle, characteristic->getHandle(), om) != 0) {
+        client.dropped += retry ? 0 : 1;  // The stack frees the buffer either way
+        return false;
+    }
+
+    client.tokensQ8 -= 256;
+    client.sent++;
+    return true;
+}
+
+void BleService::sendToSubscribers(BleChannel channel, const uint8_t* data, size_t length) {
+    // Reason: rotating the first client keeps one that always goes first
+    // from taking the stack buffers the others need
+    size_t first = nextClient_++ % BLE_MAX_CLIENTS;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        sendTo(clients_[(first + i) % BLE_MAX_CLIENTS], channel, data, length);
+    }
 }
 
 void BleService::notifyAccelData(uint32_t timestamp, const AccelData& data, float magnitude) {
-    if (!deviceConnected_ || !pAccelChar_) {
+    if (!pAccelChar_) {
         return;
     }
+    refreshClients();
 
     // Pack data into 20-byte binary format
     // Format: timestamp(4) + x(4) + y(4) + z(4) + magnitude(4) = 20 bytes
@@ -148,11 +463,216 @@ void BleService::notifyAccelData(uint32_t timestamp, const AccelData& data, floa
     packFloat(&buffer[16], magnitude);
 
     pAccelChar_->setValue(buffer, sizeof(buffer));
-    pAccelChar_->notify();
+
+    size_t first = nextClient_++ % BLE_MAX_CLIENTS;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        BleClient& client = clients_[(first + i) % BLE_MAX_CLIENTS];
+        if (client.connHandle == BLE_HS_CONN_HANDLE_NONE || client.streamFormat != BleStreamFormat::LEGACY
+            || !client.subscribed(BleChannel::ACCEL)) {
+            continue;
+        }
+        if (client.legacyGroup <= 1) {
+            sendTo(client, BleChannel::ACCEL, buffer, sizeof(buffer));
+            continue;
+        }
+
+        client.legacySum[0] += data.x;
+        client.legacySum[1] += data.y;
+        client.legacySum[2] += data.z;
+        client.legacySum[3] += magnitude;
+        if (++client.legacyCount < client.legacyGroup) {
+            continue;
+        }
+
+        // Stamped with the newest packet of the group
+        uint8_t average[20];
+        float count = client.legacyCount;
+        packUint32(&average[0], timestamp);
+        for (uint8_t k = 0; k < 4; k++) {
+            packFloat(&average[4 + k * 4], client.legacySum[k] / count);
+            client.legacySum[k] = 0.0f;
+        }
+        client.legacyCount = 0;
+        sendTo(client, BleChannel::ACCEL, average, sizeof(average));
+    }
+}
+
+void BleService::addBatchSample(uint32_t timestampUs, const RawAccel& counts, uint16_t rateHz) {
+    refreshClients();
+    if (batchClients_ == 0 || !pBatchChar_) {
+        return;
+    }
+
+    if (batchWriter_.count() == 0) {
+        batchWriter_.begin(rateHz);
+        batchStartMs_ = millis();
+    }
+
+    // Time gap too large for a delta: close the batch and start anew
+    if (!batchWriter_.add(timestampUs, counts)) {
+        sendBatch();
+        batchWriter_.begin(rateHz);
+        batchStartMs_ = millis();
+        batchWriter_.add(timestampUs, counts);
+    }
+
+    if (batchWriter_.isFull()) {
+        sendBatch();
+    }
+}
+
+void BleService::flushBatch() {
+    if (batchWriter_.count() > 0 && millis() - batchStartMs_ >= BLE_BATCH_MAX_LATENCY_MS) {
+        sendBatch();
+    }
+}
+
+void BleService::sendBatch() {
+    size_t length = batchWriter_.finish();
+    if (length == 0 || !pBatchChar_) {
+        return;
+    }
+
+    // One frame, handed to each batched client as it is
+    size_t first = nextClient_++ % BLE_MAX_CLIENTS;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        BleClient& client = clients_[(first + i) % BLE_MAX_CLIENTS];
+        if (client.streamFormat == BleStreamFormat::BATCHED) {
+            sendTo(client, BleChannel::BATCH, batchBuffer_, length);
+        }
+    }
+}
+
+void BleService::setStreamFormat(BleStreamFormat format) {
+    if (format != BleStreamFormat::LEGACY && format != BleStreamFormat::BATCHED) {
+        return;
+    }
+
+    streamFormat_ = format;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        clients_[i].streamFormat = format;
+    }
+    clientsChanged_.store(true, std::memory_order_release);
+
+    // Reason: batched raw streaming needs many connection events per
+    // second; the legacy stream at <= 50 Hz does not
+    setLinkProfile(format == BleStreamFormat::BATCHED
+                   ? BleLinkProfile::HIGH_THROUGHPUT : BleLinkProfile::LOW_POWER);
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("BLE stream format: %s\n",
+                      format == BleStreamFormat::BATCHED ? "batched" : "legacy");
+    }
+}
+
+BleStreamFormat BleService::getStreamFormat() const {
+    return streamFormat_;
+}
+
+void BleService::setLinkProfile(BleLinkProfile profile) {
+    linkProfile_ = profile;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        clients_[i].linkProfile = profile;
+        applyLinkProfile(clients_[i]);
+    }
+}
+
+BleLinkProfile BleService::getLinkProfile() const {
+    return linkProfile_;
+}
+
+void BleService::setPowerProfile(PowerProfile profile) {
+    powerProfile_ = profile;
+    if (!bleEnabled_) {
+        return;  // Applied by the next begin()
+    }
+
+    // Reason: the advertising interval only takes effect on restart
+    bool advertising = pAdvertising_ && pAdvertising_->isAdvertising();
+    if (advertising) {
+        pAdvertising_->stop();
+    }
+    applyRadioProfile();
+    if (advertising) {
+        pAdvertising_->start();
+    }
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        applyLinkProfile(clients_[i]);
+    }
+}
+
+PowerProfile BleService::getPowerProfile() const {
+    return powerProfile_;
+}
+
+uint16_t BleService::getAdvertisingInterval() const {
+    switch (powerProfile_) {
+        case PowerProfile::BALANCED:  return BLE_ADV_INTERVAL_BALANCED;
+        case PowerProfile::LOW_POWER: return BLE_ADV_INTERVAL_LOW_POWER;
+        default:                      return BLE_ADV_INTERVAL_PERFORMANCE;
+    }
+}
+
+uint16_t BleService::getConnInterval() const {
+    uint16_t shortest = 0;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        const BleClient& client = clients_[i];
+        if (client.connHandle != BLE_HS_CONN_HANDLE_NONE && client.interval != 0
+            && (shortest == 0 || client.interval < shortest)) {
+            shortest = client.interval;
+        }
+    }
+    return shortest;
+}
+
+void BleService::applyRadioProfile() {
+    // ESP32-C3 supports up to +20 dBm; +9 dBm is a good balance of range
+    // and power, lower levels suit a logger within a few metres
+    switch (powerProfile_) {
+        case PowerProfile::BALANCED:  NimBLEDevice::setPower(ESP_PWR_LVL_P3); break;
+        case PowerProfile::LOW_POWER: NimBLEDevice::setPower(ESP_PWR_LVL_N0); break;
+        default:                      NimBLEDevice::setPower(ESP_PWR_LVL_P9); break;
+    }
+
+    if (pAdvertising_) {
+        uint16_t interval = getAdvertisingInterval();
+        pAdvertising_->setMinInterval(interval);
+        pAdvertising_->setMaxInterval(interval + interval / 8);
+    }
+}
+
+void BleService::applyLinkProfile(const BleClient& client) {
+    uint16_t handle = client.connHandle;
+    if (!pServer_ || handle == BLE_HS_CONN_HANDLE_NONE) {
+        return;
+    }
+
+    if (client.linkProfile == BleLinkProfile::HIGH_THROUGHPUT) {
+        pServer_->updateConnParams(handle,
+                                   BLE_FAST_CONN_INTERVAL_MIN, BLE_FAST_CONN_INTERVAL_MAX,
+                                   BLE_FAST_CONN_LATENCY, BLE_FAST_CONN_TIMEOUT);
+    } else if (powerProfile_ == PowerProfile::LOW_POWER) {
+        pServer_->updateConnParams(handle,
+                                   BLE_SLEEPY_CONN_INTERVAL_MIN, BLE_SLEEPY_CONN_INTERVAL_MAX,
+                                   BLE_SLEEPY_CONN_LATENCY, BLE_SLEEPY_CONN_TIMEOUT);
+    } else {
+        pServer_->updateConnParams(handle,
+                                   BLE_IDLE_CONN_INTERVAL_MIN, BLE_IDLE_CONN_INTERVAL_MAX,
+                                   BLE_IDLE_CONN_LATENCY, BLE_IDLE_CONN_TIMEOUT);
+    }
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("BLE link profile (conn %d): %s\n", handle,
+                      client.linkProfile == BleLinkProfile::HIGH_THROUGHPUT ? "high throughput" : "low power");
+    }
+}
+
+uint16_t BleService::getMtu() const {
+    return batchMtu_;
 }
 
 void BleService::notifyPeak(uint32_t timestamp, float peak) {
-    if (!deviceConnected_ || !pPeakChar_) {
+    if (!pPeakChar_) {
         return;
     }
 
@@ -163,7 +683,242 @@ void BleService::notifyPeak(uint32_t timestamp, float peak) {
     packFloat(&buffer[4], peak);
 
     pPeakChar_->setValue(buffer, sizeof(buffer));
-    pPeakChar_->notify();
+    sendToSubscribers(BleChannel::PEAK, buffer, sizeof(buffer));
+}
+
+void BleService::notifyImpact(const ImpactStats& stats) {
+    if (!pImpactChar_) {
+        return;
+    }
+
+    // Pack event summary into 20-byte format (fits the default MTU)
+    // sequence(2) + trigger_us(4) + peak_g(4) + peak_offset_us(4)
+    // + above_threshold_us(4) + threshold (2, 0.1 g units)
+    uint8_t buffer[20];
+    uint16_t threshold = static_cast<uint16_t>(stats.thresholdG() * 10.0f + 0.5f);
+
+    buffer[0] = stats.sequence & 0xFF;
+    buffer[1] = (stats.sequence >> 8) & 0xFF;
+    packUint32(&buffer[2], stats.triggerUs);
+    packFloat(&buffer[6], stats.peakG());
+    packUint32(&buffer[10], stats.peakOffsetUs);
+    packUint32(&buffer[14], stats.aboveThresholdUs);
+    buffer[18] = threshold & 0xFF;
+    buffer[19] = (threshold >> 8) & 0xFF;
+
+    pImpactChar_->setValue(buffer, sizeof(buffer));
+    sendToSubscribers(BleChannel::IMPACT, buffer, sizeof(buffer));
+}
+
+void BleService::notifyStats(const StatsSummary& shortWindow, const StatsSummary& longWindow) {
+    if (!pStatsChar_) {
+        return;
+    }
+
+    // Header: sequence(2) + rate_hz(2) + short_window_ms(2) + long_window_ms(2)
+    // + threshold (2, 0.1 g units), then 40 bytes per window
+    uint8_t buffer[10 + 2 * 40];
+    uint16_t threshold = static_cast<uint16_t>(fixedToG(shortWindow.thresholdMagnitude) * 10.0f + 0.5f);
+
+    packUint16(&buffer[0], static_cast<uint16_t>(shortWindow.sequence));
+    packUint16(&buffer[2], shortWindow.rateHz);
+    packUint16(&buffer[4], static_cast<uint16_t>(shortWindow.windowMs));
+    packUint16(&buffer[6], static_cast<uint16_t>(longWindow.windowMs));
+    packUint16(&buffer[8], threshold);
+    packStatsWindow(&buffer[10], shortWindow);
+    packStatsWindow(&buffer[50], longWindow);
+
+    pStatsChar_->setValue(buffer, sizeof(buffer));
+    // Clients whose MTU is too small can still read it
+    sendToSubscribers(BleChannel::STATS, buffer, sizeof(buffer));
+}
+
+void BleService::notifySpectrum(const SpectrumResult& result) {
+    if (!pSpectrumChar_) {
+        return;
+    }
+
+    // Header: sequence(2) + rate_hz(2) + fft_size(2) + channel(1) + frames(1),
+    // then 5 peaks of frequency (0.1 Hz) + amplitude (0.01 g),
+    // then 4 bands of low_hz + high_hz + rms (0.01 g)
+    uint8_t buffer[8 + SPECTRUM_PEAK_COUNT * 4 + SPECTRUM_BAND_COUNT * 6] = {};
+
+    packUint16(&buffer[0], static_cast<uint16_t>(result.sequence));
+    packUint16(&buffer[2], result.rateHz);
+    packUint16(&buffer[4], SPECTRUM_FFT_SIZE);
+    buffer[6] = static_cast<uint8_t>(result.channel);
+    buffer[7] = static_cast<uint8_t>(result.frames > 0xFF ? 0xFF : result.frames);
+
+    // Unused peak slots stay zero
+    uint8_t* p = &buffer[8];
+    for (uint8_t i = 0; i < result.peakCount; i++) {
+        packUint16(&p[i * 4], result.peaks[i].frequencyDeciHz);
+        packUint16(&p[i * 4 + 2], packCentiG(result.peaks[i].amplitude));
+    }
+
+    p = &buffer[8 + SPECTRUM_PEAK_COUNT * 4];
+    for (uint8_t band = 0; band < SPECTRUM_BAND_COUNT; band++) {
+        packUint16(&p[band * 6], result.bandEdgesHz[band]);
+        packUint16(&p[band * 6 + 2], result.bandEdgesHz[band + 1]);
+        packUint16(&p[band * 6 + 4], packCentiG(result.bandRms[band]));
+    }
+
+    pSpectrumChar_->setValue(buffer, sizeof(buffer));
+    // Clients whose MTU is too small can still read it
+    sendToSubscribers(BleChannel::SPECTRUM, buffer, sizeof(buffer));
+}
+
+#if GSENSOR_PROFILING
+void BleService::notifyDiagnostics(const Profiler& source) {
+    if (!pDiagnosticsChar_) {
+        return;
+    }
+
+    // Header: cpu_mhz(2) + window_ms(4) + coalesced_wakes(4) + fifo_overruns(4),
+    // then per stage count + min + avg + max (4 bytes each, times in ns)
+    uint8_t buffer[14 + PROFILE_STAGE_COUNT * 16];
+    uint32_t cpuMhz = source.cpuMhz();
+
+    packUint16(&buffer[0], static_cast<uint16_t>(cpuMhz));
+    packUint32(&buffer[2], source.windowMs());
+    packUint32(&buffer[6], source.counter(ProfileCounter::COALESCED_WAKES));
+    packUint32(&buffer[10], source.counter(ProfileCounter::FIFO_OVERRUNS));
+
+    for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        ProfileSummary summary;
+        source.summary(static_cast<ProfileStage>(i), summary);
+        const uint32_t cycles[3] = {summary.minCycles, summary.averageCycles(), summary.maxCycles};
+
+        uint8_t* p = &buffer[14 + i * 16];
+        packUint32(&p[0], summary.count);
+        for (uint8_t k = 0; k < 3; k++) {
+            uint64_t ns = static_cast<uint64_t>(cycles[k]) * 1000 / cpuMhz;
+            packUint32(&p[4 + k * 4], ns > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(ns));
+        }
+    }
+
+    pDiagnosticsChar_->setValue(buffer, sizeof(buffer));
+    // Clients whose MTU is too small can still read it
+    sendToSubscribers(BleChannel::DIAGNOSTICS, buffer, sizeof(buffer));
+}
+#endif
+
+bool BleService::takeSyncRequest(uint8_t* message, size_t& length, uint64_t& receivedUs) {
+    if (!syncPending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    memcpy(message, syncRequest_, syncRequestLength_);
+    length = syncRequestLength_;
+    receivedUs = syncReceivedUs_;
+    replyConnHandle_ = syncConnHandle_;
+    syncPending_.store(false, std::memory_order_release);
+    return true;
+}
+
+void BleService::notifySync(const uint8_t* reply, size_t length) {
+    if (!pSyncChar_) {
+        return;
+    }
+
+    // Probe replies are only meaningful to the exchange in progress
+    if (reply[0] == TIME_SYNC_MSG_RESULT) {
+        pSyncChar_->setValue(reply, length);
+    }
+
+    // Reason: another client's exchange would see a reply to a probe it
+    // never sent
+    BleClient* client = findClient(replyConnHandle_);
+    if (client) {
+        sendTo(*client, BleChannel::SYNC, reply, length);
+    }
+}
+
+bool BleService::takeLogRequest(uint8_t* message, size_t& length) {
+    if (!logPending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    memcpy(message, logRequest_, logRequestLength_);
+    length = logRequestLength_;
+    logConnHandle_ = logRequestHandle_;
+    logPending_.store(false, std::memory_order_release);
+
+    // Reason: a download wants every connection event it can get
+    BleClient* client = findClient(logConnHandle_);
+    if (client && length > 0 && message[0] == LOG_TRANSFER_OP_READ
+        && client->linkProfile != BleLinkProfile::HIGH_THROUGHPUT) {
+        client->linkProfile = BleLinkProfile::HIGH_THROUGHPUT;
+        applyLinkProfile(*client);
+    }
+    return true;
+}
+
+bool BleService::notifyLog(const uint8_t* message, size_t length) {
+    BleClient* client = findClient(logConnHandle_);
+    return client && sendTo(*client, BleChannel::LOG, message, length, true);
+}
+
+size_t BleService::getLogMessageCapacity() const {
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        const BleClient& client = clients_[i];
+        if (logConnHandle_ != BLE_HS_CONN_HANDLE_NONE && client.connHandle == logConnHandle_
+            && client.subscribed(BleChannel::LOG)) {
+            return client.mtu - BLE_ATT_NOTIFY_OVERHEAD;
+        }
+    }
+    return 0;
+}
+
+bool BleService::takeCommandRequest(uint8_t* message, size_t& length) {
+    if (!commandPending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    memcpy(message, commandRequest_, commandRequestLength_);
+    length = commandRequestLength_;
+    commandConnHandle_ = commandRequestHandle_;
+    commandPending_.store(false, std::memory_order_release);
+    return true;
+}
+
+bool BleService::notifyCommand(const uint8_t* message, size_t length) {
+    BleClient* client = findClient(commandConnHandle_);
+    return client && sendTo(*client, BleChannel::COMMAND, message, length);
+}
+
+size_t BleService::getCommandReplyCapacity() const {
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        const BleClient& client = clients_[i];
+        if (commandConnHandle_ != BLE_HS_CONN_HANDLE_NONE && client.connHandle == commandConnHandle_) {
+            size_t capacity = client.mtu - BLE_ATT_NOTIFY_OVERHEAD;
+            return capacity < COMMAND_MAX_MESSAGE ? capacity : COMMAND_MAX_MESSAGE;
+        }
+    }
+    return 0;
+}
+
+bool BleService::setCommandClientFormat(BleStreamFormat format) {
+    BleClient* client = findClient(commandConnHandle_);
+    if (!client) {
+        return false;
+    }
+
+    client->streamFormat = format;
+    streamFormat_ = format;
+    // Reason: as for a config write, batched streaming needs the fast link
+    client->linkProfile = format == BleStreamFormat::BATCHED
+                        ? BleLinkProfile::HIGH_THROUGHPUT : BleLinkProfile::LOW_POWER;
+    linkProfile_ = client->linkProfile;
+    applyLinkProfile(*client);
+    clientsChanged_.store(true, std::memory_order_release);
+    return true;
+}
+
+BleStreamFormat BleService::getCommandClientFormat() const {
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (commandConnHandle_ != BLE_HS_CONN_HANDLE_NONE && clients_[i].connHandle == commandConnHandle_) {
+            return clients_[i].streamFormat;
+        }
+    }
+    return streamFormat_;
 }
 
 void BleService::setNotificationRate(uint8_t rateHz) {
@@ -175,11 +930,10 @@ void BleService::setNotificationRate(uint8_t rateHz) {
     }
 
     notificationRateHz_ = rateHz;
-
-    // Update characteristic value
-    if (pConfigChar_) {
-        pConfigChar_->setValue(&notificationRateHz_, 1);
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        clients_[i].notificationRateHz = rateHz;
     }
+    clientsChanged_.store(true, std::memory_order_release);
 
     if (DEBUG_ENABLED) {
         Serial.print("BLE notification rate set to: ");
@@ -198,32 +952,134 @@ void BleService::setCommandCallback(CommandCallback callback) {
 
 // Server callbacks
 void BleService::onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
-    deviceConnected_ = true;
+    BleClient* client = nullptr;
+    for (size_t i = 0; i < BLE_MAX_CLIENTS && !client; i++) {
+        if (clients_[i].connHandle == BLE_HS_CONN_HANDLE_NONE) {
+            client = &clients_[i];
+        }
+    }
+    if (!client) {
+        pServer->disconnect(desc->conn_handle);  // More than the stack was configured for
+        return;
+    }
 
+    uint16_t handle = desc->conn_handle;
+    client->mtu = BLE_DEFAULT_MTU;
+    client->interval = desc->conn_itvl;
+    client->notificationRateHz = notificationRateHz_;
+    client->streamFormat = streamFormat_;
+    client->linkProfile = linkProfile_;
+    client->subscriptions = 0;
+    client->sent = 0;
+    client->dropped = 0;
+    client->tokensQ8 = BLE_NOTIFY_BURST_PACKETS * 256;
+    client->refillMs = millis();
+    client->legacyGroup = 0;
+    client->legacyCount = 0;
+    memset(client->legacySum, 0, sizeof(client->legacySum));
+
+    // Reason: loop() skips free slots, so the handle is set last
+    client->connHandle = handle;
+    clientsChanged_.store(true, std::memory_order_release);
+
+    // Start the MTU exchange ourselves rather than waiting for the client
+    ble_gattc_exchange_mtu(handle, nullptr, nullptr);
+
+    // 2M PHY halves airtime per packet; data length extension lets a full
+    // MTU notification go out as one link-layer packet. Both fall back
+    // silently if the central does not support them.
+    ble_gap_set_prefered_le_phy(handle, BLE_GAP_LE_PHY_2M_MASK,
+                                BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+    pServer->setDataLen(handle, BLE_DATA_LEN_TX_OCTETS);
+
+    applyLinkProfile(*client);
+
+    size_t count = clientCount();
     if (DEBUG_ENABLED) {
-        Serial.println("BLE client connected");
+        Serial.printf("BLE client connected (%d of %d)\n", static_cast<int>(count), static_cast<int>(BLE_MAX_CLIENTS));
     }
 
-    // Continue advertising to allow multiple connections (optional)
-    // pAdvertising_->start();
+    // Keep advertising while there is room for another client
+    if (count < BLE_MAX_CLIENTS) {
+        pAdvertising_->start();
+    }
 }
 
 void BleService::onDisconnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
-    deviceConnected_ = false;
+    BleClient* client = findClient(desc->conn_handle);
+    if (client) {
+        client->connHandle = BLE_HS_CONN_HANDLE_NONE;
+        client->subscriptions = 0;
+    }
+    clientsChanged_.store(true, std::memory_order_release);
 
     if (DEBUG_ENABLED) {
-        Serial.println("BLE client disconnected");
+        Serial.printf("BLE client disconnected (%d left)\n", static_cast<int>(clientCount()));
     }
 
     // Restart advertising
-    pAdvertising_->start();
+    if (!pAdvertising_->isAdvertising()) {
+        pAdvertising_->start();
+    }
+}
+
+void BleService::onMTUChange(uint16_t mtu, ble_gap_conn_desc* desc) {
+    BleClient* client = findClient(desc->conn_handle);
+    if (!client) {
+        return;
+    }
+    client->mtu = mtu;
+    clientsChanged_.store(true, std::memory_order_release);
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("BLE MTU (conn %d): %d\n", desc->conn_handle, mtu);
+    }
 }
 
 // Characteristic callbacks
 void BleService::onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) {
-    std::string uuid = pCharacteristic->getUUID().toString();
+    if (pCharacteristic == pSyncChar_) {
+        // Reason: stamped before anything else, it is t2 of the exchange
+        uint64_t receivedUs = TimeSync::localUs();
+        std::string value = pCharacteristic->getValue();
+        if (!syncPending_.load(std::memory_order_acquire) && !value.empty()
+            && value.length() <= sizeof(syncRequest_)) {
+            memcpy(syncRequest_, value.data(), value.length());
+            syncRequestLength_ = value.length();
+            syncReceivedUs_ = receivedUs;
+            syncConnHandle_ = desc->conn_handle;
+            syncPending_.store(true, std::memory_order_release);
+        }
+        return;
+    }
+
+    if (pCharacteristic == pLogChar_) {
+        std::string value = pCharacteristic->getValue();
+        if (!logPending_.load(std::memory_order_acquire) && !value.empty()
+            && value.length() <= sizeof(logRequest_)) {
+            memcpy(logRequest_, value.data(), value.length());
+            logRequestLength_ = value.length();
+            logRequestHandle_ = desc->conn_handle;
+            logPending_.store(true, std::memory_order_release);
+        }
+        return;
+    }
+
+    if (pCharacteristic == pCommandChar_) {
+        std::string value = pCharacteristic->getValue();
+        if (!commandPending_.load(std::memory_order_acquire) && !value.empty()
+            && value.length() <= sizeof(commandRequest_)) {
+            memcpy(commandRequest_, value.data(), value.length());
+            commandRequestLength_ = value.length();
+            commandRequestHandle_ = desc->conn_handle;
+            commandPending_.store(true, std::memory_order_release);
+        }
+        return;
+    }
 
-    if (uuid == BLE_CHAR_CONTROL_UUID) {
+    // Reason: dispatch on the characteristic, not by formatting and
+    // comparing its UUID string on every write
+    if (pCharacteristic == pControlChar_) {
         // Handle control commands
         std::string value = pCharacteristic->getValue();
         if (value.length() > 0) {
@@ -235,20 +1091,59 @@ void BleService::onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_des
             }
 
             if (commandCallback_) {
-                commandCallback_(cmd);
+                commandCallback_(cmd, reinterpret_cast<const uint8_t*>(value.data()) + 1, value.length() - 1);
             }
         }
-    } else if (uuid == BLE_CHAR_CONFIG_UUID) {
-        // Handle configuration updates
+    } else if (pCharacteristic == pConfigChar_) {
+        // Handle configuration updates for the writing client; they also
+        // become the defaults for new connections
+        // Byte 0: legacy notification rate (Hz), byte 1 (optional): stream format,
+        // byte 2 (optional): link profile override
+        BleClient* client = findClient(desc->conn_handle);
         std::string value = pCharacteristic->getValue();
-        if (value.length() > 0) {
-            uint8_t newRate = value[0];
-            setNotificationRate(newRate);
+        if (!client || value.empty()) {
+            return;
+        }
+
+        uint8_t rate = value[0];
+        rate = rate < BLE_MIN_NOTIFY_RATE_HZ ? BLE_MIN_NOTIFY_RATE_HZ
+             : (rate > BLE_MAX_NOTIFY_RATE_HZ ? BLE_MAX_NOTIFY_RATE_HZ : rate);
+        client->notificationRateHz = rate;
+        notificationRateHz_ = rate;
+
+        BleLinkProfile profile = client->linkProfile;
+        uint8_t format = value.length() > 1 ? static_cast<uint8_t>(value[1]) : 0xFF;
+        if (format <= static_cast<uint8_t>(BleStreamFormat::BATCHED)) {
+            client->streamFormat = static_cast<BleStreamFormat>(format);
+            streamFormat_ = client->streamFormat;
+            // Reason: batched raw streaming needs many connection events
+            // per second; the legacy stream at <= 50 Hz does not
+            profile = client->streamFormat == BleStreamFormat::BATCHED
+                    ? BleLinkProfile::HIGH_THROUGHPUT : BleLinkProfile::LOW_POWER;
+        }
+        if (value.length() > 2 && static_cast<uint8_t>(value[2]) <= 1) {
+            profile = static_cast<BleLinkProfile>(value[2]);
+        }
+        if (profile != client->linkProfile || format <= static_cast<uint8_t>(BleStreamFormat::BATCHED)) {
+            client->linkProfile = profile;
+            linkProfile_ = profile;
+            applyLinkProfile(*client);
+        }
+        clientsChanged_.store(true, std::memory_order_release);
+
+        if (DEBUG_ENABLED) {
+            Serial.printf("BLE config (conn %d): %d Hz, %s\n", desc->conn_handle, rate,
+                          client->streamFormat == BleStreamFormat::BATCHED ? "batched" : "legacy");
         }
     }
 }
 
 void BleService::onRead(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) {
+    // Refresh negotiated link values before the client reads them
+    if (pCharacteristic == pConfigChar_) {
+        updateConfigValue(findClient(desc->conn_handle));
+    }
+
     // Optional: Log read operations
     if (DEBUG_ENABLED) {
         Serial.print("BLE characteristic read: ");
@@ -256,6 +1151,64 @@ void BleService::onRead(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc
     }
 }
 
+void BleService::onSubscribe(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc, uint16_t subValue) {
+    BleClient* client = findClient(desc->conn_handle);
+    if (!client) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BleChannel::COUNT); i++) {
+        if (channelCharacteristic(static_cast<BleChannel>(i)) != pCharacteristic) {
+            continue;
+        }
+        // Indications are not used; bit 0 of the CCCD enables notifications
+        uint16_t bit = 1u << i;
+        client->subscriptions = (subValue & 0x0001) ? (client->subscriptions | bit)
+                                                    : (client->subscriptions & ~bit);
+        clientsChanged_.store(true, std::memory_order_release);
+        return;
+    }
+}
+
+void BleService::updateConfigValue(const BleClient* client) {
+    if (!pConfigChar_) {
+        return;
+    }
+
+    // Negotiated link state (zero when not connected)
+    uint16_t mtu = BLE_DEFAULT_MTU;
+    uint16_t interval = 0;
+    uint16_t latency = 0;
+    uint8_t txPhy = 0;
+    uint8_t rxPhy = 0;
+    uint16_t handle = client ? client->connHandle : BLE_HS_CONN_HANDLE_NONE;
+    if (handle != BLE_HS_CONN_HANDLE_NONE) {
+        mtu = client->mtu;
+        ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(handle, &desc) == 0) {
+            interval = desc.conn_itvl;
+            latency = desc.conn_latency;
+        }
+        ble_gap_read_le_phy(handle, &txPhy, &rxPhy);
+    }
+
+    // Format: rate(1) + stream format(1) + MTU(2) + interval(2, 1.25 ms units)
+    //         + latency(2) + TX PHY(1) + RX PHY(1) + link profile(1)
+    uint8_t buffer[11];
+    buffer[0] = client ? client->notificationRateHz : notificationRateHz_;
+    buffer[1] = static_cast<uint8_t>(client ? client->streamFormat : streamFormat_);
+    buffer[2] = mtu & 0xFF;
+    buffer[3] = (mtu >> 8) & 0xFF;
+    buffer[4] = interval & 0xFF;
+    buffer[5] = (interval >> 8) & 0xFF;
+    buffer[6] = latency & 0xFF;
+    buffer[7] = (latency >> 8) & 0xFF;
+    buffer[8] = txPhy;
+    buffer[9] = rxPhy;
+    buffer[10] = static_cast<uint8_t>(client ? client->linkProfile : linkProfile_);
+    pConfigChar_->setValue(buffer, sizeof(buffer));
+}
+
 // Helper functions for packing data (little-endian)
 void BleService::packFloat(uint8_t* buffer, float value) {
     uint8_t* p = reinterpret_cast<uint8_t*>(&value);
@@ -271,3 +1224,41 @@ void BleService::packUint32(uint8_t* buffer, uint32_t value) {
     buffer[2] = (value >> 16) & 0xFF;
     buffer[3] = (value >> 24) & 0xFF;
 }
+
+void BleService::packUint16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+}
+
+uint16_t BleService::packCentiG(int32_t valueFixed) {
+    float centiG = fixedToG(valueFixed) * 100.0f + 0.5f;
+    if (centiG <= 0.0f) {
+        return 0;
+    }
+    return centiG > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(centiG);
+}
+
+void BleService::packStatsWindow(uint8_t* buffer, const StatsSummary& summary) {
+    // Per channel (X, Y, Z, magnitude): mean, rms, min, max as int16 in
+    // 0.01 g (saturating), then time above threshold as uint16 ms
+    for (uint8_t ch = 0; ch < STATS_CHANNELS; ch++) {
+        const ChannelStats& stats = summary.channels[ch];
+        const int32_t values[4] = {stats.mean, stats.rms, stats.min, stats.max};
+        uint8_t* p = &buffer[ch * 10];
+
+        for (uint8_t i = 0; i < 4; i++) {
+            // Reason: the magnitude of three saturated axes reaches ~347 g
+            float centiG = fixedToG(values[i]) * 100.0f;
+            if (centiG > INT16_MAX) {
+                centiG = INT16_MAX;
+            } else if (centiG < INT16_MIN) {
+                centiG = INT16_MIN;
+            }
+            int16_t packed = static_cast<int16_t>(centiG < 0 ? centiG - 0.5f : centiG + 0.5f);
+            packUint16(&p[i * 2], static_cast<uint16_t>(packed));
+        }
+
+        uint32_t aboveMs = stats.aboveUs / 1000;
+        packUint16(&p[8], static_cast<uint16_t>(aboveMs > 0xFFFF ? 0xFFFF : aboveMs));
+    }
+}
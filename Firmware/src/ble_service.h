@@ -4,6 +4,22 @@
  *
  * Provides BLE connectivity using NimBLE library.
  * Streams accelerometer data via notifications to connected clients.
+ *
+ * Up to BLE_MAX_CLIENTS centrals can be connected at once (advertising
+ * continues until the slots are full). Each connection keeps its own
+ * stream format, legacy notification rate, link profile, MTU and
+ * subscriptions, and every notification is addressed to one connection:
+ *
+ * - Batched frames are built once, sized to the smallest MTU among the
+ *   batched clients, and the same buffer is handed to each of them.
+ * - Legacy packets are sent at the fastest requested rate; slower
+ *   clients get averages of whole groups of those packets (the nearest
+ *   integer fraction of the fastest rate).
+ * - The notify scheduler gives each connection a budget of packets per
+ *   connection event (token bucket refilled from its negotiated
+ *   interval) and serves connections in rotating order, so a slow link
+ *   drops its own notifications instead of filling the stack's shared
+ *   buffers and starving the others.
  */
 
 #ifndef BLE_SERVICE_H
@@ -11,9 +27,83 @@
 
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include <atomic>
 #include <functional>
 #include "config.h"
+#include "settings.h"
 #include "signal_processing.h"
+#include "stream_frame.h"
+#include "impact_capture.h"
+#include "window_stats.h"
+#include "profiler.h"
+#include "spectrum.h"
+#include "time_sync.h"
+#include "log_transfer.h"
+#include "command_protocol.h"
+
+/**
+ * @brief Accelerometer stream format sent to BLE clients
+ */
+enum class BleStreamFormat : uint8_t {
+    LEGACY = 0,   ///< One 20-byte filtered sample per notification (accel char)
+    BATCHED = 1   ///< MTU-sized raw sample frames (batch char, see stream_frame.h)
+};
+
+/**
+ * @brief Connection parameter profile requested from the central
+ */
+enum class BleLinkProfile : uint8_t {
+    LOW_POWER = 0,        ///< Longer interval, enough for the legacy stream
+    HIGH_THROUGHPUT = 1   ///< Minimal interval, no latency
+};
+
+/**
+ * @brief Notifying characteristics a client can subscribe to
+ */
+enum class BleChannel : uint8_t {
+    ACCEL = 0,
+    PEAK,
+    BATCH,
+    IMPACT,
+    STATS,
+    SPECTRUM,
+    DIAGNOSTICS,
+    SYNC,
+    LOG,
+    COMMAND,
+    COUNT
+};
+
+/**
+ * @brief State of one connected client
+ */
+struct BleClient {
+    uint16_t connHandle;        ///< BLE_HS_CONN_HANDLE_NONE = free slot
+    uint16_t mtu;               ///< Negotiated ATT MTU
+    uint16_t interval;          ///< Connection interval (1.25 ms units, 0 = unknown)
+    uint8_t notificationRateHz; ///< Requested legacy stream rate
+    BleStreamFormat streamFormat;
+    BleLinkProfile linkProfile;
+    uint16_t subscriptions;     ///< Bit per BleChannel
+    uint32_t sent;              ///< Notifications handed to the stack
+    uint32_t dropped;           ///< Notifications skipped (budget or stack buffers)
+
+    // Notify budget (loop() only)
+    uint32_t tokensQ8;          ///< Packets available, Q8
+    uint32_t refillMs;
+
+    // Legacy averaging over groups of fastest-rate packets (loop() only)
+    uint8_t legacyGroup;        ///< Packets per notification
+    uint8_t legacyCount;
+    float legacySum[4];         ///< x, y, z, magnitude
+
+    /**
+     * @brief Check if the client subscribed to a characteristic
+     */
+    bool subscribed(BleChannel channel) const {
+        return (subscriptions & (1u << static_cast<uint8_t>(channel))) != 0;
+    }
+};
 
 /**
  * @brief BLE GATT server for accelerometer data streaming
@@ -23,15 +113,23 @@
  * - Peak value (notify)
  * - Control commands (write)
  * - Configuration (read/write)
+ * - Batched raw samples (notify)
+ * - Impact event summary (read/notify)
+ * - Window statistics (read/notify)
+ * - Vibration spectrum summary (read/notify)
+ * - Time sync exchange (write/notify)
+ * - Log download (write/notify)
+ * - Command protocol (write/notify)
  */
 class BleService : public NimBLEServerCallbacks, public NimBLECharacteristicCallbacks {
 public:
     /**
      * @brief Command callback type
      *
-     * Called when a control command is received via BLE
+     * Called when a control command is received via BLE, with any bytes
+     * written after the command byte as its payload
      */
-    using CommandCallback = std::function<void(uint8_t cmd)>;
+    using CommandCallback = std::function<void(uint8_t cmd, const uint8_t* payload, size_t length)>;
 
     /**
      * @brief Construct a new BLE Service
@@ -71,15 +169,59 @@ public:
     /**
      * @brief Check if a client is connected
      *
-     * @return true if connected
+     * @return true if at least one client is connected
      */
     bool isConnected() const;
 
+    /**
+     * @brief Get the number of connected clients
+     */
+    size_t clientCount() const;
+
+    /**
+     * @brief Copy the state of a client slot
+     *
+     * @param index Slot (0 to BLE_MAX_CLIENTS - 1)
+     * @param out Client state
+     * @return true if the slot holds a connection
+     */
+    bool getClient(size_t index, BleClient& out) const;
+
+    /**
+     * @brief Check if a client takes the given sample stream
+     *
+     * @param format Stream format
+     * @return true if a connected client selected it and subscribed to
+     *         its characteristic
+     */
+    bool hasStreamClients(BleStreamFormat format) const;
+
+    /**
+     * @brief Get the fastest legacy rate requested by a streaming client
+     *
+     * Legacy packets should be produced at this rate; slower clients
+     * average them.
+     *
+     * @return uint8_t Rate in Hz (the default rate with no legacy client)
+     */
+    uint8_t getFastestNotificationRate() const;
+
+    /**
+     * @brief Run the notify scheduler for this loop() pass
+     *
+     * Refills each connection's budget, follows connection interval
+     * changes and resizes batch frames to the batched clients' MTU.
+     *
+     * @param now Current time in milliseconds
+     */
+    void update(uint32_t now);
+
     /**
      * @brief Send accelerometer data notification
      *
-     * Packs data into 20-byte binary format and sends via notify.
-     * Only sends if a client is connected and subscribed.
+     * Packs data into 20-byte binary format and sends via notify to
+     * each subscribed legacy client. Call at getFastestNotificationRate();
+     * slower clients are sent the average of each group of calls.
      *
      * @param timestamp Timestamp in milliseconds
      * @param data Filtered accelerometer data
@@ -87,6 +229,96 @@ public:
      */
     void notifyAccelData(uint32_t timestamp, const AccelData& data, float magnitude);
 
+    /**
+     * @brief Append a raw sample to the current batch
+     *
+     * Sends the batch as one notification to each batched client once it
+     * fills the smallest negotiated MTU among them. Only used in
+     * BleStreamFormat::BATCHED.
+     *
+     * @param timestampUs Sample time in microseconds
+     * @param counts Calibrated counts
+     * @param rateHz Current sample rate (written to the frame header)
+     */
+    void addBatchSample(uint32_t timestampUs, const RawAccel& counts, uint16_t rateHz);
+
+    /**
+     * @brief Send a partly filled batch once it is old enough
+     *
+     * Call regularly so low sample rates are not held back waiting for
+     * a full MTU.
+     */
+    void flushBatch();
+
+    /**
+     * @brief Select the stream format for every connected client
+     *
+     * Also the default for new connections. A client can pick its own
+     * through the config characteristic.
+     *
+     * @param format Legacy per-sample packets or batched frames
+     */
+    void setStreamFormat(BleStreamFormat format);
+
+    /**
+     * @brief Get the stream format for new connections
+     */
+    BleStreamFormat getStreamFormat() const;
+
+    /**
+     * @brief Request a connection parameter profile from every client
+     *
+     * Selecting the batched format switches to HIGH_THROUGHPUT and the
+     * legacy format back to LOW_POWER; this overrides that choice until
+     * the format changes again. The central may still pick other values.
+     *
+     * @param profile Link profile to request
+     */
+    void setLinkProfile(BleLinkProfile profile);
+
+    /**
+     * @brief Get the link profile for new connections
+     */
+    BleLinkProfile getLinkProfile() const;
+
+    /**
+     * @brief Select the radio power profile
+     *
+     * Sets TX power and advertising interval, and in the low-power
+     * profile requests BLE_SLEEPY_CONN_* instead of the idle link
+     * values. Kept across setEnabled() cycles.
+     *
+     * @param profile Power profile
+     */
+    void setPowerProfile(PowerProfile profile);
+
+    /**
+     * @brief Get the radio power profile
+     */
+    PowerProfile getPowerProfile() const;
+
+    /**
+     * @brief Get the advertising interval of the current profile
+     *
+     * @return uint16_t Interval in 0.625 ms units
+     */
+    uint16_t getAdvertisingInterval() const;
+
+    /**
+     * @brief Get the shortest negotiated connection interval
+     *
+     * @return uint16_t Interval in 1.25 ms units (0 when not connected)
+     */
+    uint16_t getConnInterval() const;
+
+    /**
+     * @brief Get the ATT MTU batch frames are sized to
+     *
+     * @return uint16_t Smallest MTU among batched clients, else among all
+     *         clients (23 until they negotiate)
+     */
+    uint16_t getMtu() const;
+
     /**
      * @brief Send peak value notification
      *
@@ -96,14 +328,158 @@ public:
     void notifyPeak(uint32_t timestamp, float peak);
 
     /**
-     * @brief Set notification rate
+     * @brief Publish the summary of a captured impact
+     *
+     * Updates the readable value even when no client is connected, so a
+     * client can read the last event after connecting.
+     *
+     * @param stats Event summary
+     */
+    void notifyImpact(const ImpactStats& stats);
+
+    /**
+     * @brief Publish the short and long window statistics
+     *
+     * The 90-byte value is only notified to clients whose negotiated MTU
+     * fits it; it can always be read.
+     *
+     * @param shortWindow Newest short-window summary
+     * @param longWindow Newest long-window summary
+     */
+    void notifyStats(const StatsSummary& shortWindow, const StatsSummary& longWindow);
+
+    /**
+     * @brief Publish the peaks and band energies of a spectrum
+     *
+     * The 52-byte value is only notified to clients whose negotiated MTU
+     * fits it; it can always be read. The bins themselves are not sent.
+     *
+     * @param result Newest spectrum
+     */
+    void notifySpectrum(const SpectrumResult& result);
+
+#if GSENSOR_PROFILING
+    /**
+     * @brief Publish the hot-path timing counters
+     *
+     * The 158-byte value is only notified to clients whose negotiated
+     * MTU fits it; it can always be read.
+     *
+     * @param source Profiler to summarise
+     */
+    void notifyDiagnostics(const Profiler& source);
+#endif
+
+    /**
+     * @brief Take the newest time sync message written by the client
+     *
+     * Writes arrive on the NimBLE host task and are stamped there; the
+     * exchange itself runs on loop(), which answers with notifySync().
+     * A write that arrives before the previous one is taken is dropped
+     * (the host retries).
+     *
+     * @param message Buffer of TIME_SYNC_MAX_MESSAGE bytes
+     * @param length Set to the message length
+     * @param receivedUs Set to TimeSync::localUs() at the write
+     * @return true if a message was waiting
+     */
+    bool takeSyncRequest(uint8_t* message, size_t& length, uint64_t& receivedUs);
+
+    /**
+     * @brief Answer a time sync message to the client that wrote it
+     *
+     * Result replies also become the readable value.
+     *
+     * @param reply Reply from TimeSync::handleMessage()
+     * @param length Reply length
+     */
+    void notifySync(const uint8_t* reply, size_t length);
+
+    /**
+     * @brief Take the newest log transfer request written by a client
+     *
+     * Later replies and data from notifyLog() go to that client. A READ
+     * also switches its link to the high-throughput profile. A write that
+     * arrives before the previous one is taken is dropped.
+     *
+     * @param message Buffer of LOG_TRANSFER_MAX_REQUEST bytes
+     * @param length Set to the message length
+     * @return true if a message was waiting
+     */
+    bool takeLogRequest(uint8_t* message, size_t& length);
+
+    /**
+     * @brief Notify a log transfer message to the requesting client
+     *
+     * @return true if the stack took it; false when the connection's
+     *         notify budget or the stack buffers are used up (try again
+     *         on a later pass, nothing is counted as dropped)
+     */
+    bool notifyLog(const uint8_t* message, size_t length);
+
+    /**
+     * @brief Get the largest log transfer message the requesting client takes
+     *
+     * @return size_t Bytes (0 once it has disconnected or unsubscribed)
+     */
+    size_t getLogMessageCapacity() const;
+
+    /**
+     * @brief Take the newest command request written by a client
+     *
+     * Replies from notifyCommand() and setCommandClientFormat() apply to
+     * that client. A write that arrives before the previous one is taken
+     * is dropped (the host retries).
+     *
+     * @param message Buffer of COMMAND_MAX_MESSAGE bytes
+     * @param length Set to the message length
+     * @return true if a message was waiting
+     */
+    bool takeCommandRequest(uint8_t* message, size_t& length);
+
+    /**
+     * @brief Notify a command response to the requesting client
+     *
+     * @return true if the stack took it
+     */
+    bool notifyCommand(const uint8_t* message, size_t length);
+
+    /**
+     * @brief Get the largest command response the requesting client takes
+     *
+     * @return size_t Bytes (0 once it has disconnected)
+     */
+    size_t getCommandReplyCapacity() const;
+
+    /**
+     * @brief Select the stream format of the requesting client only
+     *
+     * Switches its link profile like a config characteristic write.
+     *
+     * @param format Legacy per-sample packets or batched frames
+     * @return true if the client is still connected
+     */
+    bool setCommandClientFormat(BleStreamFormat format);
+
+    /**
+     * @brief Get the stream format of the requesting client
+     *
+     * @return BleStreamFormat Its format, or the default for new
+     *         connections once it has disconnected
+     */
+    BleStreamFormat getCommandClientFormat() const;
+
+    /**
+     * @brief Set the legacy notification rate for every connected client
+     *
+     * Also the default for new connections.
      *
      * @param rateHz Rate in Hz (clamped to BLE_MIN/MAX_NOTIFY_RATE_HZ)
      */
     void setNotificationRate(uint8_t rateHz);
 
     /**
-     * @brief Get current notification rate
+     * @brief Get the legacy notification rate for new connections
      *
      * @return uint8_t Rate in Hz
      */
@@ -119,10 +495,12 @@ public:
     // NimBLEServerCallbacks overrides
     void onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) override;
     void onDisconnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) override;
+    void onMTUChange(uint16_t mtu, ble_gap_conn_desc* desc) override;
 
     // NimBLECharacteristicCallbacks overrides
     void onWrite(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) override;
     void onRead(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc) override;
+    void onSubscribe(NimBLECharacteristic* pCharacteristic, ble_gap_conn_desc* desc, uint16_t subValue) override;
 
 private:
     NimBLEServer* pServer_;
@@ -131,13 +509,122 @@ private:
     NimBLECharacteristic* pPeakChar_;
     NimBLECharacteristic* pControlChar_;
     NimBLECharacteristic* pConfigChar_;
+    NimBLECharacteristic* pBatchChar_;
+    NimBLECharacteristic* pImpactChar_;
+    NimBLECharacteristic* pStatsChar_;
+    NimBLECharacteristic* pSpectrumChar_;
+    NimBLECharacteristic* pDiagnosticsChar_;  // Profiling builds only
+    NimBLECharacteristic* pSyncChar_;
+    NimBLECharacteristic* pLogChar_;
+    NimBLECharacteristic* pCommandChar_;
     NimBLEAdvertising* pAdvertising_;
 
-    bool deviceConnected_;
     bool bleEnabled_;
-    uint8_t notificationRateHz_;
+    PowerProfile powerProfile_;
     CommandCallback commandCallback_;
 
+    // Defaults for new connections (persisted by the config store)
+    uint8_t notificationRateHz_;
+    BleStreamFormat streamFormat_;
+    BleLinkProfile linkProfile_;
+
+    // Connections, written by the NimBLE task on connect and disconnect
+    BleClient clients_[BLE_MAX_CLIENTS];
+    std::atomic<bool> clientsChanged_;
+    size_t nextClient_;             // Rotates the order clients are served in
+    size_t batchClients_;
+    uint32_t lastIntervalCheckMs_;
+
+    // Batched stream state
+    uint8_t batchBuffer_[BLE_PREFERRED_MTU - BLE_ATT_NOTIFY_OVERHEAD];
+    StreamFrameWriter batchWriter_;
+    uint32_t batchStartMs_;
+    uint16_t batchMtu_;
+
+    // Time sync write handed from the NimBLE task to loop()
+    uint8_t syncRequest_[TIME_SYNC_MAX_MESSAGE];
+    size_t syncRequestLength_;
+    uint64_t syncReceivedUs_;
+    uint16_t syncConnHandle_;
+    std::atomic<bool> syncPending_;
+    uint16_t replyConnHandle_;      // Writer of the request taken last
+
+    // Log transfer write handed from the NimBLE task to loop()
+    uint8_t logRequest_[LOG_TRANSFER_MAX_REQUEST];
+    size_t logRequestLength_;
+    uint16_t logRequestHandle_;
+    std::atomic<bool> logPending_;
+    uint16_t logConnHandle_;        // Client the transfer answers
+
+    // Command write handed from the NimBLE task to loop()
+    uint8_t commandRequest_[COMMAND_MAX_MESSAGE];
+    size_t commandRequestLength_;
+    uint16_t commandRequestHandle_;
+    std::atomic<bool> commandPending_;
+    uint16_t commandConnHandle_;    // Writer of the request taken last
+
+    /**
+     * @brief Find the slot of a connection (nullptr if none)
+     */
+    BleClient* findClient(uint16_t connHandle);
+
+    /**
+     * @brief Get the characteristic of a channel
+     */
+    NimBLECharacteristic* channelCharacteristic(BleChannel channel) const;
+
+    /**
+     * @brief Notify one client, within its budget and MTU
+     *
+     * @param retry The caller sends the same data again later, so a full
+     *              budget or stack is not counted as a drop
+     * @return true if the stack took the notification
+     */
+    bool sendTo(BleClient& client, BleChannel channel, const uint8_t* data, size_t length,
+                bool retry = false);
+
+    /**
+     * @brief Notify every client subscribed to a channel
+     */
+    void sendToSubscribers(BleChannel channel, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Follow client changes made by the NimBLE task
+     *
+     * Recomputes the legacy averaging groups and the batch frame size
+     * (loop() only).
+     */
+    void refreshClients();
+
+    /**
+     * @brief Refill a client's notify budget
+     */
+    static void refillTokens(BleClient& client, uint32_t now);
+
+    /**
+     * @brief Finish the current batch and notify it
+     */
+    void sendBatch();
+
+    /**
+     * @brief Send the connection parameters for a client's profile
+     */
+    void applyLinkProfile(const BleClient& client);
+
+    /**
+     * @brief Apply TX power and advertising interval for the power profile
+     */
+    void applyRadioProfile();
+
+    /**
+     * @brief Refresh the config characteristic value for one client
+     *
+     * Reads the negotiated interval and PHY back from the controller.
+     *
+     * @param client Client about to read it (nullptr = defaults)
+     */
+    void updateConfigValue(const BleClient* client);
+
     /**
      * @brief Pack float into little-endian byte array
      */
@@ -147,6 +634,21 @@ private:
      * @brief Pack uint32_t into little-endian byte array
      */
     void packUint32(uint8_t* buffer, uint32_t value);
+
+    /**
+     * @brief Pack little-endian uint16_t
+     */
+    void packUint16(uint8_t* buffer, uint16_t value);
+
+    /**
+     * @brief Convert a non-negative Q4 value to saturating uint16 0.01 g
+     */
+    uint16_t packCentiG(int32_t valueFixed);
+
+    /**
+     * @brief Pack one window's channel stats (40 bytes)
+     */
+    void packStatsWindow(uint8_t* buffer, const StatsSummary& summary);
 };
 
 #endif // BLE_SERVICE_H
@@ -0,0 +1,176 @@
+/**
+ * @file calibration.cpp
+ * @brief Zero-g calibration implementation
+ */
+
+#include "calibration.h"
+#include <cmath>
+
+// One offset register step in Q4 counts
+constexpr int32_t OFFSET_STEP_Q4 = ADXL375_OFFSET_COUNTS_PER_LSB << ACCEL_FIXED_FRAC_BITS;
+
+RawAccel AccelCalibration::residualCounts() const {
+    // Round half away from zero so the integer and Q4 paths agree on sign
+    int16_t counts[3];
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        int32_t q4 = residualQ4[axis];
+        int32_t half = 1 << (ACCEL_FIXED_FRAC_BITS - 1);
+        counts[axis] = static_cast<int16_t>(q4 >= 0 ? (q4 + half) >> ACCEL_FIXED_FRAC_BITS
+                                                    : -((-q4 + half) >> ACCEL_FIXED_FRAC_BITS));
+    }
+    return {counts[0], counts[1], counts[2]};
+}
+
+float AccelCalibration::offsetG(uint8_t axis) const {
+    int32_t totalQ4 = residualQ4[axis] - static_cast<int32_t>(hardware[axis]) * OFFSET_STEP_Q4;
+    return fixedToG(totalQ4);
+}
+
+AccelCalibration splitOffsets(const int32_t offsetQ4[3]) {
+    AccelCalibration calibration;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        // The sensor adds the register value, so it takes the negated offset
+        int32_t offset = offsetQ4[axis];
+        int32_t steps = offset >= 0 ? -((offset + OFFSET_STEP_Q4 / 2) / OFFSET_STEP_Q4)
+                                    : (-offset + OFFSET_STEP_Q4 / 2) / OFFSET_STEP_Q4;
+        if (steps > INT8_MAX) {
+            steps = INT8_MAX;
+        } else if (steps < INT8_MIN) {
+            steps = INT8_MIN;
+        }
+
+        int32_t residual = offset + steps * OFFSET_STEP_Q4;
+        if (residual > INT16_MAX) {
+            residual = INT16_MAX;
+        } else if (residual < INT16_MIN) {
+            residual = INT16_MIN;
+        }
+
+        calibration.hardware[axis] = static_cast<int8_t>(steps);
+        calibration.residualQ4[axis] = static_cast<int16_t>(residual);
+    }
+    return calibration;
+}
+
+AccelCalibration defaultCalibration() {
+    const int32_t offsets[3] = {
+        static_cast<int32_t>(OFFSET_X_COUNTS) * (1 << ACCEL_FIXED_FRAC_BITS),
+        static_cast<int32_t>(OFFSET_Y_COUNTS) * (1 << ACCEL_FIXED_FRAC_BITS),
+        static_cast<int32_t>(OFFSET_Z_COUNTS) * (1 << ACCEL_FIXED_FRAC_BITS)
+    };
+    return splitOffsets(offsets);
+}
+
+const char* calibrationStatusName(CalibrationStatus status) {
+    switch (status) {
+        case CalibrationStatus::IDLE:        return "not run";
+        case CalibrationStatus::RUNNING:     return "running";
+        case CalibrationStatus::DONE:        return "done";
+        case CalibrationStatus::MOVED:       return "failed, sensor moved";
+        case CalibrationStatus::NOT_LEVEL:   return "failed, no axis along gravity";
+        case CalibrationStatus::UNAVAILABLE: return "unavailable";
+    }
+    return "unknown";
+}
+
+// ==================== Calibration Routine ====================
+
+CalibrationRoutine::CalibrationRoutine()
+    : running_(false)
+    , settleRemaining_(0)
+    , windowSamples_(1)
+    , count_(0)
+    , sum_{}
+    , sumSquares_{}
+    , status_(CalibrationStatus::IDLE)
+    , result_(defaultCalibration()) {
+}
+
+void CalibrationRoutine::start(uint32_t rateHz) {
+    windowSamples_ = (rateHz * CALIBRATION_WINDOW_MS) / 1000;
+    if (windowSamples_ < 1) {
+        windowSamples_ = 1;
+    }
+    settleRemaining_ = CALIBRATION_SETTLE_SAMPLES;
+    count_ = 0;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        sum_[axis] = 0;
+        sumSquares_[axis] = 0;
+    }
+    status_ = CalibrationStatus::RUNNING;
+    running_ = true;
+}
+
+bool CalibrationRoutine::addSample(const RawAccel& raw) {
+    if (!running_) {
+        return false;
+    }
+    if (settleRemaining_ > 0) {
+        settleRemaining_--;
+        return false;
+    }
+
+    const int32_t values[3] = {raw.x, raw.y, raw.z};
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        sum_[axis] += values[axis];
+        sumSquares_[axis] += static_cast<uint64_t>(values[axis] * values[axis]);
+    }
+
+    if (++count_ < windowSamples_) {
+        return false;
+    }
+    finish();
+    return true;
+}
+
+void CalibrationRoutine::cancel() {
+    if (running_) {
+        running_ = false;
+        status_ = CalibrationStatus::UNAVAILABLE;
+    }
+}
+
+void CalibrationRoutine::finish() {
+    running_ = false;
+
+    // Runs once per calibration, so float is affordable here
+    const float maxVariance = (CALIBRATION_MAX_NOISE_G / ADXL375_SCALE_FACTOR)
+                            * (CALIBRATION_MAX_NOISE_G / ADXL375_SCALE_FACTOR);
+    float mean[3];
+    uint8_t gravityAxis = 0;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        mean[axis] = static_cast<float>(sum_[axis]) / count_;
+        float variance = static_cast<float>(sumSquares_[axis]) / count_ - mean[axis] * mean[axis];
+        if (variance > maxVariance) {
+            status_ = CalibrationStatus::MOVED;
+            return;
+        }
+        if (fabsf(mean[axis]) > fabsf(mean[gravityAxis])) {
+            gravityAxis = axis;
+        }
+    }
+
+    // Gravity must clearly dominate, or the sign and axis are guesses
+    float gravity = fabsf(mean[gravityAxis]);
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        if (axis != gravityAxis && fabsf(mean[axis]) * 2.0f > gravity) {
+            status_ = CalibrationStatus::NOT_LEVEL;
+            return;
+        }
+    }
+    if (gravity * ADXL375_SCALE_FACTOR < CALIBRATION_MIN_GRAVITY_G) {
+        status_ = CalibrationStatus::NOT_LEVEL;
+        return;
+    }
+
+    // Offset = reading - expected (+/-1 g on the gravity axis, 0 g elsewhere)
+    const float oneGCounts = 1.0f / ADXL375_SCALE_FACTOR;
+    int32_t offsetQ4[3];
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        float expected = axis == gravityAxis ? (mean[axis] > 0.0f ? oneGCounts : -oneGCounts) : 0.0f;
+        offsetQ4[axis] = static_cast<int32_t>(lroundf((mean[axis] - expected) * (1 << ACCEL_FIXED_FRAC_BITS)));
+    }
+
+    result_ = splitOffsets(offsetQ4);
+    status_ = CalibrationStatus::DONE;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file calibration.h
+ * @brief Zero-g calibration of the ADXL375
+ *
+ * Offsets are measured over a still window and split into whole steps
+ * of the sensor's OFSX/OFSY/OFSZ registers, which the ADXL375 applies
+ * before samples reach the FIFO, and a small remainder removed in Q4
+ * fixed point. Calibrations are persisted in NVS (config_store.h) so one
+ * firmware build serves every unit.
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "signal_processing.h"
+
+/**
+ * @brief Per-unit zero-g offsets
+ */
+struct AccelCalibration {
+    int8_t hardware[3];     // OFSX/Y/Z register values (ADXL375_OFFSET_COUNTS_PER_LSB counts each)
+    int16_t residualQ4[3];  // Left over after the hardware step (Q4 counts, subtract)
+
+    /**
+     * @brief Remainder rounded to whole counts (calibrated = raw - residual)
+     */
+    RawAccel residualCounts() const;
+
+    /**
+     * @brief Total offset of one axis in g (as measured, sign: reading at 0 g)
+     */
+    float offsetG(uint8_t axis) const;
+};
+
+/**
+ * @brief Split measured offsets into register steps and a remainder
+ *
+ * @param offsetQ4 Offset per axis, as read at 0 g (Q4 counts)
+ * @return AccelCalibration Register values and remainder
+ */
+AccelCalibration splitOffsets(const int32_t offsetQ4[3]);
+
+/**
+ * @brief Calibration built from the OFFSET_* constants in config.h
+ */
+AccelCalibration defaultCalibration();
+
+/**
+ * @brief Outcome of a calibration run
+ */
+enum class CalibrationStatus : uint8_t {
+    IDLE = 0,    ///< No run since boot
+    RUNNING,     ///< Collecting the still window
+    DONE,        ///< New offsets applied
+    MOVED,       ///< Too much motion during the window
+    NOT_LEVEL,   ///< No single axis clearly carried gravity
+    UNAVAILABLE  ///< Could not start (sensor missing or shock-wake mode)
+};
+
+/**
+ * @brief Short name of a calibration status
+ */
+const char* calibrationStatusName(CalibrationStatus status);
+
+/**
+ * @brief Still-window offset measurement (sampler task only)
+ *
+ * Feed raw samples taken with the offset registers at zero. The axis
+ * with the largest mean is taken as the gravity axis and calibrated to
+ * +/-1 g; the others to 0 g.
+ */
+class CalibrationRoutine {
+public:
+    CalibrationRoutine();
+
+    /**
+     * @brief Start a new window
+     *
+     * @param rateHz Current sample rate
+     */
+    void start(uint32_t rateHz);
+
+    /**
+     * @brief Check if a window is being collected
+     */
+    bool isRunning() const { return running_; }
+
+    /**
+     * @brief Add one raw sample
+     *
+     * @return true when the window is complete (see status() and result())
+     */
+    bool addSample(const RawAccel& raw);
+
+    /**
+     * @brief Abandon the window (status becomes UNAVAILABLE)
+     */
+    void cancel();
+
+    /**
+     * @brief Outcome of the last completed window
+     */
+    CalibrationStatus status() const { return status_; }
+
+    /**
+     * @brief Offsets from the last successful window
+     */
+    const AccelCalibration& result() const { return result_; }
+
+private:
+    bool running_;
+    uint32_t settleRemaining_;
+    uint32_t windowSamples_;
+    uint32_t count_;
+    int64_t sum_[3];
+    uint64_t sumSquares_[3];
+    CalibrationStatus status_;
+    AccelCalibration result_;
+
+    void finish();
+};
+
+#endif // CALIBRATION_H
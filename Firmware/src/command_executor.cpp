@@ -0,0 +1,209 @@
+/**
+ * @file command_executor.cpp
+ * @brief Command protocol executor implementation
+ */
+
+#include "command_executor.h"
+#include "time_sync.h"
+
+CommandExecutor* CommandExecutor::active_ = nullptr;
+
+CommandExecutor::CommandExecutor(Sampler& sampler, BleService& ble, WifiStreamer& wifi, Display& display,
+                                 Settings& settings, SerialFormatFunction setSerialFormat,
+                                 PowerProfileFunction applyPowerProfile)
+    : sampler_(sampler)
+    , ble_(ble)
+    , wifi_(wifi)
+    , display_(display)
+    , settings_(settings)
+    , setSerialFormat_(setSerialFormat)
+    , applyPowerProfile_(applyPowerProfile) {
+}
+
+size_t CommandExecutor::run(CommandTransport transport, const uint8_t* request, size_t length,
+                            uint8_t* response, size_t capacity) {
+    // Reason: runCommands() takes a plain function, and every request is
+    // run from loop(), so the executor in use can be a static
+    active_ = this;
+    return runCommands(transport, request, length, response, capacity, &CommandExecutor::handleRecord);
+}
+
+CommandStatus CommandExecutor::handleRecord(CommandTransport transport, const CommandRecord& record,
+                                            CommandReply& reply) {
+    return active_->handle(transport, record, reply);
+}
+
+CommandStatus CommandExecutor::handle(CommandTransport transport, const CommandRecord& record, CommandReply& reply) {
+    CommandStatus status = CommandStatus::OK;
+
+    switch (static_cast<CommandTag>(record.tag)) {
+        case CommandTag::STATUS:
+            if (record.length != 0) {
+                return CommandStatus::BAD_LENGTH;
+            }
+            reply.put8(COMMAND_PROTOCOL_VERSION);
+            reply.put8((sampler_.logger().isLogging() ? 0x01 : 0)
+                       | (sampler_.isShockWakeEnabled() ? 0x02 : 0)
+                       | (ble_.isConnected() ? 0x04 : 0)
+                       | (wifi_.isStreaming() ? 0x08 : 0)
+                       | (timeSync.isSynced() ? 0x10 : 0));
+            reply.put32(millis());
+            return status;
+
+        case CommandTag::SAMPLE_RATE:
+            if (record.length == 2) {
+                status = sampler_.setSampleRate(record.u16(0)) ? CommandStatus::OK : CommandStatus::BAD_VALUE;
+            } else if (record.length != 0) {
+                status = CommandStatus::BAD_LENGTH;
+            }
+            reply.put16(static_cast<uint16_t>(sampler_.getSampleRate()));
+            return status;
+
+        case CommandTag::FILTER:
+            {
+                FilterConfig config = {};
+                if (record.length == 1 || record.length == 7) {
+                    status = parseFilterPayload(record.value, record.length, config) && sampler_.setFilterConfig(config)
+                           ? CommandStatus::OK : CommandStatus::BAD_VALUE;
+                } else if (record.length != 0) {
+                    status = CommandStatus::BAD_LENGTH;
+                }
+
+                config = sampler_.getFilterConfig();
+                int preset = findFilterPreset(config);
+                reply.put8(preset < 0 ? 0xFF : static_cast<uint8_t>(preset));
+                reply.put8(config.dcBlock ? 0x01 : 0);
+                reply.put16(config.highPassHz);
+                reply.put16(config.lowPassHz);
+                reply.put16(config.averageMs);
+            }
+            return status;
+
+        case CommandTag::TRIGGER:
+            if (record.length == 2 || record.length == 3) {
+                if (!sampler_.setImpactThresholdG(record.u16(0) / 10.0f)) {
+                    status = CommandStatus::BAD_VALUE;
+                } else if (record.length == 3 && (record.u8(2) != 0) != sampler_.isShockWakeEnabled()
+                           && !sampler_.setShockWake(record.u8(2) != 0)) {
+                    status = CommandStatus::UNAVAILABLE;  // INT1 not wired
+                }
+            } else if (record.length != 0) {
+                status = CommandStatus::BAD_LENGTH;
+            }
+            reply.put16(static_cast<uint16_t>(sampler_.capture().getThresholdG() * 10.0f + 0.5f));
+            reply.put8(sampler_.isShockWakeEnabled() ? 1 : 0);
+            return status;
+
+        case CommandTag::STREAM_FORMAT:
+            {
+                if (record.length != 1 && record.length != 2) {
+                    return CommandStatus::BAD_LENGTH;
+                }
+                uint8_t link = record.u8(0);
+                bool set = record.length == 2;
+                uint8_t format = set ? record.u8(1) : 0;
+                uint8_t current;
+
+                if (link == 0) {
+                    if (set && format <= static_cast<uint8_t>(SerialFormat::STATS)) {
+                        setSerialFormat_(static_cast<SerialFormat>(format));
+                    } else if (set) {
+                        status = CommandStatus::BAD_VALUE;
+                    }
+                    current = static_cast<uint8_t>(settings_.serialFormat);
+                } else if (link == 1) {
+                    BleStreamFormat bleFormat = static_cast<BleStreamFormat>(format);
+                    if (set && format > static_cast<uint8_t>(BleStreamFormat::BATCHED)) {
+                        status = CommandStatus::BAD_VALUE;
+                    } else if (set && transport == CommandTransport::BLE) {
+                        status = ble_.setCommandClientFormat(bleFormat) ? CommandStatus::OK
+                                                                              : CommandStatus::UNAVAILABLE;
+                    } else if (set) {
+                        ble_.setStreamFormat(bleFormat);
+                    }
+                    current = static_cast<uint8_t>(transport == CommandTransport::BLE
+                                                   ? ble_.getCommandClientFormat()
+                                                   : ble_.getStreamFormat());
+                } else if (link == 2) {
+                    // Applied by the caller of run(), after the response
+                    if (set && format <= static_cast<uint8_t>(WifiMode::TCP)) {
+                        settings_.wifiMode = static_cast<WifiMode>(format);
+                    } else if (set) {
+                        status = CommandStatus::BAD_VALUE;
+                    }
+                    current = static_cast<uint8_t>(settings_.wifiMode);
+                } else {
+                    return CommandStatus::BAD_VALUE;
+                }
+
+                reply.put8(link);
+                reply.put8(current);
+            }
+            return status;
+
+        case CommandTag::LOGGING:
+            if (record.length == 1) {
+                if (record.u8(0) == 0) {
+                    sampler_.stopLogging();
+                } else if (!sampler_.logger().isLogging() && !sampler_.startLogging()) {
+                    status = CommandStatus::UNAVAILABLE;  // No log partition
+                }
+            } else if (record.length != 0) {
+                status = CommandStatus::BAD_LENGTH;
+            }
+            reply.put8(sampler_.logger().isLogging() ? 1 : 0);
+            reply.put32(sampler_.logger().logBlocks());
+            reply.put32(sampler_.logger().capacityBlocks());
+            return status;
+
+        case CommandTag::POWER_PROFILE:
+            if (record.length == 1) {
+                if (record.u8(0) <= static_cast<uint8_t>(PowerProfile::LOW_POWER)) {
+                    applyPowerProfile_(static_cast<PowerProfile>(record.u8(0)));
+                } else {
+                    status = CommandStatus::BAD_VALUE;
+                }
+            } else if (record.length != 0) {
+                status = CommandStatus::BAD_LENGTH;
+            }
+            reply.put8(static_cast<uint8_t>(settings_.powerProfile));
+            return status;
+
+        case CommandTag::RESET:
+            if (record.length != 1) {
+                return CommandStatus::BAD_LENGTH;
+            }
+            if (record.u8(0) == 0 || (record.u8(0) & ~0x03) != 0) {
+                return CommandStatus::BAD_VALUE;
+            }
+            if (record.u8(0) & 0x01) {
+                sampler_.requestPeakReset();
+                display_.resetGaugeMax();
+            }
+            if (record.u8(0) & 0x02) {
+                sampler_.requestFilterReset();
+            }
+            return status;
+
+        case CommandTag::CALIBRATE:
+            if (record.length != 0) {
+                return CommandStatus::BAD_LENGTH;
+            }
+            return sampler_.requestCalibration() ? CommandStatus::OK : CommandStatus::UNAVAILABLE;
+    }
+    return CommandStatus::UNKNOWN_TAG;
+}
+
+bool parseFilterPayload(const uint8_t* payload, size_t length, FilterConfig& config) {
+    if (length == 1) {
+        return filterPreset(payload[0], config);
+    }
+    if (length != 7) {
+        return false;
+    }
+    config.dcBlock = (payload[0] & 0x01) != 0;
+    config.highPassHz = payload[1] | (payload[2] << 8);
+    config.lowPassHz = payload[3] | (payload[4] << 8);
+    config.averageMs = payload[5] | (payload[6] << 8);
+    return true;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file command_executor.h
+ * @brief Runs command protocol requests against the device settings
+ *
+ * The one executor behind every link: serial COMMAND frames, writes to
+ * the Command characteristic and Wi-Fi command datagrams all go through
+ * run(), so a setting changes the same way whichever link the host
+ * uses, and the config store saves it like a text command's change.
+ * The record format is in command_protocol.h. loop() only.
+ */
+
+#ifndef COMMAND_EXECUTOR_H
+#define COMMAND_EXECUTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "settings.h"
+#include "filter_chain.h"
+#include "command_protocol.h"
+#include "sampler.h"
+#include "ble_service.h"
+#include "wifi_stream.h"
+#include "display.h"
+
+/**
+ * @brief Decode a filter setting sent by a host
+ *
+ * Payload: preset number, or flags (bit 0 DC block) + HP Hz + LP Hz +
+ * average ms (uint16 LE). Used by the BLE control command and the
+ * command protocol.
+ *
+ * @param payload Setting bytes
+ * @param length Payload length (1 or 7)
+ * @param config Decoded settings
+ * @return true if the payload has a known preset or the full settings
+ *         (Sampler::setFilterConfig() checks their limits)
+ */
+bool parseFilterPayload(const uint8_t* payload, size_t length, FilterConfig& config);
+
+/**
+ * @brief Command protocol executor shared by serial, BLE and Wi-Fi
+ *
+ * A Wi-Fi mode change is only stored in Settings::wifiMode, because it
+ * restarts the radio; the caller applies it once the response is sent.
+ */
+class CommandExecutor {
+public:
+    /**
+     * @brief Switches the serial output format (owned by the application)
+     */
+    using SerialFormatFunction = void (*)(SerialFormat format);
+
+    /**
+     * @brief Applies and records a power profile (owned by the application)
+     */
+    using PowerProfileFunction = void (*)(PowerProfile profile);
+
+    CommandExecutor(Sampler& sampler, BleService& ble, WifiStreamer& wifi, Display& display,
+                    Settings& settings, SerialFormatFunction setSerialFormat,
+                    PowerProfileFunction applyPowerProfile);
+
+    /**
+     * @brief Run every record of a request and build the response
+     *
+     * @param transport Link the request arrived on
+     * @param request Message without any transport framing
+     * @param length Message length
+     * @param response Response buffer
+     * @param capacity Largest response the link takes
+     * @return size_t Response length (0 = empty request, nothing to send)
+     */
+    size_t run(CommandTransport transport, const uint8_t* request, size_t length,
+               uint8_t* response, size_t capacity);
+
+private:
+    static CommandExecutor* active_;  // Executor of the request being run
+
+    Sampler& sampler_;
+    BleService& ble_;
+    WifiStreamer& wifi_;
+    Display& display_;
+    Settings& settings_;
+    SerialFormatFunction setSerialFormat_;
+    PowerProfileFunction applyPowerProfile_;
+
+    static CommandStatus handleRecord(CommandTransport transport, const CommandRecord& record,
+                                      CommandReply& reply);
+    CommandStatus handle(CommandTransport transport, const CommandRecord& record, CommandReply& reply);
+};
+
+#endif // COMMAND_EXECUTOR_H
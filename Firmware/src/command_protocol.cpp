@@ -0,0 +1,58 @@
+/**
+ * @file command_protocol.cpp
+ * @brief Command record codec implementation
+ */
+
+#include "command_protocol.h"
+
+void CommandReply::put8(uint8_t value) {
+    if (length_ < COMMAND_MAX_VALUE) {
+        buffer_[length_++] = value;
+    }
+}
+
+void CommandReply::put16(uint16_t value) {
+    put8(value & 0xFF);
+    put8((value >> 8) & 0xFF);
+}
+
+void CommandReply::put32(uint32_t value) {
+    put16(value & 0xFFFF);
+    put16(value >> 16);
+}
+
+size_t runCommands(CommandTransport transport, const uint8_t* request, size_t length,
+                   uint8_t* response, size_t capacity, CommandHandler handler) {
+    if (length < COMMAND_HEADER_SIZE || capacity < COMMAND_HEADER_SIZE) {
+        return 0;
+    }
+
+    response[0] = request[0];
+    size_t in = COMMAND_HEADER_SIZE;
+    size_t out = COMMAND_HEADER_SIZE;
+
+    // Reason: an answer is written in place before its size is known, so
+    // room for the largest one is checked first
+    while (in < length && capacity - out >= COMMAND_REPLY_HEADER + COMMAND_MAX_VALUE) {
+        uint8_t* answer = &response[out];
+        answer[0] = request[in];
+        if (length - in < COMMAND_RECORD_HEADER
+            || length - in - COMMAND_RECORD_HEADER < request[in + 1]) {
+            answer[1] = static_cast<uint8_t>(CommandStatus::MALFORMED);
+            answer[2] = 0;
+            out += COMMAND_REPLY_HEADER;
+            break;
+        }
+
+        CommandRecord record = {request[in], &request[in + COMMAND_RECORD_HEADER], request[in + 1]};
+        in += COMMAND_RECORD_HEADER + record.length;
+
+        CommandReply reply(&answer[COMMAND_REPLY_HEADER]);
+        CommandStatus status = record.length > COMMAND_MAX_VALUE ? CommandStatus::BAD_LENGTH
+                             : handler(transport, record, reply);
+        answer[1] = static_cast<uint8_t>(status);
+        answer[2] = static_cast<uint8_t>(reply.length());
+        out += COMMAND_REPLY_HEADER + reply.length();
+    }
+    return out;
+}
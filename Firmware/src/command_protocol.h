@@ -0,0 +1,163 @@
+/**
+ * @file command_protocol.h
+ * @brief Binary command protocol shared by serial, BLE and Wi-Fi
+ *
+ * One request carries any number of settings as tag-length-value
+ * records, and the response answers each of them in order, so a host
+ * drives every link with the same encoder instead of the text console,
+ * the one-byte BLE control codes and the config characteristic.
+ *
+ *   request   seq(u8), records of tag(u8), length(u8), value
+ *   response  seq(u8), records of tag(u8), status(u8), length(u8), value
+ *
+ * seq is echoed so a host can match a response to its request and drop
+ * stale ones. A record with an empty value reads the setting; one with a
+ * value changes it. Either way the response value is the setting now in
+ * effect (also after an error), so a host always sees what the device
+ * runs; logging starts and stops on the sampler task, so its value can
+ * lag a change by one FIFO drain. Values are little-endian:
+ *
+ *   STATUS         0x01  read only: version(u8), flags(u8), uptime(u32 ms)
+ *                        flags bit 0 logging, 1 shock wake, 2 BLE client,
+ *                        3 Wi-Fi host, 4 time synced
+ *   SAMPLE_RATE    0x02  rate(u16 Hz): 25, 50, 100, 200, 400, 800, 1600, 3200
+ *   FILTER         0x03  set: preset(u8), or dc block(u8), high-pass(u16 Hz),
+ *                        low-pass(u16 Hz), average(u16 ms)
+ *                        value: preset(u8, 0xFF = custom) and the 7 bytes
+ *   TRIGGER        0x04  threshold(u16 0.1 g)[, shock wake(u8)]
+ *   STREAM_FORMAT  0x05  link(u8)[, format(u8)]; value: link, format
+ *                        link 0 serial: 0 CSV, 1 binary, 2 stats
+ *                        link 1 BLE: 0 legacy, 1 batched (sent over BLE,
+ *                        the requesting client only)
+ *                        link 2 Wi-Fi: 0 off, 1 UDP, 2 TCP
+ *   LOGGING        0x06  set: on(u8); value: on(u8), blocks(u32), capacity(u32)
+ *   POWER_PROFILE  0x07  profile(u8): 0 performance, 1 balanced, 2 low power
+ *   RESET          0x08  set only: bit 0 peak, bit 1 filters; no value back
+ *   CALIBRATE      0x09  no value: start the orientation calibration
+ *
+ * Records are only run while the response has room for the largest
+ * answer (COMMAND_REPLY_HEADER + COMMAND_MAX_VALUE); the rest of the
+ * request is dropped and the host sends it again. A record running past
+ * the end of the request is answered MALFORMED and ends it.
+ *
+ * Messages travel as COMMAND serial frames (see serial_frame.h), as
+ * writes and notifications on the Command characteristic, or as UDP
+ * datagrams starting with COMMAND_MAGIC on the Wi-Fi stream port.
+ * runCommands() neither allocates nor copies the request.
+ */
+
+#ifndef COMMAND_PROTOCOL_H
+#define COMMAND_PROTOCOL_H
+
+#include <Arduino.h>
+
+constexpr uint8_t COMMAND_PROTOCOL_VERSION = 1;
+constexpr size_t COMMAND_HEADER_SIZE = 1;        // seq
+constexpr size_t COMMAND_RECORD_HEADER = 2;      // tag, length
+constexpr size_t COMMAND_REPLY_HEADER = 3;       // tag, status, length
+constexpr size_t COMMAND_MAX_VALUE = 16;
+constexpr size_t COMMAND_MAX_MESSAGE = 128;
+
+// Prefix of command datagrams on the Wi-Fi stream port
+constexpr uint8_t COMMAND_MAGIC[4] = {'G', 'C', 'M', 'D'};
+constexpr size_t COMMAND_MAGIC_SIZE = sizeof(COMMAND_MAGIC);
+
+/**
+ * @brief Setting or action a record addresses
+ */
+enum class CommandTag : uint8_t {
+    STATUS = 0x01,
+    SAMPLE_RATE = 0x02,
+    FILTER = 0x03,
+    TRIGGER = 0x04,
+    STREAM_FORMAT = 0x05,
+    LOGGING = 0x06,
+    POWER_PROFILE = 0x07,
+    RESET = 0x08,
+    CALIBRATE = 0x09
+};
+
+/**
+ * @brief Result of one record
+ */
+enum class CommandStatus : uint8_t {
+    OK = 0,
+    UNKNOWN_TAG = 1,   ///< Tag not supported by this firmware
+    BAD_LENGTH = 2,    ///< Value has the wrong size for the tag
+    BAD_VALUE = 3,     ///< Value out of range; nothing changed
+    UNAVAILABLE = 4,   ///< Not possible now (e.g. no log partition, INT1 not wired)
+    MALFORMED = 5      ///< Record runs past the end of the request
+};
+
+/**
+ * @brief Link a request arrived on
+ */
+enum class CommandTransport : uint8_t {
+    SERIAL_PORT = 0,
+    BLE = 1,
+    WIFI = 2
+};
+
+/**
+ * @brief One request record, pointing into the request buffer
+ */
+struct CommandRecord {
+    uint8_t tag;
+    const uint8_t* value;
+    size_t length;   ///< 0 = read the setting
+
+    uint8_t u8(size_t offset) const { return value[offset]; }
+    uint16_t u16(size_t offset) const {
+        return static_cast<uint16_t>(value[offset] | (value[offset + 1] << 8));
+    }
+};
+
+/**
+ * @brief Writes a record's response value in place
+ *
+ * Bytes past COMMAND_MAX_VALUE are dropped.
+ */
+class CommandReply {
+public:
+    explicit CommandReply(uint8_t* buffer)
+        : buffer_(buffer)
+        , length_(0) {
+    }
+
+    void put8(uint8_t value);
+    void put16(uint16_t value);
+    void put32(uint32_t value);
+
+    size_t length() const { return length_; }
+
+private:
+    uint8_t* buffer_;
+    size_t length_;
+};
+
+/**
+ * @brief Runs one record
+ *
+ * @param transport Link the request arrived on
+ * @param record Record to run
+ * @param reply Response value to fill in
+ * @return CommandStatus Status sent back for the record
+ */
+using CommandHandler = CommandStatus (*)(CommandTransport transport, const CommandRecord& record,
+                                         CommandReply& reply);
+
+/**
+ * @brief Run every record of a request and build the response
+ *
+ * @param transport Link the request arrived on
+ * @param request Message without any transport framing
+ * @param length Message length
+ * @param response Response buffer
+ * @param capacity Largest response the link takes
+ * @param handler Executes each record
+ * @return size_t Response length (0 = empty request, nothing to send)
+ */
+size_t runCommands(CommandTransport transport, const uint8_t* request, size_t length,
+                   uint8_t* response, size_t capacity, CommandHandler handler);
+
+#endif // COMMAND_PROTOCOL_H
@@ -44,8 +44,22 @@ constexpr uint8_t PIN_ADXL_SCL = 20;  // JST RX pin -> I2C SCL
 // ADXL375 I2C address (ALT ADDRESS pin LOW on Adafruit board)
 constexpr uint8_t ADXL375_I2C_ADDR = 0x53;
 
+// ADXL375 I2C clock
+// The sensor is specified for 400 kHz. begin() tries the fast clock (the
+// ESP32-C3 controller maximum) and keeps it only if register reads verify;
+// long or heavily loaded JST leads fall back to 400 kHz. Set the fast clock
+// equal to the standard clock to disable the probe.
+constexpr uint32_t ADXL_I2C_CLOCK_HZ = 400000;
+constexpr uint32_t ADXL_I2C_FAST_CLOCK_HZ = 800000;
+
+// ADXL375 INT1 output (FIFO watermark interrupt)
+// The stock 4-pin JST harness has no spare line for INT1, so this defaults
+// to -1 and the FIFO is drained on a timer instead. Set to the GPIO wired to
+// INT1 to drain on the watermark interrupt.
+constexpr int8_t PIN_ADXL_INT1 = -1;
+
 // Calibration offsets (measured with sensor flat, screen up)
-// These values are subtracted from raw readings
+// Fallback used until a unit is calibrated with 'c' (stored in NVS)
 // Adjust these based on your sensor's readings at rest
 constexpr float OFFSET_X = 0.35f;   // X reads +0.35g when should be 0
 constexpr float OFFSET_Y = -0.60f;  // Y reads -0.6g when should be 0
@@ -59,6 +73,12 @@ constexpr uint16_t DISPLAY_CENTER_Y = DISPLAY_HEIGHT / 2;
 
 // Display refresh rate (milliseconds)
 constexpr uint32_t DISPLAY_UPDATE_INTERVAL_MS = 100;  // 10 Hz refresh (slower for consistent sampling)
+constexpr uint32_t DISPLAY_OUTPUT_RATE_HZ = 1000 / DISPLAY_UPDATE_INTERVAL_MS;  // Gauge decimation
+
+// Waveform screen: one min/max column per display update, so the plot
+// advances one pixel per frame (200 columns = 20 s window)
+constexpr uint32_t WAVEFORM_COLUMN_MS = DISPLAY_UPDATE_INTERVAL_MS;
+constexpr uint16_t WAVEFORM_COLUMNS = 200;  // Plot width in pixels
 
 // ==================== ADXL375 Configuration ====================
 // Fixed range: +/- 200g
@@ -66,24 +86,177 @@ constexpr uint32_t DISPLAY_UPDATE_INTERVAL_MS = 100;  // 10 Hz refresh (slower f
 constexpr float ADXL375_SCALE_FACTOR = 0.049f;  // g per LSB
 constexpr float ADXL375_MAX_G = 200.0f;
 
+/**
+ * @brief Convert g to the nearest whole number of LSB counts
+ */
+constexpr int16_t gToCounts(float g) {
+    return static_cast<int16_t>(g >= 0.0f ? g / ADXL375_SCALE_FACTOR + 0.5f
+                                          : g / ADXL375_SCALE_FACTOR - 0.5f);
+}
+
+// Calibration offsets in LSB counts, for the integer sample paths
+constexpr int16_t OFFSET_X_COUNTS = gToCounts(OFFSET_X);
+constexpr int16_t OFFSET_Y_COUNTS = gToCounts(OFFSET_Y);
+constexpr int16_t OFFSET_Z_COUNTS = gToCounts(OFFSET_Z);
+
 // Sample rate (Hz) - ADXL375 can output up to 3200 Hz
 // Default rate for display, can be changed at runtime via serial command
 constexpr uint32_t ADXL_DEFAULT_SAMPLE_RATE_HZ = 100;
 
-// Available sample rates (serial command: s1-s4)
-// Limited to 800 Hz max due to serial bandwidth at 115200 baud
+// Available sample rates (serial command: s1-s6; 25 and 50 Hz through the
+// command protocol only). Samples are buffered in the ADXL375 FIFO, so every
+// rate is acquired gap-free. The CSV serial output cannot keep up above
+// ~250 Hz at 115200 baud. The sensor's slower codes (12.5 Hz and below) are
+// not whole rates and are not used.
+constexpr uint32_t ADXL_RATE_25HZ   = 25;
+constexpr uint32_t ADXL_RATE_50HZ   = 50;
 constexpr uint32_t ADXL_RATE_100HZ  = 100;   // s1 - default/low power
 constexpr uint32_t ADXL_RATE_200HZ  = 200;   // s2
 constexpr uint32_t ADXL_RATE_400HZ  = 400;   // s3
-constexpr uint32_t ADXL_RATE_800HZ  = 800;   // s4 - max for serial
+constexpr uint32_t ADXL_RATE_800HZ  = 800;   // s4
+constexpr uint32_t ADXL_RATE_1600HZ = 1600;  // s5
+constexpr uint32_t ADXL_RATE_3200HZ = 3200;  // s6 - sensor maximum
+
+// On-chip FIFO depth (X/Y/Z frames)
+constexpr uint8_t ADXL375_FIFO_DEPTH = 32;
+
+// Target interval between FIFO drains
+// The watermark is chosen per rate so the FIFO is drained about this often,
+// leaving the rest of the 32-entry FIFO as headroom for a slow loop().
+constexpr uint32_t ADXL_FIFO_DRAIN_INTERVAL_US = 5000;
+
+// ==================== Calibration ====================
+// Serial 'c' / BLE 0x05 averages a still window, with one axis carrying
+// gravity, into per-unit zero-g offsets. Whole OFSx steps are programmed
+// into the ADXL375 (so the FIFO already holds corrected samples) and the
+// remainder is removed in Q4 fixed point. The result is kept in NVS.
+constexpr uint32_t CALIBRATION_WINDOW_MS = 1000;
+
+// Samples discarded after zeroing the offset registers: the FIFO may
+// still hold samples taken with the old offsets
+constexpr uint32_t CALIBRATION_SETTLE_SAMPLES = ADXL375_FIFO_DEPTH + 8;
+
+// Largest per-axis standard deviation accepted as "still"
+// ADXL375 noise is ~0.2 g RMS at 3200 Hz, ~0.04 g at 100 Hz
+constexpr float CALIBRATION_MAX_NOISE_G = 0.5f;
+
+// The gravity axis must read at least this, and twice any other axis
+constexpr float CALIBRATION_MIN_GRAVITY_G = 0.5f;
+
+// OFSX/OFSY/OFSZ scale: 0.196 g per LSB = 4 output counts
+constexpr int16_t ADXL375_OFFSET_COUNTS_PER_LSB = 4;
+
+// ==================== Config Store ====================
+// Settings, sample rate, BLE notification rate and stream format, filter
+// chain, impact threshold and shock wake are restored from NVS at boot.
+// Changes are written once they have been stable for CONFIG_SAVE_DELAY_MS,
+// so a burst of commands costs one flash write.
+constexpr const char* CONFIG_NVS_NAMESPACE = "gsensor";
+constexpr const char* CONFIG_NVS_KEY = "runtime";
+constexpr const char* CALIBRATION_NVS_KEY = "accel_cal";  // Stored on its own, only after a run
+constexpr uint32_t CONFIG_SAVE_DELAY_MS = 2000;
+
+// How often loop() compares the live configuration with the stored one
+constexpr uint32_t CONFIG_CHECK_INTERVAL_MS = 250;
+
+// ==================== Sampler Task ====================
+// Sampling and processing run in their own FreeRTOS task so display,
+// touch and BLE work in loop() cannot delay FIFO drains.
+// Priority sits above loop() (1) and below the NimBLE host task.
+constexpr UBaseType_t SAMPLER_TASK_PRIORITY = configMAX_PRIORITIES - 5;
+constexpr uint32_t SAMPLER_TASK_STACK_SIZE = 4096;
+
+// Processed samples kept for consumers (power of two)
+// 512 samples = 160 ms at 3200 Hz, 5 s at 100 Hz
+constexpr size_t SAMPLE_RING_SIZE = 512;
+
+// Decimated samples kept for the gauge and legacy BLE stream (power of two)
+// 16 outputs = 1.6 s at the 10 Hz display rate, 320 ms at 50 Hz notify
+constexpr size_t DECIMATED_RING_SIZE = 16;
+
+// ==================== Impact Capture ====================
+// Events trigger on the unfiltered magnitude so short transients are not
+// averaged away. Threshold can be changed at runtime (serial 't<g>').
+constexpr float IMPACT_DEFAULT_THRESHOLD_G = 20.0f;
+constexpr float IMPACT_MIN_THRESHOLD_G = 1.0f;
+
+// Samples kept before and recorded from the trigger, at the full ODR
+// 64 + 448 samples = 20 ms + 140 ms at 3200 Hz, 0.64 s + 4.48 s at 100 Hz
+constexpr size_t IMPACT_PRE_TRIGGER_SAMPLES = 64;
+constexpr size_t IMPACT_POST_TRIGGER_SAMPLES = 448;
+constexpr size_t IMPACT_EVENT_SAMPLES = IMPACT_PRE_TRIGGER_SAMPLES + IMPACT_POST_TRIGGER_SAMPLES;
+
+// Shock-wake mode (serial 'w', needs PIN_ADXL_INT1 wired)
+// The sampler stops draining the FIFO and sleeps until the ADXL375 shock
+// detector fires, then drains and records the impact. Pre-trigger history
+// is limited to what the 32-entry FIFO holds. Shock detection is per axis,
+// so the per-axis threshold is the impact threshold / sqrt(3): every
+// impact above the magnitude threshold wakes the sampler, and the software
+// trigger confirms it. Longer events are not reported as shocks.
+constexpr uint32_t ADXL_SHOCK_MAX_DURATION_US = 150000;
+
+// ==================== Window Statistics ====================
+// Mean, RMS, min, max, crest factor and time above the impact threshold
+// of the filtered axes and magnitude. The sampler accumulates tumbling
+// buckets; the long window slides over the last STATS_LONG_BUCKETS of them.
+constexpr uint32_t STATS_BUCKET_MS = 1000;
+constexpr size_t STATS_LONG_BUCKETS = 10;   // 10 s window, updated every second
+
+// ==================== Spectrum ====================
+// Real FFT of one unfiltered channel (magnitude by default), Hann window,
+// 50% overlap, computed by a low-priority task. Frames are power-averaged
+// and published every SPECTRUM_PUBLISH_MS (or every frame, if slower).
+// 512 points = 6.25 Hz bins at 3200 Hz, 0.2 Hz bins at 100 Hz
+constexpr size_t SPECTRUM_FFT_SIZE = 512;  // Power of two
+constexpr uint32_t SPECTRUM_PUBLISH_MS = 500;
+constexpr size_t SPECTRUM_PEAK_COUNT = 5;
+
+// Band energy (RMS) edges in Hz; bands above Nyquist report 0
+constexpr size_t SPECTRUM_BAND_COUNT = 4;
+constexpr uint16_t SPECTRUM_DEFAULT_BAND_EDGES_HZ[SPECTRUM_BAND_COUNT + 1] = {2, 10, 100, 500, 1600};
+
+constexpr UBaseType_t SPECTRUM_TASK_PRIORITY = 1;
+constexpr uint32_t SPECTRUM_TASK_STACK_SIZE = 4096;
+
+// ==================== Data Logger ====================
+// Raw samples are logged to the "gslog" flash partition (partitions.csv)
+// in one-sector blocks, written by a low-priority task from two RAM
+// buffers filled by the sampler.
+constexpr const char* LOG_PARTITION_LABEL = "gslog";
+constexpr uint8_t LOG_PARTITION_SUBTYPE = 0x40;  // Custom data subtype
+constexpr size_t LOG_BLOCK_SIZE = 4096;          // One flash erase sector
+
+// true: overwrite the oldest blocks when the partition is full
+// false: stop logging when full
+constexpr bool LOG_WRAP_WHEN_FULL = true;
+
+// Writer task sits above loop() and below the sampler; flash erases
+// (tens of ms per sector) happen here
+constexpr UBaseType_t LOGGER_TASK_PRIORITY = 2;
+constexpr uint32_t LOGGER_TASK_STACK_SIZE = 4096;
 
 // ==================== Signal Processing ====================
-// Moving average filter window size
-// Larger = smoother but more latency
-// At 100 Hz sample rate:
-//   10 samples = 100ms averaging window
-//   20 samples = 200ms averaging window
-constexpr size_t MOVING_AVG_WINDOW_SIZE = 10;
+// Filter chain applied to each axis and the magnitude (see filter_chain.h)
+// Stages are set in Hz / ms, so the response does not change with the ODR
+// Preset used at boot: 0 = raw, 1 = smooth (100 ms average), 2 = low-pass, 3 = vibration
+constexpr uint8_t FILTER_DEFAULT_PRESET = 1;
+
+// Longest boxcar average in samples
+// 320 samples = 100 ms at 3200 Hz, 3.2 s at 100 Hz
+constexpr size_t FILTER_AVERAGE_MAX_SAMPLES = 320;
+
+// DC removal time constant (rounded down to a power of two in samples)
+constexpr uint32_t FILTER_DC_TIME_CONSTANT_MS = 1000;
+
+// Limits for runtime filter settings
+constexpr uint16_t FILTER_MAX_HIGH_PASS_HZ = 1000;
+constexpr uint16_t FILTER_MAX_LOW_PASS_HZ = 1600;
+constexpr uint16_t FILTER_MAX_AVERAGE_MS = 1000;
+
+// Longest decimator block: 3200 Hz down to the 5 Hz minimum notify rate
+// Display and legacy BLE values are block averages of the filtered
+// stream, so vibration above their rate cannot alias into the readout
+constexpr uint32_t DECIMATOR_MAX_FACTOR = 640;
 
 // ==================== UI Configuration ====================
 // Pastel/neutral color palette (RGB565 format)
@@ -120,12 +293,96 @@ constexpr float GAUGE_MAX_VALUE   = 200.0f;   // Full scale = 200g
 constexpr uint32_t TOUCH_TAP_THRESHOLD_MS = 300;
 constexpr uint32_t TOUCH_LONG_PRESS_MS = 500;
 
+// Touch task: sleeps on the INT pin, polls only while a finger is down
+constexpr UBaseType_t TOUCH_TASK_PRIORITY = 1;   // Same as loop(), below everything else
+constexpr uint32_t TOUCH_TASK_STACK_SIZE = 3072;
+constexpr uint32_t TOUCH_ACTIVE_POLL_MS = 20;    // Release detection while touching
+constexpr size_t TOUCH_EVENT_QUEUE_LENGTH = 4;
+
+// Finger-count poll for controllers whose INT never fires; stops at the
+// first interrupt (0 = interrupt only)
+constexpr uint32_t TOUCH_POLL_FALLBACK_MS = 100;
+
 // ==================== Serial Debug ====================
 constexpr uint32_t SERIAL_BAUD_RATE = 115200;
 
+// Max CSV lines written per loop() pass, so a backlog of samples cannot
+// starve the display and BLE work that follows
+constexpr size_t SERIAL_MAX_LINES_PER_LOOP = 32;
+
+// Binary serial stream (serial command 'b', 'a' returns to CSV)
+// 16 samples per frame = 142 bytes; 3200 Hz is ~28 KB/s over USB-CDC
+constexpr uint8_t SERIAL_BINARY_BATCH_SAMPLES = 16;
+// Send a partly filled frame after this long so low rates stay responsive
+constexpr uint32_t SERIAL_BINARY_FLUSH_MS = 20;
+
 // Set to true to enable debug output via serial
 constexpr bool DEBUG_ENABLED = true;
 
+// ==================== Profiling ====================
+// Only used when built with -DGSENSOR_PROFILING=1 (serial 'i', BLE de09)
+// Histogram: power-of-two buckets of CPU cycles; the first covers
+// everything below 2^(FIRST_BIT + 1) cycles (1.6 us at 160 MHz)
+constexpr int PROFILE_HISTOGRAM_BUCKETS = 16;
+constexpr int PROFILE_HISTOGRAM_FIRST_BIT = 7;
+// BLE diagnostics notification period
+constexpr uint32_t PROFILE_NOTIFY_INTERVAL_MS = 1000;
+
+// ==================== Benchmarks ====================
+// Only used by the benchmark firmware (pio run -e bench, see bench/)
+// Synthetic samples per signal-path run, at ADXL_RATE_3200HZ
+constexpr uint32_t BENCH_SAMPLE_COUNT = 32000;
+// Frames drawn per display run
+constexpr uint32_t BENCH_DISPLAY_FRAMES = 100;
+// Length of each transport throughput run
+constexpr uint32_t BENCH_TRANSPORT_MS = 3000;
+// Time to wait for a BLE client before skipping the BLE transport runs
+constexpr uint32_t BENCH_BLE_CONNECT_WAIT_MS = 15000;
+
+// ==================== Power Management ====================
+// Profiles (serial 'o0'-'o2'): performance keeps everything at full power,
+// balanced dims and later blanks the backlight and advertises slowly, low
+// power also lowers the CPU clock, TX power and connection rate, drains
+// the FIFO less often, and light-sleeps between drains while the display
+// is off and BLE and serial are disabled.
+constexpr uint8_t BACKLIGHT_FULL = 255;
+constexpr uint8_t BACKLIGHT_DIM = 40;
+
+// Inactivity (touch, button, serial) before dimming / blanking (0 = never)
+constexpr uint32_t POWER_BALANCED_DIM_MS = 30000;
+constexpr uint32_t POWER_BALANCED_OFF_MS = 300000;
+constexpr uint32_t POWER_LOW_DIM_MS = 10000;
+constexpr uint32_t POWER_LOW_OFF_MS = 30000;
+
+// CPU clock per profile; 80 MHz is the lowest that keeps APB (I2C, SPI,
+// timers) at full speed on the ESP32-C3
+constexpr uint32_t POWER_FULL_CPU_MHZ = 160;
+constexpr uint32_t POWER_LOW_CPU_MHZ = 80;
+
+// loop() pause per pass; the low-power value still drains the sample
+// ring long before it wraps (512 samples = 160 ms at 3200 Hz)
+constexpr uint32_t POWER_FULL_IDLE_DELAY_MS = 1;
+constexpr uint32_t POWER_LOW_IDLE_DELAY_MS = 5;
+
+// FIFO drain interval in the low-power profile (watermark still capped
+// at half the FIFO): fewer, larger wake-ups
+constexpr uint32_t ADXL_FIFO_LOW_POWER_DRAIN_INTERVAL_US = 40000;
+
+// Longest single light sleep, so loop() housekeeping still runs
+constexpr uint32_t POWER_SLEEP_MAX_MS = 100;
+
+// Supply current model for the power report (mA, typical datasheet
+// figures; measure a unit at the battery to refine them)
+constexpr float POWER_CPU_FULL_MA = 25.0f;         // ESP32-C3 active, 160 MHz
+constexpr float POWER_CPU_LOW_MA = 17.0f;          // ESP32-C3 active, 80 MHz
+constexpr float POWER_LIGHT_SLEEP_MA = 0.35f;      // Chip, regulator and pull-ups
+constexpr float POWER_PANEL_MA = 4.0f;             // GC9A01 controller
+constexpr float POWER_BACKLIGHT_FULL_MA = 30.0f;   // Scales with PWM duty
+constexpr float POWER_SENSOR_MA = 0.15f;           // ADXL375 measuring
+constexpr float POWER_BLE_ADV_EVENT_UC = 60.0f;    // Three channels, ~3 ms at ~20 mA
+constexpr float POWER_BLE_CONN_EVENT_UC = 15.0f;   // One short exchange
+constexpr uint32_t POWER_REPORT_BATTERY_MAH = 1000;  // Runtime quoted per this capacity
+
 // ==================== BLE Configuration ====================
 // Device name visible during BLE scanning
 constexpr const char* BLE_DEVICE_NAME = "gSENSOR";
@@ -137,6 +394,14 @@ constexpr const char* BLE_CHAR_ACCEL_UUID     = "12345678-1234-5678-1234-56789ab
 constexpr const char* BLE_CHAR_PEAK_UUID      = "12345678-1234-5678-1234-56789abcde02";
 constexpr const char* BLE_CHAR_CONTROL_UUID   = "12345678-1234-5678-1234-56789abcde03";
 constexpr const char* BLE_CHAR_CONFIG_UUID    = "12345678-1234-5678-1234-56789abcde04";
+constexpr const char* BLE_CHAR_BATCH_UUID     = "12345678-1234-5678-1234-56789abcde05";
+constexpr const char* BLE_CHAR_IMPACT_UUID    = "12345678-1234-5678-1234-56789abcde06";
+constexpr const char* BLE_CHAR_STATS_UUID     = "12345678-1234-5678-1234-56789abcde07";
+constexpr const char* BLE_CHAR_SPECTRUM_UUID  = "12345678-1234-5678-1234-56789abcde08";
+constexpr const char* BLE_CHAR_DIAGNOSTICS_UUID = "12345678-1234-5678-1234-56789abcde09";  // Profiling builds only
+constexpr const char* BLE_CHAR_SYNC_UUID      = "12345678-1234-5678-1234-56789abcde0a";
+constexpr const char* BLE_CHAR_LOG_UUID       = "12345678-1234-5678-1234-56789abcde0b";
+constexpr const char* BLE_CHAR_COMMAND_UUID   = "12345678-1234-5678-1234-56789abcde0c";
 
 // BLE notification rate (Hz) - lower saves power
 constexpr uint8_t BLE_DEFAULT_NOTIFY_RATE_HZ = 20;
@@ -144,8 +409,122 @@ constexpr uint8_t BLE_MAX_NOTIFY_RATE_HZ = 50;
 constexpr uint8_t BLE_MIN_NOTIFY_RATE_HZ = 5;
 constexpr uint32_t BLE_NOTIFY_INTERVAL_MS = 1000 / BLE_DEFAULT_NOTIFY_RATE_HZ;
 
+// Batched stream (BLE_CHAR_BATCH): many raw samples per notification
+// ATT MTU requested from clients (247 = one LL packet with data length
+// extension). Frames are sized to the MTU actually negotiated.
+constexpr uint16_t BLE_PREFERRED_MTU = 247;
+constexpr uint16_t BLE_DEFAULT_MTU = 23;
+constexpr uint16_t BLE_ATT_NOTIFY_OVERHEAD = 3;  // Opcode + handle
+// Send a partly filled batch after this long
+constexpr uint32_t BLE_BATCH_MAX_LATENCY_MS = 50;
+
+// Concurrent connections (advertising continues until all are taken);
+// must not exceed CONFIG_BT_NIMBLE_MAX_CONNECTIONS (3 by default)
+constexpr size_t BLE_MAX_CLIENTS = 3;
+// Notify budget per connection: packets per connection event, and the
+// most that can be saved up while the link is idle
+constexpr uint32_t BLE_NOTIFY_PACKETS_PER_EVENT = 6;
+constexpr uint32_t BLE_NOTIFY_BURST_PACKETS = 12;
+// How often the negotiated connection intervals are read back
+constexpr uint32_t BLE_CONN_INTERVAL_CHECK_MS = 1000;
+
+// Connection link profiles (intervals in 1.25 ms units, timeout in 10 ms units)
+// High throughput: used while the batched stream is selected
+constexpr uint16_t BLE_FAST_CONN_INTERVAL_MIN = 6;    // 7.5 ms
+constexpr uint16_t BLE_FAST_CONN_INTERVAL_MAX = 12;   // 15 ms
+constexpr uint16_t BLE_FAST_CONN_LATENCY = 0;
+constexpr uint16_t BLE_FAST_CONN_TIMEOUT = 400;       // 4 s
+// Low power: enough for the legacy stream (<= 50 Hz, 1-2 packets per event)
+constexpr uint16_t BLE_IDLE_CONN_INTERVAL_MIN = 24;   // 30 ms
+constexpr uint16_t BLE_IDLE_CONN_INTERVAL_MAX = 40;   // 50 ms
+constexpr uint16_t BLE_IDLE_CONN_LATENCY = 0;
+constexpr uint16_t BLE_IDLE_CONN_TIMEOUT = 400;       // 4 s
+// Low-power power profile: replaces the idle values; notifications queue
+// and go out a few per event
+constexpr uint16_t BLE_SLEEPY_CONN_INTERVAL_MIN = 80;  // 100 ms
+constexpr uint16_t BLE_SLEEPY_CONN_INTERVAL_MAX = 120; // 150 ms
+constexpr uint16_t BLE_SLEEPY_CONN_LATENCY = 4;
+constexpr uint16_t BLE_SLEEPY_CONN_TIMEOUT = 600;      // 6 s
+
+// Advertising interval per power profile (0.625 ms units)
+constexpr uint16_t BLE_ADV_INTERVAL_PERFORMANCE = 160;  // 100 ms
+constexpr uint16_t BLE_ADV_INTERVAL_BALANCED = 800;     // 500 ms
+constexpr uint16_t BLE_ADV_INTERVAL_LOW_POWER = 1600;   // 1 s
+
+// LE data length extension: max link-layer payload so one 247-byte MTU
+// notification fits in a single packet
+constexpr uint16_t BLE_DATA_LEN_TX_OCTETS = 251;
+
 // Control commands (received via BLE_CHAR_CONTROL)
 constexpr uint8_t BLE_CMD_RESET_PEAK    = 0x01;
 constexpr uint8_t BLE_CMD_RESET_FILTERS = 0x02;
+constexpr uint8_t BLE_CMD_SET_FILTER    = 0x03;  // + preset byte, or 7-byte filter config
+constexpr uint8_t BLE_CMD_SET_SPECTRUM  = 0x04;  // + channel byte [+ band edges, uint16 Hz each]
+constexpr uint8_t BLE_CMD_CALIBRATE     = 0x05;  // Zero-g calibration (sensor still, one axis vertical)
+constexpr uint8_t BLE_CMD_SET_POWER     = 0x06;  // + profile byte (0 performance, 1 balanced, 2 low power)
+
+// ==================== Wi-Fi Streaming ====================
+// Network to join (station mode); set per build in platformio.ini, e.g.
+// '-DGSENSOR_WIFI_SSID="lab"' '-DGSENSOR_WIFI_PASSWORD="secret"'
+#ifndef GSENSOR_WIFI_SSID
+#define GSENSOR_WIFI_SSID ""
+#endif
+#ifndef GSENSOR_WIFI_PASSWORD
+#define GSENSOR_WIFI_PASSWORD ""
+#endif
+constexpr const char* WIFI_SSID = GSENSOR_WIFI_SSID;
+constexpr const char* WIFI_PASSWORD = GSENSOR_WIFI_PASSWORD;
+
+// Port for both transports: UDP receivers subscribe by sending any
+// datagram to it, TCP receivers connect to it
+constexpr uint16_t WIFI_STREAM_PORT = 5555;
+
+// One unfragmented UDP datagram on a 1500-byte MTU (182 samples per frame)
+constexpr size_t WIFI_FRAME_MAX_BYTES = 1472;
+// Send a partly filled frame after this long
+constexpr uint32_t WIFI_BATCH_MAX_LATENCY_MS = 50;
+// UDP receivers must re-send a datagram this often to keep the stream
+constexpr uint32_t WIFI_UDP_SUBSCRIBE_TIMEOUT_MS = 10000;
+
+// ==================== Time Synchronization ====================
+// The exchange with the shortest round trip in each bucket is kept for
+// the offset and drift fit; 16 buckets of 8 s span about two minutes
+constexpr size_t TIME_SYNC_WINDOW = 16;
+constexpr uint32_t TIME_SYNC_BUCKET_US = 8000000;
+
+// Exchanges with a longer round trip say too little about the offset
+// (BLE: two connection events; the sleepy link profile stays under this)
+constexpr uint32_t TIME_SYNC_MAX_DELAY_US = 250000;
+
+// Step the clock instead of slewing when an exchange disagrees with the
+// current estimate by more than half its round trip plus this (a new
+// host or reference clock)
+constexpr uint32_t TIME_SYNC_STEP_US = 10000;
+
+// Fit drift only once the window spans this long; clamp it to a crystal
+// tolerance so one bad window cannot run the clock away
+constexpr uint32_t TIME_SYNC_MIN_DRIFT_SPAN_US = 30000000;
+constexpr int32_t TIME_SYNC_MAX_DRIFT_PPB = 200000;  // 200 ppm
+
+// Report the estimate as held (free-running on the last drift) after
+// this long without an exchange
+constexpr uint32_t TIME_SYNC_STALE_MS = 30000;
+
+// ==================== Log Transfer ====================
+// Blocks sent ahead of the host's acknowledgement (default, and the most
+// a host may ask for); 4 blocks keep a BLE link busy across a round trip
+constexpr uint8_t LOG_TRANSFER_DEFAULT_WINDOW = 4;
+constexpr uint8_t LOG_TRANSFER_MAX_WINDOW = 8;
+
+// Give up on a transfer when the host has not acknowledged for this long
+// (it resumes with a new READ)
+constexpr uint32_t LOG_TRANSFER_TIMEOUT_MS = 5000;
+
+// Largest message: a data chunk in one notification at BLE_PREFERRED_MTU
+constexpr size_t LOG_TRANSFER_MAX_MESSAGE = BLE_PREFERRED_MTU - BLE_ATT_NOTIFY_OVERHEAD;
+
+// Serial messages are kept small enough that a whole frame fits the
+// 256-byte USB-CDC transmit buffer
+constexpr size_t LOG_TRANSFER_SERIAL_MESSAGE = 200;
 
 #endif // CONFIG_H
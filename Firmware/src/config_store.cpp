@@ -0,0 +1,175 @@
+/**
+ * @file config_store.cpp
+ * @brief Versioned configuration storage implementation
+ */
+
+#include "config_store.h"
+#include <Preferences.h>
+
+// Stored layouts; bump when RuntimeConfig or AccelCalibration changes
+constexpr uint8_t CONFIG_NVS_VERSION = 3;
+constexpr uint8_t CALIBRATION_NVS_VERSION = 1;
+
+struct StoredConfig {
+    uint8_t version;
+    RuntimeConfig config;
+};
+
+struct StoredCalibration {
+    uint8_t version;
+    AccelCalibration calibration;
+};
+
+/**
+ * @brief Read one versioned record
+ *
+ * @return true if the key holds a record of this size and version
+ */
+template <typename Record>
+static bool readRecord(const char* key, uint8_t version, Record& out) {
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, true)) {
+        return false;
+    }
+
+    Record stored;
+    bool valid = prefs.getBytesLength(key) == sizeof(stored)
+              && prefs.getBytes(key, &stored, sizeof(stored)) == sizeof(stored)
+              && stored.version == version;
+    prefs.end();
+
+    if (valid) {
+        out = stored;
+    }
+    return valid;
+}
+
+/**
+ * @brief Write one record
+ */
+template <typename Record>
+static bool writeRecord(const char* key, const Record& record) {
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putBytes(key, &record, sizeof(record)) == sizeof(record);
+    prefs.end();
+    return ok;
+}
+
+bool RuntimeConfig::operator==(const RuntimeConfig& other) const {
+    return settings.bleEnabled == other.settings.bleEnabled
+        && settings.serialEnabled == other.settings.serialEnabled
+        && settings.serialFormat == other.settings.serialFormat
+        && settings.fastBoot == other.settings.fastBoot
+        && settings.powerProfile == other.settings.powerProfile
+        && settings.wifiMode == other.settings.wifiMode
+        && sampleRateHz == other.sampleRateHz
+        && notifyRateHz == other.notifyRateHz
+        && bleStreamFormat == other.bleStreamFormat
+        && shockWake == other.shockWake
+        && impactThresholdG == other.impactThresholdG
+        && filter == other.filter;
+}
+
+RuntimeConfig defaultRuntimeConfig() {
+    RuntimeConfig config;
+    config.settings = Settings();
+    config.sampleRateHz = ADXL_DEFAULT_SAMPLE_RATE_HZ;
+    config.notifyRateHz = BLE_DEFAULT_NOTIFY_RATE_HZ;
+    config.bleStreamFormat = 0;
+    config.shockWake = false;
+    config.impactThresholdG = IMPACT_DEFAULT_THRESHOLD_G;
+    config.filter = {};
+    filterPreset(FILTER_DEFAULT_PRESET, config.filter);
+    return config;
+}
+
+bool loadCalibration(AccelCalibration& out) {
+    StoredCalibration stored;
+    if (!readRecord(CALIBRATION_NVS_KEY, CALIBRATION_NVS_VERSION, stored)) {
+        return false;
+    }
+    out = stored.calibration;
+    return true;
+}
+
+bool saveCalibration(const AccelCalibration& calibration) {
+    StoredCalibration stored = {};
+    stored.version = CALIBRATION_NVS_VERSION;
+    stored.calibration = calibration;
+    return writeRecord(CALIBRATION_NVS_KEY, stored);
+}
+
+bool clearCalibration() {
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = !prefs.isKey(CALIBRATION_NVS_KEY) || prefs.remove(CALIBRATION_NVS_KEY);
+    prefs.end();
+    return ok;
+}
+
+// ==================== Config Store ====================
+
+ConfigStore::ConfigStore()
+    : saved_(defaultRuntimeConfig())
+    , changed_(saved_)
+    , changedMs_(0)
+    , baselineValid_(false)
+    , pending_(false)
+    , loaded_(false) {
+}
+
+bool ConfigStore::load(RuntimeConfig& out) {
+    StoredConfig stored;
+    loaded_ = readRecord(CONFIG_NVS_KEY, CONFIG_NVS_VERSION, stored)
+           && stored.config.settings.serialFormat <= SerialFormat::STATS
+           && stored.config.settings.powerProfile <= PowerProfile::LOW_POWER
+           && stored.config.settings.wifiMode <= WifiMode::TCP;
+    out = loaded_ ? stored.config : defaultRuntimeConfig();
+    return loaded_;
+}
+
+bool ConfigStore::update(const RuntimeConfig& current, uint32_t nowMs) {
+    if (!baselineValid_) {
+        saved_ = current;
+        baselineValid_ = true;
+        return false;
+    }
+
+    if (current == saved_) {
+        pending_ = false;
+        return false;
+    }
+
+    // Restart the delay on every change so a burst is written once
+    if (!pending_ || current != changed_) {
+        changed_ = current;
+        changedMs_ = nowMs;
+        pending_ = true;
+        return false;
+    }
+
+    if (nowMs - changedMs_ < CONFIG_SAVE_DELAY_MS) {
+        return false;
+    }
+
+    // Reason: on a failed write keep the old baseline but wait another
+    // delay, so a broken partition is not rewritten every loop
+    pending_ = false;
+    if (!save(current)) {
+        return false;
+    }
+    saved_ = current;
+    return true;
+}
+
+bool ConfigStore::save(const RuntimeConfig& config) {
+    StoredConfig stored = {};
+    stored.version = CONFIG_NVS_VERSION;
+    stored.config = config;
+    return writeRecord(CONFIG_NVS_KEY, stored);
+}
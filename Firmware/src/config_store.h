@@ -0,0 +1,117 @@
+/**
+ * @file config_store.h
+ * @brief Versioned configuration storage in NVS
+ *
+ * Two records live in the CONFIG_NVS_NAMESPACE namespace: the runtime
+ * configuration (settings, rates, filter and trigger) and the per-unit
+ * calibration. Each is stored with a layout version and ignored when
+ * the version or size does not match, so a firmware update that changes
+ * a layout falls back to defaults instead of misreading old bytes.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "settings.h"
+#include "filter_chain.h"
+#include "calibration.h"
+
+/**
+ * @brief Everything restored at boot apart from the calibration
+ */
+struct RuntimeConfig {
+    Settings settings;
+    uint32_t sampleRateHz;
+    uint8_t notifyRateHz;      // Legacy BLE stream rate
+    uint8_t bleStreamFormat;   // BleStreamFormat
+    bool shockWake;
+    float impactThresholdG;
+    FilterConfig filter;
+
+    bool operator==(const RuntimeConfig& other) const;
+    bool operator!=(const RuntimeConfig& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Configuration used when nothing valid is stored
+ */
+RuntimeConfig defaultRuntimeConfig();
+
+/**
+ * @brief Read the stored calibration from NVS
+ *
+ * @param out Destination (unchanged if nothing valid is stored)
+ * @return true if a calibration was stored
+ */
+bool loadCalibration(AccelCalibration& out);
+
+/**
+ * @brief Store a calibration in NVS
+ *
+ * Erases and writes flash, so call it from a task that may block for a
+ * few milliseconds (not the sampler).
+ *
+ * @return true if the calibration was written
+ */
+bool saveCalibration(const AccelCalibration& calibration);
+
+/**
+ * @brief Remove the stored calibration (the defaults apply from next boot)
+ */
+bool clearCalibration();
+
+/**
+ * @brief Runtime configuration record with deferred saving
+ *
+ * loop() passes the live configuration to update(); it is written only
+ * after it has differed from the stored copy, unchanged, for
+ * CONFIG_SAVE_DELAY_MS. Not thread-safe: use it from loop() only.
+ */
+class ConfigStore {
+public:
+    ConfigStore();
+
+    /**
+     * @brief Read the stored configuration
+     *
+     * @param out Destination (defaults if nothing valid is stored)
+     * @return true if a configuration was stored
+     */
+    bool load(RuntimeConfig& out);
+
+    /**
+     * @brief Save the configuration once it has settled
+     *
+     * The first call adopts the configuration as already stored, so the
+     * state applied at boot is not written back.
+     *
+     * @param current Live configuration
+     * @param nowMs Current time (millis())
+     * @return true if the configuration was written by this call
+     */
+    bool update(const RuntimeConfig& current, uint32_t nowMs);
+
+    /**
+     * @brief Check if a change is waiting to be written
+     */
+    bool isPending() const { return pending_; }
+
+    /**
+     * @brief Check if a configuration was found at boot
+     */
+    bool wasLoaded() const { return loaded_; }
+
+private:
+    RuntimeConfig saved_;     // What NVS holds (or the boot state)
+    RuntimeConfig changed_;   // Newest unsaved configuration
+    uint32_t changedMs_;      // When changed_ was last different
+    bool baselineValid_;
+    bool pending_;
+    bool loaded_;
+
+    bool save(const RuntimeConfig& config);
+};
+
+#endif // CONFIG_STORE_H
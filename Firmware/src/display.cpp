@@ -6,19 +6,82 @@
  */
 
 #include "display.h"
+#include "profiler.h"
 
 // Smooth font includes from LovyanGFX
 #include <lgfx/v1/LGFX_Sprite.hpp>
+#include <esp_heap_caps.h>
 
 // Default gauge max value
 constexpr float DEFAULT_GAUGE_MAX = 10.0f;
 
+// HUD gauge ring radii
+constexpr int16_t HUD_RADIUS_OUTER = 105;
+constexpr int16_t HUD_RADIUS_INNER = 85;
+
+// Main screen regions redrawn from sprites (x, y, width, height)
+// Reason: the magnitude box stays inside the accent ring (radius 60)
+constexpr int16_t MAGNITUDE_W = 104;
+constexpr int16_t MAGNITUDE_H = 40;
+constexpr int16_t MAGNITUDE_X = DISPLAY_CENTER_X - MAGNITUDE_W / 2;
+constexpr int16_t MAGNITUDE_Y = DISPLAY_CENTER_Y - 5 - MAGNITUDE_H / 2;
+
+constexpr int16_t PEAK_W = 110;
+constexpr int16_t PEAK_H = 28;
+constexpr int16_t PEAK_X = DISPLAY_CENTER_X - PEAK_W / 2;
+constexpr int16_t PEAK_Y = 8;
+
+constexpr int16_t XYZ_W = 170;
+constexpr int16_t XYZ_H = 22;
+constexpr int16_t XYZ_X = DISPLAY_CENTER_X - XYZ_W / 2;
+constexpr int16_t XYZ_Y = DISPLAY_HEIGHT - 38 - XYZ_H / 2;
+
+// Waveform plot area (sits inside the round panel)
+constexpr int16_t PLOT_W = WAVEFORM_COLUMNS;
+constexpr int16_t PLOT_H = 120;
+constexpr int16_t PLOT_X = DISPLAY_CENTER_X - PLOT_W / 2;
+constexpr int16_t PLOT_Y = DISPLAY_CENTER_Y - PLOT_H / 2;
+
+// Lowest spectrum bar scale
+constexpr float SPECTRUM_MIN_SCALE_G = 0.1f;
+static_assert(PLOT_W <= SPECTRUM_BINS, "Each spectrum column needs at least one bin");
+
+// Band buffer size: the largest region
+constexpr size_t BAND_PIXELS_MAG = MAGNITUDE_W * MAGNITUDE_H;
+constexpr size_t BAND_PIXELS_PEAK = PEAK_W * PEAK_H;
+constexpr size_t BAND_PIXELS_XYZ = XYZ_W * XYZ_H;
+constexpr size_t BAND_PIXELS =
+    BAND_PIXELS_MAG > BAND_PIXELS_PEAK
+        ? (BAND_PIXELS_MAG > BAND_PIXELS_XYZ ? BAND_PIXELS_MAG : BAND_PIXELS_XYZ)
+        : (BAND_PIXELS_PEAK > BAND_PIXELS_XYZ ? BAND_PIXELS_PEAK : BAND_PIXELS_XYZ);
+
 Display::Display()
     : tft_()
-    , gaugeSprite_(nullptr)
+    , band_(&tft_)
+    , bandBuffers_{nullptr, nullptr}
+    , nextBand_(0)
     , lastMagnitude_(0.0f)
     , lastPeak_(0.0f)
-    , gaugeMax_(DEFAULT_GAUGE_MAX) {
+    , gaugeMax_(DEFAULT_GAUGE_MAX)
+    , mainValid_(false)
+    , segmentColors_{}
+    , gaugeVertices_{}
+    , ringColor_(0)
+    , magnitudeColor_(0)
+    , magnitudeText_{}
+    , peakText_{}
+    , xyzText_{}
+    , waveValid_(false)
+    , waveDrawn_(0)
+    , waveScaleG_(DEFAULT_GAUGE_MAX)
+    , spectrumValid_(false)
+    , spectrumShown_(0)
+    , spectrumChannel_(0)
+    , spectrumScaleG_(SPECTRUM_MIN_SCALE_G)
+    , settingsValid_(false)
+    , shownSettings_()
+    , shownBleConnected_(false)
+    , shownWifiStatus_{} {
 }
 
 bool Display::begin() {
@@ -28,6 +91,9 @@ bool Display::begin() {
     // Fill with test color
     tft_.fillScreen(TFT_BLUE);
 
+    // Gauge geometry never changes, so no trig is needed per frame
+    buildGaugeGeometry();
+
     // Turn on backlight AFTER display init (as per factory sample)
     pinMode(PIN_TFT_BL, OUTPUT);
     digitalWrite(PIN_TFT_BL, HIGH);
@@ -37,10 +103,21 @@ bool Display::begin() {
     // Clear to black
     tft_.fillScreen(TFT_BLACK);
 
-    // Create sprite for smooth gauge updates
-    gaugeSprite_ = new LGFX_Sprite(&tft_);
-    gaugeSprite_->createSprite(DISPLAY_WIDTH, DISPLAY_HEIGHT);
-    gaugeSprite_->setColorDepth(16);
+    // Two band buffers for the text regions (about 16 KB instead of a
+    // 115 KB full-screen frame)
+    for (int i = 0; i < 2; i++) {
+        bandBuffers_[i] = static_cast<uint16_t*>(
+            heap_caps_malloc(BAND_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA));
+        if (bandBuffers_[i] == nullptr) {
+            if (DEBUG_ENABLED) {
+                Serial.println("ERROR: Display band buffer allocation failed");
+            }
+            return false;
+        }
+    }
+
+    // Hold the bus from here on; DMA pushes then return without waiting
+    tft_.startWrite();
 
     if (DEBUG_ENABLED) {
         Serial.println("Display initialized (LovyanGFX)");
@@ -59,31 +136,85 @@ void Display::clear(uint32_t color) {
 
 void Display::drawStaticUI() {
     // Modern minimal style - no decorative elements
-    // The gauge and text are drawn in update() via sprite
+    // The gauge and text are drawn in update()
     tft_.fillScreen(UI_BG_PRIMARY);
+    invalidate();
 }
 
-void Display::update(const AccelData& data, float magnitude, float peak) {
-    // Use sprite for flicker-free updates
-    gaugeSprite_->fillSprite(UI_BG_PRIMARY);
+void Display::invalidate() {
+    mainValid_ = false;
+    waveValid_ = false;
+    spectrumValid_ = false;
+    settingsValid_ = false;
+}
 
-    // Reset text size to 1 (smooth fonts handle their own sizing)
-    gaugeSprite_->setTextSize(1);
+/**
+ * @brief Round a magnitude up to the next gauge range
+ *
+ * Uses nice round numbers: 10, 20, 50, 100, 200
+ *
+ * @param g Magnitude in g
+ * @return float Range in g
+ */
+static float gaugeRangeFor(float g) {
+    if (g <= 10.0f) {
+        return 10.0f;
+    } else if (g <= 20.0f) {
+        return 20.0f;
+    } else if (g <= 50.0f) {
+        return 50.0f;
+    } else if (g <= 100.0f) {
+        return 100.0f;
+    }
+    return 200.0f;
+}
+
+/**
+ * @brief Spectrum bar scale: 1-2-5 steps from SPECTRUM_MIN_SCALE_G to 200 g
+ */
+static float spectrumRangeFor(float g) {
+    static const float STEPS[] = {1.0f, 2.0f, 5.0f};
+    for (float decade = SPECTRUM_MIN_SCALE_G; decade < 200.0f; decade *= 10.0f) {
+        for (float step : STEPS) {
+            if (g <= decade * step) {
+                return decade * step;
+            }
+        }
+    }
+    return 200.0f;
+}
+
+void Display::drawMainStatic() {
+    // Parts of the main screen that never change
+    tft_.setTextSize(1);
+    tft_.setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
+    tft_.setTextDatum(middle_center);
+    tft_.setFont(&fonts::FreeSans12pt7b);
+    tft_.drawString("G", DISPLAY_CENTER_X, DISPLAY_CENTER_Y + 35);
+
+    // Accent bar at bottom
+    tft_.fillRect(35, DISPLAY_HEIGHT - 22, 170, 2, UI_TEXT_MUTED);
+
+    // Force every region to redraw
+    for (int i = 0; i < GAUGE_SEGMENTS; i++) {
+        segmentColors_[i] = UI_BG_PRIMARY;
+    }
+    ringColor_ = UI_BG_PRIMARY;
+    magnitudeText_[0] = '\0';
+    peakText_[0] = '\0';
+    xyzText_[0] = '\0';
+}
+
+void Display::update(const AccelData& data, float magnitude, float peak) {
+    // Only regions whose content changed are redrawn
+    if (!mainValid_) {
+        drawMainStatic();
+        mainValid_ = true;
+    }
 
     // Adapt gauge max if magnitude exceeds current range
-    // Use nice round numbers: 10, 20, 50, 100, 200
     if (magnitude > gaugeMax_) {
-        if (magnitude <= 10.0f) {
-            gaugeMax_ = 10.0f;
-        } else if (magnitude <= 20.0f) {
-            gaugeMax_ = 20.0f;
-        } else if (magnitude <= 50.0f) {
-            gaugeMax_ = 50.0f;
-        } else if (magnitude <= 100.0f) {
-            gaugeMax_ = 100.0f;
-        } else {
-            gaugeMax_ = 200.0f;
-        }
+        gaugeMax_ = gaugeRangeFor(magnitude);
     }
 
     // Get color based on magnitude
@@ -101,12 +232,9 @@ void Display::update(const AccelData& data, float magnitude, float peak) {
     // Draw peak indicator with accent bar
     drawPeakHUD(peak);
 
-    // Draw XYZ values with bottom accent bar
+    // Draw XYZ values
     drawXYZHUD(data);
 
-    // Push sprite to display
-    gaugeSprite_->pushSprite(0, 0);
-
     lastMagnitude_ = magnitude;
     lastPeak_ = peak;
 }
@@ -135,26 +263,11 @@ void Display::showSplash() {
     tft_.fillScreen(UI_BG_PRIMARY);
 
     // Draw segmented accent arc (matching main gauge style)
-    constexpr int NUM_SEGMENTS = 20;
-    constexpr float SEGMENT_GAP = 3.0f;
-    constexpr float TOTAL_ARC = 270.0f;
-    constexpr float SEGMENT_ANGLE = (TOTAL_ARC - (NUM_SEGMENTS * SEGMENT_GAP)) / NUM_SEGMENTS;
-
-    float angle = 135.0f;
-    for (int i = 0; i < NUM_SEGMENTS; i++) {
-        float rad1 = angle * DEG_TO_RAD;
-        float rad2 = (angle + SEGMENT_ANGLE) * DEG_TO_RAD;
-
-        // Draw segment
-        for (float a = angle; a < angle + SEGMENT_ANGLE; a += 2.0f) {
-            float rad = a * DEG_TO_RAD;
-            int16_t x1 = DISPLAY_CENTER_X + cos(rad) * 90;
-            int16_t y1 = DISPLAY_CENTER_Y + sin(rad) * 90;
-            int16_t x2 = DISPLAY_CENTER_X + cos(rad) * 105;
-            int16_t y2 = DISPLAY_CENTER_Y + sin(rad) * 105;
-            tft_.drawLine(x1, y1, x2, y2, UI_ACCENT);
+    for (int i = 0; i < GAUGE_SEGMENTS; i++) {
+        for (int j = 0; j < GAUGE_SEGMENT_STEPS; j++) {
+            const GaugeVertex& v = gaugeVertices_[i][j];
+            tft_.drawLine(v.innerX, v.innerY, v.outerX, v.outerY, UI_ACCENT);
         }
-        angle += SEGMENT_ANGLE + SEGMENT_GAP;
     }
 
     // Draw text with smooth font
@@ -177,8 +290,20 @@ void Display::backlightOn(bool on) {
     digitalWrite(PIN_TFT_BL, on ? HIGH : LOW);
 }
 
+void Display::setPanelSleep(bool sleep) {
+    if (sleep) {
+        tft_.sleep();
+    } else {
+        tft_.wakeup();
+    }
+}
+
 void Display::resetGaugeMax() {
     gaugeMax_ = DEFAULT_GAUGE_MAX;
+    waveScaleG_ = DEFAULT_GAUGE_MAX;
+    waveValid_ = false;
+    spectrumScaleG_ = SPECTRUM_MIN_SCALE_G;
+    spectrumValid_ = false;
 }
 
 uint32_t Display::getGColor(float g) const {
@@ -198,24 +323,65 @@ void Display::drawGaugeHUD(float value, uint32_t color) {
     if (value < 0) value = 0;
     if (value > gaugeMax_) value = gaugeMax_;
 
-    constexpr int NUM_SEGMENTS = 20;
-    constexpr float SEGMENT_GAP = 3.0f;  // Degrees gap between segments
-    constexpr float TOTAL_ARC = GAUGE_END_ANGLE - GAUGE_START_ANGLE;  // 270 degrees
-    constexpr float SEGMENT_ANGLE = (TOTAL_ARC - (NUM_SEGMENTS * SEGMENT_GAP)) / NUM_SEGMENTS;
+    int filledSegments = (int)((value / gaugeMax_) * GAUGE_SEGMENTS);
 
-    int filledSegments = (int)((value / gaugeMax_) * NUM_SEGMENTS);
+    for (int i = 0; i < GAUGE_SEGMENTS; i++) {
+        // Segment is filled if below current value
+        uint16_t segColor = (i < filledSegments) ? color : UI_GAUGE_BG;
 
+        // Segments don't overlap, so one can be repainted in place
+        if (segColor != segmentColors_[i]) {
+            drawGaugeSegment(i, segColor);
+            segmentColors_[i] = segColor;
+        }
+    }
+}
+
+LGFX_Sprite& Display::beginBand(int16_t w, int16_t h) {
+    // The other buffer may still be in flight; this one finished before
+    // it started (LovyanGFX runs one DMA transfer at a time)
+    band_.setBuffer(bandBuffers_[nextBand_], w, h, 16);
+    return band_;
+}
+
+void Display::pushBand(int16_t x, int16_t y, int16_t w, int16_t h) {
+    // Includes any wait for the previous band's DMA to finish
+    GSENSOR_PROFILE_SCOPE(DISPLAY_PUSH);
+    // Sprite buffers are already in panel byte order
+    tft_.pushImageDMA(x, y, w, h, reinterpret_cast<const lgfx::swap565_t*>(bandBuffers_[nextBand_]));
+    nextBand_ ^= 1;
+}
+
+void Display::buildGaugeGeometry() {
+    // Each segment is stepped in GAUGE_ARC_STEP slices; the last may be shorter
     float angle = GAUGE_START_ANGLE;
-    for (int i = 0; i < NUM_SEGMENTS; i++) {
-        // Segment is filled if below current value
-        uint32_t segColor = (i < filledSegments) ? color : UI_GAUGE_BG;
+    for (int i = 0; i < GAUGE_SEGMENTS; i++) {
+        float endAngle = angle + GAUGE_SEGMENT_ANGLE;
+        for (int j = 0; j <= GAUGE_SEGMENT_STEPS; j++) {
+            float a = angle + j * GAUGE_ARC_STEP;
+            if (a > endAngle) a = endAngle;
 
-        fillArc(DISPLAY_CENTER_X, DISPLAY_CENTER_Y,
-                angle, angle + SEGMENT_ANGLE,
-                105, 85,  // Outer and inner radius
-                segColor);
+            float rad = a * DEG_TO_RAD;
+            float c = cos(rad);
+            float s = sin(rad);
+
+            GaugeVertex& v = gaugeVertices_[i][j];
+            v.outerX = DISPLAY_CENTER_X + c * HUD_RADIUS_OUTER;
+            v.outerY = DISPLAY_CENTER_Y + s * HUD_RADIUS_OUTER;
+            v.innerX = DISPLAY_CENTER_X + c * HUD_RADIUS_INNER;
+            v.innerY = DISPLAY_CENTER_Y + s * HUD_RADIUS_INNER;
+        }
+        angle += GAUGE_SEGMENT_ANGLE + GAUGE_SEGMENT_GAP;
+    }
+}
 
-        angle += SEGMENT_ANGLE + SEGMENT_GAP;
+void Display::drawGaugeSegment(int index, uint16_t color) {
+    const GaugeVertex* v = gaugeVertices_[index];
+    for (int j = 0; j < GAUGE_SEGMENT_STEPS; j++) {
+        const GaugeVertex& a = v[j];
+        const GaugeVertex& b = v[j + 1];
+        tft_.fillTriangle(a.outerX, a.outerY, b.outerX, b.outerY, a.innerX, a.innerY, color);
+        tft_.fillTriangle(b.outerX, b.outerY, a.innerX, a.innerY, b.innerX, b.innerY, color);
     }
 }
 
@@ -226,13 +392,13 @@ void Display::drawAccentRing(uint32_t color) {
         ((color >> 5) & 0x3F) * 4 / 24,   // G component dimmed
         (color & 0x1F) * 8 / 24           // B component dimmed
     );
-    gaugeSprite_->drawCircle(DISPLAY_CENTER_X, DISPLAY_CENTER_Y, 60, dimColor);
+    if (dimColor != ringColor_) {
+        tft_.drawCircle(DISPLAY_CENTER_X, DISPLAY_CENTER_Y, 60, dimColor);
+        ringColor_ = dimColor;
+    }
 }
 
 void Display::drawMagnitudeSmooth(float magnitude, uint32_t color) {
-    gaugeSprite_->setTextColor(color, UI_BG_PRIMARY);
-    gaugeSprite_->setTextDatum(middle_center);
-
     char buf[16];
     if (magnitude < 10.0f) {
         snprintf(buf, sizeof(buf), "%.2f", magnitude);
@@ -242,50 +408,64 @@ void Display::drawMagnitudeSmooth(float magnitude, uint32_t color) {
         snprintf(buf, sizeof(buf), "%.0f", magnitude);
     }
 
-    // Large value using smooth font
-    gaugeSprite_->setFont(&fonts::FreeSansBold24pt7b);
-    gaugeSprite_->drawString(buf, DISPLAY_CENTER_X, DISPLAY_CENTER_Y - 5);
-
-    // Unit label
-    gaugeSprite_->setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
-    gaugeSprite_->setFont(&fonts::FreeSans12pt7b);
-    gaugeSprite_->drawString("G", DISPLAY_CENTER_X, DISPLAY_CENTER_Y + 35);
+    if (color == magnitudeColor_ && strcmp(buf, magnitudeText_) == 0) {
+        return;
+    }
+    strcpy(magnitudeText_, buf);
+    magnitudeColor_ = color;
+
+    // Large value using smooth font (unit label is static)
+    LGFX_Sprite& band = beginBand(MAGNITUDE_W, MAGNITUDE_H);
+    band.fillSprite(UI_BG_PRIMARY);
+    band.setTextSize(1);
+    band.setTextColor(color, UI_BG_PRIMARY);
+    band.setTextDatum(middle_center);
+    band.setFont(&fonts::FreeSansBold24pt7b);
+    band.drawString(buf, MAGNITUDE_W / 2, MAGNITUDE_H / 2);
+    pushBand(MAGNITUDE_X, MAGNITUDE_Y, MAGNITUDE_W, MAGNITUDE_H);
 }
 
 void Display::drawPeakHUD(float peak) {
-    // Draw framed box for peak
-    int16_t boxW = 110;
-    int16_t boxH = 28;
-    int16_t boxX = DISPLAY_CENTER_X - boxW / 2;
-    int16_t boxY = 8;
+    char buf[24];
+    snprintf(buf, sizeof(buf), "PEAK %.1f", peak);
+    if (strcmp(buf, peakText_) == 0) {
+        return;
+    }
+    strcpy(peakText_, buf);
 
-    // Box background and border
-    gaugeSprite_->fillRoundRect(boxX, boxY, boxW, boxH, 4, UI_BG_SECONDARY);
-    gaugeSprite_->drawRoundRect(boxX, boxY, boxW, boxH, 4, UI_ACCENT);
+    // Framed box: background and border fill the whole sprite
+    LGFX_Sprite& band = beginBand(PEAK_W, PEAK_H);
+    band.fillSprite(UI_BG_PRIMARY);
+    band.fillRoundRect(0, 0, PEAK_W, PEAK_H, 4, UI_BG_SECONDARY);
+    band.drawRoundRect(0, 0, PEAK_W, PEAK_H, 4, UI_ACCENT);
 
     // Peak text with smooth font
-    gaugeSprite_->setTextColor(UI_ACCENT, UI_BG_SECONDARY);
-    gaugeSprite_->setTextDatum(middle_center);
-    gaugeSprite_->setFont(&fonts::FreeSans9pt7b);
-
-    char buf[24];
-    snprintf(buf, sizeof(buf), "PEAK %.1f", peak);
-    gaugeSprite_->drawString(buf, DISPLAY_CENTER_X, boxY + boxH / 2 + 2);
+    band.setTextSize(1);
+    band.setTextColor(UI_ACCENT, UI_BG_SECONDARY);
+    band.setTextDatum(middle_center);
+    band.setFont(&fonts::FreeSans9pt7b);
+    band.drawString(buf, PEAK_W / 2, PEAK_H / 2 + 2);
+    pushBand(PEAK_X, PEAK_Y, PEAK_W, PEAK_H);
 }
 
 void Display::drawXYZHUD(const AccelData& data) {
-    // Accent bar at bottom
-    gaugeSprite_->fillRect(35, DISPLAY_HEIGHT - 22, 170, 2, UI_TEXT_MUTED);
-
-    // XYZ values with smooth font
-    gaugeSprite_->setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
-    gaugeSprite_->setTextDatum(middle_center);
-    gaugeSprite_->setFont(&fonts::FreeSans9pt7b);
-
     char buf[40];
     snprintf(buf, sizeof(buf), "X%+.0f Y%+.0f Z%+.0f",
              data.x, data.y, data.z);
-    gaugeSprite_->drawString(buf, DISPLAY_CENTER_X, DISPLAY_HEIGHT - 38);
+    if (strcmp(buf, xyzText_) == 0) {
+        return;
+    }
+    strcpy(xyzText_, buf);
+
+    // XYZ values with smooth font (accent bar below is static)
+    LGFX_Sprite& band = beginBand(XYZ_W, XYZ_H);
+    band.fillSprite(UI_BG_PRIMARY);
+    band.setTextSize(1);
+    band.setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
+    band.setTextDatum(middle_center);
+    band.setFont(&fonts::FreeSans9pt7b);
+    band.drawString(buf, XYZ_W / 2, XYZ_H / 2);
+    pushBand(XYZ_X, XYZ_Y, XYZ_W, XYZ_H);
 }
 
 // Legacy functions kept for compatibility but unused
@@ -305,117 +485,277 @@ void Display::drawXYZ(const AccelData& data) {
     drawXYZHUD(data);
 }
 
-void Display::fillArc(int16_t x, int16_t y, float start_angle, float end_angle,
-                      int16_t r_outer, int16_t r_inner, uint32_t color) {
-    float step = 2.0f;
+void Display::prepareScreen() {
+    tft_.fillScreen(UI_BG_PRIMARY);
+    invalidate();
+}
 
-    for (float angle = start_angle; angle < end_angle; angle += step) {
-        float nextAngle = angle + step;
-        if (nextAngle > end_angle) nextAngle = end_angle;
+void Display::drawSettingsScreen(const Settings& settings, bool bleConnected, const char* wifiStatus) {
+    // Redraw only when something shown on the screen changed
+    if (settingsValid_
+        && settings.bleEnabled == shownSettings_.bleEnabled
+        && settings.serialEnabled == shownSettings_.serialEnabled
+        && settings.wifiMode == shownSettings_.wifiMode
+        && bleConnected == shownBleConnected_
+        && strcmp(wifiStatus, shownWifiStatus_) == 0) {
+        return;
+    }
 
-        float rad1 = angle * DEG_TO_RAD;
-        float rad2 = nextAngle * DEG_TO_RAD;
+    // Reset to default text size (important when mixing with smooth fonts)
+    tft_.setTextSize(1);
 
-        int16_t x1 = x + cos(rad1) * r_outer;
-        int16_t y1 = y + sin(rad1) * r_outer;
-        int16_t x2 = x + cos(rad2) * r_outer;
-        int16_t y2 = y + sin(rad2) * r_outer;
+    if (!settingsValid_) {
+        // Header with smooth font
+        tft_.setTextColor(UI_TEXT_PRIMARY, UI_BG_PRIMARY);
+        tft_.setTextDatum(middle_center);
+        tft_.setFont(&fonts::FreeSansBold12pt7b);
+        tft_.drawString("SETTINGS", DISPLAY_CENTER_X, 30);
+
+        // Back button
+        drawBackButton(70, 195, 100, 35);
+    }
+
+    // BLE toggle button
+    drawToggleButton(30, 52, 180, 34, "BLE", settings.bleEnabled);
+
+    // Serial toggle button
+    drawToggleButton(30, 92, 180, 34, "Serial", settings.serialEnabled);
 
-        int16_t x3 = x + cos(rad1) * r_inner;
-        int16_t y3 = y + sin(rad1) * r_inner;
-        int16_t x4 = x + cos(rad2) * r_inner;
-        int16_t y4 = y + sin(rad2) * r_inner;
+    // Wi-Fi button cycles off / UDP / TCP
+    drawToggleButton(30, 132, 180, 34, "Wi-Fi", settings.wifiMode != WifiMode::OFF,
+                     wifiModeName(settings.wifiMode));
 
-        gaugeSprite_->fillTriangle(x1, y1, x2, y2, x3, y3, color);
-        gaugeSprite_->fillTriangle(x2, y2, x3, y3, x4, y4, color);
+    // Status line with smooth font (cleared first: lengths differ)
+    tft_.fillRect(30, 168, 180, 22, UI_BG_PRIMARY);
+    tft_.setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
+    tft_.setTextDatum(middle_center);
+    tft_.setFont(&fonts::FreeSans9pt7b);
+
+    // Wi-Fi status while it is on: the address receivers need
+    if (settings.wifiMode != WifiMode::OFF) {
+        tft_.drawString(wifiStatus, DISPLAY_CENTER_X, 178);
+    } else if (settings.bleEnabled) {
+        if (bleConnected) {
+            tft_.setTextColor(COLOR_LOW_G, UI_BG_PRIMARY);
+            tft_.drawString("BLE: Connected", DISPLAY_CENTER_X, 178);
+        } else {
+            tft_.drawString("BLE: Advertising...", DISPLAY_CENTER_X, 178);
+        }
+    } else {
+        tft_.setTextColor(UI_TEXT_MUTED, UI_BG_PRIMARY);
+        tft_.drawString("BLE: Disabled", DISPLAY_CENTER_X, 178);
     }
+
+    shownSettings_ = settings;
+    shownBleConnected_ = bleConnected;
+    strncpy(shownWifiStatus_, wifiStatus, sizeof(shownWifiStatus_) - 1);
+    shownWifiStatus_[sizeof(shownWifiStatus_) - 1] = '\0';
+    settingsValid_ = true;
 }
 
-void Display::prepareScreen() {
-    tft_.fillScreen(UI_BG_PRIMARY);
+void Display::drawWaveform(const WaveformBuffer& wave) {
+    uint32_t count = wave.columnCount();
+    uint32_t oldest = count > PLOT_W ? count - PLOT_W : 0;
+
+    // A buffer reset also means starting over
+    bool full = !waveValid_ || count < waveDrawn_;
+    uint32_t from = full ? oldest : (waveDrawn_ > oldest ? waveDrawn_ : oldest);
+
+    // Grow the scale to fit; older columns already fit the current one
+    for (uint32_t i = from; i < count; i++) {
+        float g = wave.column(i).maxG();
+        if (g > waveScaleG_) {
+            waveScaleG_ = gaugeRangeFor(g);
+            full = true;
+        }
+    }
+
+    if (full) {
+        drawWaveformStatic();
+        from = oldest;
+    }
+
+    for (uint32_t i = from; i < count; i++) {
+        drawWaveformColumn(i, wave.column(i));
+    }
+
+    // Sweep cursor marks where the next column goes
+    if (count > 0) {
+        tft_.drawFastVLine(PLOT_X + count % PLOT_W, PLOT_Y, PLOT_H, UI_TEXT_MUTED);
+    }
+
+    waveDrawn_ = count;
+    waveValid_ = true;
 }
 
-void Display::drawSettingsScreen(const Settings& settings, bool bleConnected) {
-    // Use sprite for flicker-free updates
-    gaugeSprite_->fillSprite(UI_BG_PRIMARY);
+void Display::drawWaveformStatic() {
+    tft_.setTextSize(1);
+    tft_.setTextDatum(middle_center);
+    tft_.setFont(&fonts::FreeSans9pt7b);
 
-    // Reset to default text size (important when mixing with smooth fonts)
-    gaugeSprite_->setTextSize(1);
+    // Scale label
+    char buf[24];
+    snprintf(buf, sizeof(buf), "MAG 0-%.0f G", waveScaleG_);
+    tft_.fillRect(PLOT_X, PLOT_Y - 32, PLOT_W, 24, UI_BG_PRIMARY);
+    tft_.setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
+    tft_.drawString(buf, DISPLAY_CENTER_X, PLOT_Y - 20);
 
-    // Header with smooth font
-    gaugeSprite_->setTextColor(UI_TEXT_PRIMARY, UI_BG_PRIMARY);
-    gaugeSprite_->setTextDatum(middle_center);
-    gaugeSprite_->setFont(&fonts::FreeSansBold12pt7b);
-    gaugeSprite_->drawString("SETTINGS", DISPLAY_CENTER_X, 30);
+    // Empty plot with baseline
+    tft_.fillRect(PLOT_X, PLOT_Y, PLOT_W, PLOT_H, UI_BG_PRIMARY);
+    tft_.drawFastHLine(PLOT_X, PLOT_Y + PLOT_H, PLOT_W, UI_TEXT_MUTED);
 
-    // BLE toggle button
-    drawToggleButton(30, 60, 180, 40, "BLE", settings.bleEnabled);
+    // Time span label
+    snprintf(buf, sizeof(buf), "%lu s", (unsigned long)(PLOT_W * WAVEFORM_COLUMN_MS / 1000));
+    tft_.setTextColor(UI_TEXT_MUTED, UI_BG_PRIMARY);
+    tft_.drawString(buf, DISPLAY_CENTER_X, PLOT_Y + PLOT_H + 20);
+}
 
-    // Serial toggle button
-    drawToggleButton(30, 110, 180, 40, "Serial", settings.serialEnabled);
+void Display::drawWaveformColumn(uint32_t index, const WaveformColumn& column) {
+    // Pixels per count, bottom row = 0 g
+    float pixelsPerCount = (PLOT_H - 1) * ADXL375_SCALE_FACTOR / waveScaleG_;
+    int32_t maxPx = static_cast<int32_t>(column.maxCounts * pixelsPerCount);
+    int32_t minPx = static_cast<int32_t>(column.minCounts * pixelsPerCount);
+    if (maxPx > PLOT_H - 1) maxPx = PLOT_H - 1;
+    if (minPx > maxPx) minPx = maxPx;
+
+    int16_t x = PLOT_X + index % PLOT_W;
+    int16_t bottom = PLOT_Y + PLOT_H - 1;
+
+    // Clear the column (also erases the old cursor), dotted half-scale
+    // grid line, then the min-max envelope
+    tft_.drawFastVLine(x, PLOT_Y, PLOT_H, UI_BG_PRIMARY);
+    if ((x & 3) == 0) {
+        tft_.drawPixel(x, PLOT_Y + PLOT_H / 2, UI_GAUGE_BG);
+    }
+    tft_.drawFastVLine(x, bottom - maxPx, maxPx - minPx + 1, getGColor(column.maxG()));
+}
 
-    // Status line with smooth font
-    gaugeSprite_->setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
-    gaugeSprite_->setTextDatum(middle_center);
-    gaugeSprite_->setFont(&fonts::FreeSans9pt7b);
+void Display::drawSpectrum(const SpectrumResult& result) {
+    if (spectrumValid_ && result.sequence == spectrumShown_) {
+        return;
+    }
 
-    if (settings.bleEnabled) {
-        if (bleConnected) {
-            gaugeSprite_->setTextColor(COLOR_LOW_G, UI_BG_PRIMARY);
-            gaugeSprite_->drawString("BLE: Connected", DISPLAY_CENTER_X, 165);
-        } else {
-            gaugeSprite_->drawString("BLE: Advertising...", DISPLAY_CENTER_X, 165);
+    // Bins of each plot column (more bins than columns: keep the largest)
+    uint16_t columns[PLOT_W];
+    uint16_t loudest = 0;
+    for (int16_t x = 0; x < PLOT_W; x++) {
+        size_t first = (static_cast<size_t>(x) * SPECTRUM_BINS) / PLOT_W;
+        size_t last = (static_cast<size_t>(x + 1) * SPECTRUM_BINS) / PLOT_W;
+        uint16_t amplitude = 0;
+        for (size_t k = first; k < last; k++) {
+            if (result.bins[k] > amplitude) {
+                amplitude = result.bins[k];
+            }
+        }
+        columns[x] = amplitude;
+        if (amplitude > loudest) {
+            loudest = amplitude;
         }
+    }
+
+    bool full = !spectrumValid_ || static_cast<uint8_t>(result.channel) != spectrumChannel_;
+    float loudestG = fixedToG(loudest);
+    if (loudestG > spectrumScaleG_) {
+        spectrumScaleG_ = spectrumRangeFor(loudestG);
+        full = true;
+    }
+
+    spectrumChannel_ = static_cast<uint8_t>(result.channel);
+    if (full) {
+        drawSpectrumStatic();
+    }
+
+    // Pixels per g, bottom row = 0 g
+    float pixelsPerG = (PLOT_H - 1) / spectrumScaleG_;
+    int16_t bottom = PLOT_Y + PLOT_H - 1;
+    for (int16_t x = 0; x < PLOT_W; x++) {
+        int32_t barPx = static_cast<int32_t>(fixedToG(columns[x]) * pixelsPerG);
+        if (barPx > PLOT_H - 1) barPx = PLOT_H - 1;
+
+        tft_.drawFastVLine(PLOT_X + x, PLOT_Y, PLOT_H - 1 - barPx, UI_BG_PRIMARY);
+        tft_.drawFastVLine(PLOT_X + x, bottom - barPx, barPx + 1, UI_ACCENT);
+    }
+
+    // Frequency span and strongest peak (cleared first: lengths differ)
+    char buf[32];
+    if (result.peakCount > 0) {
+        snprintf(buf, sizeof(buf), "0-%u Hz  pk %.1f Hz", result.rateHz / 2,
+                 result.peaks[0].frequencyDeciHz / 10.0f);
     } else {
-        gaugeSprite_->setTextColor(UI_TEXT_MUTED, UI_BG_PRIMARY);
-        gaugeSprite_->drawString("BLE: Disabled", DISPLAY_CENTER_X, 165);
+        snprintf(buf, sizeof(buf), "0-%u Hz", result.rateHz / 2);
     }
+    tft_.setTextSize(1);
+    tft_.setTextDatum(middle_center);
+    tft_.setFont(&fonts::FreeSans9pt7b);
+    tft_.fillRect(PLOT_X, PLOT_Y + PLOT_H + 8, PLOT_W, 24, UI_BG_PRIMARY);
+    tft_.setTextColor(UI_TEXT_MUTED, UI_BG_PRIMARY);
+    tft_.drawString(buf, DISPLAY_CENTER_X, PLOT_Y + PLOT_H + 20);
+
+    spectrumShown_ = result.sequence;
+    spectrumValid_ = true;
+}
 
-    // Back button
-    drawBackButton(70, 195, 100, 35);
+void Display::drawSpectrumStatic() {
+    static const char* const CHANNEL_LABELS[] = {"X", "Y", "Z", "MAG"};
 
-    // Push sprite to display
-    gaugeSprite_->pushSprite(0, 0);
+    tft_.setTextSize(1);
+    tft_.setTextDatum(middle_center);
+    tft_.setFont(&fonts::FreeSans9pt7b);
+
+    // Channel and scale label
+    char buf[24];
+    snprintf(buf, sizeof(buf), spectrumScaleG_ < 1.0f ? "%s FFT 0-%.1f G" : "%s FFT 0-%.0f G",
+             CHANNEL_LABELS[spectrumChannel_ & 3], spectrumScaleG_);
+    tft_.fillRect(PLOT_X, PLOT_Y - 32, PLOT_W, 24, UI_BG_PRIMARY);
+    tft_.setTextColor(UI_TEXT_SECONDARY, UI_BG_PRIMARY);
+    tft_.drawString(buf, DISPLAY_CENTER_X, PLOT_Y - 20);
+
+    // Empty plot with baseline
+    tft_.fillRect(PLOT_X, PLOT_Y, PLOT_W, PLOT_H, UI_BG_PRIMARY);
+    tft_.drawFastHLine(PLOT_X, PLOT_Y + PLOT_H, PLOT_W, UI_TEXT_MUTED);
 }
 
 void Display::drawToggleButton(int16_t x, int16_t y, int16_t w, int16_t h,
-                                const char* label, bool active) {
+                                const char* label, bool active, const char* state) {
     // Button background
     uint16_t bgColor = active ? UI_BG_SECONDARY : UI_BG_PRIMARY;
     uint16_t borderColor = active ? UI_ACCENT : UI_TEXT_MUTED;
 
-    gaugeSprite_->fillRoundRect(x, y, w, h, 8, bgColor);
-    gaugeSprite_->drawRoundRect(x, y, w, h, 8, borderColor);
+    tft_.fillRoundRect(x, y, w, h, 8, bgColor);
+    tft_.drawRoundRect(x, y, w, h, 8, borderColor);
 
     // Toggle indicator (left side)
     int16_t indicatorX = x + 15;
     int16_t indicatorY = y + h / 2;
     if (active) {
-        gaugeSprite_->fillCircle(indicatorX, indicatorY, 8, UI_ACCENT);
+        tft_.fillCircle(indicatorX, indicatorY, 8, UI_ACCENT);
     } else {
-        gaugeSprite_->drawCircle(indicatorX, indicatorY, 8, UI_TEXT_MUTED);
+        tft_.drawCircle(indicatorX, indicatorY, 8, UI_TEXT_MUTED);
     }
 
     // Label text with smooth font
-    gaugeSprite_->setTextColor(active ? UI_TEXT_PRIMARY : UI_TEXT_SECONDARY, bgColor);
-    gaugeSprite_->setTextDatum(middle_left);
-    gaugeSprite_->setFont(&fonts::FreeSans12pt7b);
-    gaugeSprite_->drawString(label, x + 35, y + h / 2);
+    tft_.setTextColor(active ? UI_TEXT_PRIMARY : UI_TEXT_SECONDARY, bgColor);
+    tft_.setTextDatum(middle_left);
+    tft_.setFont(&fonts::FreeSans12pt7b);
+    tft_.drawString(label, x + 35, y + h / 2);
 
     // Status text on right
-    gaugeSprite_->setTextDatum(middle_right);
-    gaugeSprite_->setFont(&fonts::FreeSans9pt7b);
-    gaugeSprite_->drawString(active ? "ON" : "OFF", x + w - 15, y + h / 2);
+    tft_.setTextDatum(middle_right);
+    tft_.setFont(&fonts::FreeSans9pt7b);
+    if (state == nullptr) {
+        state = active ? "ON" : "OFF";
+    }
+    tft_.drawString(state, x + w - 15, y + h / 2);
 }
 
 void Display::drawBackButton(int16_t x, int16_t y, int16_t w, int16_t h) {
     // Button with accent border
-    gaugeSprite_->fillRoundRect(x, y, w, h, 6, UI_BG_SECONDARY);
-    gaugeSprite_->drawRoundRect(x, y, w, h, 6, UI_ACCENT);
+    tft_.fillRoundRect(x, y, w, h, 6, UI_BG_SECONDARY);
+    tft_.drawRoundRect(x, y, w, h, 6, UI_ACCENT);
 
     // Back text with smooth font
-    gaugeSprite_->setTextColor(UI_ACCENT, UI_BG_SECONDARY);
-    gaugeSprite_->setTextDatum(middle_center);
-    gaugeSprite_->setFont(&fonts::FreeSans12pt7b);
-    gaugeSprite_->drawString("BACK", x + w / 2, y + h / 2);
+    tft_.setTextColor(UI_ACCENT, UI_BG_SECONDARY);
+    tft_.setTextDatum(middle_center);
+    tft_.setFont(&fonts::FreeSans12pt7b);
+    tft_.drawString("BACK", x + w / 2, y + h / 2);
 }
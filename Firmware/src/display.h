@@ -14,6 +14,8 @@
 #include "config.h"
 #include "signal_processing.h"
 #include "settings.h"
+#include "waveform.h"
+#include "spectrum.h"
 
 /**
  * @brief LovyanGFX display class for ESP32-2424S012
@@ -73,6 +75,17 @@ public:
 
 /**
  * @brief Display manager for g-sensor UI
+ *
+ * The main screen is redrawn by region: gauge segments and the accent
+ * ring are drawn straight to the panel when their colour changes, and
+ * the magnitude, peak and XYZ text are rendered into small bands that
+ * are pushed only when their text changes.
+ *
+ * Bands alternate between two DMA buffers: one is rendered while the
+ * other is still being sent, and update() returns as soon as the last
+ * transfer is queued. The display keeps the SPI2 transaction open for
+ * its lifetime (the panel is the only device on the bus), so no draw
+ * call waits for the bus to be released.
  */
 class Display {
 public:
@@ -86,26 +99,62 @@ public:
     void setBacklight(uint8_t brightness);
     void backlightOn(bool on = true);
 
+    /**
+     * @brief Put the panel controller to sleep or wake it
+     *
+     * The panel keeps its contents, so drawing resumes where it stopped.
+     *
+     * Args:
+     *     sleep (bool): true to enter sleep mode.
+     */
+    void setPanelSleep(bool sleep);
+
     /**
      * @brief Draw the settings screen
      *
      * Args:
      *     settings (Settings&): Current settings state.
      *     bleConnected (bool): Whether a BLE client is connected.
+     *     wifiStatus (const char*): Status line shown while Wi-Fi is on.
      */
-    void drawSettingsScreen(const Settings& settings, bool bleConnected);
+    void drawSettingsScreen(const Settings& settings, bool bleConnected, const char* wifiStatus);
+
+    /**
+     * @brief Draw the waveform screen
+     *
+     * Only columns completed since the last call are drawn, at a sweep
+     * cursor that wraps across the plot. The plot is redrawn in full
+     * only after a screen switch or when the scale has to grow.
+     *
+     * Args:
+     *     wave (WaveformBuffer&): Decimated magnitude envelope.
+     */
+    void drawWaveform(const WaveformBuffer& wave);
+
+    /**
+     * @brief Draw the spectrum screen
+     *
+     * The bars are redrawn only when a new result arrives. The amplitude
+     * scale grows to fit and shrinks only on resetGaugeMax().
+     *
+     * Args:
+     *     result (SpectrumResult&): Newest spectrum.
+     */
+    void drawSpectrum(const SpectrumResult& result);
 
     /**
      * @brief Clear screen for new content
      *
-     * Use when switching between screens.
+     * Use when switching between screens. The next update() or
+     * drawSettingsScreen() redraws everything.
      */
     void prepareScreen();
 
     /**
      * @brief Reset gauge max to default (10g)
      *
-     * Call this when resetting peak to also reset gauge scale.
+     * Call this when resetting peak to also reset gauge, waveform and
+     * spectrum scale.
      */
     void resetGaugeMax();
 
@@ -115,12 +164,71 @@ public:
     float getGaugeMax() const { return gaugeMax_; }
 
 private:
+    // HUD gauge geometry (fixed, so vertices are computed once in begin())
+    static constexpr int GAUGE_SEGMENTS = 20;
+    static constexpr float GAUGE_SEGMENT_GAP = 3.0f;   // Degrees between segments
+    static constexpr float GAUGE_SEGMENT_ANGLE =
+        (GAUGE_END_ANGLE - GAUGE_START_ANGLE - GAUGE_SEGMENTS * GAUGE_SEGMENT_GAP) / GAUGE_SEGMENTS;
+    static constexpr float GAUGE_ARC_STEP = 2.0f;      // Degrees per triangle pair
+    static constexpr int GAUGE_SEGMENT_STEPS =
+        static_cast<int>(GAUGE_SEGMENT_ANGLE / GAUGE_ARC_STEP)
+        + (static_cast<int>(GAUGE_SEGMENT_ANGLE / GAUGE_ARC_STEP) * GAUGE_ARC_STEP < GAUGE_SEGMENT_ANGLE ? 1 : 0);
+
+    /**
+     * @brief Outer and inner edge point at one angle of a segment
+     */
+    struct GaugeVertex {
+        int16_t outerX;
+        int16_t outerY;
+        int16_t innerX;
+        int16_t innerY;
+    };
+
     LGFX tft_;
-    LGFX_Sprite* gaugeSprite_;
+    LGFX_Sprite band_;            // Canvas over the band buffer being rendered
+    uint16_t* bandBuffers_[2];    // DMA-capable, sized for the largest region
+    uint8_t nextBand_;
     float lastMagnitude_;
     float lastPeak_;
     float gaugeMax_;  // Dynamic gauge range (starts at 10g)
 
+    // What is currently on the panel (main screen)
+    bool mainValid_;
+    uint16_t segmentColors_[GAUGE_SEGMENTS];
+    GaugeVertex gaugeVertices_[GAUGE_SEGMENTS][GAUGE_SEGMENT_STEPS + 1];
+    uint16_t ringColor_;
+    uint16_t magnitudeColor_;
+    char magnitudeText_[16];
+    char peakText_[24];
+    char xyzText_[40];
+
+    // What is currently on the panel (waveform screen)
+    bool waveValid_;
+    uint32_t waveDrawn_;  // Next column number to draw
+    float waveScaleG_;    // Plot full scale
+
+    // What is currently on the panel (spectrum screen)
+    bool spectrumValid_;
+    uint32_t spectrumShown_;   // Sequence of the result on the panel
+    uint8_t spectrumChannel_;  // Channel shown in the scale label
+    float spectrumScaleG_;     // Bar full scale
+
+    // What is currently on the panel (settings screen)
+    bool settingsValid_;
+    Settings shownSettings_;
+    bool shownBleConnected_;
+    char shownWifiStatus_[32];
+
+    void invalidate();
+    void drawMainStatic();
+    void buildGaugeGeometry();
+    void drawWaveformStatic();
+    void drawWaveformColumn(uint32_t index, const WaveformColumn& column);
+    void drawSpectrumStatic();
+    LGFX_Sprite& beginBand(int16_t w, int16_t h);
+    void pushBand(int16_t x, int16_t y, int16_t w, int16_t h);
+    void drawGaugeSegment(int index, uint16_t color);
+
     uint32_t getGColor(float g) const;
 
     // Racing HUD style drawing functions
@@ -136,10 +244,8 @@ private:
     void drawPeak(float peak);
     void drawXYZ(const AccelData& data);
 
-    void fillArc(int16_t x, int16_t y, float start_angle, float end_angle,
-                 int16_t r_outer, int16_t r_inner, uint32_t color);
     void drawToggleButton(int16_t x, int16_t y, int16_t w, int16_t h,
-                          const char* label, bool active);
+                          const char* label, bool active, const char* state = nullptr);
     void drawBackButton(int16_t x, int16_t y, int16_t w, int16_t h);
 };
 
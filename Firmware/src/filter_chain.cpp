@@ -0,0 +1,282 @@
+/**
+ * @file filter_chain.cpp
+ * @brief Filter pipeline implementation
+ */
+
+#include "filter_chain.h"
+#include <cmath>
+
+// Q format of fixed-point biquad coefficients
+// Reason: |a1| approaches 2, so Q28 is the most precision that fits int32_t
+constexpr int BIQUAD_COEFF_FRAC_BITS = 28;
+
+// Extra fraction bits of the fixed-point biquad history
+// Q4 samples (+/-2^17) shifted by 8 times Q28 coefficients stay well inside int64_t
+constexpr int BIQUAD_STATE_EXTRA_BITS = 8;
+
+// Extra fraction bits of the fixed-point DC mean
+// Q4 samples (+/-2^17) shifted by 12 still fit int32_t
+constexpr int DC_MEAN_EXTRA_BITS = 12;
+
+// Longest DC time constant: 2^20 samples (over 5 minutes at 3200 Hz)
+constexpr uint8_t DC_MAX_SHIFT = 20;
+
+struct FilterPreset {
+    const char* name;
+    FilterConfig config;
+};
+
+static const FilterPreset FILTER_PRESETS[FILTER_PRESET_COUNT] = {
+    {"raw",       {false, 0, 0, 0}},
+    {"smooth",    {false, 0, 0, 100}},  // Matches the old 10-sample average at 100 Hz
+    {"lowpass",   {false, 0, 50, 0}},
+    {"vibration", {true, 10, 0, 0}},    // Gravity removed, motion above 10 Hz
+};
+
+bool filterPreset(uint8_t index, FilterConfig& out) {
+    if (index >= FILTER_PRESET_COUNT) {
+        return false;
+    }
+    out = FILTER_PRESETS[index].config;
+    return true;
+}
+
+const char* filterPresetName(uint8_t index) {
+    return index < FILTER_PRESET_COUNT ? FILTER_PRESETS[index].name : "custom";
+}
+
+int findFilterPreset(const FilterConfig& config) {
+    for (uint8_t i = 0; i < FILTER_PRESET_COUNT; i++) {
+        if (FILTER_PRESETS[i].config == config) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ==================== Biquad ====================
+
+/**
+ * @brief RBJ cookbook Butterworth coefficients, normalised to a0 = 1
+ *
+ * Runs only on configure(), so double precision is affordable here.
+ * Order: b0, b1, b2, a1, a2.
+ */
+static void designButterworth(bool highPass, float cornerHz, uint32_t rateHz, double out[5]) {
+    double w0 = 2.0 * M_PI * cornerHz / rateHz;
+    double cosW0 = cos(w0);
+    double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+    double a0 = 1.0 + alpha;
+
+    double b1 = highPass ? -(1.0 + cosW0) : (1.0 - cosW0);
+    double b0 = highPass ? -b1 / 2.0 : b1 / 2.0;
+
+    out[0] = b0 / a0;
+    out[1] = b1 / a0;
+    out[2] = b0 / a0;
+    out[3] = -2.0 * cosW0 / a0;
+    out[4] = (1.0 - alpha) / a0;
+}
+
+template <typename T>
+Biquad<T>::Biquad()
+    : c_{}
+    , x1_(0)
+    , x2_(0)
+    , y1_(0)
+    , y2_(0)
+    , residue_(0) {
+}
+
+template <>
+void Biquad<float>::design(bool highPass, float cornerHz, uint32_t rateHz) {
+    double coeffs[5];
+    designButterworth(highPass, cornerHz, rateHz, coeffs);
+    c_ = {
+        static_cast<float>(coeffs[0]), static_cast<float>(coeffs[1]), static_cast<float>(coeffs[2]),
+        static_cast<float>(coeffs[3]), static_cast<float>(coeffs[4])
+    };
+    reset();
+}
+
+template <>
+void Biquad<int32_t>::design(bool highPass, float cornerHz, uint32_t rateHz) {
+    double coeffs[5];
+    designButterworth(highPass, cornerHz, rateHz, coeffs);
+
+    int32_t q[5];
+    for (int i = 0; i < 5; i++) {
+        q[i] = static_cast<int32_t>(lround(coeffs[i] * (1L << BIQUAD_COEFF_FRAC_BITS)));
+    }
+
+    // Reason: rounding b0..b2 separately leaves a small DC gain in the
+    // high-pass, which the near-unity poles amplify; derive b1 and b2
+    // from b0 so the zeros sit exactly at DC (or Nyquist for the low-pass)
+    q[1] = highPass ? -2 * q[0] : 2 * q[0];
+    q[2] = q[0];
+    c_ = {q[0], q[1], q[2], q[3], q[4]};
+    reset();
+}
+
+template <>
+float Biquad<float>::process(float x) {
+    float y = c_.b0 * x + c_.b1 * x1_ + c_.b2 * x2_ - c_.a1 * y1_ - c_.a2 * y2_;
+    x2_ = x1_;
+    x1_ = x;
+    y2_ = y1_;
+    y1_ = y;
+    return y;
+}
+
+template <>
+int32_t Biquad<int32_t>::process(int32_t x) {
+    int32_t xs = x << BIQUAD_STATE_EXTRA_BITS;
+    int64_t acc = static_cast<int64_t>(c_.b0) * xs
+                + static_cast<int64_t>(c_.b1) * x1_
+                + static_cast<int64_t>(c_.b2) * x2_
+                - static_cast<int64_t>(c_.a1) * y1_
+                - static_cast<int64_t>(c_.a2) * y2_
+                + residue_;
+
+    int32_t y = static_cast<int32_t>(acc >> BIQUAD_COEFF_FRAC_BITS);
+    residue_ = acc - (static_cast<int64_t>(y) << BIQUAD_COEFF_FRAC_BITS);
+
+    x2_ = x1_;
+    x1_ = xs;
+    y2_ = y1_;
+    y1_ = y;
+    return (y + (1 << (BIQUAD_STATE_EXTRA_BITS - 1))) >> BIQUAD_STATE_EXTRA_BITS;
+}
+
+template <typename T>
+void Biquad<T>::reset() {
+    x1_ = x2_ = y1_ = y2_ = 0;
+    residue_ = 0;
+}
+
+// ==================== DC Blocker ====================
+
+template <typename T>
+DcBlocker<T>::DcBlocker()
+    : mean_(0)
+    , shift_(1)
+    , primed_(false) {
+}
+
+template <typename T>
+void DcBlocker<T>::configure(uint32_t timeConstantMs, uint32_t rateHz) {
+    uint32_t samples = (rateHz * timeConstantMs) / 1000;
+
+    // floor(log2(samples)), at least one
+    shift_ = 1;
+    while (shift_ < DC_MAX_SHIFT && (samples >> (shift_ + 1)) != 0) {
+        shift_++;
+    }
+    reset();
+}
+
+template <>
+float DcBlocker<float>::process(float x) {
+    if (!primed_) {
+        mean_ = x;
+        primed_ = true;
+    }
+    mean_ += ldexpf(x - mean_, -shift_);
+    return x - mean_;
+}
+
+template <>
+int32_t DcBlocker<int32_t>::process(int32_t x) {
+    int32_t scaled = x << DC_MEAN_EXTRA_BITS;
+
+    // Start from the first sample so the output doesn't ramp down from 1 g
+    if (!primed_) {
+        mean_ = scaled;
+        primed_ = true;
+    }
+    mean_ += (scaled - mean_) >> shift_;
+    return x - ((mean_ + (1 << (DC_MEAN_EXTRA_BITS - 1))) >> DC_MEAN_EXTRA_BITS);
+}
+
+template <typename T>
+void DcBlocker<T>::reset() {
+    mean_ = 0;
+    primed_ = false;
+}
+
+// ==================== Filter Chain ====================
+
+template <typename T>
+FilterChain<T>::FilterChain()
+    : dc_()
+    , highPass_()
+    , lowPass_()
+    , average_()
+    , dcEnabled_(false)
+    , highPassEnabled_(false)
+    , lowPassEnabled_(false)
+    , averageEnabled_(false) {
+}
+
+template <typename T>
+void FilterChain<T>::configure(const FilterConfig& config, uint32_t rateHz) {
+    // Reason: the bilinear design warps badly near Nyquist, so a corner
+    // the current rate can't represent disables the stage instead
+    uint32_t cornerLimit = (rateHz * 9) / 20;
+
+    dcEnabled_ = config.dcBlock;
+    if (dcEnabled_) {
+        dc_.configure(FILTER_DC_TIME_CONSTANT_MS, rateHz);
+    }
+
+    highPassEnabled_ = config.highPassHz > 0 && config.highPassHz < cornerLimit;
+    if (highPassEnabled_) {
+        highPass_.design(true, config.highPassHz, rateHz);
+    }
+
+    lowPassEnabled_ = config.lowPassHz > 0 && config.lowPassHz < cornerLimit;
+    if (lowPassEnabled_) {
+        lowPass_.design(false, config.lowPassHz, rateHz);
+    }
+
+    uint32_t averageSamples = (static_cast<uint32_t>(config.averageMs) * rateHz) / 1000;
+    averageEnabled_ = averageSamples > 1;
+    if (averageEnabled_) {
+        average_.setLength(averageSamples);
+    }
+
+    reset();
+}
+
+template <typename T>
+T FilterChain<T>::process(T x) {
+    if (dcEnabled_) {
+        x = dc_.process(x);
+    }
+    if (highPassEnabled_) {
+        x = highPass_.process(x);
+    }
+    if (lowPassEnabled_) {
+        x = lowPass_.process(x);
+    }
+    if (averageEnabled_) {
+        x = average_.process(x);
+    }
+    return x;
+}
+
+template <typename T>
+void FilterChain<T>::reset() {
+    dc_.reset();
+    highPass_.reset();
+    lowPass_.reset();
+    average_.reset();
+}
+
+// Float for host-side use, int32_t (Q4 counts) for the sampler
+template class Biquad<float>;
+template class Biquad<int32_t>;
+template class DcBlocker<float>;
+template class DcBlocker<int32_t>;
+template class FilterChain<float>;
+template class FilterChain<int32_t>;
@@ -0,0 +1,278 @@
+/**
+ * @file filter_chain.h
+ * @brief Runtime-configurable filter pipeline for one signal channel
+ *
+ * Stages run in a fixed order: DC removal, high-pass biquad, low-pass
+ * biquad, boxcar average. Each can be switched off. Corners are given
+ * in Hz and the average in ms, so the response stays the same when the
+ * sample rate changes; coefficients are recomputed only on configure().
+ *
+ * All state is fixed-size and there is no heap use. The int32_t (Q4
+ * counts) variant uses Q28 coefficients with 64-bit accumulators, so the
+ * sampler never touches float per sample.
+ */
+
+#ifndef FILTER_CHAIN_H
+#define FILTER_CHAIN_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "config.h"
+
+/**
+ * @brief Filter pipeline settings (shared by all channels)
+ */
+struct FilterConfig {
+    bool dcBlock;         // Subtract a slow running mean (FILTER_DC_TIME_CONSTANT_MS)
+    uint16_t highPassHz;  // 2nd-order Butterworth high-pass corner (0 = off)
+    uint16_t lowPassHz;   // 2nd-order Butterworth low-pass corner (0 = off)
+    uint16_t averageMs;   // Boxcar average window (0 = off)
+
+    bool operator==(const FilterConfig& other) const {
+        return dcBlock == other.dcBlock && highPassHz == other.highPassHz
+            && lowPassHz == other.lowPassHz && averageMs == other.averageMs;
+    }
+
+    /**
+     * @brief Check the settings are within the FILTER_MAX_* limits
+     */
+    bool isValid() const {
+        return highPassHz <= FILTER_MAX_HIGH_PASS_HZ && lowPassHz <= FILTER_MAX_LOW_PASS_HZ
+            && averageMs <= FILTER_MAX_AVERAGE_MS;
+    }
+};
+
+/**
+ * @brief Number of built-in filter presets
+ */
+constexpr uint8_t FILTER_PRESET_COUNT = 4;
+
+/**
+ * @brief Get a built-in preset
+ *
+ * 0 = raw, 1 = smooth (default), 2 = low-pass, 3 = vibration.
+ *
+ * @param index Preset number
+ * @param out Preset settings
+ * @return true if the preset exists
+ */
+bool filterPreset(uint8_t index, FilterConfig& out);
+
+/**
+ * @brief Get a preset's name
+ *
+ * @param index Preset number
+ * @return const char* Name, or "custom" for an unknown index
+ */
+const char* filterPresetName(uint8_t index);
+
+/**
+ * @brief Find the preset matching a configuration
+ *
+ * @param config Settings to look up
+ * @return int Preset number, or -1 for a custom configuration
+ */
+int findFilterPreset(const FilterConfig& config);
+
+/**
+ * @brief Biquad coefficients (normalised, a0 = 1)
+ *
+ * @tparam T Sample type: float, or int32_t with Q28 coefficients
+ */
+template <typename T>
+struct BiquadCoeffs;
+
+template <>
+struct BiquadCoeffs<float> {
+    float b0, b1, b2, a1, a2;
+};
+
+template <>
+struct BiquadCoeffs<int32_t> {
+    int32_t b0, b1, b2, a1, a2;  // Q28
+};
+
+/**
+ * @brief Second-order IIR section (direct form I)
+ *
+ * The fixed-point variant keeps extra fraction bits in its history and
+ * carries the rounding residue into the next output (error feedback), so
+ * low corners relative to the sample rate don't drown in quantisation
+ * noise.
+ *
+ * @tparam T float or int32_t
+ */
+template <typename T>
+class Biquad {
+public:
+    Biquad();
+
+    /**
+     * @brief Set Butterworth (Q = 0.707) low- or high-pass coefficients
+     *
+     * @param highPass true for high-pass, false for low-pass
+     * @param cornerHz Corner frequency in Hz
+     * @param rateHz Sample rate in Hz
+     */
+    void design(bool highPass, float cornerHz, uint32_t rateHz);
+
+    /**
+     * @brief Filter one sample
+     */
+    T process(T x);
+
+    /**
+     * @brief Clear the filter history
+     */
+    void reset();
+
+private:
+    BiquadCoeffs<T> c_;
+    T x1_, x2_, y1_, y2_;  // Fixed point keeps BIQUAD_STATE_EXTRA_BITS more fraction bits
+    int64_t residue_;  // Fixed point only: rounding error carried forward
+};
+
+/**
+ * @brief Running-mean DC remover
+ *
+ * Tracks the mean with a one-pole average whose time constant is a
+ * power of two in samples (a shift, no multiply), and subtracts it.
+ *
+ * @tparam T float or int32_t
+ */
+template <typename T>
+class DcBlocker {
+public:
+    DcBlocker();
+
+    /**
+     * @brief Set the time constant
+     *
+     * @param timeConstantMs Averaging time constant in ms
+     * @param rateHz Sample rate in Hz
+     */
+    void configure(uint32_t timeConstantMs, uint32_t rateHz);
+
+    /**
+     * @brief Filter one sample
+     */
+    T process(T x);
+
+    /**
+     * @brief Restart the mean from the next sample
+     */
+    void reset();
+
+private:
+    T mean_;  // Fixed point keeps DC_MEAN_EXTRA_BITS more fraction bits than the samples
+    uint8_t shift_;
+    bool primed_;
+};
+
+/**
+ * @brief Boxcar (moving) average with a runtime length
+ *
+ * Length is set in samples up to MaxN; the running sum keeps it O(1).
+ *
+ * @tparam T float or int32_t
+ * @tparam MaxN Largest supported window
+ */
+template <typename T, size_t MaxN>
+class BoxcarAverage {
+public:
+    BoxcarAverage() : buffer_{}, length_(1), index_(0), count_(0), sum_(0) {}
+
+    /**
+     * @brief Set the window length (clears the history)
+     *
+     * @param length Window in samples (clamped to 1..MaxN)
+     */
+    void setLength(size_t length) {
+        length_ = length < 1 ? 1 : (length > MaxN ? MaxN : length);
+        reset();
+    }
+
+    /**
+     * @brief Add a sample and return the current average
+     */
+    T process(T value) {
+        sum_ -= buffer_[index_];
+        buffer_[index_] = value;
+        sum_ += value;
+
+        if (++index_ == length_) {
+            index_ = 0;
+        }
+        if (count_ < length_) {
+            count_++;
+        }
+
+        return static_cast<T>(sum_ / static_cast<Sum>(count_));
+    }
+
+    /**
+     * @brief Clear the history
+     */
+    void reset() {
+        for (size_t i = 0; i < length_; i++) {
+            buffer_[i] = T(0);
+        }
+        index_ = 0;
+        count_ = 0;
+        sum_ = 0;
+    }
+
+private:
+    // Reason: 320 Q4 samples of +/-200 g would overflow an int32_t sum
+    using Sum = typename std::conditional<std::is_integral<T>::value, int64_t, T>::type;
+
+    T buffer_[MaxN];
+    size_t length_;
+    size_t index_;
+    size_t count_;
+    Sum sum_;
+};
+
+/**
+ * @brief Complete filter pipeline for one channel
+ *
+ * @tparam T float or int32_t
+ */
+template <typename T>
+class FilterChain {
+public:
+    FilterChain();
+
+    /**
+     * @brief Apply settings for a sample rate (clears the history)
+     *
+     * Corners at or above 0.45 x the sample rate switch that stage off.
+     *
+     * @param config Filter settings
+     * @param rateHz Sample rate in Hz
+     */
+    void configure(const FilterConfig& config, uint32_t rateHz);
+
+    /**
+     * @brief Filter one sample
+     */
+    T process(T x);
+
+    /**
+     * @brief Clear the history of every stage
+     */
+    void reset();
+
+private:
+    DcBlocker<T> dc_;
+    Biquad<T> highPass_;
+    Biquad<T> lowPass_;
+    BoxcarAverage<T, FILTER_AVERAGE_MAX_SAMPLES> average_;
+
+    bool dcEnabled_;
+    bool highPassEnabled_;
+    bool lowPassEnabled_;
+    bool averageEnabled_;
+};
+
+#endif // FILTER_CHAIN_H
@@ -0,0 +1,299 @@
+/**
+ * @file flash_logger.cpp
+ * @brief Flash sample logger implementation
+ */
+
+#include "flash_logger.h"
+#include "stream_frame.h"
+
+FlashLogger::FlashLogger()
+    : partition_(nullptr)
+    , sectorCount_(0)
+    , taskHandle_(nullptr)
+    , buffers_{}
+    , pendingWrite_{}
+    , fillIndex_(0)
+    , writeIndex_(0)
+    , nextSequence_(1)
+    , nextSector_(0)
+    , logStart_(0)
+    , newestSequence_(0)
+    , active_(false)
+    , wrapWhenFull_(true)
+    , droppedSamples_(0)
+    , offsets_{0, 0, 0}
+    , firstBlockOfLog_(false)
+    , lastTimestampUs_(0)
+    , blockRateHz_(0) {
+}
+
+bool FlashLogger::begin() {
+    partition_ = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA,
+        static_cast<esp_partition_subtype_t>(LOG_PARTITION_SUBTYPE),
+        LOG_PARTITION_LABEL);
+
+    if (partition_ == nullptr) {
+        if (DEBUG_ENABLED) {
+            Serial.println("WARNING: Log partition not found (check partitions.csv)");
+        }
+        return false;
+    }
+
+    sectorCount_ = partition_->size / LOG_BLOCK_SIZE;
+    scan();
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        &FlashLogger::taskEntry, "logger", LOGGER_TASK_STACK_SIZE,
+        this, LOGGER_TASK_PRIORITY, &taskHandle_, 0);
+
+    if (created != pdPASS) {
+        if (DEBUG_ENABLED) {
+            Serial.println("ERROR: Failed to create logger task");
+        }
+        partition_ = nullptr;
+        return false;
+    }
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("Log partition: %u blocks of %u samples, %u blocks in newest log\n",
+                      sectorCount_, static_cast<unsigned>(LOG_SAMPLES_PER_BLOCK), logBlocks());
+    }
+
+    return true;
+}
+
+void FlashLogger::scan() {
+    // Find the block with the highest sequence number
+    // Reason: only the 32-byte headers are read, so this takes a few ms
+    uint32_t newest = 0;
+    uint32_t newestSector = 0;
+    uint32_t newestLogStart = 0;
+
+    for (uint32_t sector = 0; sector < sectorCount_; sector++) {
+        LogBlockHeader header;
+        if (esp_partition_read(partition_, sector * LOG_BLOCK_SIZE, &header, sizeof(header)) != ESP_OK) {
+            continue;
+        }
+        if (header.magic != LOG_BLOCK_MAGIC || header.version != LOG_BLOCK_VERSION) {
+            continue;
+        }
+        if (header.sequence > newest) {
+            newest = header.sequence;
+            newestSector = sector;
+            newestLogStart = header.logStart;
+        }
+    }
+
+    if (newest == 0) {
+        nextSequence_.store(1);
+        nextSector_.store(0);
+        return;
+    }
+
+    newestSequence_.store(newest);
+    logStart_.store(newestLogStart);
+    nextSequence_.store(newest + 1);
+    nextSector_.store((newestSector + 1) % sectorCount_);
+}
+
+bool FlashLogger::start(LogFullMode mode) {
+    if (partition_ == nullptr || active_.load()) {
+        return false;
+    }
+
+    wrapWhenFull_.store(mode == LogFullMode::WRAP);
+    droppedSamples_.store(0);
+    firstBlockOfLog_ = true;
+    // Discard a partial block left behind when a STOP-mode log filled up
+    if (!pendingWrite_[fillIndex_].load(std::memory_order_acquire)) {
+        buffers_[fillIndex_].header.sampleCount = 0;
+    }
+    active_.store(true);
+    return true;
+}
+
+void FlashLogger::stop() {
+    if (!active_.load()) {
+        return;
+    }
+    closeBlock();
+    active_.store(false);
+}
+
+void FlashLogger::setCalibration(const RawAccel& offsets) {
+    offsets_ = offsets;
+}
+
+void FlashLogger::addSample(uint32_t timestampUs, const RawAccel& raw, uint32_t rateHz) {
+    if (!active_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Both buffers waiting for flash: drop rather than block the sampler
+    if (pendingWrite_[fillIndex_].load(std::memory_order_acquire)) {
+        droppedSamples_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogBlock* block = &buffers_[fillIndex_];
+
+    // Keep blocks evenly spaced: a rate change or missing sample starts a new one
+    if (block->header.sampleCount > 0) {
+        uint32_t periodUs = 1000000 / rateHz;
+        uint32_t gapUs = timestampUs - lastTimestampUs_;
+        if (rateHz != blockRateHz_ || gapUs > periodUs + periodUs / 2) {
+            closeBlock();
+            if (pendingWrite_[fillIndex_].load(std::memory_order_acquire)) {
+                droppedSamples_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            block = &buffers_[fillIndex_];
+        }
+    }
+
+    if (block->header.sampleCount == 0) {
+        openBlock(timestampUs, rateHz);
+    }
+
+    block->samples[block->header.sampleCount++] = raw;
+    lastTimestampUs_ = timestampUs;
+
+    if (block->header.sampleCount >= LOG_SAMPLES_PER_BLOCK) {
+        closeBlock();
+    }
+}
+
+void FlashLogger::openBlock(uint32_t timestampUs, uint32_t rateHz) {
+    LogBlockHeader& header = buffers_[fillIndex_].header;
+    header.magic = LOG_BLOCK_MAGIC;
+    header.version = LOG_BLOCK_VERSION;
+    header.sampleCount = 0;
+    header.sequence = 0;   // Assigned by the writer
+    header.logStart = 0;
+    header.startTimestampUs = timestampUs;
+    header.rateHz = static_cast<uint16_t>(rateHz);
+    header.offsetX = offsets_.x;
+    header.offsetY = offsets_.y;
+    header.offsetZ = offsets_.z;
+    header.flags = firstBlockOfLog_ ? LOG_FLAG_FIRST : 0;
+    header.crc = 0;
+
+    firstBlockOfLog_ = false;
+    blockRateHz_ = rateHz;
+}
+
+void FlashLogger::closeBlock() {
+    if (buffers_[fillIndex_].header.sampleCount == 0) {
+        return;
+    }
+
+    pendingWrite_[fillIndex_].store(true, std::memory_order_release);
+    xTaskNotifyGive(taskHandle_);
+
+    fillIndex_ ^= 1;
+}
+
+uint32_t FlashLogger::logBlocks() const {
+    uint32_t newest = newestSequence_.load();
+    uint32_t start = logStart_.load();
+    if (newest == 0 || newest < start) {
+        return 0;
+    }
+
+    uint32_t blocks = newest - start + 1;
+    return blocks > sectorCount_ ? sectorCount_ : blocks;
+}
+
+uint32_t FlashLogger::oldestSequence() const {
+    uint32_t blocks = logBlocks();
+    return blocks == 0 ? 0 : newestSequence_.load() - (blocks - 1);
+}
+
+bool FlashLogger::readBlock(uint32_t index, LogBlock& out) const {
+    uint32_t blocks = logBlocks();
+    if (index >= blocks) {
+        return false;
+    }
+    return readSequence(newestSequence_.load() - (blocks - 1) + index, out);
+}
+
+bool FlashLogger::readSequence(uint32_t sequence, LogBlock& out) const {
+    uint32_t newest = newestSequence_.load();
+    if (partition_ == nullptr || sequence == 0 || sequence > newest || newest - sequence >= sectorCount_) {
+        return false;
+    }
+
+    // Blocks are written round-robin, so sequence maps straight to a sector
+    uint32_t newestSector = (nextSector_.load() + sectorCount_ - 1) % sectorCount_;
+    uint32_t sector = (newestSector + sectorCount_ - (newest - sequence) % sectorCount_) % sectorCount_;
+
+    if (esp_partition_read(partition_, sector * LOG_BLOCK_SIZE, &out, sizeof(out)) != ESP_OK) {
+        return false;
+    }
+
+    // Also rejects a block overwritten since the sequence was chosen
+    return out.header.magic == LOG_BLOCK_MAGIC
+        && out.header.sequence == sequence
+        && out.header.sampleCount <= LOG_SAMPLES_PER_BLOCK
+        && out.header.crc == blockCrc(out);
+}
+
+void FlashLogger::taskEntry(void* param) {
+    static_cast<FlashLogger*>(param)->run();
+}
+
+void FlashLogger::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Buffers are closed alternately, so write them in the same order
+        while (pendingWrite_[writeIndex_].load(std::memory_order_acquire)) {
+            writeBlock(buffers_[writeIndex_]);
+            buffers_[writeIndex_].header.sampleCount = 0;
+            pendingWrite_[writeIndex_].store(false, std::memory_order_release);
+            writeIndex_ ^= 1;
+        }
+    }
+}
+
+void FlashLogger::writeBlock(LogBlock& block) {
+    uint32_t sequence = nextSequence_.load();
+    uint32_t start = (block.header.flags & LOG_FLAG_FIRST) ? sequence : logStart_.load();
+
+    // Stop mode: never overwrite a block of the current log
+    if (!wrapWhenFull_.load() && sequence - start >= sectorCount_) {
+        if (active_.exchange(false) && DEBUG_ENABLED) {
+            Serial.println("Log full, logging stopped");
+        }
+        return;
+    }
+
+    block.header.sequence = sequence;
+    block.header.logStart = start;
+    block.header.crc = blockCrc(block);
+
+    uint32_t sector = nextSector_.load();
+    uint32_t offset = sector * LOG_BLOCK_SIZE;
+
+    esp_err_t err = esp_partition_erase_range(partition_, offset, LOG_BLOCK_SIZE);
+    if (err == ESP_OK) {
+        err = esp_partition_write(partition_, offset, &block, sizeof(block));
+    }
+    if (err != ESP_OK && DEBUG_ENABLED) {
+        Serial.printf("ERROR: Log write failed at block %u (%d)\n", sector, err);
+    }
+
+    // Advance even on failure so a bad sector is skipped, not retried forever
+    logStart_.store(start);
+    newestSequence_.store(sequence);
+    nextSequence_.store(sequence + 1);
+    nextSector_.store((sector + 1) % sectorCount_);
+}
+
+uint16_t FlashLogger::blockCrc(const LogBlock& block) {
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(&block.header);
+    uint16_t crc = crc16Ccitt(header, offsetof(LogBlockHeader, crc));
+    return crc16Ccitt(reinterpret_cast<const uint8_t*>(block.samples),
+                      block.header.sampleCount * sizeof(RawAccel), crc);
+}
@@ -0,0 +1,224 @@
+/**
+ * @file flash_logger.h
+ * @brief Append-only raw sample log on a dedicated flash partition
+ *
+ * Samples are stored as 4 KB blocks, one per flash sector. Each block has
+ * a header (start timestamp, ODR, calibration, sequence number, CRC)
+ * followed by raw int16 X/Y/Z counts at the block's ODR.
+ *
+ * Blocks are written round-robin through the partition, so every sector
+ * is erased equally often (wear levelling). The newest block is found at
+ * boot by its sequence number, so nothing else has to be stored.
+ *
+ * The sampler task fills one of two RAM blocks while the writer task
+ * erases and programs the other, so flash latency never reaches the
+ * sampler's code path. Note that the ESP32-C3 suspends flash cache during
+ * an erase; the ADXL375 FIFO covers that stall up to about 800 Hz.
+ */
+
+#ifndef FLASH_LOGGER_H
+#define FLASH_LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_partition.h>
+#include "config.h"
+#include "signal_processing.h"
+
+constexpr uint32_t LOG_BLOCK_MAGIC = 0x474C5347;  // "GSLG" little-endian
+constexpr uint16_t LOG_BLOCK_VERSION = 1;
+
+// Block header flags
+constexpr uint16_t LOG_FLAG_FIRST = 0x0001;  // First block of a log
+
+/**
+ * @brief Header at the start of every log block (32 bytes, little-endian)
+ */
+struct LogBlockHeader {
+    uint32_t magic;             // LOG_BLOCK_MAGIC
+    uint16_t version;           // LOG_BLOCK_VERSION
+    uint16_t sampleCount;       // Samples in this block
+    uint32_t sequence;          // Block number, increments across logs (never 0)
+    uint32_t logStart;          // Sequence of the first block of this log
+    uint32_t startTimestampUs;  // Time of the first sample (us, see time_sync.h)
+    uint16_t rateHz;            // Sample rate (samples are evenly spaced)
+    int16_t offsetX;            // Calibration offsets in counts, subtract
+    int16_t offsetY;            //   from the raw samples to calibrate
+    int16_t offsetZ;
+    uint16_t flags;             // LOG_FLAG_* bits
+    uint16_t crc;               // CRC-16/CCITT-FALSE over the header (before crc) and samples
+};
+
+static_assert(sizeof(LogBlockHeader) == 32, "LogBlockHeader must be 32 bytes");
+
+constexpr size_t LOG_SAMPLES_PER_BLOCK = (LOG_BLOCK_SIZE - sizeof(LogBlockHeader)) / sizeof(RawAccel);
+
+/**
+ * @brief One log block as stored in flash
+ */
+struct LogBlock {
+    LogBlockHeader header;
+    RawAccel samples[LOG_SAMPLES_PER_BLOCK];  // Raw (uncalibrated) counts
+};
+
+static_assert(sizeof(LogBlock) <= LOG_BLOCK_SIZE, "LogBlock must fit in one sector");
+
+/**
+ * @brief What to do when every block holds part of the current log
+ */
+enum class LogFullMode : uint8_t {
+    WRAP,  // Overwrite the oldest blocks
+    STOP   // Stop logging
+};
+
+/**
+ * @brief Flash-backed sample logger
+ *
+ * start(), stop(), setCalibration() and addSample() belong to the sampler
+ * task. Status getters and readBlock() are safe from any task.
+ */
+class FlashLogger {
+public:
+    FlashLogger();
+
+    /**
+     * @brief Find the log partition, locate the newest block and start the writer task
+     *
+     * @return true if the partition exists
+     */
+    bool begin();
+
+    /**
+     * @brief Check if the log partition was found
+     */
+    bool isAvailable() const { return partition_ != nullptr; }
+
+    /**
+     * @brief Start a new log (sampler task only)
+     *
+     * @param mode Behaviour when the partition is full
+     * @return true if logging started
+     */
+    bool start(LogFullMode mode);
+
+    /**
+     * @brief Stop logging and flush the partial block (sampler task only)
+     */
+    void stop();
+
+    /**
+     * @brief Check if samples are being logged
+     */
+    bool isLogging() const { return active_.load(); }
+
+    /**
+     * @brief Set the offsets recorded in new block headers (sampler task only)
+     *
+     * @param offsets Offsets in counts (calibrated = raw - offsets)
+     */
+    void setCalibration(const RawAccel& offsets);
+
+    /**
+     * @brief Append one raw sample (sampler task only)
+     *
+     * A block is closed early when the rate changes or a sample is
+     * missing, so every block stays evenly spaced.
+     *
+     * @param timestampUs Sample time in microseconds
+     * @param raw Raw counts
+     * @param rateHz Current sample rate
+     */
+    void addSample(uint32_t timestampUs, const RawAccel& raw, uint32_t rateHz);
+
+    /**
+     * @brief Number of blocks in the partition
+     */
+    uint32_t capacityBlocks() const { return sectorCount_; }
+
+    /**
+     * @brief Number of blocks in the newest log (capped at capacity)
+     */
+    uint32_t logBlocks() const;
+
+    /**
+     * @brief Samples lost because both RAM buffers were waiting for flash
+     */
+    uint32_t droppedSamples() const { return droppedSamples_.load(); }
+
+    /**
+     * @brief Read a block of the newest log
+     *
+     * @param index Block index within the log (0 = oldest still stored)
+     * @param out Destination
+     * @return true if the block exists and its CRC matches
+     */
+    bool readBlock(uint32_t index, LogBlock& out) const;
+
+    /**
+     * @brief Sequence of the first block of the newest log (0 = none)
+     *
+     * Identifies the log: it only changes when a new log starts.
+     */
+    uint32_t logStartSequence() const { return logStart_.load(); }
+
+    /**
+     * @brief Sequence of the oldest block of the newest log still stored
+     *
+     * @return uint32_t Sequence (0 = no log)
+     */
+    uint32_t oldestSequence() const;
+
+    /**
+     * @brief Sequence of the newest block written (0 = none)
+     */
+    uint32_t newestSequence() const { return newestSequence_.load(); }
+
+    /**
+     * @brief Read a block by its sequence number
+     *
+     * Unlike an index, a sequence keeps naming the same block while the
+     * log grows or wraps, so transfers can resume against it.
+     *
+     * @param sequence Block sequence (oldestSequence() to newestSequence())
+     * @param out Destination
+     * @return true if the block is still stored and its CRC matches
+     */
+    bool readSequence(uint32_t sequence, LogBlock& out) const;
+
+private:
+    const esp_partition_t* partition_;
+    uint32_t sectorCount_;
+    TaskHandle_t taskHandle_;
+
+    // RAM blocks: the sampler fills one while the writer programs the other
+    LogBlock buffers_[2];
+    std::atomic<bool> pendingWrite_[2];
+    uint8_t fillIndex_;   // Sampler task only
+    uint8_t writeIndex_;  // Writer task only
+
+    // Log position (written by the writer task, read by anyone)
+    std::atomic<uint32_t> nextSequence_;
+    std::atomic<uint32_t> nextSector_;
+    std::atomic<uint32_t> logStart_;
+    std::atomic<uint32_t> newestSequence_;  // Last block written (0 = none)
+
+    std::atomic<bool> active_;
+    std::atomic<bool> wrapWhenFull_;
+    std::atomic<uint32_t> droppedSamples_;
+
+    // Block being filled (sampler task only)
+    RawAccel offsets_;
+    bool firstBlockOfLog_;
+    uint32_t lastTimestampUs_;
+    uint32_t blockRateHz_;
+
+    static void taskEntry(void* param);
+    void run();
+    void scan();
+    void openBlock(uint32_t timestampUs, uint32_t rateHz);
+    void closeBlock();
+    void writeBlock(LogBlock& block);
+    static uint16_t blockCrc(const LogBlock& block);
+};
+
+#endif // FLASH_LOGGER_H
@@ -0,0 +1,149 @@
+/**
+ * @file impact_capture.cpp
+ * @brief Impact capture implementation
+ */
+
+#include "impact_capture.h"
+
+/**
+ * @brief Convert g to Q4 counts
+ */
+static int32_t gToFixed(float g) {
+    return static_cast<int32_t>(g / ADXL375_SCALE_FACTOR * (1 << ACCEL_FIXED_FRAC_BITS) + 0.5f);
+}
+
+ImpactCapture::ImpactCapture()
+    : history_{}
+    , historyTimes_{}
+    , historyHead_(0)
+    , historyCount_(0)
+    , events_()
+    , thresholdQ4_(gToFixed(IMPACT_DEFAULT_THRESHOLD_G))
+    , state_(State::ARMED)
+    , current_(nullptr)
+    , peakSq_(0)
+    , peakUs_(0)
+    , aboveCount_(0) {
+}
+
+bool ImpactCapture::setThresholdG(float thresholdG) {
+    if (thresholdG < IMPACT_MIN_THRESHOLD_G || thresholdG > ADXL375_MAX_G) {
+        return false;
+    }
+    thresholdQ4_.store(gToFixed(thresholdG), std::memory_order_relaxed);
+    return true;
+}
+
+float ImpactCapture::getThresholdG() const {
+    return fixedToG(thresholdQ4_.load(std::memory_order_relaxed));
+}
+
+void ImpactCapture::addSample(uint32_t timestampUs, const RawAccel& counts, uint32_t rateHz) {
+    // Compare squared magnitudes in whole counts
+    // Reason: no square root per sample; one root per event for the peak
+    uint32_t magSq = static_cast<uint32_t>(static_cast<int32_t>(counts.x) * counts.x)
+                   + static_cast<uint32_t>(static_cast<int32_t>(counts.y) * counts.y)
+                   + static_cast<uint32_t>(static_cast<int32_t>(counts.z) * counts.z);
+    uint32_t thresholdQ4 = static_cast<uint32_t>(thresholdQ4_.load(std::memory_order_relaxed));
+    uint32_t thresholdSq = static_cast<uint32_t>(
+        (static_cast<uint64_t>(thresholdQ4) * thresholdQ4) >> (2 * ACCEL_FIXED_FRAC_BITS));
+    bool above = magSq >= thresholdSq;
+
+    if (state_ == State::HOLDOFF && !above) {
+        state_ = State::ARMED;
+    }
+
+    if (state_ == State::ARMED && above) {
+        trigger(timestampUs, rateHz);
+    }
+
+    if (state_ == State::CAPTURING) {
+        ImpactStats& stats = current_->stats;
+        current_->samples[stats.sampleCount++] = counts;
+
+        if (above) {
+            aboveCount_++;
+        }
+        if (magSq > peakSq_) {
+            peakSq_ = magSq;
+            peakUs_ = timestampUs;
+        }
+
+        if (stats.sampleCount >= IMPACT_EVENT_SAMPLES) {
+            finish();
+        }
+    }
+
+    // History keeps running during a capture so a follow-up event has it too
+    history_[historyHead_] = counts;
+    historyTimes_[historyHead_] = timestampUs;
+    if (++historyHead_ == IMPACT_PRE_TRIGGER_SAMPLES) {
+        historyHead_ = 0;
+    }
+    if (historyCount_ < IMPACT_PRE_TRIGGER_SAMPLES) {
+        historyCount_++;
+    }
+}
+
+void ImpactCapture::reset() {
+    historyHead_ = 0;
+    historyCount_ = 0;
+    state_ = State::ARMED;
+    current_ = nullptr;
+}
+
+uint32_t ImpactCapture::eventCount() const {
+    return events_.sequence();
+}
+
+bool ImpactCapture::latestStats(ImpactStats& out) const {
+    // Reason: copies the stats only, not the sample block
+    return events_.read(out, [](const ImpactEvent& event) -> const ImpactStats& {
+        return event.stats;
+    });
+}
+
+bool ImpactCapture::latestEvent(ImpactEvent& out) const {
+    return events_.read(out);
+}
+
+void ImpactCapture::trigger(uint32_t timestampUs, uint32_t rateHz) {
+    current_ = &events_.next();
+
+    ImpactStats& stats = current_->stats;
+    stats.sequence = events_.nextSequence();
+    stats.triggerUs = timestampUs;
+    stats.thresholdMagnitude = thresholdQ4_.load(std::memory_order_relaxed);
+    stats.rateHz = static_cast<uint16_t>(rateHz);
+    stats.preTriggerSamples = static_cast<uint16_t>(historyCount_);
+    stats.sampleCount = 0;
+
+    // Unroll the history oldest-first in front of the trigger sample
+    size_t index = (historyHead_ + IMPACT_PRE_TRIGGER_SAMPLES - historyCount_) % IMPACT_PRE_TRIGGER_SAMPLES;
+    stats.firstSampleUs = historyCount_ > 0 ? historyTimes_[index] : timestampUs;
+    for (size_t i = 0; i < historyCount_; i++) {
+        current_->samples[stats.sampleCount++] = history_[index];
+        if (++index == IMPACT_PRE_TRIGGER_SAMPLES) {
+            index = 0;
+        }
+    }
+
+    peakSq_ = 0;
+    peakUs_ = timestampUs;
+    aboveCount_ = 0;
+    state_ = State::CAPTURING;
+}
+
+void ImpactCapture::finish() {
+    ImpactStats& stats = current_->stats;
+    stats.peakMagnitude = static_cast<int32_t>(
+        isqrt64(static_cast<uint64_t>(peakSq_) << (2 * ACCEL_FIXED_FRAC_BITS)));
+    stats.peakOffsetUs = peakUs_ - stats.triggerUs;
+    stats.aboveThresholdUs = stats.rateHz > 0
+        ? static_cast<uint32_t>((static_cast<uint64_t>(aboveCount_) * 1000000) / stats.rateHz)
+        : 0;
+
+    events_.publish();
+    current_ = nullptr;
+    state_ = State::HOLDOFF;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file impact_capture.h
+ * @brief Pre/post-trigger impact capture
+ *
+ * Watches the unfiltered magnitude of every sample. When it crosses the
+ * threshold, the pre-trigger history and the following samples are
+ * recorded at the full ODR into a statically allocated event buffer,
+ * along with summary stats for the event.
+ */
+
+#ifndef IMPACT_CAPTURE_H
+#define IMPACT_CAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "sample_ring.h"
+#include "signal_processing.h"
+
+/**
+ * @brief Summary of one captured impact
+ */
+struct ImpactStats {
+    uint32_t sequence;          // Event number since boot (1-based)
+    uint32_t triggerUs;         // Time of the first sample above threshold
+    uint32_t firstSampleUs;     // Time of samples[0] (start of pre-trigger history)
+    uint32_t peakOffsetUs;      // Time of peak, relative to the trigger
+    uint32_t aboveThresholdUs;  // Total time above threshold after the trigger
+    int32_t peakMagnitude;      // Peak unfiltered magnitude (Q4 counts)
+    int32_t thresholdMagnitude; // Trigger threshold (Q4 counts)
+    uint16_t rateHz;            // Sample rate during the event
+    uint16_t preTriggerSamples; // Samples before the trigger sample
+    uint16_t sampleCount;       // Samples recorded in total
+
+    /**
+     * @brief Peak magnitude in g
+     */
+    float peakG() const { return fixedToG(peakMagnitude); }
+
+    /**
+     * @brief Trigger threshold in g
+     */
+    float thresholdG() const { return fixedToG(thresholdMagnitude); }
+};
+
+/**
+ * @brief One captured impact with its samples
+ */
+struct ImpactEvent {
+    ImpactStats stats;
+    RawAccel samples[IMPACT_EVENT_SAMPLES];  // Calibrated counts, evenly spaced at stats.rateHz
+};
+
+/**
+ * @brief Threshold-triggered capture engine
+ *
+ * addSample() and reset() belong to the sampler task. The other methods
+ * are safe from any task: completed events are published into one of two
+ * slots, so a reader copies the newest event while the next one records.
+ */
+class ImpactCapture {
+public:
+    ImpactCapture();
+
+    /**
+     * @brief Set the trigger threshold (thread-safe)
+     *
+     * @param thresholdG Threshold on unfiltered magnitude in g
+     * @return true if the threshold is within range
+     */
+    bool setThresholdG(float thresholdG);
+
+    /**
+     * @brief Get the trigger threshold
+     *
+     * @return float Threshold in g
+     */
+    float getThresholdG() const;
+
+    /**
+     * @brief Get the trigger threshold in fixed point
+     *
+     * @return int32_t Threshold (Q4 counts)
+     */
+    int32_t getThresholdFixed() const { return thresholdQ4_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Feed one sample (sampler task only)
+     *
+     * @param timestampUs Sample time in microseconds
+     * @param counts Calibrated counts
+     * @param rateHz Current sample rate
+     */
+    void addSample(uint32_t timestampUs, const RawAccel& counts, uint32_t rateHz);
+
+    /**
+     * @brief Drop the pre-trigger history and any capture in progress
+     *
+     * Call when the sample rate changes (sampler task only).
+     */
+    void reset();
+
+    /**
+     * @brief Check if post-trigger samples are being recorded (sampler task only)
+     */
+    bool isCapturing() const { return state_ == State::CAPTURING; }
+
+    /**
+     * @brief Number of events completed since boot
+     */
+    uint32_t eventCount() const;
+
+    /**
+     * @brief Copy the stats of the newest completed event
+     *
+     * @param out Destination
+     * @return true if an event has been captured
+     */
+    bool latestStats(ImpactStats& out) const;
+
+    /**
+     * @brief Copy the newest completed event including its samples
+     *
+     * @param out Destination (large: keep it off small task stacks)
+     * @return true if an event has been captured
+     */
+    bool latestEvent(ImpactEvent& out) const;
+
+private:
+    enum class State : uint8_t {
+        ARMED,      // Waiting for a sample above threshold
+        CAPTURING,  // Recording post-trigger samples
+        HOLDOFF     // Event done; waiting for magnitude to fall below threshold
+    };
+
+    // Pre-trigger history ring
+    RawAccel history_[IMPACT_PRE_TRIGGER_SAMPLES];
+    uint32_t historyTimes_[IMPACT_PRE_TRIGGER_SAMPLES];
+    size_t historyHead_;
+    size_t historyCount_;
+
+    // Completed events; the next one records into events_.next()
+    DoubleBuffered<ImpactEvent> events_;
+
+    std::atomic<int32_t> thresholdQ4_;  // Trigger threshold (Q4 counts)
+
+    // Capture in progress (sampler task only)
+    State state_;
+    ImpactEvent* current_;
+    uint32_t peakSq_;
+    uint32_t peakUs_;
+    uint32_t aboveCount_;
+
+    void trigger(uint32_t timestampUs, uint32_t rateHz);
+    void finish();
+};
+
+#endif // IMPACT_CAPTURE_H
@@ -0,0 +1,37 @@
+/**
+ * @file log.h
+ * @brief Compile-time filtered serial logging
+ *
+ * Messages above GSENSOR_LOG_LEVEL compile to nothing, so debug lines can
+ * stay in hot paths at no cost. Override the level with a build flag,
+ * e.g. -DGSENSOR_LOG_LEVEL=4 in platformio.ini for debug output.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+#define GSENSOR_LOG_NONE  0
+#define GSENSOR_LOG_ERROR 1
+#define GSENSOR_LOG_WARN  2
+#define GSENSOR_LOG_INFO  3
+#define GSENSOR_LOG_DEBUG 4
+
+#ifndef GSENSOR_LOG_LEVEL
+#define GSENSOR_LOG_LEVEL GSENSOR_LOG_INFO
+#endif
+
+#define GSENSOR_LOG(level, fmt, ...)                   \
+    do {                                               \
+        if ((level) <= GSENSOR_LOG_LEVEL) {            \
+            Serial.printf(fmt "\n", ##__VA_ARGS__);    \
+        }                                              \
+    } while (0)
+
+#define LOG_ERROR(fmt, ...) GSENSOR_LOG(GSENSOR_LOG_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  GSENSOR_LOG(GSENSOR_LOG_WARN, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  GSENSOR_LOG(GSENSOR_LOG_INFO, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) GSENSOR_LOG(GSENSOR_LOG_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif // LOG_H
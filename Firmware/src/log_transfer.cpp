@@ -0,0 +1,242 @@
+/**
+ * @file log_transfer.cpp
+ * @brief Log download implementation
+ */
+
+#include "log_transfer.h"
+
+const char* logTransportName(LogTransport transport) {
+    switch (transport) {
+        case LogTransport::NONE:        return "idle";
+        case LogTransport::BLE:         return "BLE";
+        case LogTransport::SERIAL_PORT: return "serial";
+    }
+    return "unknown";
+}
+
+static uint32_t readUint32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+         | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void packUint32(uint8_t* buffer, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static void packUint16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+}
+
+LogTransfer::LogTransfer(const FlashLogger& logger)
+    : logger_(logger)
+    , transport_(LogTransport::NONE)
+    , next_(0)
+    , end_(0)
+    , acked_(0)
+    , window_(LOG_TRANSFER_DEFAULT_WINDOW)
+    , lastAckMs_(0)
+    , block_{}
+    , blockSequence_(0)
+    , blockLength_(0)
+    , offset_(0)
+    , statusPending_(false)
+    , pendingStatus_(LogTransferStatus::OK)
+    , pendingSequence_(0)
+    , blocksSent_(0)
+    , transfers_(0) {
+}
+
+size_t LogTransfer::handleRequest(LogTransport transport, const uint8_t* request, size_t length, uint8_t* reply) {
+    if (length == 0) {
+        return packStatus(reply, LogTransferStatus::MALFORMED, 0);
+    }
+
+    switch (request[0]) {
+        case LOG_TRANSFER_OP_INFO: {
+            uint32_t first = logger_.oldestSequence();
+            reply[0] = LOG_TRANSFER_MSG_INFO;
+            reply[1] = static_cast<uint8_t>(first != 0 ? LogTransferStatus::OK : LogTransferStatus::NO_LOG);
+            reply[2] = logger_.isLogging() ? 1 : 0;
+            packUint32(&reply[3], first != 0 ? logger_.logStartSequence() : 0);
+            packUint32(&reply[7], first);
+            packUint32(&reply[11], first != 0 ? logger_.newestSequence() : 0);
+            packUint32(&reply[15], logger_.capacityBlocks());
+            packUint16(&reply[19], static_cast<uint16_t>(LOG_SAMPLES_PER_BLOCK));
+            packUint16(&reply[21], static_cast<uint16_t>(sizeof(LogBlock)));
+            return LOG_TRANSFER_INFO_SIZE;
+        }
+
+        case LOG_TRANSFER_OP_READ:
+            if (length < LOG_TRANSFER_READ_SIZE) {
+                return packStatus(reply, LogTransferStatus::MALFORMED, 0);
+            }
+            return startRead(transport, request, reply);
+
+        case LOG_TRANSFER_OP_ACK:
+            if (length < LOG_TRANSFER_ACK_SIZE) {
+                return packStatus(reply, LogTransferStatus::MALFORMED, 0);
+            }
+            // An ACK for a transfer that has ended (or runs elsewhere) is stale
+            if (transport == transport_) {
+                uint32_t next = readUint32(&request[1]);
+                // Reason: the block in progress cannot have arrived yet
+                next = next > next_ ? next_ : next;
+                acked_ = next > acked_ ? next : acked_;
+                lastAckMs_ = millis();
+            }
+            return 0;
+
+        case LOG_TRANSFER_OP_ABORT:
+            if (transport == transport_) {
+                abort();
+            }
+            return packStatus(reply, LogTransferStatus::ABORTED, 0);
+
+        default:
+            return packStatus(reply, LogTransferStatus::MALFORMED, 0);
+    }
+}
+
+size_t LogTransfer::startRead(LogTransport transport, const uint8_t* request, uint8_t* reply) {
+    uint32_t now = millis();
+    if (transport_ != LogTransport::NONE && transport_ != transport
+        && now - lastAckMs_ < LOG_TRANSFER_TIMEOUT_MS) {
+        return packStatus(reply, LogTransferStatus::BUSY, 0);
+    }
+
+    uint32_t first = logger_.oldestSequence();
+    uint32_t newest = logger_.newestSequence();
+    if (first == 0) {
+        return packStatus(reply, LogTransferStatus::NO_LOG, 0);
+    }
+
+    uint32_t logStart = readUint32(&request[1]);
+    if (logStart != logger_.logStartSequence()) {
+        return packStatus(reply, LogTransferStatus::LOG_CHANGED, logger_.logStartSequence());
+    }
+
+    uint32_t from = readUint32(&request[5]);
+    uint32_t count = readUint32(&request[9]);
+    uint8_t window = request[13];
+    from = from == 0 ? first : from;
+    if (from < first || from > newest) {
+        return packStatus(reply, LogTransferStatus::OUT_OF_RANGE, first);
+    }
+
+    // A new READ replaces the transfer in progress: it is how the host
+    // asks for a block again
+    transport_ = transport;
+    next_ = from;
+    end_ = (count == 0 || count > newest - from) ? newest : from + count - 1;
+    acked_ = from;
+    window_ = window == 0 ? LOG_TRANSFER_DEFAULT_WINDOW
+            : (window > LOG_TRANSFER_MAX_WINDOW ? LOG_TRANSFER_MAX_WINDOW : window);
+    lastAckMs_ = now;
+    blockSequence_ = 0;
+    offset_ = 0;
+    statusPending_ = false;
+    transfers_++;
+
+    if (DEBUG_ENABLED && transport != LogTransport::SERIAL_PORT) {
+        Serial.printf("Log transfer over %s: blocks %u-%u\n", logTransportName(transport), from, end_);
+    }
+    return packStatus(reply, LogTransferStatus::OK, from);
+}
+
+void LogTransfer::service(size_t maxMessage, SendFunction send) {
+    if (transport_ == LogTransport::NONE) {
+        return;
+    }
+    if (maxMessage <= LOG_TRANSFER_DATA_HEADER || millis() - lastAckMs_ >= LOG_TRANSFER_TIMEOUT_MS) {
+        abort();  // Link lost or host gone; it resumes with a new READ
+        return;
+    }
+
+    if (statusPending_) {
+        uint8_t status[LOG_TRANSFER_STATUS_SIZE];
+        if (!send(status, packStatus(status, pendingStatus_, pendingSequence_))) {
+            return;
+        }
+        statusPending_ = false;
+        if (pendingStatus_ != LogTransferStatus::BAD_BLOCK) {
+            transport_ = LogTransport::NONE;
+            return;
+        }
+    }
+
+    if (acked_ > end_) {
+        queueStatus(LogTransferStatus::DONE, end_);
+        return;
+    }
+
+    uint8_t message[LOG_TRANSFER_MAX_MESSAGE];
+    size_t chunk = (maxMessage < sizeof(message) ? maxMessage : sizeof(message)) - LOG_TRANSFER_DATA_HEADER;
+
+    while (next_ <= end_ && next_ - acked_ < window_) {
+        if (blockSequence_ != next_ && !loadBlock(next_)) {
+            if (next_ < logger_.oldestSequence()) {
+                // Overwritten by a wrapping log since the READ
+                queueStatus(LogTransferStatus::OUT_OF_RANGE, logger_.oldestSequence());
+            } else {
+                queueStatus(LogTransferStatus::BAD_BLOCK, next_);
+                next_++;
+                blocksSent_++;
+            }
+            return;
+        }
+
+        size_t length = blockLength_ - offset_;
+        length = length < chunk ? length : chunk;
+        message[0] = LOG_TRANSFER_MSG_DATA;
+        packUint32(&message[1], next_);
+        packUint16(&message[5], static_cast<uint16_t>(offset_));
+        memcpy(&message[LOG_TRANSFER_DATA_HEADER], reinterpret_cast<const uint8_t*>(&block_) + offset_, length);
+        if (!send(message, LOG_TRANSFER_DATA_HEADER + length)) {
+            return;  // Offered again next pass
+        }
+
+        offset_ += length;
+        if (offset_ >= blockLength_) {
+            next_++;
+            offset_ = 0;
+            blocksSent_++;
+        }
+    }
+}
+
+void LogTransfer::abort() {
+    if (transport_ != LogTransport::NONE && DEBUG_ENABLED && transport_ != LogTransport::SERIAL_PORT) {
+        Serial.printf("Log transfer stopped at block %u\n", acked_);
+    }
+    transport_ = LogTransport::NONE;
+    statusPending_ = false;
+    blockSequence_ = 0;
+}
+
+bool LogTransfer::loadBlock(uint32_t sequence) {
+    // Reason: one 4 KB flash read per block, not per chunk
+    if (!logger_.readSequence(sequence, block_)) {
+        blockSequence_ = 0;
+        return false;
+    }
+    blockSequence_ = sequence;
+    blockLength_ = sizeof(LogBlockHeader) + block_.header.sampleCount * sizeof(RawAccel);
+    offset_ = 0;
+    return true;
+}
+
+void LogTransfer::queueStatus(LogTransferStatus status, uint32_t sequence) {
+    statusPending_ = true;
+    pendingStatus_ = status;
+    pendingSequence_ = sequence;
+}
+
+size_t LogTransfer::packStatus(uint8_t* reply, LogTransferStatus status, uint32_t sequence) {
+    reply[0] = LOG_TRANSFER_MSG_STATUS;
+    reply[1] = static_cast<uint8_t>(status);
+    packUint32(&reply[2], sequence);
+    return LOG_TRANSFER_STATUS_SIZE;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file log_transfer.h
+ * @brief Resumable bulk download of the flash log over BLE or serial
+ *
+ * The same messages travel as writes and notifications on the Log
+ * Transfer characteristic, or as LOG_TRANSFER serial frames (see
+ * serial_frame.h).
+ * All values are little-endian.
+ *
+ *   host  -> device  INFO   0x01
+ *   device -> host   INFO   0x81, status(u8), logging(u8), log start(u32),
+ *                           first(u32), last(u32), capacity(u32),
+ *                           samples per block(u16), block size(u16)
+ *   host  -> device  READ   0x02, log start(u32), from(u32), count(u32), window(u8)
+ *   host  -> device  ACK    0x03, next(u32)
+ *   host  -> device  ABORT  0x04
+ *   device -> host   STATUS 0x82, status(u8), sequence(u32)
+ *   device -> host   DATA   0x83, sequence(u32), offset(u16), bytes
+ *
+ * Blocks are named by their sequence number (see flash_logger.h), which
+ * keeps naming the same block while the log grows or wraps. INFO gives
+ * the range of the newest log; first and last are 0 without one.
+ *
+ * READ answers STATUS OK with its first sequence, then sends each block
+ * (the 32-byte header and its samples, as stored) as DATA chunks in
+ * order. from = 0 starts at the oldest block and count = 0 runs to the
+ * newest one at the time of the request. The log start must match INFO,
+ * so a resumed download cannot mix two logs.
+ *
+ * The host checks each block with the CRC in its header and ACKs the
+ * sequence after the last good block in order. At most window blocks are
+ * sent ahead of the newest ACK. A bad or missing block is fetched again
+ * with a new READ from it, which replaces the transfer in progress; the
+ * same READ resumes after a disconnect, as the device keeps no state
+ * between transfers. A block that fails its CRC in flash is reported
+ * with STATUS BAD_BLOCK instead of its data and counts as sent. STATUS
+ * DONE follows the ACK of the last block.
+ *
+ * One transfer runs at a time; loop() only.
+ */
+
+#ifndef LOG_TRANSFER_H
+#define LOG_TRANSFER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "flash_logger.h"
+
+constexpr uint8_t LOG_TRANSFER_OP_INFO = 0x01;
+constexpr uint8_t LOG_TRANSFER_OP_READ = 0x02;
+constexpr uint8_t LOG_TRANSFER_OP_ACK = 0x03;
+constexpr uint8_t LOG_TRANSFER_OP_ABORT = 0x04;
+constexpr uint8_t LOG_TRANSFER_MSG_INFO = 0x81;
+constexpr uint8_t LOG_TRANSFER_MSG_STATUS = 0x82;
+constexpr uint8_t LOG_TRANSFER_MSG_DATA = 0x83;
+
+constexpr size_t LOG_TRANSFER_READ_SIZE = 14;
+constexpr size_t LOG_TRANSFER_ACK_SIZE = 5;
+constexpr size_t LOG_TRANSFER_MAX_REQUEST = LOG_TRANSFER_READ_SIZE;
+constexpr size_t LOG_TRANSFER_INFO_SIZE = 23;
+constexpr size_t LOG_TRANSFER_STATUS_SIZE = 6;
+constexpr size_t LOG_TRANSFER_MAX_REPLY = LOG_TRANSFER_INFO_SIZE;
+constexpr size_t LOG_TRANSFER_DATA_HEADER = 7;
+
+/**
+ * @brief Result of a log transfer request
+ */
+enum class LogTransferStatus : uint8_t {
+    OK = 0,            ///< Transfer started
+    DONE = 1,          ///< Every block acknowledged
+    ABORTED = 2,       ///< Stopped by the host or a timeout
+    LOG_CHANGED = 3,   ///< Log start does not match (sequence = current log start)
+    OUT_OF_RANGE = 4,  ///< Block not stored (sequence = oldest stored)
+    BUSY = 5,          ///< A transfer runs on the other transport
+    BAD_BLOCK = 6,     ///< Block failed its CRC in flash (sequence = block)
+    NO_LOG = 7,        ///< Nothing logged, or no log partition
+    MALFORMED = 8      ///< Unknown or short request
+};
+
+/**
+ * @brief Link a transfer runs on
+ */
+enum class LogTransport : uint8_t {
+    NONE = 0,
+    BLE,
+    SERIAL_PORT
+};
+
+/**
+ * @brief Get a transport name for logs
+ */
+const char* logTransportName(LogTransport transport);
+
+/**
+ * @brief Block-windowed log download state machine
+ */
+class LogTransfer {
+public:
+    /**
+     * @brief Hands one message to the transport
+     *
+     * @return true if taken; false when the link has no room now (the
+     *         same message is offered again on the next service())
+     */
+    using SendFunction = bool (*)(const uint8_t* message, size_t length);
+
+    explicit LogTransfer(const FlashLogger& logger);
+
+    /**
+     * @brief Answer one host request
+     *
+     * @param transport Link the request arrived on
+     * @param request Message without any transport framing
+     * @param length Message length
+     * @param reply Buffer of LOG_TRANSFER_MAX_REPLY bytes
+     * @return size_t Reply length (0 = nothing to send, e.g. for ACK)
+     */
+    size_t handleRequest(LogTransport transport, const uint8_t* request, size_t length, uint8_t* reply);
+
+    /**
+     * @brief Send what the window allows on the active transport
+     *
+     * Call once per loop() pass while transport() is not NONE.
+     *
+     * @param maxMessage Largest message the link takes (0 = link lost,
+     *                   which ends the transfer)
+     * @param send Transport send function
+     */
+    void service(size_t maxMessage, SendFunction send);
+
+    /**
+     * @brief Stop the transfer without telling the host
+     */
+    void abort();
+
+    /**
+     * @brief Get the transport of the running transfer (NONE = idle)
+     */
+    LogTransport transport() const { return transport_; }
+
+    /**
+     * @brief Blocks sent since boot
+     */
+    uint32_t blocksSent() const { return blocksSent_; }
+
+    /**
+     * @brief Transfers started since boot (each resume counts)
+     */
+    uint32_t transfers() const { return transfers_; }
+
+private:
+    const FlashLogger& logger_;
+    LogTransport transport_;
+
+    // Window (sequences)
+    uint32_t next_;       // Block being sent
+    uint32_t end_;        // Last block of the transfer
+    uint32_t acked_;      // Host has every block before this
+    uint8_t window_;
+    uint32_t lastAckMs_;
+
+    // Block being sent
+    LogBlock block_;
+    uint32_t blockSequence_;  // 0 = none loaded
+    size_t blockLength_;
+    size_t offset_;
+
+    // Status the host still has to be sent (DONE, BAD_BLOCK, OUT_OF_RANGE)
+    bool statusPending_;
+    LogTransferStatus pendingStatus_;
+    uint32_t pendingSequence_;
+
+    uint32_t blocksSent_;
+    uint32_t transfers_;
+
+    size_t startRead(LogTransport transport, const uint8_t* request, uint8_t* reply);
+    bool loadBlock(uint32_t sequence);
+    void queueStatus(LogTransferStatus status, uint32_t sequence);
+    static size_t packStatus(uint8_t* reply, LogTransferStatus status, uint32_t sequence);
+};
+
+#endif // LOG_TRANSFER_H
@@ -17,83 +17,124 @@
  */
 
 #include <Arduino.h>
+#include <atomic>
 #include "config.h"
 #include "display.h"
-#include "accelerometer.h"
-#include "signal_processing.h"
+#include "sampler.h"
+#include "config_store.h"
+#include "stream_frame.h"
 #include "ble_service.h"
 #include "touch.h"
 #include "settings.h"
 #include "ui_manager.h"
+#include "power_manager.h"
+#include "profiler.h"
+#include "waveform.h"
+#include "wifi_stream.h"
+#include "time_sync.h"
+#include "log_transfer.h"
+#include "command_protocol.h"
+#include "command_executor.h"
+#include "serial_frame.h"
 
 // Global objects
 Display display;
-Accelerometer accel;
-SignalProcessor processor;
+Sampler sampler;
 BleService bleService;
+WifiStreamer wifiStreamer;
 TouchManager touchMgr;
 UIManager uiMgr;
 Settings settings;
+ConfigStore configStore;
+PowerManager powerMgr(display, bleService);
 
-// Hardware timer for precise sampling
-hw_timer_t* sampleTimer = nullptr;
-volatile bool sampleFlag = false;
+// Power profile requested over BLE, applied by loop() (0xFF = none)
+std::atomic<uint8_t> requestedPowerProfile(0xFF);
 
-// Current sample rate (can be changed at runtime via serial command)
-uint32_t currentSampleRateHz = ADXL_DEFAULT_SAMPLE_RATE_HZ;
+// Serial sample consumer (reads every sample, drops when the link is too slow)
+SampleRingBuffer::Reader serialReader(sampler.ring());
 
-// Timer ISR - just sets flag, actual I2C read happens in loop
-void IRAM_ATTR onSampleTimer() {
-    sampleFlag = true;
-}
+// BLE batched stream consumer (reads every sample while batching is selected)
+SampleRingBuffer::Reader bleReader(sampler.ring());
 
-/**
- * @brief Change the accelerometer sample rate at runtime
- *
- * Updates both the hardware timer interval and the ADXL375 data rate register.
- * Valid rates: 100, 200, 400, 800 Hz (limited by serial bandwidth)
- *
- * @param rateHz Target sample rate in Hz
- * @return true if rate was changed successfully
- */
-bool setSampleRate(uint32_t rateHz) {
-    // Map Hz to ADXL data rate enum
-    adxl3xx_dataRate_t adxlRate;
-    switch (rateHz) {
-        case 100:  adxlRate = ADXL3XX_DATARATE_100_HZ; break;
-        case 200:  adxlRate = ADXL3XX_DATARATE_200_HZ; break;
-        case 400:  adxlRate = ADXL3XX_DATARATE_400_HZ; break;
-        case 800:  adxlRate = ADXL3XX_DATARATE_800_HZ; break;
-        default:
-            Serial.printf("Invalid rate: %d Hz\n", rateHz);
-            return false;
-    }
-
-    // Update ADXL375 data rate
-    accel.setDataRate(adxlRate);
-
-    // Calculate new timer interval in microseconds
-    uint32_t intervalUs = 1000000 / rateHz;
-
-    // Update hardware timer
-    timerAlarmDisable(sampleTimer);
-    timerAlarmWrite(sampleTimer, intervalUs, true);
-    timerAlarmEnable(sampleTimer);
-
-    currentSampleRateHz = rateHz;
-    Serial.printf("Sample rate: %d Hz\n", rateHz);
-    return true;
-}
+// Wi-Fi stream consumer (reads every sample while a receiver is attached)
+SampleRingBuffer::Reader wifiReader(sampler.ring());
+
+// Legacy BLE stream consumer (block averages at the notification rate)
+DecimatedRingBuffer::Reader notifyReader(sampler.notifyRing());
+
+// Waveform screen consumer (reads every sample while the waveform is shown)
+SampleRingBuffer::Reader waveReader(sampler.ring());
+WaveformBuffer waveform;
+
+// Binary serial stream state
+uint8_t serialFrameBuffer[streamFrameSize(SERIAL_BINARY_BATCH_SAMPLES)];
+StreamFrameWriter serialFrame(serialFrameBuffer, sizeof(serialFrameBuffer));
+uint32_t serialFrameStartMs = 0;
+uint32_t serialFramesDropped = 0;
+
+// Impact events
+ImpactEvent impactDump;            // Copy for the 'd' command (too large for the loop stack)
+uint32_t lastImpactSequence = 0;   // Newest event already reported
+uint32_t lastStatsSequence = 0;    // Newest window summary already reported
+
+// Vibration spectrum
+SpectrumResult spectrum;              // Newest result (too large for the loop stack)
+bool spectrumValid = false;
+uint32_t lastSpectrumSequence = 0;    // Newest result already reported
+
+// Log download over BLE or serial
+LogTransfer logTransfer(sampler.logger());
+
+// Binary requests on serial (log transfer and command protocol frames)
+SerialFrameParser serialFrameParser;
+
+// Calibration runs already reported (and stored)
+uint32_t lastCalibrationCount = 0;
 
 // Timing variables
 uint32_t lastDisplayTime = 0;
-uint32_t lastBLENotifyTime = 0;
+uint32_t lastPeakNotifyTime = 0;
+uint32_t lastConfigCheckTime = 0;
+uint32_t lastDiagnosticsTime = 0;
 
 // State
 bool sensorOk = false;
 
 // Forward declaration (ESP32 doesn't auto-call serialEvent like classic Arduino)
 void serialEvent();
+void streamSerialCsv();
+void streamSerialBinary();
+void streamBleBatched(uint32_t now);
+void streamWifi();
+const char* wifiStatusLine();
+void reportImpacts();
+void reportStats();
+void reportSpectrum();
+void reportCalibration();
+bool startSampler();
+void applyPowerProfile(PowerProfile profile);
+void printPowerReport();
+void printWifiStatus();
+void printBleStatus();
+void serviceTimeSync();
+void serviceLogTransfer();
+void serviceCommands();
+void setSerialFormat(SerialFormat format);
+void printLogTransfer();
+void printTimeSync();
+void printProfile();
+RuntimeConfig currentConfig();
+void printCalibration();
+void printSpectrum();
+void printWindowStats(const StatsSummary& summary);
+void printImpactStats(const ImpactStats& stats);
+void dumpImpact();
+void printFilterConfig(const FilterConfig& config);
+
+// Command protocol requests from serial, BLE and Wi-Fi
+CommandExecutor commandExecutor(sampler, bleService, wifiStreamer, display, settings, setSerialFormat,
+                                applyPowerProfile);
 
 /**
  * @brief Arduino setup function
@@ -101,7 +142,14 @@ void serialEvent();
 void setup() {
     // Initialize serial for debugging
     Serial.begin(SERIAL_BAUD_RATE);
-    delay(500);  // Give serial more time to initialize
+
+    // Restore the saved configuration first: it decides how the board boots
+    RuntimeConfig config;
+    bool restored = configStore.load(config);
+    settings = config.settings;
+    if (!settings.fastBoot) {
+        delay(500);  // Give serial more time to initialize
+    }
 
     Serial.println();
     Serial.println("================================");
@@ -109,8 +157,24 @@ void setup() {
     Serial.println("================================");
     Serial.println();
     Serial.println("[Setup] Starting...");
+    Serial.println(restored ? "[Setup] Configuration restored from NVS"
+                            : "[Setup] No stored configuration, using defaults");
+
+    // Queued now, applied by the sampler task from its first sample
+    sampler.setSampleRate(config.sampleRateHz);
+    sampler.setFilterConfig(config.filter);
+    sampler.setImpactThresholdG(config.impactThresholdG);
+    if (config.shockWake) {
+        sampler.setShockWake(true);
+    }
 
-    // Initialize display first (shows splash screen)
+    // Headless fast start: sample before the display is even initialised
+    if (settings.fastBoot) {
+        Serial.println("[Setup] Fast boot, skipping splash");
+        sensorOk = startSampler();
+    }
+
+    // Initialize display (shows splash screen on a normal boot)
     Serial.println("[Setup] Initializing display...");
     if (!display.begin()) {
         Serial.println("ERROR: Display initialization failed!");
@@ -118,27 +182,19 @@ void setup() {
             delay(500);
         }
     }
-    Serial.println("[Setup] Display OK, showing splash...");
-
-    display.showSplash();
-    Serial.println("[Setup] Splash shown, waiting...");
-    delay(1500);  // Show splash for 1.5 seconds
+    Serial.println("[Setup] Display OK");
 
-    // Initialize accelerometer
-    Serial.println("[Setup] Initializing ADXL375...");
-    sensorOk = accel.begin();
+    if (!settings.fastBoot) {
+        display.showSplash();
+        Serial.println("[Setup] Splash shown, waiting...");
+        delay(1500);  // Show splash for 1.5 seconds
+        sensorOk = startSampler();
+    }
 
     if (!sensorOk) {
         display.showError("ADXL375 NOT FOUND");
-        Serial.println("ERROR: Accelerometer initialization failed!");
-        Serial.println("Check wiring:");
-        Serial.println("  JST GND  -> ADXL375 GND");
-        Serial.println("  JST 3.3V -> ADXL375 VIN");
-        Serial.println("  JST TX   -> ADXL375 SDA");
-        Serial.println("  JST RX   -> ADXL375 SCL");
-        // Continue anyway to show error on display
     } else {
-        Serial.println("[Setup] ADXL375 OK, drawing UI...");
+        Serial.println("[Setup] Drawing UI...");
         // Clear display and draw static UI
         display.clear();
         display.drawStaticUI();
@@ -156,13 +212,27 @@ void setup() {
     // Initialize BLE
     Serial.println("[Setup] Initializing BLE...");
     bleService.begin();
+    bleService.setNotificationRate(config.notifyRateHz);
+    sampler.setNotifyRate(bleService.getFastestNotificationRate());
+    bleService.setStreamFormat(static_cast<BleStreamFormat>(config.bleStreamFormat));
+    bleService.setEnabled(settings.bleEnabled);
     Serial.println("[Setup] BLE OK");
 
+    // Wi-Fi stream: joins the network in the background
+    wifiStreamer.setMode(settings.wifiMode);
+    if (wifiStreamer.isEnabled()) {
+        Serial.printf("[Setup] Wi-Fi %s stream, %s\n", wifiModeName(settings.wifiMode),
+                      wifiStatusName(wifiStreamer.status()));
+    }
+
+    // Clock, radio, backlight and FIFO drain settings of the saved profile
+    applyPowerProfile(settings.powerProfile);
+
     // Register BLE command callback
-    bleService.setCommandCallback([](uint8_t cmd) {
+    bleService.setCommandCallback([](uint8_t cmd, const uint8_t* payload, size_t length) {
         switch (cmd) {
             case BLE_CMD_RESET_PEAK:
-                processor.resetPeak();
+                sampler.requestPeakReset();
                 display.resetGaugeMax();
                 if (DEBUG_ENABLED) {
                     Serial.println("BLE: Peak reset");
@@ -170,12 +240,65 @@ void setup() {
                 break;
 
             case BLE_CMD_RESET_FILTERS:
-                processor.reset();
+                sampler.requestFilterReset();
                 if (DEBUG_ENABLED) {
                     Serial.println("BLE: Filters reset");
                 }
                 break;
 
+            case BLE_CMD_SET_FILTER:
+                {
+                    FilterConfig config = {};
+                    if (parseFilterPayload(payload, length, config) && sampler.setFilterConfig(config)) {
+                        if (DEBUG_ENABLED) {
+                            Serial.print("BLE: ");
+                            printFilterConfig(config);
+                        }
+                    } else if (DEBUG_ENABLED) {
+                        Serial.println("BLE: Invalid filter settings");
+                    }
+                }
+                break;
+
+            case BLE_CMD_SET_POWER:
+                // Reason: the power manager belongs to loop(); this runs in the NimBLE host task
+                if (length == 1 && payload[0] <= static_cast<uint8_t>(PowerProfile::LOW_POWER)) {
+                    requestedPowerProfile.store(payload[0]);
+                } else if (DEBUG_ENABLED) {
+                    Serial.println("BLE: Invalid power profile");
+                }
+                break;
+
+            case BLE_CMD_CALIBRATE:
+                if (sampler.requestCalibration() && DEBUG_ENABLED) {
+                    Serial.println("BLE: Calibrating");
+                }
+                break;
+
+            case BLE_CMD_SET_SPECTRUM:
+                {
+                    // Payload: channel, optionally followed by the band edges (uint16 Hz LE)
+                    bool valid = (length == 1 || length == 1 + 2 * (SPECTRUM_BAND_COUNT + 1))
+                                 && payload[0] <= static_cast<uint8_t>(SpectrumChannel::MAGNITUDE);
+                    if (valid && length > 1) {
+                        uint16_t edges[SPECTRUM_BAND_COUNT + 1];
+                        for (size_t i = 0; i <= SPECTRUM_BAND_COUNT; i++) {
+                            edges[i] = payload[1 + i * 2] | (payload[2 + i * 2] << 8);
+                        }
+                        valid = sampler.spectrum().setBands(edges);
+                    }
+
+                    if (valid) {
+                        sampler.spectrum().setChannel(static_cast<SpectrumChannel>(payload[0]));
+                        if (DEBUG_ENABLED) {
+                            Serial.println("BLE: Spectrum settings changed");
+                        }
+                    } else if (DEBUG_ENABLED) {
+                        Serial.println("BLE: Invalid spectrum settings");
+                    }
+                }
+                break;
+
             default:
                 if (DEBUG_ENABLED) {
                     Serial.print("BLE: Unknown command 0x");
@@ -189,60 +312,303 @@ void setup() {
     pinMode(PIN_BUTTON, INPUT_PULLUP);
     Serial.println("[Setup] Button initialized on GPIO9");
 
-    // Set up hardware timer for sampling
-    // Timer 0, prescaler 80 (80MHz/80 = 1MHz tick rate), count up
-    sampleTimer = timerBegin(0, 80, true);
-    timerAttachInterrupt(sampleTimer, &onSampleTimer, true);
-    // Set initial rate (can be changed at runtime via serial command s1-s4)
-    uint32_t initialIntervalUs = 1000000 / ADXL_DEFAULT_SAMPLE_RATE_HZ;
-    timerAlarmWrite(sampleTimer, initialIntervalUs, true);
-    timerAlarmEnable(sampleTimer);
-    Serial.printf("[Setup] Sample timer configured for %d Hz (s1-s4 to change)\n", ADXL_DEFAULT_SAMPLE_RATE_HZ);
-
     // Initialize timing
     lastDisplayTime = millis();
-    lastBLENotifyTime = millis();
+    lastPeakNotifyTime = millis();
+    lastConfigCheckTime = millis();
+
+    // The restored state is what NVS already holds
+    configStore.update(currentConfig(), millis());
 
     Serial.println("[Setup] Complete! Entering main loop...");
 }
 
+/**
+ * @brief Initialize the accelerometer and start the sampler task
+ *
+ * @return true if the sensor was found
+ */
+bool startSampler() {
+    Serial.println("[Setup] Initializing ADXL375...");
+    if (!sampler.begin()) {
+        Serial.println("ERROR: Accelerometer initialization failed!");
+        Serial.println("Check wiring:");
+        Serial.println("  JST GND  -> ADXL375 GND");
+        Serial.println("  JST 3.3V -> ADXL375 VIN");
+        Serial.println("  JST TX   -> ADXL375 SDA");
+        Serial.println("  JST RX   -> ADXL375 SCL");
+        // Continue anyway to show error on display
+        return false;
+    }
+
+    Serial.printf("[Setup] Sampler task running at %d Hz (s1-s6 to change), %u ms after boot\n",
+                  sampler.getSampleRate(), millis());
+    return true;
+}
+
+/**
+ * @brief Switch power profile (saved with the settings)
+ */
+void applyPowerProfile(PowerProfile profile) {
+    settings.powerProfile = profile;
+    powerMgr.setProfile(profile, millis());
+    sampler.setLowPowerDrain(profile == PowerProfile::LOW_POWER);
+    // Timings taken at the old clock would not compare
+    GSENSOR_PROFILE_RESET();
+}
+
+/**
+ * @brief Print the power profile and the estimated supply current
+ *
+ * Format: Power: <profile>, backlight <state> | ~N mA (CPU, backlight,
+ * panel, radio, sensor) | asleep P% of S s | ~H h per C mAh
+ */
+void printPowerReport() {
+    static const char* const backlightNames[] = {"on", "dim", "off"};
+    PowerReport report = powerMgr.report(millis());
+    Serial.printf("Power: %s, backlight %s | ~%.1f mA (CPU %.1f, backlight %.1f, panel %.1f, "
+                  "radio %.2f, sensor %.2f) | asleep %.1f%% of %u s | ~%.0f h per %u mAh\n",
+                  powerProfileName(powerMgr.getProfile()),
+                  backlightNames[static_cast<uint8_t>(powerMgr.getBacklight())],
+                  report.totalMa(), report.cpuMa, report.backlightMa, report.panelMa,
+                  report.radioMa, report.sensorMa, report.sleepFraction * 100.0f,
+                  report.windowMs / 1000, report.batteryHours(), POWER_REPORT_BATTERY_MAH);
+}
+
+/**
+ * @brief Print the Wi-Fi stream state
+ *
+ * Format: Wi-Fi: <mode>, <status>[, <ip>:<port>] | frames N sent, N dropped | samples N dropped
+ */
+void printWifiStatus() {
+    Serial.printf("Wi-Fi: %s, %s", wifiModeName(wifiStreamer.getMode()), wifiStatusName(wifiStreamer.status()));
+    if (wifiStreamer.status() == WifiStatus::WAITING || wifiStreamer.status() == WifiStatus::STREAMING) {
+        Serial.printf(", %s:%u", wifiStreamer.localIp().toString().c_str(), WIFI_STREAM_PORT);
+    }
+    Serial.printf(" | frames %u sent, %u dropped | samples %u dropped\n",
+                  wifiStreamer.framesSent(), wifiStreamer.framesDropped(), wifiReader.dropped());
+}
+
+/**
+ * @brief Print the connected BLE clients
+ *
+ * Format: BLE: N of N clients, then per client
+ *         BLE client <conn>: <format> [N Hz], MTU N, interval N.NN ms | sent N, dropped N
+ */
+void printBleStatus() {
+    Serial.printf("BLE: %s, %u of %u clients\n", bleService.isEnabled() ? "on" : "off",
+                  static_cast<unsigned>(bleService.clientCount()), static_cast<unsigned>(BLE_MAX_CLIENTS));
+    for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        BleClient client;
+        if (!bleService.getClient(i, client)) {
+            continue;
+        }
+        Serial.printf("BLE client %u: ", client.connHandle);
+        if (client.streamFormat == BleStreamFormat::BATCHED) {
+            Serial.print("batched");
+        } else {
+            Serial.printf("legacy %u Hz", client.notificationRateHz);
+        }
+        Serial.printf(", MTU %u, interval %.2f ms | sent %u, dropped %u\n",
+                      client.mtu, client.interval * 1.25f, client.sent, client.dropped);
+    }
+}
+
+/**
+ * @brief Answer a time sync message written over BLE
+ *
+ * Wi-Fi sync datagrams are answered by WifiStreamer::update().
+ */
+void serviceTimeSync() {
+    uint8_t request[TIME_SYNC_MAX_MESSAGE];
+    size_t length;
+    uint64_t receivedUs;
+    if (!bleService.takeSyncRequest(request, length, receivedUs)) {
+        return;
+    }
+
+    uint8_t reply[TIME_SYNC_MAX_MESSAGE];
+    size_t replyLength = timeSync.handleMessage(request, length, receivedUs, reply);
+    if (replyLength > 0) {
+        bleService.notifySync(reply, replyLength);
+    }
+}
+
+/**
+ * @brief Answer log transfer requests written over BLE and send the
+ *        blocks of the running transfer
+ *
+ * Serial requests arrive through serialEvent().
+ */
+void serviceLogTransfer() {
+    uint8_t request[LOG_TRANSFER_MAX_REQUEST];
+    size_t length;
+    if (bleService.takeLogRequest(request, length)) {
+        uint8_t reply[LOG_TRANSFER_MAX_REPLY];
+        size_t replyLength = logTransfer.handleRequest(LogTransport::BLE, request, length, reply);
+        // Reason: a reply the link has no room for is lost; the host
+        // repeats requests it gets no answer to
+        if (replyLength > 0) {
+            bleService.notifyLog(reply, replyLength);
+        }
+    }
+
+    if (logTransfer.transport() == LogTransport::BLE) {
+        logTransfer.service(bleService.getLogMessageCapacity(),
+                            [](const uint8_t* message, size_t length) { return bleService.notifyLog(message, length); });
+    } else if (logTransfer.transport() == LogTransport::SERIAL_PORT) {
+        logTransfer.service(LOG_TRANSFER_SERIAL_MESSAGE, [](const uint8_t* message, size_t length) {
+            return writeSerialFrame(SerialFrameType::LOG_TRANSFER, message, length);
+        });
+    }
+}
+
+/**
+ * @brief Answer command requests written over BLE or sent over Wi-Fi
+ *
+ * Serial requests arrive through serialEvent().
+ */
+void serviceCommands() {
+    uint8_t request[COMMAND_MAX_MESSAGE];
+    uint8_t response[COMMAND_MAX_MESSAGE];
+    size_t length;
+    if (bleService.takeCommandRequest(request, length)) {
+        size_t responseLength = commandExecutor.run(CommandTransport::BLE, request, length, response,
+                                                    bleService.getCommandReplyCapacity());
+        // Reason: a response the link has no room for is lost; the host
+        // repeats requests it gets no answer to
+        if (responseLength > 0) {
+            bleService.notifyCommand(response, responseLength);
+        }
+    }
+
+    if (wifiStreamer.takeCommandRequest(request, length)) {
+        size_t responseLength = commandExecutor.run(CommandTransport::WIFI, request, length, response,
+                                                    sizeof(response));
+        if (responseLength > 0) {
+            wifiStreamer.sendCommandReply(response, responseLength);
+        }
+    }
+
+    // Reason: a Wi-Fi mode change restarts the radio, so the executor
+    // only records it and it is applied once the response is on its way
+    wifiStreamer.setMode(settings.wifiMode);
+}
+
+/**
+ * @brief Print the log transfer state
+ *
+ * Format: Log transfer: <transport> | N transfers, N blocks sent
+ */
+void printLogTransfer() {
+    Serial.printf("Log transfer: %s | %u transfers, %u blocks sent\n",
+                  logTransportName(logTransfer.transport()), logTransfer.transfers(), logTransfer.blocksSent());
+}
+
+/**
+ * @brief Print the time sync state
+ *
+ * Format: Time sync: <state> | error N us, delay N us (best N us), drift N.NN ppm |
+ *         exchanges N, rejected N, steps N
+ */
+void printTimeSync() {
+    Serial.printf("Time sync: %s | error %d us, delay %u us (best %u us), drift %.2f ppm | "
+                  "exchanges %u, rejected %u, steps %u\n",
+                  timeSyncStateName(timeSync.state(millis())), timeSync.lastErrorUs(),
+                  timeSync.lastDelayUs(), timeSync.bestDelayUs(), timeSync.driftPpb() / 1000.0f,
+                  timeSync.exchanges(), timeSync.rejected(), timeSync.steps());
+}
+
+/**
+ * @brief Print the hot-path timing counters
+ *
+ * Format: a Profile: summary line, then prof_hist_us with each histogram
+ * bucket's upper edge in us, then one line per stage:
+ * prof,<stage>,count,min_us,avg_us,max_us,<bucket counts>
+ */
+void printProfile() {
+#if GSENSOR_PROFILING
+    uint32_t cpuMhz = profiler.cpuMhz();
+    Serial.printf("Profile: %u MHz, %u s | coalesced wakes %u | FIFO overruns %u\n",
+                  cpuMhz, profiler.windowMs() / 1000,
+                  profiler.counter(ProfileCounter::COALESCED_WAKES),
+                  profiler.counter(ProfileCounter::FIFO_OVERRUNS));
+
+    Serial.print("prof_hist_us");
+    for (int k = 0; k < PROFILE_HISTOGRAM_BUCKETS - 1; k++) {
+        Serial.printf(",%.1f", static_cast<float>(1UL << (PROFILE_HISTOGRAM_FIRST_BIT + k + 1)) / cpuMhz);
+    }
+    Serial.println(",inf");
+
+    for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        ProfileStage stage = static_cast<ProfileStage>(i);
+        ProfileSummary summary;
+        profiler.summary(stage, summary);
+        Serial.printf("prof,%s,%u,%.1f,%.1f,%.1f", profileStageName(stage), summary.count,
+                      static_cast<float>(summary.minCycles) / cpuMhz,
+                      static_cast<float>(summary.averageCycles()) / cpuMhz,
+                      static_cast<float>(summary.maxCycles) / cpuMhz);
+        for (int k = 0; k < PROFILE_HISTOGRAM_BUCKETS; k++) {
+            Serial.printf(",%u", summary.histogram[k]);
+        }
+        Serial.println();
+    }
+#else
+    Serial.println("Profiling disabled (build with -DGSENSOR_PROFILING=1)");
+#endif
+}
+
+/**
+ * @brief Snapshot of everything the config store persists
+ */
+RuntimeConfig currentConfig() {
+    RuntimeConfig config;
+    config.settings = settings;
+    config.sampleRateHz = sampler.getSampleRate();
+    config.notifyRateHz = bleService.getNotificationRate();
+    config.bleStreamFormat = static_cast<uint8_t>(bleService.getStreamFormat());
+    config.shockWake = sampler.isShockWakeEnabled();
+    config.impactThresholdG = sampler.capture().getThresholdG();
+    config.filter = sampler.getFilterConfig();
+    return config;
+}
+
 /**
  * @brief Arduino main loop
  */
 void loop() {
-    // Sample accelerometer FIRST when timer fires (highest priority!)
-    // The timer ISR sets sampleFlag at precise 100Hz intervals
-    if (sampleFlag && sensorOk) {
-        sampleFlag = false;  // Clear flag immediately
-
-        AccelData raw;
-        if (accel.read(raw)) {
-            // Process through moving average filter
-            AccelData filtered = processor.process(raw);
-
-            // Serial output in CSV format for plotting (if enabled)
-            // Format: timestamp,x,y,z,magnitude,peak
-            if (DEBUG_ENABLED && settings.serialEnabled) {
-                float mag = processor.getFilteredMagnitude();
-                float peak = processor.getPeakMagnitude();
-
-                Serial.print(millis());
-                Serial.print(",");
-                Serial.print(filtered.x, 3);
-                Serial.print(",");
-                Serial.print(filtered.y, 3);
-                Serial.print(",");
-                Serial.print(filtered.z, 3);
-                Serial.print(",");
-                Serial.print(mag, 3);
-                Serial.print(",");
-                Serial.println(peak, 3);
-            }
-        }
+    GSENSOR_PROFILE_START(loopStart);
+
+    // First, so the device side of an exchange is answered promptly
+    serviceTimeSync();
+    serviceLogTransfer();
+    serviceCommands();
+
+    // Serial sample output (if enabled)
+    // Samples come from the sampler task's ring, so a slow serial link only
+    // drops output and never delays acquisition
+    if (logTransfer.transport() == LogTransport::SERIAL_PORT) {
+        // The download has the link to itself
+        serialReader.skipToLatest();
+    } else if (settings.serialFormat == SerialFormat::BINARY) {
+        streamSerialBinary();
+    } else if (settings.serialFormat == SerialFormat::STATS) {
+        // Summaries replace the sample stream
+        serialReader.skipToLatest();
+    } else {
+        streamSerialCsv();
     }
 
     uint32_t now = millis();
 
+    // Report newly captured impact events, window summaries and spectra
+    if (sensorOk) {
+        reportImpacts();
+        reportStats();
+        reportSpectrum();
+        reportCalibration();
+    }
+
     // Handle physical button (active LOW, debounced)
     static bool lastButtonState = HIGH;
     static uint32_t lastButtonTime = 0;
@@ -250,9 +616,16 @@ void loop() {
 
     if (buttonState != lastButtonState && (now - lastButtonTime) > 200) {
         lastButtonTime = now;
-        if (buttonState == LOW) {
-            // Button pressed - toggle screen
+        // A press on a dimmed or dark display only wakes it
+        if (buttonState == LOW && !powerMgr.noteActivity(now)) {
+            // Button pressed - cycle gauge -> waveform -> spectrum -> settings
             if (uiMgr.getScreen() == UIScreen::MAIN_GAUGE) {
+                uiMgr.setScreen(UIScreen::WAVEFORM);
+                Serial.println("[Button] Opening waveform");
+            } else if (uiMgr.getScreen() == UIScreen::WAVEFORM) {
+                uiMgr.setScreen(UIScreen::SPECTRUM);
+                Serial.println("[Button] Opening spectrum");
+            } else if (uiMgr.getScreen() == UIScreen::SPECTRUM) {
                 uiMgr.setScreen(UIScreen::SETTINGS);
                 Serial.println("[Button] Opening settings");
             } else {
@@ -263,32 +636,63 @@ void loop() {
         lastButtonState = buttonState;
     }
 
-    // Handle touch input (skipped if no touch controller)
-    touchMgr.update();
+    // Handle touch input (gestures are queued by the touch task)
     TouchEvent event = touchMgr.getEvent();
-    if (event.gesture != TouchGesture::NONE) {
+    if (event.gesture != TouchGesture::NONE && !powerMgr.noteActivity(now)) {
         uiMgr.handleTouch(event, settings);
 
-        // Handle BLE enable/disable from settings
+        // Handle BLE enable/disable and Wi-Fi mode from settings
         bleService.setEnabled(settings.bleEnabled);
+        wifiStreamer.setMode(settings.wifiMode);
+    }
+
+    // Power profile from BLE, then backlight timeouts
+    uint8_t profile = requestedPowerProfile.exchange(0xFF);
+    if (profile != 0xFF) {
+        applyPowerProfile(static_cast<PowerProfile>(profile));
+    }
+    powerMgr.update(now);
+
+    // Persist configuration changes once they settle
+    if (now - lastConfigCheckTime >= CONFIG_CHECK_INTERVAL_MS) {
+        lastConfigCheckTime = now;
+        if (configStore.update(currentConfig(), now)
+            && DEBUG_ENABLED && settings.serialEnabled && settings.serialFormat != SerialFormat::BINARY) {
+            Serial.println("Configuration saved");
+        }
     }
 
     // Handle peak reset from UI (long press)
     if (uiMgr.peakResetRequested()) {
-        processor.resetPeak();
+        sampler.requestPeakReset();
         display.resetGaugeMax();
         if (DEBUG_ENABLED && settings.serialEnabled) {
             Serial.println("Peak reset (touch)");
         }
     }
 
+    // Decimate every sample into the waveform envelope while it is shown
+    if (uiMgr.getScreen() == UIScreen::WAVEFORM) {
+        uint32_t rateHz = sampler.getSampleRate();
+        SampleRecord record;
+        while (waveReader.read(record)) {
+            waveform.addSample(record.counts, rateHz);
+        }
+    } else {
+        waveReader.skipToLatest();
+    }
+
     // Update display at lower rate (to prevent flicker and save CPU)
-    if (now - lastDisplayTime >= DISPLAY_UPDATE_INTERVAL_MS) {
+    // Nothing is drawn while the panel sleeps; it keeps its contents
+    if (powerMgr.isDisplayOn() && now - lastDisplayTime >= DISPLAY_UPDATE_INTERVAL_MS) {
         lastDisplayTime = now;
+        GSENSOR_PROFILE_SCOPE(DISPLAY);
 
         // Check if screen changed (need to prepare)
         if (uiMgr.screenChanged()) {
             display.prepareScreen();
+            // The plot starts empty rather than with a gap
+            waveform.reset();
         }
 
         // Draw appropriate screen
@@ -297,45 +701,461 @@ void loop() {
             float magnitude = 0.0f;
             float peak = 0.0f;
 
-            if (sensorOk) {
-                accelData = processor.getLastFiltered();
-                magnitude = processor.getFilteredMagnitude();
-                peak = processor.getPeakMagnitude();
+            // Block average over the last refresh period, not a single
+            // sample that could alias with vibration above 5 Hz
+            DecimatedRecord latest;
+            if (sensorOk && sampler.displayRing().latest(latest)) {
+                accelData = latest.filteredG();
+                magnitude = latest.magnitudeG();
+                peak = latest.peakG();
             }
 
             display.update(accelData, magnitude, peak);
+        } else if (uiMgr.getScreen() == UIScreen::WAVEFORM) {
+            display.drawWaveform(waveform);
+        } else if (uiMgr.getScreen() == UIScreen::SPECTRUM) {
+            if (spectrumValid) {
+                display.drawSpectrum(spectrum);
+            }
         } else {
             // Settings screen
-            display.drawSettingsScreen(settings, bleService.isConnected());
+            display.drawSettingsScreen(settings, bleService.isConnected(), wifiStatusLine());
         }
     }
 
-    // Send BLE notifications at configured rate (if BLE is enabled)
-    if (settings.bleEnabled && bleService.isConnected() && sensorOk) {
-        uint32_t bleInterval = 1000 / bleService.getNotificationRate();
-        if (now - lastBLENotifyTime >= bleInterval) {
-            lastBLENotifyTime = now;
-
-            const AccelData& filtered = processor.getLastFiltered();
-            float magnitude = processor.getFilteredMagnitude();
-            float peak = processor.getPeakMagnitude();
+    // Send BLE notifications (if BLE is enabled); each client takes the
+    // stream it selected
+    GSENSOR_PROFILE_START(bleStart);
+    bleService.update(now);
+    bool bleStreaming = settings.bleEnabled && bleService.isConnected() && sensorOk;
+    if (bleStreaming && bleService.hasStreamClients(BleStreamFormat::BATCHED)) {
+        streamBleBatched(now);
+    } else {
+        // Only queue samples while batching, so a new batch starts fresh
+        bleReader.skipToLatest();
+    }
 
-            bleService.notifyAccelData(now, filtered, magnitude);
+    // Legacy per-sample packets at the fastest client's rate, one per
+    // decimated output so the stream is evenly spaced in sample time
+    sampler.setNotifyRate(bleService.getFastestNotificationRate());
+    if (bleStreaming && bleService.hasStreamClients(BleStreamFormat::LEGACY)) {
+        DecimatedRecord record;
+        while (notifyReader.read(record)) {
+            bleService.notifyAccelData(timeSync.toSyncedMs(record.timestampUs), record.filteredG(), record.magnitudeG());
 
             // Also send peak update periodically (every ~500ms)
-            static uint32_t lastPeakNotify = 0;
-            if (now - lastPeakNotify >= 500) {
-                lastPeakNotify = now;
-                bleService.notifyPeak(now, peak);
+            if (now - lastPeakNotifyTime >= 500) {
+                lastPeakNotifyTime = now;
+                bleService.notifyPeak(timeSync.toSyncedMs(record.timestampUs), record.peakG());
             }
         }
+    } else {
+        notifyReader.skipToLatest();
+    }
+    if (bleStreaming) {
+        GSENSOR_PROFILE_STOP(BLE_NOTIFY, bleStart);
+    }
+
+    // Raw frames over Wi-Fi, independent of the BLE and serial streams
+    wifiStreamer.update(now);
+    if (sensorOk && wifiStreamer.isStreaming()) {
+        streamWifi();
+    } else {
+        wifiReader.skipToLatest();
+    }
+
+#if GSENSOR_PROFILING
+    if (bleStreaming && now - lastDiagnosticsTime >= PROFILE_NOTIFY_INTERVAL_MS) {
+        lastDiagnosticsTime = now;
+        bleService.notifyDiagnostics(profiler);
     }
+#endif
 
     // Handle serial commands (ESP32 doesn't auto-call serialEvent)
     serialEvent();
 
-    // Small delay to prevent tight loop (saves power)
-    delay(1);
+    GSENSOR_PROFILE_STOP(LOOP, loopStart);
+
+    // Pause until the next pass; light sleep needs USB serial and BLE off
+    // Sampling runs in its own task, so this never adds sample jitter
+    bool sleepAllowed = !settings.serialEnabled && !bleService.isEnabled() && !wifiStreamer.isEnabled();
+    if (powerMgr.idle(sleepAllowed, sampler.sleepBudgetUs())) {
+        // The drain timer stops in light sleep, so drain straight away
+        sampler.wake();
+    }
+}
+
+/**
+ * @brief Write pending samples as CSV lines
+ *
+ * Format: timestamp,x,y,z,magnitude,peak (filtered values, in g)
+ */
+void streamSerialCsv() {
+    SampleRecord record;
+    for (size_t lines = 0; lines < SERIAL_MAX_LINES_PER_LOOP && serialReader.read(record); lines++) {
+        if (DEBUG_ENABLED && settings.serialEnabled) {
+            AccelData filtered = record.filteredG();
+            Serial.print(timeSync.toSyncedMs(record.timestampUs));
+            Serial.print(",");
+            Serial.print(filtered.x, 3);
+            Serial.print(",");
+            Serial.print(filtered.y, 3);
+            Serial.print(",");
+            Serial.print(filtered.z, 3);
+            Serial.print(",");
+            Serial.print(record.magnitudeG(), 3);
+            Serial.print(",");
+            Serial.println(record.peakG(), 3);
+        }
+    }
+}
+
+/**
+ * @brief Finish the current binary frame and write it to serial
+ *
+ * Frames the USB-CDC buffer has no room for are dropped rather than
+ * blocking the loop; the host sees the gap in sequence numbers.
+ */
+void sendSerialFrame() {
+    size_t length = serialFrame.finish();
+    if (length == 0) {
+        return;
+    }
+
+    if (Serial.availableForWrite() >= static_cast<int>(length)) {
+        Serial.write(serialFrameBuffer, length);
+    } else {
+        serialFramesDropped++;
+    }
+}
+
+/**
+ * @brief Switch the serial output format
+ *
+ * A binary frame in progress is finished first, and binary output starts
+ * from the newest sample rather than a stale backlog.
+ */
+void setSerialFormat(SerialFormat format) {
+    if (format == settings.serialFormat) {
+        return;
+    }
+    if (settings.serialFormat == SerialFormat::BINARY) {
+        sendSerialFrame();
+    } else if (format == SerialFormat::BINARY) {
+        serialReader.skipToLatest();
+    }
+    settings.serialFormat = format;
+}
+
+/**
+ * @brief Write pending samples as batched binary frames
+ *
+ * Raw calibrated counts, SERIAL_BINARY_BATCH_SAMPLES per frame
+ * (see stream_frame.h for the layout).
+ */
+void streamSerialBinary() {
+    SampleRecord record;
+    while (serialReader.read(record)) {
+        if (!settings.serialEnabled) {
+            continue;
+        }
+
+        const RawAccel& counts = record.counts;
+
+        if (serialFrame.count() == 0) {
+            serialFrame.begin(sampler.getSampleRate());
+            serialFrameStartMs = millis();
+        }
+
+        // Time gap too large for a delta: close the frame and start anew
+        if (!serialFrame.add(record.timestampUs, counts)) {
+            sendSerialFrame();
+            serialFrame.begin(sampler.getSampleRate());
+            serialFrameStartMs = millis();
+            serialFrame.add(record.timestampUs, counts);
+        }
+
+        if (serialFrame.count() >= SERIAL_BINARY_BATCH_SAMPLES) {
+            sendSerialFrame();
+        }
+    }
+
+    // Flush a partial frame so low sample rates still stream promptly
+    if (serialFrame.count() > 0 && millis() - serialFrameStartMs >= SERIAL_BINARY_FLUSH_MS) {
+        sendSerialFrame();
+    }
+}
+
+/**
+ * @brief Feed pending samples into BLE batch notifications
+ *
+ * Every sample goes out as raw calibrated counts, as many per
+ * notification as the negotiated MTU allows. The peak value is still
+ * sent periodically on its own characteristic.
+ *
+ * @param now Current time in milliseconds
+ */
+void streamBleBatched(uint32_t now) {
+    uint16_t rateHz = sampler.getSampleRate();
+    SampleRecord record;
+    SampleRecord last;
+    bool haveSample = false;
+
+    while (bleReader.read(record)) {
+        bleService.addBatchSample(record.timestampUs, record.counts, rateHz);
+        last = record;
+        haveSample = true;
+    }
+    bleService.flushBatch();
+
+    // Shared with the legacy stream, so peak subscribers get one update
+    // per interval whichever streams are running
+    if (haveSample && now - lastPeakNotifyTime >= 500) {
+        lastPeakNotifyTime = now;
+        bleService.notifyPeak(timeSync.toSyncedMs(last.timestampUs), last.peakG());
+    }
+}
+
+/**
+ * @brief Send pending raw samples as Wi-Fi frames
+ *
+ * Stops taking samples while a TCP frame is still being sent; they
+ * wait in the ring (and count as dropped if it laps the reader).
+ */
+void streamWifi() {
+    uint16_t rateHz = sampler.getSampleRate();
+    SampleRecord record;
+    while (wifiStreamer.isReady() && wifiReader.read(record)) {
+        wifiStreamer.addSample(record.timestampUs, record.counts, rateHz);
+    }
+    wifiStreamer.flush();
+}
+
+/**
+ * @brief Wi-Fi line for the settings screen, e.g. "UDP 192.168.1.20:5555"
+ *
+ * Shows the address until a receiver attaches
+ */
+const char* wifiStatusLine() {
+    static char line[32];
+    WifiStatus status = wifiStreamer.status();
+    if (status == WifiStatus::WAITING) {
+        // The address receivers need
+        snprintf(line, sizeof(line), "%s %s:%u", wifiModeName(wifiStreamer.getMode()),
+                 wifiStreamer.localIp().toString().c_str(), WIFI_STREAM_PORT);
+    } else if (status == WifiStatus::STREAMING) {
+        snprintf(line, sizeof(line), "%s: Streaming", wifiModeName(wifiStreamer.getMode()));
+    } else {
+        snprintf(line, sizeof(line), "Wi-Fi: %s", wifiStatusName(status));
+    }
+    return line;
+}
+
+/**
+ * @brief Publish impact events completed since the last call
+ */
+void reportImpacts() {
+    if (sampler.capture().eventCount() == lastImpactSequence) {
+        return;
+    }
+
+    ImpactStats stats;
+    if (!sampler.capture().latestStats(stats)) {
+        return;
+    }
+    lastImpactSequence = stats.sequence;
+
+    if (settings.bleEnabled) {
+        bleService.notifyImpact(stats);
+    }
+
+    // Text would corrupt the binary stream, so only announce in CSV mode
+    if (DEBUG_ENABLED && settings.serialEnabled && settings.serialFormat != SerialFormat::BINARY) {
+        printImpactStats(stats);
+    }
+}
+
+/**
+ * @brief Publish window statistics completed since the last call
+ */
+void reportStats() {
+    const WindowStats& stats = sampler.stats();
+    if (stats.summaryCount() == lastStatsSequence) {
+        return;
+    }
+
+    StatsSummary shortWindow;
+    StatsSummary longWindow;
+    if (!stats.latest(StatsWindow::SHORT, shortWindow) || !stats.latest(StatsWindow::LONG, longWindow)) {
+        return;
+    }
+    // A new pair may land between the two copies; send only a matching pair
+    if (shortWindow.sequence != longWindow.sequence) {
+        return;
+    }
+    lastStatsSequence = shortWindow.sequence;
+
+    if (settings.bleEnabled && bleService.isConnected()) {
+        bleService.notifyStats(shortWindow, longWindow);
+    }
+
+    if (DEBUG_ENABLED && settings.serialEnabled && settings.serialFormat == SerialFormat::STATS) {
+        printWindowStats(shortWindow);
+        printWindowStats(longWindow);
+    }
+}
+
+/**
+ * @brief Publish a spectrum completed since the last call
+ */
+void reportSpectrum() {
+    const SpectrumAnalyzer& analyzer = sampler.spectrum();
+    if (analyzer.resultCount() == lastSpectrumSequence || !analyzer.latest(spectrum)) {
+        return;
+    }
+    spectrumValid = true;
+    lastSpectrumSequence = spectrum.sequence;
+
+    if (settings.bleEnabled && bleService.isConnected()) {
+        bleService.notifySpectrum(spectrum);
+    }
+}
+
+/**
+ * @brief Print the newest spectrum peaks and band energies
+ *
+ * Format: Spectrum (channel, rate, bin width, frames): peaks F Hz A g, ...
+ * | bands L-H Hz R g rms, ... (amplitudes are sine amplitudes)
+ */
+void printSpectrum() {
+    static const char CHANNEL_NAMES[] = {'x', 'y', 'z', 'm'};
+
+    if (!spectrumValid) {
+        Serial.printf("Spectrum (%c): no result yet\n",
+                      CHANNEL_NAMES[static_cast<uint8_t>(sampler.spectrum().getChannel())]);
+        return;
+    }
+
+    Serial.printf("Spectrum (%c, %u Hz, %.2f Hz bins, %u frames): peaks",
+                  CHANNEL_NAMES[static_cast<uint8_t>(spectrum.channel)], spectrum.rateHz,
+                  spectrum.binHz(), spectrum.frames);
+    for (uint8_t i = 0; i < spectrum.peakCount; i++) {
+        Serial.printf("%s %.1f Hz %.3f g", i > 0 ? "," : "",
+                      spectrum.peaks[i].frequencyDeciHz / 10.0f, fixedToG(spectrum.peaks[i].amplitude));
+    }
+    Serial.print(" | bands");
+    for (size_t band = 0; band < SPECTRUM_BAND_COUNT; band++) {
+        Serial.printf("%s %u-%u Hz %.3f g rms", band > 0 ? "," : "",
+                      spectrum.bandEdgesHz[band], spectrum.bandEdgesHz[band + 1],
+                      fixedToG(spectrum.bandRms[band]));
+    }
+    Serial.println();
+}
+
+/**
+ * @brief Store and report a calibration run completed since the last call
+ */
+void reportCalibration() {
+    uint32_t count = sampler.calibrationCount();
+    if (count == lastCalibrationCount) {
+        return;
+    }
+    lastCalibrationCount = count;
+
+    CalibrationStatus status = sampler.calibrationStatus();
+    if (status != CalibrationStatus::DONE) {
+        Serial.printf("Calibration %s\n", calibrationStatusName(status));
+        return;
+    }
+
+    // Reason: NVS writes can block for milliseconds, so they happen here
+    // rather than in the sampler task
+    if (!saveCalibration(sampler.getCalibration())) {
+        Serial.println("WARNING: Calibration applied but not stored");
+    }
+    printCalibration();
+}
+
+/**
+ * @brief Print the calibration in use
+ *
+ * Format: Calibration: offsets X, Y, Z g (registers a, b, c; residual x, y, z counts)
+ */
+void printCalibration() {
+    const AccelCalibration& calibration = sampler.getCalibration();
+    RawAccel residual = calibration.residualCounts();
+    Serial.printf("Calibration: offsets %.3f, %.3f, %.3f g (registers %d, %d, %d; residual %d, %d, %d counts)\n",
+                  calibration.offsetG(0), calibration.offsetG(1), calibration.offsetG(2),
+                  calibration.hardware[0], calibration.hardware[1], calibration.hardware[2],
+                  residual.x, residual.y, residual.z);
+}
+
+/**
+ * @brief Print one window summary, one line per channel
+ *
+ * Format: stats,window_ms,end_ms,samples,channel,mean,rms,min,max,crest,above_ms
+ * (channel x, y, z or m; values in g)
+ */
+void printWindowStats(const StatsSummary& summary) {
+    static const char CHANNEL_NAMES[STATS_CHANNELS] = {'x', 'y', 'z', 'm'};
+
+    for (uint8_t ch = 0; ch < STATS_CHANNELS; ch++) {
+        const ChannelStats& stats = summary.channels[ch];
+        Serial.printf("stats,%u,%u,%u,%c,%.3f,%.3f,%.3f,%.3f,%.2f,%u\n",
+                      summary.windowMs, summary.endUs / 1000, summary.sampleCount, CHANNEL_NAMES[ch],
+                      fixedToG(stats.mean), fixedToG(stats.rms), fixedToG(stats.min), fixedToG(stats.max),
+                      stats.crestFactor(), stats.aboveUs / 1000);
+    }
+}
+
+/**
+ * @brief Print an impact event summary
+ *
+ * Format: Impact #n: peak P g at +T us, above threshold D us
+ * (threshold G g, S samples at R Hz)
+ */
+void printImpactStats(const ImpactStats& stats) {
+    Serial.printf("Impact #%u: peak %.2f g at +%u us, above threshold %u us "
+                  "(threshold %.1f g, %u samples at %u Hz)\n",
+                  stats.sequence, stats.peakG(), stats.peakOffsetUs, stats.aboveThresholdUs,
+                  stats.thresholdG(), stats.sampleCount, stats.rateHz);
+}
+
+/**
+ * @brief Dump the samples of the newest impact event
+ *
+ * Format: summary line, then one line per sample:
+ * time_us,x,y,z (time relative to the trigger, calibrated values in g)
+ */
+void dumpImpact() {
+    if (!sampler.capture().latestEvent(impactDump)) {
+        Serial.println("No impact captured");
+        return;
+    }
+
+    const ImpactStats& stats = impactDump.stats;
+    printImpactStats(stats);
+
+    for (uint16_t i = 0; i < stats.sampleCount; i++) {
+        int32_t offsetUs = static_cast<int32_t>(
+            (static_cast<int64_t>(i - stats.preTriggerSamples) * 1000000) / stats.rateHz);
+        const RawAccel& counts = impactDump.samples[i];
+        Serial.printf("%d,%.3f,%.3f,%.3f\n", offsetUs,
+                      counts.x * ADXL375_SCALE_FACTOR,
+                      counts.y * ADXL375_SCALE_FACTOR,
+                      counts.z * ADXL375_SCALE_FACTOR);
+    }
+}
+
+/**
+ * @brief Print filter chain settings on one line
+ */
+void printFilterConfig(const FilterConfig& config) {
+    int preset = findFilterPreset(config);
+    Serial.printf("Filter: %s (DC %s, HP %u Hz, LP %u Hz, avg %u ms; 0 = off)\n",
+                  preset >= 0 ? filterPresetName(preset) : "custom",
+                  config.dcBlock ? "on" : "off",
+                  config.highPassHz, config.lowPassHz, config.averageMs);
 }
 
 /**
@@ -343,29 +1163,195 @@ void loop() {
  *
  * Commands:
  *   'r' - Reset peak value
- *   'c' - Calibrate (reset filters)
+ *   'c' - Calibrate zero-g offsets (sensor still, one axis vertical; stored in NVS)
+ *   'x' - Reset filters
  *   's1' - Set sample rate to 100 Hz
  *   's2' - Set sample rate to 200 Hz
  *   's3' - Set sample rate to 400 Hz
  *   's4' - Set sample rate to 800 Hz
+ *   's5' - Set sample rate to 1600 Hz
+ *   's6' - Set sample rate to 3200 Hz
+ *   'b' - Binary sample stream (batched frames, see stream_frame.h)
+ *   'a' - ASCII CSV sample stream (default)
+ *   'v' - Window statistics instead of samples (one summary per second)
+ *   'e' - Print the newest impact event summary
+ *   'd' - Dump the newest impact event samples
+ *   't<g>' - Set the impact threshold in g (e.g. t25); 't' alone prints it
+ *   'w' - Toggle shock-wake mode (sample only around impacts; needs INT1)
+ *   'l' - Toggle logging to flash
+ *   'f0'-'f3' - Filter preset: raw, smooth, lowpass, vibration; 'f' alone prints it
+ *   'px'/'py'/'pz'/'pm' - Spectrum channel; 'p' alone prints the newest spectrum
+ *   'h' - Toggle headless fast boot (no splash, sampling starts first)
+ *   'o0'-'o2' - Power profile: performance, balanced, low power; 'o' alone prints the power report
  *   '?' - Print current status
+ *
+ * Bytes starting with SERIAL_FRAME_SYNC are log transfer and command
+ * protocol frames (see serial_frame.h), not commands. The command
+ * protocol reaches every setting here, and the 25 and 50 Hz rates, with
+ * status replies for programs; these characters remain the console for
+ * a person at a terminal.
  */
 void serialEvent() {
     static bool expectingRateDigit = false;
+    static bool expectingThreshold = false;
+    static bool expectingFilterPreset = false;
+    static bool expectingSpectrumChannel = false;
+    static bool expectingPowerProfile = false;
+    static bool expectingProfileReset = false;
+    static bool expectingWifiMode = false;
+    static bool expectingSyncReset = false;
+    static uint32_t thresholdValue = 0;
+    static uint8_t thresholdDigits = 0;
 
     while (Serial.available()) {
         char cmd = Serial.read();
+        powerMgr.noteActivity(millis());
+
+        // Binary log transfer and command frames
+        SerialFrameParser::Result frame = serialFrameParser.feed(static_cast<uint8_t>(cmd));
+        if (frame == SerialFrameParser::Result::COMPLETE) {
+            if (serialFrameParser.type() == SerialFrameType::COMMAND) {
+                uint8_t response[COMMAND_MAX_MESSAGE];
+                size_t responseLength = commandExecutor.run(CommandTransport::SERIAL_PORT, serialFrameParser.message(),
+                                                            serialFrameParser.length(), response, sizeof(response));
+                if (responseLength > 0) {
+                    writeSerialFrame(SerialFrameType::COMMAND, response, responseLength);
+                }
+            } else {
+                uint8_t reply[LOG_TRANSFER_MAX_REPLY];
+                size_t replyLength = logTransfer.handleRequest(LogTransport::SERIAL_PORT, serialFrameParser.message(),
+                                                                serialFrameParser.length(), reply);
+                if (replyLength > 0) {
+                    writeSerialFrame(SerialFrameType::LOG_TRANSFER, reply, replyLength);
+                }
+            }
+            continue;
+        }
+        if (frame == SerialFrameParser::Result::PENDING) {
+            continue;
+        }
+
+        // Collect threshold digits after 't' command
+        if (expectingThreshold) {
+            if (cmd >= '0' && cmd <= '9' && thresholdDigits < 3) {
+                thresholdValue = thresholdValue * 10 + (cmd - '0');
+                thresholdDigits++;
+                continue;
+            }
+
+            expectingThreshold = false;
+            if (thresholdDigits == 0) {
+                Serial.printf("Impact threshold: %.1f g\n", sampler.capture().getThresholdG());
+            } else if (sampler.setImpactThresholdG(static_cast<float>(thresholdValue))) {
+                Serial.printf("Impact threshold: %u g\n", thresholdValue);
+            } else {
+                Serial.printf("Invalid threshold. Use t%d-t%d (g)\n",
+                              static_cast<int>(IMPACT_MIN_THRESHOLD_G), static_cast<int>(ADXL375_MAX_G));
+            }
+            if (cmd >= '0' && cmd <= '9') {
+                continue;  // Excess digits
+            }
+        }
+
+        // Handle preset digit after 'f' command
+        if (expectingFilterPreset) {
+            expectingFilterPreset = false;
+            FilterConfig config = {};
+            if (cmd >= '0' && cmd <= '9') {
+                if (filterPreset(cmd - '0', config) && sampler.setFilterConfig(config)) {
+                    printFilterConfig(config);
+                } else {
+                    Serial.printf("Invalid preset. Use f0-f%d\n", FILTER_PRESET_COUNT - 1);
+                }
+                continue;
+            }
+            printFilterConfig(sampler.getFilterConfig());
+        }
+
+        // Handle profile digit after 'o' command
+        if (expectingPowerProfile) {
+            expectingPowerProfile = false;
+            if (cmd >= '0' && cmd <= '9') {
+                if (cmd - '0' <= static_cast<int>(PowerProfile::LOW_POWER)) {
+                    applyPowerProfile(static_cast<PowerProfile>(cmd - '0'));
+                } else {
+                    Serial.println("Invalid profile. Use o0=performance, o1=balanced, o2=low power");
+                }
+                continue;
+            }
+            printPowerReport();
+        }
+
+        // Handle digit after 'n' command
+        if (expectingWifiMode) {
+            expectingWifiMode = false;
+            if (cmd >= '0' && cmd <= '9') {
+                if (cmd - '0' <= static_cast<int>(WifiMode::TCP)) {
+                    settings.wifiMode = static_cast<WifiMode>(cmd - '0');
+                    wifiStreamer.setMode(settings.wifiMode);
+                    printWifiStatus();
+                } else {
+                    Serial.println("Invalid Wi-Fi mode. Use n0=off, n1=UDP, n2=TCP");
+                }
+                continue;
+            }
+            printWifiStatus();
+        }
+
+        // Handle 'r' after 'y' command
+        if (expectingSyncReset) {
+            expectingSyncReset = false;
+            if (cmd == 'r' || cmd == 'R') {
+                timeSync.reset();
+                Serial.println("Time sync reset (local time)");
+                continue;
+            }
+            printTimeSync();
+        }
+
+        // Handle 'r' after 'i' command
+        if (expectingProfileReset) {
+            expectingProfileReset = false;
+            if (cmd == 'r' || cmd == 'R') {
+                GSENSOR_PROFILE_RESET();
+                Serial.println("Profile reset");
+                continue;
+            }
+            printProfile();
+        }
+
+        // Handle channel letter after 'p' command
+        if (expectingSpectrumChannel) {
+            expectingSpectrumChannel = false;
+            SpectrumChannel channel;
+            bool selected = true;
+            switch (cmd) {
+                case 'x': case 'X': channel = SpectrumChannel::X; break;
+                case 'y': case 'Y': channel = SpectrumChannel::Y; break;
+                case 'z': case 'Z': channel = SpectrumChannel::Z; break;
+                case 'm': case 'M': channel = SpectrumChannel::MAGNITUDE; break;
+                default: selected = false; break;
+            }
+            if (selected) {
+                sampler.spectrum().setChannel(channel);
+                Serial.printf("Spectrum channel: %c\n", cmd | 0x20);
+                continue;
+            }
+            printSpectrum();
+        }
 
         // Handle rate digit after 's' command
         if (expectingRateDigit) {
             expectingRateDigit = false;
             switch (cmd) {
-                case '1': setSampleRate(ADXL_RATE_100HZ); break;
-                case '2': setSampleRate(ADXL_RATE_200HZ); break;
-                case '3': setSampleRate(ADXL_RATE_400HZ); break;
-                case '4': setSampleRate(ADXL_RATE_800HZ); break;
+                case '1': sampler.setSampleRate(ADXL_RATE_100HZ); break;
+                case '2': sampler.setSampleRate(ADXL_RATE_200HZ); break;
+                case '3': sampler.setSampleRate(ADXL_RATE_400HZ); break;
+                case '4': sampler.setSampleRate(ADXL_RATE_800HZ); break;
+                case '5': sampler.setSampleRate(ADXL_RATE_1600HZ); break;
+                case '6': sampler.setSampleRate(ADXL_RATE_3200HZ); break;
                 default:
-                    Serial.println("Invalid rate. Use s1=100Hz, s2=200Hz, s3=400Hz, s4=800Hz");
+                    Serial.println("Invalid rate. Use s1=100Hz, s2=200Hz, s3=400Hz, s4=800Hz, s5=1600Hz, s6=3200Hz");
                     break;
             }
             continue;
@@ -374,7 +1360,7 @@ void serialEvent() {
         switch (cmd) {
             case 'r':
             case 'R':
-                processor.resetPeak();
+                sampler.requestPeakReset();
                 display.resetGaugeMax();
                 if (DEBUG_ENABLED && settings.serialEnabled) {
                     Serial.println("Peak reset");
@@ -383,7 +1369,14 @@ void serialEvent() {
 
             case 'c':
             case 'C':
-                processor.reset();
+                if (sampler.requestCalibration()) {
+                    Serial.printf("Calibrating: keep the sensor still for %u ms\n", CALIBRATION_WINDOW_MS);
+                }
+                break;
+
+            case 'x':
+            case 'X':
+                sampler.requestFilterReset();
                 if (DEBUG_ENABLED && settings.serialEnabled) {
                     Serial.println("Filters reset");
                 }
@@ -394,9 +1387,119 @@ void serialEvent() {
                 expectingRateDigit = true;
                 break;
 
+            case 'b':
+            case 'B':
+                setSerialFormat(SerialFormat::BINARY);
+                break;
+
+            case 'a':
+            case 'A':
+                setSerialFormat(SerialFormat::CSV);
+                break;
+
+            case 'v':
+            case 'V':
+                setSerialFormat(SerialFormat::STATS);
+                break;
+
+            case 'e':
+            case 'E':
+                {
+                    ImpactStats stats;
+                    if (sampler.capture().latestStats(stats)) {
+                        printImpactStats(stats);
+                    } else {
+                        Serial.println("No impact captured");
+                    }
+                }
+                break;
+
+            case 'd':
+            case 'D':
+                dumpImpact();
+                break;
+
+            case 't':
+            case 'T':
+                expectingThreshold = true;
+                thresholdValue = 0;
+                thresholdDigits = 0;
+                break;
+
+            case 'w':
+            case 'W':
+                sampler.setShockWake(!sampler.isShockWakeEnabled());
+                break;
+
+            case 'f':
+            case 'F':
+                expectingFilterPreset = true;
+                break;
+
+            case 'p':
+            case 'P':
+                expectingSpectrumChannel = true;
+                break;
+
+            case 'o':
+            case 'O':
+                expectingPowerProfile = true;
+                break;
+
+            case 'i':
+            case 'I':
+                expectingProfileReset = true;
+                break;
+
+            case 'n':
+            case 'N':
+                expectingWifiMode = true;
+                break;
+
+            case 'y':
+            case 'Y':
+                expectingSyncReset = true;
+                break;
+
+            case 'h':
+            case 'H':
+                settings.fastBoot = !settings.fastBoot;
+                Serial.printf("Fast boot: %s (from next power-up)\n", settings.fastBoot ? "on" : "off");
+                break;
+
+            case 'l':
+            case 'L':
+                if (sampler.logger().isLogging()) {
+                    sampler.stopLogging();
+                    Serial.println("Logging: off");
+                } else if (sampler.startLogging()) {
+                    Serial.println("Logging: on");
+                }
+                break;
+
             case '?':
-                Serial.printf("Rate: %d Hz | Commands: r=reset peak, c=calibrate, s1-s4=rate, ?=status\n",
-                              currentSampleRateHz);
+                Serial.printf("Rate: %d Hz | Serial dropped: %u samples, %u frames | "
+                              "Impacts: %u (threshold %.1f g, shock wake %s) | "
+                              "Log: %s, %u/%u blocks, %u dropped | "
+                              "Commands: r=reset peak, c=calibrate, x=reset filters, s1-s6=rate, b=binary, a=CSV, v=stats, "
+                              "e=impact, d=dump impact, t<g>=threshold, w=shock wake, l=log, f0-f3=filter, p[x|y|z|m]=spectrum, h=fast boot, o0-o2=power, n0-n2=Wi-Fi, y=time sync, yr=reset sync, i=profile, ir=reset profile, ?=status\n",
+                              sampler.getSampleRate(), serialReader.dropped(), serialFramesDropped,
+                              sampler.capture().eventCount(), sampler.capture().getThresholdG(),
+                              sampler.isShockWakeEnabled() ? "on" : "off",
+                              sampler.logger().isLogging() ? "on" : "off",
+                              sampler.logger().logBlocks(), sampler.logger().capacityBlocks(),
+                              sampler.logger().droppedSamples());
+                printFilterConfig(sampler.getFilterConfig());
+                printCalibration();
+                Serial.printf("Config: %s at boot%s, fast boot %s\n",
+                              configStore.wasLoaded() ? "restored" : "defaults",
+                              configStore.isPending() ? ", change not yet saved" : "",
+                              settings.fastBoot ? "on" : "off");
+                printPowerReport();
+                printBleStatus();
+                printWifiStatus();
+                printTimeSync();
+                printLogTransfer();
                 break;
 
             default:
@@ -0,0 +1,214 @@
+/**
+ * @file power_manager.cpp
+ * @brief Power policy implementation
+ */
+
+#include "power_manager.h"
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+/**
+ * @brief Inactivity timeouts of a profile (0 = never)
+ */
+static void profileTimeouts(PowerProfile profile, uint32_t& dimMs, uint32_t& offMs) {
+    switch (profile) {
+        case PowerProfile::BALANCED:
+            dimMs = POWER_BALANCED_DIM_MS;
+            offMs = POWER_BALANCED_OFF_MS;
+            break;
+        case PowerProfile::LOW_POWER:
+            dimMs = POWER_LOW_DIM_MS;
+            offMs = POWER_LOW_OFF_MS;
+            break;
+        default:
+            dimMs = 0;
+            offMs = 0;
+            break;
+    }
+}
+
+static uint8_t backlightDuty(BacklightState state) {
+    switch (state) {
+        case BacklightState::DIM: return BACKLIGHT_DIM;
+        case BacklightState::OFF: return 0;
+        default:                  return BACKLIGHT_FULL;
+    }
+}
+
+const char* powerProfileName(PowerProfile profile) {
+    switch (profile) {
+        case PowerProfile::PERFORMANCE: return "performance";
+        case PowerProfile::BALANCED:    return "balanced";
+        case PowerProfile::LOW_POWER:   return "low power";
+    }
+    return "unknown";
+}
+
+float PowerReport::batteryHours() const {
+    float total = totalMa();
+    return total > 0.0f ? POWER_REPORT_BATTERY_MAH / total : 0.0f;
+}
+
+PowerManager::PowerManager(Display& display, BleService& ble)
+    : display_(display)
+    , ble_(ble)
+    , profile_(PowerProfile::PERFORMANCE)
+    , backlight_(BacklightState::ON)
+    , lastActivityMs_(0)
+    , reportStartMs_(0)
+    , lastUpdateMs_(0)
+    , sleepUs_(0)
+    , backlightDutyMs_(0)
+    , panelOnMs_(0)
+    , advertisingMs_(0)
+    , connectedMs_(0) {
+}
+
+void PowerManager::setProfile(PowerProfile profile, uint32_t nowMs) {
+    profile_ = profile;
+    setCpuFrequencyMhz(profile == PowerProfile::LOW_POWER ? POWER_LOW_CPU_MHZ : POWER_FULL_CPU_MHZ);
+    ble_.setPowerProfile(profile);
+
+    lastActivityMs_ = nowMs;
+    setBacklight(BacklightState::ON);
+    resetReport(nowMs);
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("Power profile: %s (CPU %u MHz)\n", powerProfileName(profile), getCpuFrequencyMhz());
+    }
+}
+
+bool PowerManager::noteActivity(uint32_t nowMs) {
+    update(nowMs);  // Account the time before the change
+    lastActivityMs_ = nowMs;
+    if (backlight_ == BacklightState::ON) {
+        return false;
+    }
+    setBacklight(BacklightState::ON);
+    return true;
+}
+
+void PowerManager::update(uint32_t nowMs) {
+    uint32_t elapsedMs = nowMs - lastUpdateMs_;
+    lastUpdateMs_ = nowMs;
+
+    backlightDutyMs_ += static_cast<uint64_t>(elapsedMs) * backlightDuty(backlight_);
+    if (backlight_ != BacklightState::OFF) {
+        panelOnMs_ += elapsedMs;
+    }
+    if (ble_.isEnabled()) {
+        // Each connection has its own events; advertising continues
+        // while there is room for another client
+        size_t clients = ble_.clientCount();
+        connectedMs_ += elapsedMs * clients;
+        if (clients < BLE_MAX_CLIENTS) {
+            advertisingMs_ += elapsedMs;
+        }
+    }
+
+    uint32_t dimMs;
+    uint32_t offMs;
+    profileTimeouts(profile_, dimMs, offMs);
+    uint32_t inactiveMs = nowMs - lastActivityMs_;
+
+    BacklightState target = BacklightState::ON;
+    if (offMs != 0 && inactiveMs >= offMs) {
+        target = BacklightState::OFF;
+    } else if (dimMs != 0 && inactiveMs >= dimMs) {
+        target = BacklightState::DIM;
+    }
+    if (target != backlight_) {
+        setBacklight(target);
+    }
+}
+
+bool PowerManager::idle(bool sleepAllowed, uint32_t budgetUs) {
+    if (sleepAllowed && profile_ == PowerProfile::LOW_POWER && backlight_ == BacklightState::OFF) {
+        uint32_t durationUs = POWER_SLEEP_MAX_MS * 1000;
+        if (budgetUs != 0 && budgetUs < durationUs) {
+            durationUs = budgetUs;
+        }
+        lightSleep(durationUs);
+        return true;
+    }
+
+    delay(profile_ == PowerProfile::LOW_POWER ? POWER_LOW_IDLE_DELAY_MS : POWER_FULL_IDLE_DELAY_MS);
+    return false;
+}
+
+PowerReport PowerManager::report(uint32_t nowMs) const {
+    PowerReport report = {};
+    report.windowMs = nowMs - reportStartMs_;
+    if (report.windowMs == 0) {
+        return report;
+    }
+
+    float window = static_cast<float>(report.windowMs);
+    report.sleepFraction = static_cast<float>(sleepUs_) / 1000.0f / window;
+    if (report.sleepFraction > 1.0f) {
+        report.sleepFraction = 1.0f;
+    }
+
+    float activeMa = profile_ == PowerProfile::LOW_POWER ? POWER_CPU_LOW_MA : POWER_CPU_FULL_MA;
+    report.cpuMa = (1.0f - report.sleepFraction) * activeMa + report.sleepFraction * POWER_LIGHT_SLEEP_MA;
+    report.backlightMa = static_cast<float>(backlightDutyMs_) / BACKLIGHT_FULL / window * POWER_BACKLIGHT_FULL_MA;
+    report.panelMa = panelOnMs_ / window * POWER_PANEL_MA;
+
+    // Charge per radio event over the event interval (uC / ms = mA)
+    float advIntervalMs = ble_.getAdvertisingInterval() * 0.625f;
+    uint16_t connInterval = ble_.getConnInterval();
+    float connIntervalMs = (connInterval != 0 ? connInterval : BLE_IDLE_CONN_INTERVAL_MAX) * 1.25f;
+    report.radioMa = advertisingMs_ / window * POWER_BLE_ADV_EVENT_UC / advIntervalMs
+                   + connectedMs_ / window * POWER_BLE_CONN_EVENT_UC / connIntervalMs;
+
+    report.sensorMa = POWER_SENSOR_MA;
+    return report;
+}
+
+void PowerManager::resetReport(uint32_t nowMs) {
+    reportStartMs_ = nowMs;
+    lastUpdateMs_ = nowMs;
+    sleepUs_ = 0;
+    backlightDutyMs_ = 0;
+    panelOnMs_ = 0;
+    advertisingMs_ = 0;
+    connectedMs_ = 0;
+}
+
+void PowerManager::setBacklight(BacklightState state) {
+    if (state != BacklightState::OFF && backlight_ == BacklightState::OFF) {
+        display_.setPanelSleep(false);
+    }
+    display_.setBacklight(backlightDuty(state));
+    if (state == BacklightState::OFF) {
+        display_.setPanelSleep(true);
+    }
+    backlight_ = state;
+}
+
+void PowerManager::lightSleep(uint32_t durationUs) {
+    esp_sleep_enable_timer_wakeup(durationUs);
+
+    // Reason: ESP32-C3 GPIO wake-up reuses the pin's interrupt type, so
+    // INT1 becomes level-triggered while asleep. Its handler is masked
+    // meanwhile, or a still-high line would fire it continuously.
+    if (PIN_ADXL_INT1 >= 0) {
+        gpio_num_t int1 = static_cast<gpio_num_t>(PIN_ADXL_INT1);
+        gpio_intr_disable(int1);
+        gpio_wakeup_enable(int1, GPIO_INTR_HIGH_LEVEL);
+    }
+    gpio_wakeup_enable(static_cast<gpio_num_t>(PIN_BUTTON), GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    uint32_t startUs = micros();
+    esp_light_sleep_start();
+    sleepUs_ += micros() - startUs;
+
+    gpio_wakeup_disable(static_cast<gpio_num_t>(PIN_BUTTON));
+    if (PIN_ADXL_INT1 >= 0) {
+        gpio_num_t int1 = static_cast<gpio_num_t>(PIN_ADXL_INT1);
+        gpio_wakeup_disable(int1);
+        gpio_set_intr_type(int1, GPIO_INTR_POSEDGE);
+        gpio_intr_enable(int1);
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * @file power_manager.h
+ * @brief Power profiles: backlight timeouts, CPU clock, light sleep
+ *
+ * The profile decides how long the backlight stays on after the last
+ * touch, button press or serial command, the CPU clock, the BLE radio
+ * settings and how loop() idles. In the low-power profile loop() enters
+ * light sleep between FIFO drains once nothing needs it awake: display
+ * off, BLE and serial disabled. It wakes on the RTC timer before the FIFO
+ * can fill, on ADXL375 INT1 (watermark or shock) if wired, and on the
+ * button.
+ *
+ * Nothing here is measured: the power report is a model built from the
+ * time spent in each state and the POWER_*_MA figures in config.h.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "settings.h"
+#include "display.h"
+#include "ble_service.h"
+
+/**
+ * @brief Backlight state set by the inactivity timeouts
+ */
+enum class BacklightState : uint8_t {
+    ON = 0,
+    DIM,
+    OFF   ///< Backlight off and panel asleep
+};
+
+/**
+ * @brief Estimated supply current, averaged since the report was reset
+ */
+struct PowerReport {
+    uint32_t windowMs;      // Time the averages cover
+    float sleepFraction;    // Share of the window spent in light sleep
+    float cpuMa;
+    float backlightMa;
+    float panelMa;
+    float radioMa;
+    float sensorMa;
+
+    /**
+     * @brief Total estimated current in mA
+     */
+    float totalMa() const { return cpuMa + backlightMa + panelMa + radioMa + sensorMa; }
+
+    /**
+     * @brief Estimated runtime on a POWER_REPORT_BATTERY_MAH battery
+     */
+    float batteryHours() const;
+};
+
+/**
+ * @brief Get a power profile's name
+ */
+const char* powerProfileName(PowerProfile profile);
+
+/**
+ * @brief Power policy run from loop()
+ *
+ * Not thread-safe: call it from loop() only.
+ */
+class PowerManager {
+public:
+    PowerManager(Display& display, BleService& ble);
+
+    /**
+     * @brief Apply a profile's clock, radio and timeouts
+     *
+     * Turns the backlight fully on and restarts the power report.
+     *
+     * @param profile Power profile
+     * @param nowMs Current time (millis())
+     */
+    void setProfile(PowerProfile profile, uint32_t nowMs);
+
+    /**
+     * @brief Get the active profile
+     */
+    PowerProfile getProfile() const { return profile_; }
+
+    /**
+     * @brief Record user activity and restore the backlight
+     *
+     * @param nowMs Current time (millis())
+     * @return true if the backlight was dimmed or off, so the caller can
+     *         treat the input as a wake-up only
+     */
+    bool noteActivity(uint32_t nowMs);
+
+    /**
+     * @brief Apply the inactivity timeouts and account time per state
+     *
+     * @param nowMs Current time (millis())
+     */
+    void update(uint32_t nowMs);
+
+    /**
+     * @brief Check if the panel is worth drawing to
+     */
+    bool isDisplayOn() const { return backlight_ != BacklightState::OFF; }
+
+    /**
+     * @brief Get the backlight state
+     */
+    BacklightState getBacklight() const { return backlight_; }
+
+    /**
+     * @brief Pause at the end of a loop() pass
+     *
+     * Light-sleeps in the low-power profile when the caller allows it and
+     * the display is off; otherwise waits the profile's idle delay.
+     *
+     * @param sleepAllowed Nothing outside this class needs the CPU awake
+     * @param budgetUs Longest sleep before the FIFO needs draining
+     *                 (Sampler::sleepBudgetUs(), 0 = no limit)
+     * @return true if the CPU slept (the sampler should be woken)
+     */
+    bool idle(bool sleepAllowed, uint32_t budgetUs);
+
+    /**
+     * @brief Estimate the supply current since the last reset
+     *
+     * @param nowMs Current time (millis())
+     */
+    PowerReport report(uint32_t nowMs) const;
+
+    /**
+     * @brief Restart the averages behind report()
+     */
+    void resetReport(uint32_t nowMs);
+
+private:
+    Display& display_;
+    BleService& ble_;
+    PowerProfile profile_;
+    BacklightState backlight_;
+    uint32_t lastActivityMs_;
+
+    // Time per state since resetReport()
+    uint32_t reportStartMs_;
+    uint32_t lastUpdateMs_;
+    uint64_t sleepUs_;
+    uint64_t backlightDutyMs_;  // Milliseconds x PWM duty (0-255)
+    uint32_t panelOnMs_;
+    uint32_t advertisingMs_;
+    uint32_t connectedMs_;      // Summed over connected clients
+
+    void setBacklight(BacklightState state);
+    void lightSleep(uint32_t durationUs);
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,98 @@
+/**
+ * @file profiler.cpp
+ * @brief Hot-path timing implementation
+ */
+
+#include "profiler.h"
+
+const char* profileStageName(ProfileStage stage) {
+    switch (stage) {
+        case ProfileStage::FIFO_READ:      return "fifo_read";
+        case ProfileStage::PROCESS:        return "process";
+        case ProfileStage::DRAIN:          return "drain";
+        case ProfileStage::DRAIN_INTERVAL: return "drain_interval";
+        case ProfileStage::DISPLAY:        return "display";
+        case ProfileStage::DISPLAY_PUSH:   return "display_push";
+        case ProfileStage::TOUCH:          return "touch";
+        case ProfileStage::BLE_NOTIFY:     return "ble_notify";
+        case ProfileStage::LOOP:           return "loop";
+        case ProfileStage::COUNT:          break;
+    }
+    return "unknown";
+}
+
+#if GSENSOR_PROFILING
+
+Profiler profiler;
+
+/**
+ * @brief Start a summary with no timings
+ */
+static void clearSummary(ProfileSummary& summary) {
+    summary = {};
+    summary.minCycles = UINT32_MAX;
+}
+
+Profiler::Profiler()
+    : stages_{}
+    , counters_{}
+    , generation_(0)
+    , cpuMhz_(POWER_FULL_CPU_MHZ)
+    , resetMs_(0) {
+    for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        clearSummary(stages_[i].summary);
+    }
+}
+
+void Profiler::record(ProfileStage stage, uint32_t cycles) {
+    Stage& entry = stages_[static_cast<size_t>(stage)];
+
+    uint32_t generation = generation_.load(std::memory_order_acquire);
+    if (entry.generation != generation) {
+        clearSummary(entry.summary);
+        entry.generation = generation;
+    }
+
+    ProfileSummary& summary = entry.summary;
+    summary.count++;
+    summary.totalCycles += cycles;
+    if (cycles < summary.minCycles) {
+        summary.minCycles = cycles;
+    }
+    if (cycles > summary.maxCycles) {
+        summary.maxCycles = cycles;
+    }
+
+    // Power-of-two buckets: one count-leading-zeros, no division
+    int bit = cycles != 0 ? 31 - __builtin_clz(cycles) : 0;
+    int bucket = bit - PROFILE_HISTOGRAM_FIRST_BIT;
+    if (bucket < 0) {
+        bucket = 0;
+    } else if (bucket >= PROFILE_HISTOGRAM_BUCKETS) {
+        bucket = PROFILE_HISTOGRAM_BUCKETS - 1;
+    }
+    summary.histogram[bucket]++;
+}
+
+void Profiler::reset() {
+    for (size_t i = 0; i < PROFILE_COUNTER_COUNT; i++) {
+        counters_[i].store(0, std::memory_order_relaxed);
+    }
+    cpuMhz_.store(getCpuFrequencyMhz(), std::memory_order_relaxed);
+    resetMs_.store(millis(), std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+void Profiler::summary(ProfileStage stage, ProfileSummary& out) const {
+    const Stage& entry = stages_[static_cast<size_t>(stage)];
+    if (entry.generation != generation_.load(std::memory_order_acquire)) {
+        clearSummary(out);  // Reset, not yet recorded again
+    } else {
+        out = entry.summary;
+    }
+    if (out.count == 0) {
+        out.minCycles = 0;
+    }
+}
+
+#endif // GSENSOR_PROFILING
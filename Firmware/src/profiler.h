@@ -0,0 +1,199 @@
+/**
+ * @file profiler.h
+ * @brief Compile-time optional hot-path timing
+ *
+ * Build with -DGSENSOR_PROFILING=1 (see platformio.ini) to time each
+ * stage with the CPU cycle counter and count coalesced sampler wake-ups
+ * and FIFO overruns. Without it every GSENSOR_PROFILE_* macro compiles
+ * to nothing and no profiler object exists.
+ *
+ * Each stage is recorded by one task only (FIFO read, processing and
+ * drain intervals by the sampler, touch by the touch task, the rest by
+ * loop()), so recording takes no lock. Summaries are read without one
+ * too and may lag a record in progress by one sample.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+#ifndef GSENSOR_PROFILING
+#define GSENSOR_PROFILING 0
+#endif
+
+/**
+ * @brief Timed stages
+ */
+enum class ProfileStage : uint8_t {
+    FIFO_READ = 0,   ///< Sampler: I2C FIFO burst (accel readFifo)
+    PROCESS,         ///< Sampler: filter chain, one sample
+    DRAIN,           ///< Sampler: one whole drain (read, process, publish, feed consumers)
+    DRAIN_INTERVAL,  ///< Sampler: start-to-start time between drains (jitter)
+    DISPLAY,         ///< loop(): one screen update
+    DISPLAY_PUSH,    ///< loop(): queueing one band for DMA (pushImageDMA)
+    TOUCH,           ///< Touch task: one controller read
+    BLE_NOTIFY,      ///< loop(): BLE sample notifications
+    LOOP,            ///< loop(): one pass, excluding the idle pause
+    COUNT
+};
+
+constexpr size_t PROFILE_STAGE_COUNT = static_cast<size_t>(ProfileStage::COUNT);
+
+/**
+ * @brief Event counters
+ */
+enum class ProfileCounter : uint8_t {
+    COALESCED_WAKES = 0,  ///< Sampler notifications merged because the task ran late
+    FIFO_OVERRUNS,        ///< Drains that found the FIFO full (samples may be lost)
+    COUNT
+};
+
+constexpr size_t PROFILE_COUNTER_COUNT = static_cast<size_t>(ProfileCounter::COUNT);
+
+/**
+ * @brief Short name of a stage (for serial output)
+ */
+const char* profileStageName(ProfileStage stage);
+
+/**
+ * @brief Timing summary of one stage, in CPU cycles
+ */
+struct ProfileSummary {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    // Bucket k counts times below 2^(PROFILE_HISTOGRAM_FIRST_BIT + k + 1)
+    // cycles; the last bucket is open-ended
+    uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+
+    /**
+     * @brief Mean time in cycles
+     */
+    uint32_t averageCycles() const {
+        return count > 0 ? static_cast<uint32_t>(totalCycles / count) : 0;
+    }
+};
+
+#if GSENSOR_PROFILING
+
+/**
+ * @brief Per-stage accumulators and event counters
+ */
+class Profiler {
+public:
+    Profiler();
+
+    /**
+     * @brief Read the cycle counter (stops during light sleep)
+     */
+    static uint32_t cycles() { return ESP.getCycleCount(); }
+
+    /**
+     * @brief Convert a wall-clock time to cycles at the current clock
+     *
+     * For intervals that may include light sleep, timed with micros().
+     */
+    uint32_t usToCycles(uint32_t us) const {
+        uint64_t cycles = static_cast<uint64_t>(us) * cpuMhz_.load(std::memory_order_relaxed);
+        return cycles > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(cycles);  // Saturate, do not wrap
+    }
+
+    /**
+     * @brief Add one timing (only from the stage's own task)
+     */
+    void record(ProfileStage stage, uint32_t cycles);
+
+    /**
+     * @brief Add to an event counter (any task)
+     */
+    void count(ProfileCounter counter, uint32_t n) {
+        counters_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Clear everything (thread-safe)
+     *
+     * Also picks up the current CPU clock, so call it after a change.
+     * Each stage is cleared by its own task at its next record.
+     */
+    void reset();
+
+    /**
+     * @brief Copy one stage's summary
+     */
+    void summary(ProfileStage stage, ProfileSummary& out) const;
+
+    /**
+     * @brief Get an event counter
+     */
+    uint32_t counter(ProfileCounter counter) const {
+        return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief CPU clock the figures were taken at
+     */
+    uint32_t cpuMhz() const { return cpuMhz_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Time since the last reset in ms
+     */
+    uint32_t windowMs() const { return millis() - resetMs_.load(std::memory_order_relaxed); }
+
+private:
+    struct Stage {
+        ProfileSummary summary;
+        uint32_t generation;  // Reset generation this summary belongs to
+    };
+
+    Stage stages_[PROFILE_STAGE_COUNT];
+    std::atomic<uint32_t> counters_[PROFILE_COUNTER_COUNT];
+    std::atomic<uint32_t> generation_;
+    std::atomic<uint32_t> cpuMhz_;
+    std::atomic<uint32_t> resetMs_;
+};
+
+extern Profiler profiler;
+
+/**
+ * @brief Times the enclosing scope into one stage
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : stage_(stage), start_(Profiler::cycles()) {}
+    ~ProfileScope() { profiler.record(stage_, Profiler::cycles() - start_); }
+
+private:
+    ProfileStage stage_;
+    uint32_t start_;
+};
+
+#define GSENSOR_PROFILE_JOIN_(a, b) a##b
+#define GSENSOR_PROFILE_NAME_(line) GSENSOR_PROFILE_JOIN_(profileScope_, line)
+
+// Time from here to the end of the enclosing scope
+#define GSENSOR_PROFILE_SCOPE(stage) ProfileScope GSENSOR_PROFILE_NAME_(__LINE__)(ProfileStage::stage)
+// Explicit start / stop where a scope does not fit
+#define GSENSOR_PROFILE_START(var) uint32_t var = Profiler::cycles()
+#define GSENSOR_PROFILE_STOP(stage, var) profiler.record(ProfileStage::stage, Profiler::cycles() - (var))
+// Record an interval measured with micros()
+#define GSENSOR_PROFILE_INTERVAL_US(stage, us) profiler.record(ProfileStage::stage, profiler.usToCycles(us))
+#define GSENSOR_PROFILE_COUNT(counter, n) profiler.count(ProfileCounter::counter, (n))
+#define GSENSOR_PROFILE_RESET() profiler.reset()
+
+#else
+
+#define GSENSOR_PROFILE_SCOPE(stage) do {} while (0)
+#define GSENSOR_PROFILE_START(var) do {} while (0)
+#define GSENSOR_PROFILE_STOP(stage, var) do {} while (0)
+#define GSENSOR_PROFILE_INTERVAL_US(stage, us) do {} while (0)
+#define GSENSOR_PROFILE_COUNT(counter, n) do {} while (0)
+#define GSENSOR_PROFILE_RESET() do {} while (0)
+
+#endif // GSENSOR_PROFILING
+
+#endif // PROFILER_H
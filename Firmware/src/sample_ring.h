@@ -0,0 +1,277 @@
+/**
+ * @file sample_ring.h
+ * @brief Lock-free single-producer, multi-consumer sample ring buffer
+ *
+ * The sampler task publishes every processed sample here. Each consumer
+ * (display, BLE, serial, logging) reads at its own pace through its own
+ * cursor, so a slow consumer loses its oldest samples instead of
+ * stalling acquisition.
+ *
+ * DoubleBuffered does the same for results where only the newest one
+ * matters (impact events, window summaries, spectra, the synced clock).
+ */
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Overwriting ring buffer with independent reader cursors
+ *
+ * The producer never blocks and never waits for readers. Readers detect
+ * when the producer has lapped them and skip forward, counting the
+ * samples they missed. Copies are validated against the write index
+ * afterwards (seqlock style), so a reader never returns a slot that was
+ * overwritten while it was being copied. A reader can be at most N - 1
+ * samples behind: the slot after the newest is the next one written.
+ *
+ * @tparam T Element type (trivially copyable)
+ * @tparam N Capacity (must be a power of two)
+ */
+template <typename T, size_t N>
+class SampleRing {
+    static_assert((N & (N - 1)) == 0, "SampleRing capacity must be a power of two");
+
+public:
+    /**
+     * @brief Per-consumer read cursor
+     *
+     * Only one task may use a given Reader.
+     */
+    class Reader {
+    public:
+        /**
+         * @brief Construct a reader positioned at the newest sample
+         *
+         * @param ring Ring to read from
+         */
+        explicit Reader(const SampleRing& ring)
+            : ring_(ring), tail_(ring.head_.load(std::memory_order_acquire)), dropped_(0) {}
+
+        /**
+         * @brief Read the next unread sample
+         *
+         * @param out Destination for the sample
+         * @return true if a sample was read, false if none is pending
+         */
+        bool read(T& out) {
+            for (;;) {
+                uint32_t head = ring_.head_.load(std::memory_order_acquire);
+                if (head == tail_) {
+                    return false;
+                }
+
+                // Lapped by the producer: skip to the oldest valid sample.
+                // Reason: slot head & (N - 1) is the one the producer writes
+                // next, so only the newest N - 1 samples can be read safely
+                if (head - tail_ >= N) {
+                    dropped_ += head - tail_ - (N - 1);
+                    tail_ = head - (N - 1);
+                }
+
+                out = ring_.buffer_[tail_ & (N - 1)];
+
+                // Reject the copy if the producer reached this slot meanwhile
+                std::atomic_thread_fence(std::memory_order_acquire);
+                uint32_t after = ring_.head_.load(std::memory_order_relaxed);
+                if (after - tail_ >= N) {
+                    continue;
+                }
+
+                tail_++;
+                return true;
+            }
+        }
+
+        /**
+         * @brief Number of samples waiting for this reader
+         *
+         * @return size_t Pending samples (capped at ring capacity - 1)
+         */
+        size_t available() const {
+            uint32_t pending = ring_.head_.load(std::memory_order_acquire) - tail_;
+            return pending > N - 1 ? N - 1 : pending;
+        }
+
+        /**
+         * @brief Skip all pending samples
+         */
+        void skipToLatest() {
+            tail_ = ring_.head_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Get number of samples lost because this reader fell behind
+         */
+        uint32_t dropped() const { return dropped_; }
+
+    private:
+        const SampleRing& ring_;
+        uint32_t tail_;      // Index of next sample to read
+        uint32_t dropped_;   // Samples overwritten before they were read
+    };
+
+    /**
+     * @brief Construct an empty ring
+     */
+    SampleRing() : buffer_{}, head_(0) {}
+
+    /**
+     * @brief Publish a sample (producer only)
+     *
+     * @param value Sample to store; overwrites the oldest if full
+     */
+    void push(const T& value) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        buffer_[head & (N - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the newest sample without using a cursor
+     *
+     * For consumers that only ever want the current value (e.g. the gauge).
+     *
+     * @param out Destination for the sample
+     * @return true if at least one sample has been published
+     */
+    bool latest(T& out) const {
+        for (;;) {
+            uint32_t head = head_.load(std::memory_order_acquire);
+            if (head == 0) {
+                return false;
+            }
+
+            out = buffer_[(head - 1) & (N - 1)];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (head_.load(std::memory_order_relaxed) - (head - 1) < N) {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Total number of samples ever published
+     */
+    uint32_t totalPublished() const {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get ring capacity
+     */
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T buffer_[N];
+    std::atomic<uint32_t> head_;  // Index of next slot to write
+};
+
+/**
+ * @brief Newest value published by one writer, copied by any task
+ *
+ * The writer fills the slot readers are not using and then publishes
+ * it, so neither side ever waits. A reader copies the newest slot and
+ * keeps the copy only if nothing was published meanwhile (seqlock
+ * style): the slot it copied is rewritten two values later, which can
+ * only start once the next value is published.
+ *
+ * @tparam T Value type (trivially copyable)
+ */
+template <typename T>
+class DoubleBuffered {
+public:
+    /**
+     * @brief Construct with nothing published
+     */
+    DoubleBuffered() : slots_{}, published_(0) {}
+
+    /**
+     * @brief Slot the next publish() exposes (writer only)
+     *
+     * Can be filled in place over several calls; it stays the same
+     * slot until publish().
+     */
+    T& next() {
+        // Reason: orders the writes below after the previous publish(),
+        // so a reader that sees any of them also sees a new sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        return slots_[published_.load(std::memory_order_relaxed) & 1];
+    }
+
+    /**
+     * @brief Sequence the next publish() assigns (writer only, 1-based)
+     */
+    uint32_t nextSequence() const {
+        return published_.load(std::memory_order_relaxed) + 1;
+    }
+
+    /**
+     * @brief Publish the slot returned by next() (writer only)
+     */
+    void publish() {
+        published_.store(published_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy a value into the next slot and publish it (writer only)
+     *
+     * @param value Value to publish
+     */
+    void publish(const T& value) {
+        next() = value;
+        publish();
+    }
+
+    /**
+     * @brief Number of values published so far
+     */
+    uint32_t sequence() const {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Copy the newest value
+     *
+     * @param out Destination
+     * @return true if a value has been published
+     */
+    bool read(T& out) const {
+        return read(out, &whole);
+    }
+
+    /**
+     * @brief Copy part of the newest value
+     *
+     * @param out Destination
+     * @param part Returns the part to copy from a slot
+     * @return true if a value has been published
+     */
+    template <typename U, typename Part>
+    bool read(U& out, Part part) const {
+        for (;;) {
+            uint32_t sequence = published_.load(std::memory_order_acquire);
+            if (sequence == 0) {
+                return false;
+            }
+
+            out = part(slots_[(sequence - 1) & 1]);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (published_.load(std::memory_order_relaxed) == sequence) {
+                return true;
+            }
+        }
+    }
+
+private:
+    T slots_[2];
+    std::atomic<uint32_t> published_;  // Sequence of the newest value (0 = none)
+
+    static const T& whole(const T& slot) { return slot; }
+};
+
+#endif // SAMPLE_RING_H
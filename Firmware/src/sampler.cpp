@@ -0,0 +1,590 @@
+/**
+ * @file sampler.cpp
+ * @brief Sampler task implementation
+ */
+
+#include "sampler.h"
+#include "config_store.h"
+
+// Request flags posted by other tasks
+constexpr uint8_t REQUEST_PEAK_RESET    = 0x01;
+constexpr uint8_t REQUEST_FILTER_RESET  = 0x02;
+constexpr uint8_t REQUEST_SHOCK_WAKE    = 0x04;  // Apply shockWakeRequested_
+constexpr uint8_t REQUEST_SHOCK_CONFIG  = 0x08;  // Reprogram the shock threshold
+constexpr uint8_t REQUEST_LOG_START     = 0x10;
+constexpr uint8_t REQUEST_LOG_STOP      = 0x20;
+constexpr uint8_t REQUEST_FILTER_CONFIG = 0x40;  // Apply filterConfig_
+constexpr uint8_t REQUEST_CALIBRATE     = 0x80;
+
+// Per-axis shock threshold relative to the magnitude threshold (1/sqrt(3))
+constexpr float SHOCK_AXIS_THRESHOLD_RATIO = 0.57735f;
+
+Sampler* Sampler::instance_ = nullptr;
+
+/**
+ * @brief Map a sample rate to the ADXL375 data rate code
+ *
+ * @param rateHz Sample rate in Hz
+ * @param rate Output data rate code
+ * @return true if the rate is supported
+ */
+static bool rateToDataRate(uint32_t rateHz, Adxl375DataRate& rate) {
+    switch (rateHz) {
+        case 25:   rate = Adxl375DataRate::RATE_25_HZ; return true;
+        case 50:   rate = Adxl375DataRate::RATE_50_HZ; return true;
+        case 100:  rate = Adxl375DataRate::RATE_100_HZ; return true;
+        case 200:  rate = Adxl375DataRate::RATE_200_HZ; return true;
+        case 400:  rate = Adxl375DataRate::RATE_400_HZ; return true;
+        case 800:  rate = Adxl375DataRate::RATE_800_HZ; return true;
+        case 1600: rate = Adxl375DataRate::RATE_1600_HZ; return true;
+        case 3200: rate = Adxl375DataRate::RATE_3200_HZ; return true;
+        default:   return false;
+    }
+}
+
+/**
+ * @brief Pick the FIFO watermark for a sample rate
+ *
+ * Aims for one drain per interval while keeping at least half the FIFO
+ * free as headroom.
+ *
+ * @param rateHz Sample rate in Hz
+ * @param intervalUs Target drain interval
+ * @return uint8_t Watermark in samples
+ */
+static uint8_t fifoWatermarkForRate(uint32_t rateHz, uint32_t intervalUs) {
+    uint32_t watermark = (rateHz * intervalUs) / 1000000;
+    if (watermark < 1) {
+        watermark = 1;
+    } else if (watermark > ADXL375_FIFO_DEPTH / 2) {
+        watermark = ADXL375_FIFO_DEPTH / 2;
+    }
+    return static_cast<uint8_t>(watermark);
+}
+
+// FilterConfig packed into one word so it crosses tasks atomically:
+// bit 31 DC block, bits 30-21 high-pass Hz, 20-10 low-pass Hz, 9-0 average ms
+static_assert(FILTER_MAX_HIGH_PASS_HZ <= 0x3FF && FILTER_MAX_LOW_PASS_HZ <= 0x7FF
+              && FILTER_MAX_AVERAGE_MS <= 0x3FF, "FILTER_MAX_* must fit the packed fields");
+
+static uint32_t packFilterConfig(const FilterConfig& config) {
+    return (config.dcBlock ? 1UL << 31 : 0)
+         | (static_cast<uint32_t>(config.highPassHz & 0x3FF) << 21)
+         | (static_cast<uint32_t>(config.lowPassHz & 0x7FF) << 10)
+         | (config.averageMs & 0x3FF);
+}
+
+static FilterConfig unpackFilterConfig(uint32_t packed) {
+    return {
+        (packed >> 31) != 0,
+        static_cast<uint16_t>((packed >> 21) & 0x3FF),
+        static_cast<uint16_t>((packed >> 10) & 0x7FF),
+        static_cast<uint16_t>(packed & 0x3FF)
+    };
+}
+
+static uint32_t defaultFilterConfig() {
+    FilterConfig config = {};
+    filterPreset(FILTER_DEFAULT_PRESET, config);
+    return packFilterConfig(config);
+}
+
+Sampler::Sampler()
+    : accel_()
+    , processor_()
+    , ring_()
+    , displayRing_()
+    , notifyRing_()
+    , capture_()
+    , stats_()
+    , spectrum_()
+    , logger_()
+    , fifoBuffer_{}
+    , taskHandle_(nullptr)
+    , timer_(nullptr)
+    , sensorOk_(false)
+    , currentRateHz_(ADXL_DEFAULT_SAMPLE_RATE_HZ)
+    , pendingRateHz_(0)
+    , pendingRequests_(0)
+    , filterConfig_(defaultFilterConfig())
+    , shockWakeRequested_(false)
+    , calibrationStatus_(static_cast<uint8_t>(CalibrationStatus::IDLE))
+    , calibrationCount_(0)
+    , drainIntervalUs_(ADXL_FIFO_DRAIN_INTERVAL_US)
+    , sleepBudgetUs_(0)
+    , notifyRateHz_(BLE_DEFAULT_NOTIFY_RATE_HZ)
+    , calibration_(defaultCalibration())
+    , calibrator_()
+    , shockWakeActive_(false)
+    , drainTimerRunning_(false)
+    , drainPeriodUs_(0)
+    , notifyRateApplied_(0)
+#if GSENSOR_PROFILING
+    , lastDrainUs_(0)
+#endif
+{
+}
+
+bool Sampler::begin() {
+    sensorOk_ = accel_.begin();
+    if (!sensorOk_) {
+        return false;
+    }
+
+    instance_ = this;
+
+    // Per-unit offsets from NVS, or the config.h defaults
+    if (!loadCalibration(calibration_) && DEBUG_ENABLED) {
+        Serial.println("No stored calibration, using defaults");
+    }
+
+    // Logging is optional: a missing partition only disables it
+    logger_.begin();
+    applyCalibration(calibration_);
+
+    // Spectrum is optional too: without its task frames are only counted as dropped
+    spectrum_.begin();
+
+    // Set up hardware timer for FIFO drains
+    // Timer 0, prescaler 80 (80MHz/80 = 1MHz tick rate), count up
+    timer_ = timerBegin(0, 80, true);
+    timerAttachInterrupt(timer_, &Sampler::onTimer, true);
+
+    // FIFO watermark / shock interrupt (only if INT1 is wired)
+    if (PIN_ADXL_INT1 >= 0) {
+        pinMode(PIN_ADXL_INT1, INPUT);
+        attachInterrupt(digitalPinToInterrupt(PIN_ADXL_INT1), &Sampler::onSensorInterrupt, RISING);
+    }
+
+    // Gauge averages follow the display refresh; the notify output is
+    // configured on the first drain from notifyRateHz_
+    processor_.setOutputRate(ProcessorOutput::DISPLAY, DISPLAY_OUTPUT_RATE_HZ);
+
+    // A rate set before begin() (restored configuration) applies from the start
+    uint32_t startRateHz = pendingRateHz_.exchange(0);
+    applySampleRate(startRateHz != 0 ? startRateHz : currentRateHz_.load());
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        &Sampler::taskEntry, "sampler", SAMPLER_TASK_STACK_SIZE,
+        this, SAMPLER_TASK_PRIORITY, &taskHandle_, 0);
+
+    if (created != pdPASS) {
+        if (DEBUG_ENABLED) {
+            Serial.println("ERROR: Failed to create sampler task");
+        }
+        // Reason: with no task to notify, the timer and INT1 must not stay armed
+        if (PIN_ADXL_INT1 >= 0) {
+            detachInterrupt(digitalPinToInterrupt(PIN_ADXL_INT1));
+        }
+        timerAlarmDisable(timer_);
+        timerDetachInterrupt(timer_);
+        timerEnd(timer_);
+        timer_ = nullptr;
+        taskHandle_ = nullptr;
+        sensorOk_ = false;
+        return false;
+    }
+
+    return true;
+}
+
+bool Sampler::setSampleRate(uint32_t rateHz) {
+    Adxl375DataRate rate;
+    if (!rateToDataRate(rateHz, rate)) {
+        Serial.printf("Invalid rate: %d Hz\n", rateHz);
+        return false;
+    }
+
+    pendingRateHz_.store(rateHz);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+
+    Serial.printf("Sample rate: %d Hz\n", rateHz);
+    return true;
+}
+
+uint32_t Sampler::getSampleRate() const {
+    uint32_t pending = pendingRateHz_.load();
+    return pending != 0 ? pending : currentRateHz_.load();
+}
+
+void Sampler::setLowPowerDrain(bool enabled) {
+    uint32_t intervalUs = enabled ? ADXL_FIFO_LOW_POWER_DRAIN_INTERVAL_US : ADXL_FIFO_DRAIN_INTERVAL_US;
+    if (drainIntervalUs_.exchange(intervalUs) == intervalUs) {
+        return;
+    }
+
+    // The watermark is derived with the rate, so re-apply the rate
+    pendingRateHz_.store(getSampleRate());
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+}
+
+void Sampler::wake() {
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+}
+
+void Sampler::requestPeakReset() {
+    pendingRequests_.fetch_or(REQUEST_PEAK_RESET);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+}
+
+void Sampler::requestFilterReset() {
+    pendingRequests_.fetch_or(REQUEST_FILTER_RESET);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+}
+
+bool Sampler::requestCalibration() {
+    if (shockWakeRequested_.load()) {
+        Serial.println("Calibration needs shock wake off");
+        return false;
+    }
+
+    pendingRequests_.fetch_or(REQUEST_CALIBRATE);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+    return true;
+}
+
+bool Sampler::setFilterConfig(const FilterConfig& config) {
+    if (!config.isValid()) {
+        Serial.println("Invalid filter settings");
+        return false;
+    }
+
+    filterConfig_.store(packFilterConfig(config));
+    pendingRequests_.fetch_or(REQUEST_FILTER_CONFIG);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+    return true;
+}
+
+FilterConfig Sampler::getFilterConfig() const {
+    return unpackFilterConfig(filterConfig_.load());
+}
+
+bool Sampler::setImpactThresholdG(float thresholdG) {
+    if (!capture_.setThresholdG(thresholdG)) {
+        return false;
+    }
+    pendingRequests_.fetch_or(REQUEST_SHOCK_CONFIG);
+    // Reason: in shock-wake mode the drain timer is off and the task only
+    // runs on a shock, which would still be detected at the old threshold
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+    return true;
+}
+
+bool Sampler::setShockWake(bool enabled) {
+    if (enabled && PIN_ADXL_INT1 < 0) {
+        Serial.println("Shock wake needs INT1 wired (PIN_ADXL_INT1)");
+        return false;
+    }
+
+    shockWakeRequested_.store(enabled);
+    pendingRequests_.fetch_or(REQUEST_SHOCK_WAKE);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+
+    Serial.printf("Shock wake: %s\n", enabled ? "on" : "off");
+    return true;
+}
+
+bool Sampler::startLogging() {
+    if (!logger_.isAvailable()) {
+        Serial.println("No log partition");
+        return false;
+    }
+
+    pendingRequests_.fetch_or(REQUEST_LOG_START);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+    return true;
+}
+
+void Sampler::stopLogging() {
+    pendingRequests_.fetch_or(REQUEST_LOG_STOP);
+    if (taskHandle_) {
+        xTaskNotifyGive(taskHandle_);
+    }
+}
+
+void Sampler::taskEntry(void* param) {
+    static_cast<Sampler*>(param)->run();
+}
+
+void IRAM_ATTR Sampler::onTimer() {
+    if (!instance_ || !instance_->taskHandle_) {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(instance_->taskHandle_, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void IRAM_ATTR Sampler::onSensorInterrupt() {
+    if (!instance_ || !instance_->taskHandle_) {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(instance_->taskHandle_, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void Sampler::run() {
+    for (;;) {
+        // Sleep until the drain timer or a sensor interrupt fires; more
+        // than one pending notification means this task ran late
+        uint32_t wakes = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (wakes > 1) {
+            GSENSOR_PROFILE_COUNT(COALESCED_WAKES, wakes - 1);
+        }
+
+        applyRequests();
+        if (shockWakeActive_) {
+            serviceShockWake();
+        } else {
+            drainFifo();
+        }
+    }
+}
+
+void Sampler::applyRequests() {
+    uint32_t rateHz = pendingRateHz_.exchange(0);
+    if (rateHz != 0) {
+        applySampleRate(rateHz);
+    }
+
+    uint8_t requests = pendingRequests_.exchange(0);
+    if (requests & REQUEST_FILTER_CONFIG) {
+        processor_.configure(getFilterConfig(), currentRateHz_.load());
+    }
+    if (requests & REQUEST_FILTER_RESET) {
+        processor_.reset();
+    } else if (requests & REQUEST_PEAK_RESET) {
+        processor_.resetPeak();
+    }
+
+    if (requests & REQUEST_SHOCK_WAKE) {
+        applyShockWake(shockWakeRequested_.load());
+    } else if ((requests & REQUEST_SHOCK_CONFIG) && shockWakeActive_) {
+        configureShock();
+    }
+
+    if (requests & REQUEST_LOG_STOP) {
+        logger_.stop();
+    } else if (requests & REQUEST_LOG_START) {
+        logger_.start(LOG_WRAP_WHEN_FULL ? LogFullMode::WRAP : LogFullMode::STOP);
+    }
+
+    if (requests & REQUEST_CALIBRATE) {
+        startCalibration();
+    }
+}
+
+void Sampler::applyCalibration(const AccelCalibration& calibration) {
+    accel_.setCalibration(calibration);
+    // Logged raw samples already carry the register part
+    logger_.setCalibration(calibration.residualCounts());
+}
+
+void Sampler::startCalibration() {
+    if (shockWakeActive_) {
+        calibrationStatus_.store(static_cast<uint8_t>(CalibrationStatus::UNAVAILABLE));
+        calibrationCount_.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    // Measure raw offsets: nothing applied by the sensor or in software
+    AccelCalibration none = {};
+    applyCalibration(none);
+    calibrator_.start(currentRateHz_.load());
+    calibrationStatus_.store(static_cast<uint8_t>(CalibrationStatus::RUNNING));
+}
+
+void Sampler::finishCalibration() {
+    if (calibrator_.status() == CalibrationStatus::DONE) {
+        calibration_ = calibrator_.result();
+    }
+    // A failed run puts the previous calibration back
+    applyCalibration(calibration_);
+
+    // The filters hold history from the uncalibrated window
+    processor_.reset();
+
+    calibrationStatus_.store(static_cast<uint8_t>(calibrator_.status()));
+    calibrationCount_.fetch_add(1, std::memory_order_release);
+}
+
+void Sampler::applyShockWake(bool enabled) {
+    if (enabled == shockWakeActive_) {
+        return;
+    }
+
+    // Samples stop flowing between impacts, so a window would never end
+    if (enabled && calibrator_.isRunning()) {
+        calibrator_.cancel();
+        finishCalibration();
+    }
+
+    shockWakeActive_ = enabled;
+    // Windows would otherwise span the gap between awake periods
+    stats_.reset();
+    if (enabled) {
+        // Watermark off: it would wake the task for every batch of samples
+        configureShock();
+        accel_.setInterrupts(false, true);
+        setDrainTimer(false);
+    } else {
+        accel_.setInterrupts(true, false);
+        capture_.reset();
+        setDrainTimer(true);
+    }
+}
+
+void Sampler::configureShock() {
+    accel_.configureShock(capture_.getThresholdG() * SHOCK_AXIS_THRESHOLD_RATIO,
+                          ADXL_SHOCK_MAX_DURATION_US);
+}
+
+void Sampler::serviceShockWake() {
+    // Reading the status also releases INT1 for the next shock
+    bool shock = accel_.readShockStatus();
+
+    if (!drainTimerRunning_) {
+        if (!shock) {
+            return;
+        }
+
+        // The FIFO holds the samples leading up to the shock; anything
+        // older in the history is from before the idle gap
+        capture_.reset();
+        setDrainTimer(true);
+    }
+
+    drainFifo();
+
+    if (!capture_.isCapturing()) {
+        setDrainTimer(false);
+    }
+}
+
+void Sampler::setDrainTimer(bool running) {
+    if (running) {
+        timerAlarmEnable(timer_);
+    } else {
+        timerAlarmDisable(timer_);
+    }
+    drainTimerRunning_ = running;
+    sleepBudgetUs_.store(running ? drainPeriodUs_ : 0);
+}
+
+void Sampler::applySampleRate(uint32_t rateHz) {
+    Adxl375DataRate rate;
+    if (!rateToDataRate(rateHz, rate)) {
+        return;
+    }
+
+    // Update ADXL375 data rate and restart the FIFO
+    uint8_t watermark = fifoWatermarkForRate(rateHz, drainIntervalUs_.load());
+    accel_.setDataRate(rate);
+    accel_.enableFifoStream(watermark);
+    capture_.reset();
+
+    // Corners and windows are in Hz / ms, so re-derive them for the new rate
+    processor_.configure(getFilterConfig(), rateHz);
+
+    // Drain the FIFO once per watermark period
+    // Reason: the timer is the only drain trigger when INT1 is not wired,
+    // and a safety net against a missed edge when it is
+    drainPeriodUs_ = (1000000 / rateHz) * watermark;
+
+    timerAlarmDisable(timer_);
+    timerAlarmWrite(timer_, drainPeriodUs_, true);
+    setDrainTimer(!shockWakeActive_);
+
+    currentRateHz_.store(rateHz);
+}
+
+void Sampler::drainFifo() {
+    GSENSOR_PROFILE_SCOPE(DRAIN);
+#if GSENSOR_PROFILING
+    // Reason: micros(), not cycles, since light sleep stops the cycle counter
+    uint32_t startUs = micros();
+    if (lastDrainUs_ != 0) {
+        GSENSOR_PROFILE_INTERVAL_US(DRAIN_INTERVAL, startUs - lastDrainUs_);
+    }
+    lastDrainUs_ = startUs;
+#endif
+
+    GSENSOR_PROFILE_START(readStart);
+    size_t count = accel_.readFifo(fifoBuffer_, ADXL375_FIFO_DEPTH);
+    GSENSOR_PROFILE_STOP(FIFO_READ, readStart);
+    if (count >= ADXL375_FIFO_DEPTH) {
+        GSENSOR_PROFILE_COUNT(FIFO_OVERRUNS, 1);
+    }
+    uint32_t rateHz = currentRateHz_.load(std::memory_order_relaxed);
+    int32_t thresholdQ4 = capture_.getThresholdFixed();
+
+    uint32_t notifyRateHz = notifyRateHz_.load(std::memory_order_relaxed);
+    if (notifyRateHz != notifyRateApplied_) {
+        processor_.setOutputRate(ProcessorOutput::NOTIFY, notifyRateHz);
+        notifyRateApplied_ = notifyRateHz;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const AccelSample& sample = fifoBuffer_[i];
+
+        SampleRecord record;
+        record.timestampUs = sample.timestampUs;
+        record.raw = sample.raw;
+        record.counts = sample.counts;
+        {
+            GSENSOR_PROFILE_SCOPE(PROCESS);
+            record.filtered = processor_.process(accel_.toFixed(sample.raw));
+            record.magnitude = processor_.getFilteredMagnitude();
+            record.peak = processor_.getPeakMagnitude();
+        }
+
+        ring_.push(record);
+        if (processor_.outputReady(ProcessorOutput::DISPLAY)) {
+            publishDecimated(ProcessorOutput::DISPLAY, displayRing_, sample.timestampUs);
+        }
+        if (processor_.outputReady(ProcessorOutput::NOTIFY)) {
+            publishDecimated(ProcessorOutput::NOTIFY, notifyRing_, sample.timestampUs);
+        }
+
+        stats_.addSample(sample.timestampUs, record.filtered, record.magnitude, thresholdQ4, rateHz);
+        capture_.addSample(sample.timestampUs, sample.counts, rateHz);
+        spectrum_.addSample(sample.counts, rateHz);
+        logger_.addSample(sample.timestampUs, sample.raw, rateHz);
+
+        if (calibrator_.addSample(sample.raw)) {
+            finishCalibration();
+        }
+    }
+}
+
+void Sampler::publishDecimated(ProcessorOutput output, DecimatedRingBuffer& ring, uint32_t timestampUs) {
+    const BasicDecimator<AccelFixed>& decimator = processor_.decimated(output);
+
+    DecimatedRecord record;
+    record.timestampUs = timestampUs;
+    record.filtered = decimator.output();
+    record.magnitude = decimator.outputMagnitude();
+    record.peak = processor_.getPeakMagnitude();
+    ring.push(record);
+}
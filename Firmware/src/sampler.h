@@ -0,0 +1,369 @@
+/**
+ * @file sampler.h
+ * @brief High-priority sampling task
+ *
+ * Owns the accelerometer and signal processor and publishes every
+ * processed sample into a ring buffer read by the other subsystems.
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "accelerometer.h"
+#include "signal_processing.h"
+#include "sample_ring.h"
+#include "impact_capture.h"
+#include "window_stats.h"
+#include "spectrum.h"
+#include "flash_logger.h"
+#include "calibration.h"
+#include "profiler.h"
+
+/**
+ * @brief One processed sample as published to consumers
+ *
+ * Values stay in fixed point so the sampler does no float math; use the
+ * accessors to convert the samples that are actually shown in g.
+ */
+struct SampleRecord {
+    uint32_t timestampUs;  // Sample time (microseconds since boot)
+    RawAccel raw;          // Raw sensor counts
+    RawAccel counts;       // Calibrated, unfiltered counts
+    AccelFixed filtered;   // Filtered acceleration (Q4 counts)
+    int32_t magnitude;     // Filtered magnitude (Q4 counts)
+    int32_t peak;          // Peak filtered magnitude since last reset (Q4 counts)
+
+    /**
+     * @brief Filtered acceleration in g
+     */
+    AccelData filteredG() const { return filtered.toG(); }
+
+    /**
+     * @brief Filtered magnitude in g
+     */
+    float magnitudeG() const { return fixedToG(magnitude); }
+
+    /**
+     * @brief Peak magnitude in g
+     */
+    float peakG() const { return fixedToG(peak); }
+};
+
+using SampleRingBuffer = SampleRing<SampleRecord, SAMPLE_RING_SIZE>;
+
+/**
+ * @brief One block-averaged sample of a decimated output
+ *
+ * Published once per output period, so a consumer reading at that rate
+ * sees every filtered sample's contribution instead of aliasing.
+ */
+struct DecimatedRecord {
+    uint32_t timestampUs;  // Time of the last sample in the block
+    AccelFixed filtered;   // Average filtered acceleration (Q4 counts)
+    int32_t magnitude;     // Average filtered magnitude (Q4 counts)
+    int32_t peak;          // Full-rate peak since last reset (Q4 counts)
+
+    /**
+     * @brief Average filtered acceleration in g
+     */
+    AccelData filteredG() const { return filtered.toG(); }
+
+    /**
+     * @brief Average filtered magnitude in g
+     */
+    float magnitudeG() const { return fixedToG(magnitude); }
+
+    /**
+     * @brief Peak magnitude in g
+     */
+    float peakG() const { return fixedToG(peak); }
+};
+
+using DecimatedRingBuffer = SampleRing<DecimatedRecord, DECIMATED_RING_SIZE>;
+
+/**
+ * @brief Sampler task owning sensor acquisition and processing
+ *
+ * The task sleeps until the drain timer or the FIFO watermark interrupt
+ * wakes it, drains the FIFO, filters each sample and publishes it.
+ * In shock-wake mode the drain timer only runs while an impact is being
+ * recorded; the ADXL375 shock interrupt wakes the task otherwise.
+ * Other tasks never touch the accelerometer or processor directly;
+ * they post requests that the task applies between drains.
+ *
+ * Two streams come out of the processor: every full-rate sample goes to
+ * ring() and straight into capture, logging and the spectrum, while
+ * block averages at the display and BLE notify rates go to
+ * displayRing() and notifyRing().
+ */
+class Sampler {
+public:
+    Sampler();
+
+    /**
+     * @brief Initialize the accelerometer and start the sampler task
+     *
+     * @return true if the sensor was found and sampling started
+     */
+    bool begin();
+
+    /**
+     * @brief Check if the sensor is running
+     */
+    bool isSensorOk() const { return sensorOk_; }
+
+    /**
+     * @brief Request a new sample rate
+     *
+     * Thread-safe. Valid rates: 25, 50, 100, 200, 400, 800, 1600, 3200 Hz.
+     * Called before begin(), the rate applies from the first sample.
+     *
+     * @param rateHz Target sample rate in Hz
+     * @return true if the rate is valid and was queued
+     */
+    bool setSampleRate(uint32_t rateHz);
+
+    /**
+     * @brief Get the current (or pending) sample rate
+     *
+     * @return uint32_t Sample rate in Hz
+     */
+    uint32_t getSampleRate() const;
+
+    /**
+     * @brief Set the rate of the notifyRing() output (thread-safe)
+     *
+     * Applied at the next drain; the partial block is discarded.
+     *
+     * @param rateHz Legacy BLE notification rate in Hz
+     */
+    void setNotifyRate(uint32_t rateHz) { notifyRateHz_.store(rateHz, std::memory_order_relaxed); }
+
+    /**
+     * @brief Drain less often to save power (thread-safe)
+     *
+     * Switches the target drain interval between ADXL_FIFO_DRAIN_INTERVAL_US
+     * and ADXL_FIFO_LOW_POWER_DRAIN_INTERVAL_US. The rate is re-applied,
+     * so filter history and any impact being recorded are cleared.
+     *
+     * @param enabled true for fewer, larger drains
+     */
+    void setLowPowerDrain(bool enabled);
+
+    /**
+     * @brief Longest time the task may go without a drain (thread-safe)
+     *
+     * For a caller about to stop the clocks (light sleep): the drain
+     * timer does not run during sleep, so waking within this time and
+     * calling wake() keeps the FIFO from overflowing.
+     *
+     * @return uint32_t Microseconds, or 0 if only INT1 wakes the task
+     */
+    uint32_t sleepBudgetUs() const { return sleepBudgetUs_.load(); }
+
+    /**
+     * @brief Drain the FIFO now (thread-safe, e.g. after light sleep)
+     */
+    void wake();
+
+    /**
+     * @brief Request a peak reset (thread-safe)
+     */
+    void requestPeakReset();
+
+    /**
+     * @brief Request a filter and peak reset (thread-safe)
+     */
+    void requestFilterReset();
+
+    /**
+     * @brief Start a zero-g calibration (thread-safe)
+     *
+     * The sensor must lie still with one axis along gravity for
+     * CALIBRATION_WINDOW_MS. The offset registers are zeroed while the
+     * window is collected, so published samples are uncalibrated until
+     * it completes. Watch calibrationCount() for the outcome.
+     *
+     * @return false in shock-wake mode (samples only flow around impacts)
+     */
+    bool requestCalibration();
+
+    /**
+     * @brief Number of calibration runs completed (or refused) since boot
+     */
+    uint32_t calibrationCount() const { return calibrationCount_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Outcome of the newest calibration run
+     */
+    CalibrationStatus calibrationStatus() const {
+        return static_cast<CalibrationStatus>(calibrationStatus_.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Get the calibration in use
+     *
+     * Stable between runs: read it after calibrationCount() changes.
+     */
+    const AccelCalibration& getCalibration() const { return calibration_; }
+
+    /**
+     * @brief Replace the filter chain settings (thread-safe)
+     *
+     * Filter history is cleared when the new settings are applied.
+     *
+     * @param config New settings
+     * @return false if a value is outside the FILTER_MAX_* limits
+     */
+    bool setFilterConfig(const FilterConfig& config);
+
+    /**
+     * @brief Get the current (or pending) filter settings
+     */
+    FilterConfig getFilterConfig() const;
+
+    /**
+     * @brief Set the impact threshold (thread-safe)
+     *
+     * Also updates the on-chip shock threshold used by shock-wake mode.
+     *
+     * @param thresholdG Threshold on unfiltered magnitude in g
+     * @return true if the threshold is within range
+     */
+    bool setImpactThresholdG(float thresholdG);
+
+    /**
+     * @brief Enable or disable shock-wake mode (thread-safe)
+     *
+     * Between impacts no samples are published, so the gauge and sample
+     * streams pause; impacts are still captured.
+     *
+     * @param enabled true to sleep until the shock interrupt
+     * @return false if INT1 is not wired (PIN_ADXL_INT1 < 0)
+     */
+    bool setShockWake(bool enabled);
+
+    /**
+     * @brief Check if shock-wake mode is requested
+     */
+    bool isShockWakeEnabled() const { return shockWakeRequested_.load(); }
+
+    /**
+     * @brief Get the ring buffer consumers read from
+     */
+    const SampleRingBuffer& ring() const { return ring_; }
+
+    /**
+     * @brief Get the block averages at DISPLAY_OUTPUT_RATE_HZ
+     */
+    const DecimatedRingBuffer& displayRing() const { return displayRing_; }
+
+    /**
+     * @brief Get the block averages at the setNotifyRate() rate
+     */
+    const DecimatedRingBuffer& notifyRing() const { return notifyRing_; }
+
+    /**
+     * @brief Get the impact capture engine fed by this task
+     *
+     * Only the thread-safe ImpactCapture methods may be used by callers.
+     */
+    ImpactCapture& capture() { return capture_; }
+
+    /**
+     * @brief Get the window statistics fed by this task
+     *
+     * Only summaryCount() and latest() may be used by callers.
+     */
+    const WindowStats& stats() const { return stats_; }
+
+    /**
+     * @brief Get the spectrum analyser fed by this task
+     *
+     * Only the thread-safe SpectrumAnalyzer methods may be used by callers.
+     */
+    SpectrumAnalyzer& spectrum() { return spectrum_; }
+
+    /**
+     * @brief Start logging raw samples to flash (thread-safe)
+     *
+     * @return false if there is no log partition
+     */
+    bool startLogging();
+
+    /**
+     * @brief Stop logging and flush the partial block (thread-safe)
+     */
+    void stopLogging();
+
+    /**
+     * @brief Get the flash logger fed by this task
+     *
+     * Only the status getters and readBlock() may be used by callers.
+     */
+    const FlashLogger& logger() const { return logger_; }
+
+private:
+    Accelerometer accel_;
+    FixedSignalProcessor processor_;
+    SampleRingBuffer ring_;
+    DecimatedRingBuffer displayRing_;
+    DecimatedRingBuffer notifyRing_;
+    ImpactCapture capture_;
+    WindowStats stats_;
+    SpectrumAnalyzer spectrum_;
+    FlashLogger logger_;
+    AccelSample fifoBuffer_[ADXL375_FIFO_DEPTH];
+
+    TaskHandle_t taskHandle_;
+    hw_timer_t* timer_;
+    bool sensorOk_;
+
+    std::atomic<uint32_t> currentRateHz_;
+    std::atomic<uint32_t> pendingRateHz_;   // 0 = no change pending
+    std::atomic<uint8_t> pendingRequests_;  // REQUEST_* bit flags
+    std::atomic<uint32_t> filterConfig_;    // Packed FilterConfig
+    std::atomic<bool> shockWakeRequested_;
+    std::atomic<uint8_t> calibrationStatus_;  // CalibrationStatus
+    std::atomic<uint32_t> calibrationCount_;
+    std::atomic<uint32_t> drainIntervalUs_;  // Target FIFO drain interval
+    std::atomic<uint32_t> sleepBudgetUs_;    // Drain timer period, 0 while stopped
+    std::atomic<uint32_t> notifyRateHz_;     // Requested notifyRing() rate
+
+    // Calibration in use and the routine measuring a new one
+    AccelCalibration calibration_;
+    CalibrationRoutine calibrator_;
+
+    // Sampler task only
+    bool shockWakeActive_;
+    bool drainTimerRunning_;
+    uint32_t drainPeriodUs_;  // Drain timer period at the current rate
+    uint32_t notifyRateApplied_;  // notifyRateHz_ as configured in the processor
+#if GSENSOR_PROFILING
+    uint32_t lastDrainUs_;    // Start of the previous drain (interval jitter)
+#endif
+
+    static Sampler* instance_;
+
+    static void taskEntry(void* param);
+    static void IRAM_ATTR onTimer();
+    static void IRAM_ATTR onSensorInterrupt();
+
+    void run();
+    void applyRequests();
+    void applySampleRate(uint32_t rateHz);
+    void applyShockWake(bool enabled);
+    void applyCalibration(const AccelCalibration& calibration);
+    void startCalibration();
+    void finishCalibration();
+    void configureShock();
+    void serviceShockWake();
+    void setDrainTimer(bool running);
+    void drainFifo();
+    void publishDecimated(ProcessorOutput output, DecimatedRingBuffer& ring, uint32_t timestampUs);
+};
+
+#endif // SAMPLER_H
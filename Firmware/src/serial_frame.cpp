@@ -0,0 +1,77 @@
+/**
+ * @file serial_frame.cpp
+ * @brief Serial framing implementation
+ */
+
+#include "serial_frame.h"
+#include "stream_frame.h"
+
+bool writeSerialFrame(SerialFrameType type, const uint8_t* message, size_t length) {
+    if (Serial.availableForWrite() < static_cast<int>(length + SERIAL_FRAME_OVERHEAD)) {
+        return false;
+    }
+
+    uint8_t header[4] = {SERIAL_FRAME_SYNC, static_cast<uint8_t>(type),
+                         static_cast<uint8_t>(length & 0xFF), static_cast<uint8_t>(length >> 8)};
+    uint16_t crc = crc16Ccitt(message, length, crc16Ccitt(&header[2], 2));
+    uint8_t trailer[2] = {static_cast<uint8_t>(crc & 0xFF), static_cast<uint8_t>(crc >> 8)};
+
+    // Written in place, the message is not copied into a frame buffer
+    Serial.write(header, sizeof(header));
+    Serial.write(message, length);
+    Serial.write(trailer, sizeof(trailer));
+    return true;
+}
+
+SerialFrameParser::SerialFrameParser()
+    : buffer_{}
+    , type_(SerialFrameType::COMMAND)
+    , received_(0)
+    , length_(0)
+    , syncSeen_(false)
+    , inFrame_(false) {
+}
+
+void SerialFrameParser::reset() {
+    received_ = 0;
+    syncSeen_ = false;
+    inFrame_ = false;
+}
+
+SerialFrameParser::Result SerialFrameParser::feed(uint8_t byte) {
+    if (!inFrame_) {
+        if (!syncSeen_) {
+            syncSeen_ = byte == SERIAL_FRAME_SYNC;
+            return syncSeen_ ? Result::PENDING : Result::NONE;
+        }
+        if (byte == SERIAL_FRAME_SYNC) {
+            return Result::PENDING;  // Still the start of a frame
+        }
+        syncSeen_ = false;
+        if (byte != static_cast<uint8_t>(SerialFrameType::LOG_TRANSFER)
+            && byte != static_cast<uint8_t>(SerialFrameType::COMMAND)) {
+            return Result::NONE;
+        }
+        type_ = static_cast<SerialFrameType>(byte);
+        inFrame_ = true;
+        received_ = 0;
+        return Result::PENDING;
+    }
+
+    buffer_[received_++] = byte;
+    if (received_ == 2) {
+        length_ = buffer_[0] | (buffer_[1] << 8);
+        size_t maxLength = type_ == SerialFrameType::COMMAND ? COMMAND_MAX_MESSAGE : LOG_TRANSFER_MAX_REQUEST;
+        if (length_ == 0 || length_ > maxLength) {
+            reset();  // Not a request; wait for the next sync byte
+        }
+        return Result::PENDING;
+    }
+    if (received_ < 2 + length_ + 2) {
+        return Result::PENDING;
+    }
+
+    reset();
+    uint16_t crc = buffer_[2 + length_] | (buffer_[3 + length_] << 8);
+    return crc == crc16Ccitt(buffer_, 2 + length_) ? Result::COMPLETE : Result::PENDING;
+}
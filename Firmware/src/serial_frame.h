@@ -0,0 +1,79 @@
+/**
+ * @file serial_frame.h
+ * @brief Framing for binary messages sharing the serial port with text
+ *
+ * Frame: sync(u8 0xA5), type(u8), length(u16), message, CRC-16/CCITT-FALSE
+ * over length and message. The sync byte is not printable, so frames
+ * cannot be mistaken for single-character commands; the type names the
+ * protocol the message belongs to.
+ */
+
+#ifndef SERIAL_FRAME_H
+#define SERIAL_FRAME_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "log_transfer.h"
+#include "command_protocol.h"
+
+constexpr uint8_t SERIAL_FRAME_SYNC = 0xA5;
+constexpr size_t SERIAL_FRAME_OVERHEAD = 6;
+
+/**
+ * @brief Protocol a serial frame carries
+ */
+enum class SerialFrameType : uint8_t {
+    LOG_TRANSFER = 0x4C,  ///< 'L': log_transfer.h messages
+    COMMAND = 0x43        ///< 'C': command_protocol.h messages
+};
+
+/**
+ * @brief Write a message as one serial frame
+ *
+ * Writes nothing unless the whole frame fits the transmit buffer, so
+ * frames never block the loop or interleave with each other.
+ *
+ * @return true if written
+ */
+bool writeSerialFrame(SerialFrameType type, const uint8_t* message, size_t length);
+
+/**
+ * @brief Incremental parser for frames sent by the host
+ */
+class SerialFrameParser {
+public:
+    /**
+     * @brief What a byte fed to the parser was
+     */
+    enum class Result : uint8_t {
+        NONE,      ///< Not part of a frame: handle it as a command
+        PENDING,   ///< Taken, frame not complete yet
+        COMPLETE   ///< Frame complete and CRC good: see type() and message()
+    };
+
+    SerialFrameParser();
+
+    /**
+     * @brief Feed one received byte
+     */
+    Result feed(uint8_t byte);
+
+    SerialFrameType type() const { return type_; }
+    const uint8_t* message() const { return &buffer_[2]; }
+    size_t length() const { return length_; }
+
+private:
+    static constexpr size_t MAX_MESSAGE = COMMAND_MAX_MESSAGE > LOG_TRANSFER_MAX_REQUEST
+                                        ? COMMAND_MAX_MESSAGE : LOG_TRANSFER_MAX_REQUEST;
+
+    uint8_t buffer_[2 + MAX_MESSAGE + 2];  // Length, message, CRC
+    SerialFrameType type_;
+    size_t received_;   // Bytes after the sync word
+    size_t length_;
+    bool syncSeen_;     // Sync byte received
+    bool inFrame_;      // Sync and type received
+
+    void reset();
+};
+
+#endif // SERIAL_FRAME_H
@@ -3,7 +3,7 @@
  * @brief Settings structure and UI screen definitions
  *
  * Contains runtime settings for communication modes and UI state.
- * Note: Settings are not persisted - they reset to defaults on boot.
+ * Settings are persisted by the config store (see config_store.h).
  */
 
 #ifndef SETTINGS_H
@@ -16,18 +16,63 @@
  */
 enum class UIScreen {
     MAIN_GAUGE,
+    WAVEFORM,
+    SPECTRUM,
     SETTINGS
 };
 
+/**
+ * @brief Serial sample output format
+ */
+enum class SerialFormat {
+    CSV,     ///< Text lines: timestamp,x,y,z,magnitude,peak (filtered)
+    BINARY,  ///< Batched binary frames of raw counts (see stream_frame.h)
+    STATS    ///< Text window statistics once per STATS_BUCKET_MS, no samples
+};
+
+/**
+ * @brief Power profile (see power_manager.h)
+ */
+enum class PowerProfile : uint8_t {
+    PERFORMANCE = 0,  ///< Full clock, backlight always on, fast advertising
+    BALANCED,         ///< Dim and later blank the backlight, slower advertising
+    LOW_POWER         ///< Also slower clock, radio and FIFO drains; light sleep when headless
+};
+
+/**
+ * @brief Wi-Fi stream transport (see wifi_stream.h)
+ */
+enum class WifiMode : uint8_t {
+    OFF = 0,  ///< Radio off
+    UDP,      ///< Frames as datagrams to the newest subscriber
+    TCP       ///< Frames on a TCP connection from one receiver
+};
+
+/**
+ * @brief Get a Wi-Fi mode name for display and logs
+ */
+inline const char* wifiModeName(WifiMode mode) {
+    switch (mode) {
+        case WifiMode::OFF: return "OFF";
+        case WifiMode::UDP: return "UDP";
+        case WifiMode::TCP: return "TCP";
+    }
+    return "?";
+}
+
 /**
  * @brief Runtime settings structure
  *
- * These settings control communication modes and are reset
- * to defaults on each power cycle.
+ * These settings control communication modes. They are restored from
+ * NVS at boot and saved shortly after they change.
  */
 struct Settings {
     bool bleEnabled = true;      ///< Enable BLE advertising and notifications
     bool serialEnabled = true;   ///< Enable serial debug output
+    SerialFormat serialFormat = SerialFormat::CSV;  ///< Serial sample output format
+    bool fastBoot = false;       ///< Skip the splash and start sampling first (headless use)
+    PowerProfile powerProfile = PowerProfile::PERFORMANCE;  ///< Power/latency trade-off
+    WifiMode wifiMode = WifiMode::OFF;  ///< Wi-Fi raw sample stream
 
     /**
      * @brief Reset settings to defaults
@@ -35,6 +80,10 @@ struct Settings {
     void reset() {
         bleEnabled = true;
         serialEnabled = true;
+        serialFormat = SerialFormat::CSV;
+        fastBoot = false;
+        powerProfile = PowerProfile::PERFORMANCE;
+        wifiMode = WifiMode::OFF;
     }
 };
 
@@ -5,57 +5,207 @@
 
 #include "signal_processing.h"
 
-SignalProcessor::SignalProcessor()
+uint32_t isqrt64(uint64_t value) {
+    // Digit-by-digit method: one result bit per iteration, no multiplies
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return static_cast<uint32_t>(result);
+}
+
+template <typename Sample>
+BasicDecimator<Sample>::BasicDecimator()
+    : sumX_(0)
+    , sumY_(0)
+    , sumZ_(0)
+    , sumMagnitude_(0)
+    , factor_(0)
+    , count_(0)
+    , output_{}
+    , outputMagnitude_(0) {
+}
+
+template <typename Sample>
+void BasicDecimator<Sample>::configure(uint32_t factor) {
+    factor_ = factor > DECIMATOR_MAX_FACTOR ? DECIMATOR_MAX_FACTOR : factor;
+    reset();
+}
+
+template <typename Sample>
+bool BasicDecimator<Sample>::add(const Sample& filtered, Scalar magnitude) {
+    sumX_ += filtered.x;
+    sumY_ += filtered.y;
+    sumZ_ += filtered.z;
+    sumMagnitude_ += magnitude;
+
+    if (++count_ < factor_) {
+        return false;
+    }
+
+    // One division per output, not per sample
+    Scalar n = static_cast<Scalar>(factor_);
+    output_.x = sumX_ / n;
+    output_.y = sumY_ / n;
+    output_.z = sumZ_ / n;
+    outputMagnitude_ = sumMagnitude_ / n;
+    reset();
+    return true;
+}
+
+template <typename Sample>
+void BasicDecimator<Sample>::reset() {
+    sumX_ = 0;
+    sumY_ = 0;
+    sumZ_ = 0;
+    sumMagnitude_ = 0;
+    count_ = 0;
+}
+
+template <typename Sample>
+BasicSignalProcessor<Sample>::BasicSignalProcessor()
     : filterX_()
     , filterY_()
     , filterZ_()
     , filterMag_()
-    , lastFiltered_{0.0f, 0.0f, 0.0f}
-    , peakMagnitude_(0.0f) {
+    , decimators_()
+    , outputHz_{}
+    , rateHz_(0)
+    , readyOutputs_(0)
+    , lastFiltered_{}
+    , filteredMagnitude_(0)
+    , peakMagnitude_(0) {
 }
 
-AccelData SignalProcessor::process(const AccelData& raw) {
-    // Apply moving average filter to each axis
-    lastFiltered_.x = filterX_.addSample(raw.x);
-    lastFiltered_.y = filterY_.addSample(raw.y);
-    lastFiltered_.z = filterZ_.addSample(raw.z);
+template <typename Sample>
+void BasicSignalProcessor<Sample>::configure(const FilterConfig& config, uint32_t rateHz) {
+    filterX_.configure(config, rateHz);
+    filterY_.configure(config, rateHz);
+    filterZ_.configure(config, rateHz);
+    filterMag_.configure(config, rateHz);
+
+    rateHz_ = rateHz;
+    for (size_t i = 0; i < PROCESSOR_OUTPUT_COUNT; i++) {
+        configureDecimator(i);
+    }
+}
+
+template <typename Sample>
+void BasicSignalProcessor<Sample>::setOutputRate(ProcessorOutput output, uint32_t outputHz) {
+    size_t index = static_cast<size_t>(output);
+    outputHz_[index] = outputHz;
+    configureDecimator(index);
+}
+
+template <typename Sample>
+void BasicSignalProcessor<Sample>::configureDecimator(size_t index) {
+    uint32_t outputHz = outputHz_[index];
+    uint32_t factor = 0;
+    if (outputHz != 0 && rateHz_ != 0) {
+        factor = (rateHz_ + outputHz / 2) / outputHz;
+        if (factor < 1) {
+            factor = 1;  // Output faster than the input: pass every sample
+        }
+    }
+    decimators_[index].configure(factor);
+    readyOutputs_ &= ~(1U << index);
+}
+
+template <typename Sample>
+uint32_t BasicSignalProcessor<Sample>::decimationFactor(ProcessorOutput output) const {
+    return decimators_[static_cast<size_t>(output)].factor();
+}
+
+template <typename Sample>
+bool BasicSignalProcessor<Sample>::outputReady(ProcessorOutput output) const {
+    return (readyOutputs_ & (1U << static_cast<size_t>(output))) != 0;
+}
+
+template <typename Sample>
+const BasicDecimator<Sample>& BasicSignalProcessor<Sample>::decimated(ProcessorOutput output) const {
+    return decimators_[static_cast<size_t>(output)];
+}
+
+template <typename Sample>
+Sample BasicSignalProcessor<Sample>::process(const Sample& raw) {
+    // Run the filter chain on each axis
+    lastFiltered_.x = filterX_.process(raw.x);
+    lastFiltered_.y = filterY_.process(raw.y);
+    lastFiltered_.z = filterZ_.process(raw.z);
 
     // Calculate and filter magnitude
     // Reason: We filter magnitude separately rather than computing from filtered
     // axes to preserve the actual magnitude response (filtering axes separately
     // can underestimate magnitude during rapid changes)
-    float rawMagnitude = raw.magnitude();
-    float filteredMag = filterMag_.addSample(rawMagnitude);
+    Scalar rawMagnitude = raw.magnitude();
+    filteredMagnitude_ = filterMag_.process(rawMagnitude);
 
     // Update peak tracking
-    if (filteredMag > peakMagnitude_) {
-        peakMagnitude_ = filteredMag;
+    if (filteredMagnitude_ > peakMagnitude_) {
+        peakMagnitude_ = filteredMagnitude_;
+    }
+
+    // Feed the reduced-rate outputs from the same filtered samples
+    readyOutputs_ = 0;
+    for (size_t i = 0; i < PROCESSOR_OUTPUT_COUNT; i++) {
+        if (decimators_[i].factor() != 0 && decimators_[i].add(lastFiltered_, filteredMagnitude_)) {
+            readyOutputs_ |= 1U << i;
+        }
     }
 
     return lastFiltered_;
 }
 
-float SignalProcessor::getFilteredMagnitude() const {
-    return filterMag_.getAverage();
+template <typename Sample>
+typename BasicSignalProcessor<Sample>::Scalar BasicSignalProcessor<Sample>::getFilteredMagnitude() const {
+    return filteredMagnitude_;
 }
 
-float SignalProcessor::getPeakMagnitude() const {
+template <typename Sample>
+typename BasicSignalProcessor<Sample>::Scalar BasicSignalProcessor<Sample>::getPeakMagnitude() const {
     return peakMagnitude_;
 }
 
-void SignalProcessor::resetPeak() {
-    peakMagnitude_ = 0.0f;
+template <typename Sample>
+void BasicSignalProcessor<Sample>::resetPeak() {
+    peakMagnitude_ = 0;
 }
 
-void SignalProcessor::reset() {
+template <typename Sample>
+void BasicSignalProcessor<Sample>::reset() {
     filterX_.reset();
     filterY_.reset();
     filterZ_.reset();
     filterMag_.reset();
-    lastFiltered_ = {0.0f, 0.0f, 0.0f};
-    peakMagnitude_ = 0.0f;
+    for (size_t i = 0; i < PROCESSOR_OUTPUT_COUNT; i++) {
+        decimators_[i].reset();
+    }
+    readyOutputs_ = 0;
+    lastFiltered_ = {};
+    filteredMagnitude_ = 0;
+    peakMagnitude_ = 0;
 }
 
-const AccelData& SignalProcessor::getLastFiltered() const {
+template <typename Sample>
+const Sample& BasicSignalProcessor<Sample>::getLastFiltered() const {
     return lastFiltered_;
 }
+
+// Both variants are built here so the definitions stay out of the header
+template class BasicDecimator<AccelData>;
+template class BasicDecimator<AccelFixed>;
+template class BasicSignalProcessor<AccelData>;
+template class BasicSignalProcessor<AccelFixed>;
@@ -2,7 +2,10 @@
  * @file signal_processing.h
  * @brief Signal processing utilities for accelerometer data
  *
- * Provides moving average filter and magnitude calculation.
+ * Provides the per-channel filter chains and magnitude calculation, in
+ * float (g) or in fixed point (Q4 sensor counts). The ESP32-C3 has no FPU, so the
+ * sampler runs the fixed-point variant and consumers convert to g only
+ * for the samples they display or print.
  */
 
 #ifndef SIGNAL_PROCESSING_H
@@ -11,148 +14,289 @@
 #include <Arduino.h>
 #include <cmath>
 #include "config.h"
+#include "filter_chain.h"
 
 /**
- * @brief Moving average filter using ring buffer
- *
- * Efficient O(1) implementation that maintains a running sum.
- * Template parameter N sets the window size at compile time.
- *
- * @tparam T Data type (float recommended for accelerometer data)
- * @tparam N Window size (number of samples to average)
+ * @brief 3-axis acceleration data structure
  */
-template <typename T, size_t N>
-class MovingAverage {
-public:
-    /**
-     * @brief Construct a new Moving Average filter
-     */
-    MovingAverage() : buffer_{}, index_(0), count_(0), sum_(0) {}
+struct AccelData {
+    float x;  // X-axis acceleration (g)
+    float y;  // Y-axis acceleration (g)
+    float z;  // Z-axis acceleration (g)
 
     /**
-     * @brief Add a new sample to the filter
+     * @brief Calculate magnitude of acceleration vector
      *
-     * @param value New sample value
-     * @return T Current filtered (averaged) value
+     * @return float Magnitude in g: sqrt(x^2 + y^2 + z^2)
      */
-    T addSample(T value) {
-        // Subtract the oldest value from the sum
-        sum_ -= buffer_[index_];
+    float magnitude() const {
+        return sqrtf(x * x + y * y + z * z);
+    }
+};
 
-        // Store new value and add to sum
-        buffer_[index_] = value;
-        sum_ += value;
+/**
+ * @brief Raw 3-axis sensor reading in LSB counts (49 mg/LSB)
+ */
+struct RawAccel {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
 
-        // Advance index (wrap around)
-        index_ = (index_ + 1) % N;
+/**
+ * @brief Timestamped accelerometer sample
+ *
+ * Produced by the FIFO drain path. The timestamp is rebuilt from the
+ * output data rate rather than taken when the sample was read, so
+ * samples drained in one burst stay evenly spaced.
+ */
+struct AccelSample {
+    uint32_t timestampUs;  // Sample time (microseconds since boot)
+    RawAccel raw;          // Raw sensor counts
+    RawAccel counts;       // Calibrated counts (offsets removed)
+};
 
-        // Track how many samples we have (up to N)
-        if (count_ < N) {
-            count_++;
-        }
+/**
+ * @brief Fractional bits of fixed-point accelerometer values
+ *
+ * Q4 keeps 1/16 LSB (about 3 mg) through the filter chain.
+ */
+constexpr int ACCEL_FIXED_FRAC_BITS = 4;
 
-        return getAverage();
-    }
+/**
+ * @brief Convert a fixed-point value (Q4 counts) to g
+ */
+inline float fixedToG(int32_t value) {
+    return value * (ADXL375_SCALE_FACTOR / (1 << ACCEL_FIXED_FRAC_BITS));
+}
 
-    /**
-     * @brief Get current averaged value
-     *
-     * @return T Averaged value (or 0 if no samples)
-     */
-    T getAverage() const {
-        if (count_ == 0) return T(0);
-        return sum_ / static_cast<T>(count_);
-    }
+/**
+ * @brief Integer square root
+ *
+ * @param value Radicand
+ * @return uint32_t floor(sqrt(value))
+ */
+uint32_t isqrt64(uint64_t value);
+
+/**
+ * @brief 3-axis acceleration in fixed point (Q4 sensor counts)
+ */
+struct AccelFixed {
+    int32_t x;  // X-axis acceleration (1/16 LSB)
+    int32_t y;  // Y-axis acceleration (1/16 LSB)
+    int32_t z;  // Z-axis acceleration (1/16 LSB)
 
     /**
-     * @brief Reset filter to initial state
+     * @brief Build from calibrated counts
      */
-    void reset() {
-        for (size_t i = 0; i < N; i++) {
-            buffer_[i] = T(0);
-        }
-        index_ = 0;
-        count_ = 0;
-        sum_ = T(0);
+    static AccelFixed fromCounts(const RawAccel& counts) {
+        return {
+            static_cast<int32_t>(counts.x) << ACCEL_FIXED_FRAC_BITS,
+            static_cast<int32_t>(counts.y) << ACCEL_FIXED_FRAC_BITS,
+            static_cast<int32_t>(counts.z) << ACCEL_FIXED_FRAC_BITS
+        };
     }
 
     /**
-     * @brief Check if filter has enough samples
+     * @brief Calculate magnitude of acceleration vector
      *
-     * @return true if buffer is full
+     * @return int32_t Magnitude in 1/16 LSB (integer square root)
      */
-    bool isFull() const {
-        return count_ >= N;
+    int32_t magnitude() const {
+        uint64_t sumSquares = static_cast<int64_t>(x) * x
+                            + static_cast<int64_t>(y) * y
+                            + static_cast<int64_t>(z) * z;
+        return static_cast<int32_t>(isqrt64(sumSquares));
     }
 
     /**
-     * @brief Get current sample count
-     *
-     * @return size_t Number of samples in buffer
+     * @brief Convert to g
      */
-    size_t getSampleCount() const {
-        return count_;
+    AccelData toG() const {
+        return {fixedToG(x), fixedToG(y), fixedToG(z)};
     }
+};
 
-private:
-    T buffer_[N];      // Ring buffer
-    size_t index_;     // Current write position
-    size_t count_;     // Number of samples (up to N)
-    T sum_;            // Running sum for efficient averaging
+/**
+ * @brief Scalar type used for each sample representation
+ */
+template <typename Sample>
+struct SampleTraits;
+
+template <>
+struct SampleTraits<AccelData> {
+    using Scalar = float;
+};
+
+template <>
+struct SampleTraits<AccelFixed> {
+    using Scalar = int32_t;
 };
 
 /**
- * @brief 3-axis acceleration data structure
+ * @brief Reduced-rate outputs of the signal processor
  */
-struct AccelData {
-    float x;  // X-axis acceleration (g)
-    float y;  // Y-axis acceleration (g)
-    float z;  // Z-axis acceleration (g)
+enum class ProcessorOutput : uint8_t {
+    DISPLAY = 0,  // Gauge refresh rate
+    NOTIFY,       // Legacy BLE notification rate
+    COUNT
+};
+
+constexpr size_t PROCESSOR_OUTPUT_COUNT = static_cast<size_t>(ProcessorOutput::COUNT);
+
+/**
+ * @brief Integrate-and-dump decimator
+ *
+ * Averages each block of factor() filtered samples into one output.
+ * The boxcar response has nulls at every multiple of the output rate,
+ * which is where content would otherwise fold back to DC, so a value
+ * read once per output period no longer beats with the vibration.
+ *
+ * @tparam Sample AccelData (float g) or AccelFixed (Q4 counts)
+ */
+template <typename Sample>
+class BasicDecimator {
+public:
+    using Scalar = typename SampleTraits<Sample>::Scalar;
+
+    BasicDecimator();
 
     /**
-     * @brief Calculate magnitude of acceleration vector
+     * @brief Set the block length and start a new block
      *
-     * @return float Magnitude in g: sqrt(x^2 + y^2 + z^2)
+     * @param factor Input samples per output (0 = off), at most
+     *               DECIMATOR_MAX_FACTOR
      */
-    float magnitude() const {
-        return sqrtf(x * x + y * y + z * z);
-    }
+    void configure(uint32_t factor);
+
+    /**
+     * @brief Add one filtered sample
+     *
+     * @param filtered Filtered axes
+     * @param magnitude Filtered magnitude
+     * @return true if a block completed and output() holds its average
+     */
+    bool add(const Sample& filtered, Scalar magnitude);
+
+    /**
+     * @brief Discard the partial block
+     */
+    void reset();
+
+    /**
+     * @brief Input samples per output (0 = off)
+     */
+    uint32_t factor() const { return factor_; }
+
+    /**
+     * @brief Average filtered axes of the newest complete block
+     */
+    const Sample& output() const { return output_; }
+
+    /**
+     * @brief Average filtered magnitude of the newest complete block
+     */
+    Scalar outputMagnitude() const { return outputMagnitude_; }
+
+private:
+    // Reason: Q4 samples stay within +/-2^17 even with filter overshoot,
+    // so a block of DECIMATOR_MAX_FACTOR sums without overflowing int32
+    Scalar sumX_;
+    Scalar sumY_;
+    Scalar sumZ_;
+    Scalar sumMagnitude_;
+    uint32_t factor_;
+    uint32_t count_;
+
+    Sample output_;
+    Scalar outputMagnitude_;
 };
 
 /**
  * @brief Signal processor for accelerometer data
  *
- * Maintains moving average filters for each axis and magnitude.
- * Also tracks peak values.
+ * Runs one filter chain for each axis and one for the magnitude, all
+ * with the same settings. Also tracks peak values.
+ *
+ * Every call to process() returns the full-rate filtered sample. The
+ * same samples also feed one decimator per ProcessorOutput, so slower
+ * consumers get anti-aliased block averages instead of whichever
+ * sample happens to be newest when they look.
+ *
+ * @tparam Sample AccelData (float g) or AccelFixed (Q4 counts)
  */
-class SignalProcessor {
+template <typename Sample>
+class BasicSignalProcessor {
 public:
+    using Scalar = typename SampleTraits<Sample>::Scalar;
+
     /**
      * @brief Construct a new Signal Processor
      */
-    SignalProcessor();
+    BasicSignalProcessor();
+
+    /**
+     * @brief Apply filter settings for a sample rate
+     *
+     * Clears the filter history but keeps the peak. Call again whenever
+     * the sample rate changes so corners and windows stay in Hz / ms.
+     *
+     * @param config Filter settings
+     * @param rateHz Sample rate in Hz
+     */
+    void configure(const FilterConfig& config, uint32_t rateHz);
+
+    /**
+     * @brief Set the rate of a decimated output
+     *
+     * The block length is rounded to the nearest whole number of input
+     * samples, so the actual rate is rateHz / decimationFactor(). Kept
+     * across configure() and re-derived for the new sample rate.
+     *
+     * @param output Output to change
+     * @param outputHz Target output rate in Hz (0 = off)
+     */
+    void setOutputRate(ProcessorOutput output, uint32_t outputHz);
+
+    /**
+     * @brief Input samples per decimated output (0 = off)
+     */
+    uint32_t decimationFactor(ProcessorOutput output) const;
+
+    /**
+     * @brief Check whether the last process() call completed an output block
+     *
+     * @param output Output to check
+     * @return true once per block; decimated() then holds its average
+     */
+    bool outputReady(ProcessorOutput output) const;
+
+    /**
+     * @brief Get the newest decimated sample of an output
+     */
+    const BasicDecimator<Sample>& decimated(ProcessorOutput output) const;
 
     /**
      * @brief Process new accelerometer reading
      *
      * @param raw Raw acceleration data from sensor
-     * @return AccelData Filtered acceleration data
+     * @return Sample Filtered acceleration data
      */
-    AccelData process(const AccelData& raw);
+    Sample process(const Sample& raw);
 
     /**
      * @brief Get current filtered magnitude
      *
-     * @return float Filtered magnitude in g
+     * @return Scalar Filtered magnitude
      */
-    float getFilteredMagnitude() const;
+    Scalar getFilteredMagnitude() const;
 
     /**
      * @brief Get peak magnitude recorded
      *
-     * @return float Peak magnitude in g
+     * @return Scalar Peak magnitude
      */
-    float getPeakMagnitude() const;
+    Scalar getPeakMagnitude() const;
 
     /**
      * @brief Reset peak magnitude tracker
@@ -160,25 +304,35 @@ public:
     void resetPeak();
 
     /**
-     * @brief Reset all filters and peak tracking
+     * @brief Reset all filters, decimators and peak tracking
      */
     void reset();
 
     /**
      * @brief Get the last processed (filtered) data
      *
-     * @return const AccelData& Last filtered reading
+     * @return const Sample& Last filtered reading
      */
-    const AccelData& getLastFiltered() const;
+    const Sample& getLastFiltered() const;
 
 private:
-    MovingAverage<float, MOVING_AVG_WINDOW_SIZE> filterX_;
-    MovingAverage<float, MOVING_AVG_WINDOW_SIZE> filterY_;
-    MovingAverage<float, MOVING_AVG_WINDOW_SIZE> filterZ_;
-    MovingAverage<float, MOVING_AVG_WINDOW_SIZE> filterMag_;
+    FilterChain<Scalar> filterX_;
+    FilterChain<Scalar> filterY_;
+    FilterChain<Scalar> filterZ_;
+    FilterChain<Scalar> filterMag_;
+    BasicDecimator<Sample> decimators_[PROCESSOR_OUTPUT_COUNT];
+    uint32_t outputHz_[PROCESSOR_OUTPUT_COUNT];
+    uint32_t rateHz_;
+    uint8_t readyOutputs_;  // Bit per ProcessorOutput, set by the last process()
+
+    Sample lastFiltered_;
+    Scalar filteredMagnitude_;
+    Scalar peakMagnitude_;
 
-    AccelData lastFiltered_;
-    float peakMagnitude_;
+    void configureDecimator(size_t index);
 };
 
+using SignalProcessor = BasicSignalProcessor<AccelData>;
+using FixedSignalProcessor = BasicSignalProcessor<AccelFixed>;
+
 #endif // SIGNAL_PROCESSING_H
@@ -0,0 +1,369 @@
+/**
+ * @file spectrum.cpp
+ * @brief Spectrum engine implementation
+ */
+
+#include "spectrum.h"
+#include <cmath>
+
+constexpr int Q15_BITS = 15;
+constexpr size_t SPECTRUM_HALF = SPECTRUM_FFT_SIZE / 2;
+
+// Reason: full-scale input summed over more frames than this could
+// overflow the uint64_t power accumulators
+constexpr uint16_t SPECTRUM_MAX_AVERAGED = 32;
+
+// Band RMS from summed |2X|^2 of the positive bins (periodic Hann:
+// sum of w^2 = 3N/8): rms^2 = sum |2X|^2 / (3 N^2 / 4)
+constexpr uint64_t SPECTRUM_BAND_DIVISOR = 3ULL * SPECTRUM_FFT_SIZE * SPECTRUM_FFT_SIZE / 4;
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : taskHandle_(nullptr)
+    , window_{}
+    , cos_{}
+    , sin_{}
+    , history_{}
+    , historyHead_(0)
+    , historyCount_(0)
+    , sinceFrame_(0)
+    , inputRateHz_(0)
+    , inputChannel_(static_cast<uint8_t>(SpectrumChannel::MAGNITUDE))
+    , frame_{}
+    , frameRateHz_(0)
+    , frameChannel_(0)
+    , frameBusy_(false)
+    , droppedFrames_(0)
+    , re_{}
+    , im_{}
+    , power_{}
+    , averaged_(0)
+    , lastPublishMs_(0)
+    , averageRateHz_(0)
+    , averageChannel_(0)
+    , bandEdgesHz_{}
+    , channel_(static_cast<uint8_t>(SpectrumChannel::MAGNITUDE))
+    , pendingBandEdgesHz_{}
+    , bandsPending_(false)
+    , results_() {
+    for (size_t i = 0; i <= SPECTRUM_BAND_COUNT; i++) {
+        bandEdgesHz_[i] = SPECTRUM_DEFAULT_BAND_EDGES_HZ[i];
+    }
+}
+
+bool SpectrumAnalyzer::begin() {
+    // Periodic Hann (symmetric about N/2) and the twiddles W_N^k for k < N/2
+    for (size_t i = 0; i <= SPECTRUM_HALF; i++) {
+        float w = 0.5f * (1.0f - cosf(2.0f * static_cast<float>(M_PI) * i / SPECTRUM_FFT_SIZE));
+        window_[i] = static_cast<int16_t>(lroundf(w * INT16_MAX));
+    }
+    for (size_t k = 0; k < SPECTRUM_HALF; k++) {
+        float angle = 2.0f * static_cast<float>(M_PI) * k / SPECTRUM_FFT_SIZE;
+        cos_[k] = static_cast<int16_t>(lroundf(cosf(angle) * INT16_MAX));
+        sin_[k] = static_cast<int16_t>(lroundf(sinf(angle) * INT16_MAX));
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        &SpectrumAnalyzer::taskEntry, "spectrum", SPECTRUM_TASK_STACK_SIZE,
+        this, SPECTRUM_TASK_PRIORITY, &taskHandle_, 0);
+
+    if (created != pdPASS) {
+        if (DEBUG_ENABLED) {
+            Serial.println("ERROR: Failed to create spectrum task");
+        }
+        taskHandle_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SpectrumAnalyzer::addSample(const RawAccel& counts, uint32_t rateHz) {
+    uint8_t channel = channel_.load(std::memory_order_relaxed);
+    if (rateHz != inputRateHz_ || channel != inputChannel_) {
+        inputRateHz_ = rateHz;
+        inputChannel_ = channel;
+        historyHead_ = 0;
+        historyCount_ = 0;
+        sinceFrame_ = 0;
+    }
+
+    int32_t value;
+    switch (static_cast<SpectrumChannel>(channel)) {
+        case SpectrumChannel::X: value = static_cast<int32_t>(counts.x) << ACCEL_FIXED_FRAC_BITS; break;
+        case SpectrumChannel::Y: value = static_cast<int32_t>(counts.y) << ACCEL_FIXED_FRAC_BITS; break;
+        case SpectrumChannel::Z: value = static_cast<int32_t>(counts.z) << ACCEL_FIXED_FRAC_BITS; break;
+        default:
+            {
+                // Root of the Q8 sum of squares gives the magnitude in Q4
+                uint64_t sumSquares = static_cast<uint64_t>(static_cast<int32_t>(counts.x) * counts.x)
+                                    + static_cast<uint64_t>(static_cast<int32_t>(counts.y) * counts.y)
+                                    + static_cast<uint64_t>(static_cast<int32_t>(counts.z) * counts.z);
+                value = static_cast<int32_t>(isqrt64(sumSquares << (2 * ACCEL_FIXED_FRAC_BITS)));
+            }
+            break;
+    }
+
+    history_[historyHead_] = value;
+    historyHead_ = (historyHead_ + 1) & (SPECTRUM_FFT_SIZE - 1);
+    if (historyCount_ < SPECTRUM_FFT_SIZE) {
+        historyCount_++;
+    }
+
+    // A frame every half frame once the ring is full (50% overlap)
+    if (++sinceFrame_ < SPECTRUM_HALF || historyCount_ < SPECTRUM_FFT_SIZE) {
+        return;
+    }
+    sinceFrame_ = 0;
+
+    if (frameBusy_.load(std::memory_order_acquire) || !taskHandle_) {
+        droppedFrames_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Unroll oldest-first; the head is the oldest sample of a full ring
+    for (size_t i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+        frame_[i] = history_[(historyHead_ + i) & (SPECTRUM_FFT_SIZE - 1)];
+    }
+    frameRateHz_ = inputRateHz_;
+    frameChannel_ = inputChannel_;
+    frameBusy_.store(true, std::memory_order_release);
+    xTaskNotifyGive(taskHandle_);
+}
+
+void SpectrumAnalyzer::setChannel(SpectrumChannel channel) {
+    channel_.store(static_cast<uint8_t>(channel));
+}
+
+bool SpectrumAnalyzer::setBands(const uint16_t edgesHz[SPECTRUM_BAND_COUNT + 1]) {
+    for (size_t i = 0; i < SPECTRUM_BAND_COUNT; i++) {
+        if (edgesHz[i] >= edgesHz[i + 1]) {
+            return false;
+        }
+    }
+
+    // Reason: applied by the task before its next frame; concurrent
+    // setters are not expected (serial and BLE commands only)
+    for (size_t i = 0; i <= SPECTRUM_BAND_COUNT; i++) {
+        pendingBandEdgesHz_[i] = edgesHz[i];
+    }
+    bandsPending_.store(true, std::memory_order_release);
+    return true;
+}
+
+uint32_t SpectrumAnalyzer::resultCount() const {
+    return results_.sequence();
+}
+
+bool SpectrumAnalyzer::latest(SpectrumResult& out) const {
+    return results_.read(out);
+}
+
+void SpectrumAnalyzer::taskEntry(void* param) {
+    static_cast<SpectrumAnalyzer*>(param)->run();
+}
+
+void SpectrumAnalyzer::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (frameBusy_.load(std::memory_order_acquire)) {
+            analyseFrame();
+        }
+    }
+}
+
+void SpectrumAnalyzer::analyseFrame() {
+    if (bandsPending_.exchange(false, std::memory_order_acquire)) {
+        for (size_t i = 0; i <= SPECTRUM_BAND_COUNT; i++) {
+            bandEdgesHz_[i] = pendingBandEdgesHz_[i];
+        }
+    }
+
+    uint32_t rateHz = frameRateHz_;
+    uint8_t channel = frameChannel_;
+
+    // Remove the window-weighted mean (gravity)
+    // Reason: a plain mean leaves the windowed remainder of any partial
+    // period at DC, which leaks into bin 1 as a false low-frequency peak
+    int64_t weighted = 0;
+    int64_t weights = 0;
+    for (size_t i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+        int32_t w = window_[i <= SPECTRUM_HALF ? i : SPECTRUM_FFT_SIZE - i];
+        weighted += static_cast<int64_t>(frame_[i]) * w;
+        weights += w;
+    }
+    int32_t mean = static_cast<int32_t>(weighted / weights);
+
+    // Window and pack even/odd samples as the real/imaginary parts of an
+    // N/2-point complex sequence
+    for (size_t n = 0; n < SPECTRUM_HALF; n++) {
+        size_t even = 2 * n;
+        size_t odd = even + 1;
+        int32_t wEven = window_[even <= SPECTRUM_HALF ? even : SPECTRUM_FFT_SIZE - even];
+        int32_t wOdd = window_[odd <= SPECTRUM_HALF ? odd : SPECTRUM_FFT_SIZE - odd];
+        re_[n] = static_cast<int32_t>((static_cast<int64_t>(frame_[even] - mean) * wEven) >> Q15_BITS);
+        im_[n] = static_cast<int32_t>((static_cast<int64_t>(frame_[odd] - mean) * wOdd) >> Q15_BITS);
+    }
+
+    // The frame is copied out; the sampler may hand over the next one
+    frameBusy_.store(false, std::memory_order_release);
+
+    fft();
+
+    // Start a new average on a rate or channel change
+    uint32_t now = millis();
+    if (rateHz != averageRateHz_ || channel != averageChannel_) {
+        for (size_t k = 0; k < SPECTRUM_BINS; k++) {
+            power_[k] = 0;
+        }
+        averaged_ = 0;
+        averageRateHz_ = rateHz;
+        averageChannel_ = channel;
+        lastPublishMs_ = now;
+    }
+
+    // Split the complex FFT into the real spectrum X[k], k < N/2:
+    // 2X[k] = (Z[k] + conj(Z[M-k])) - j W^k (Z[k] - conj(Z[M-k]))
+    for (size_t k = 0; k < SPECTRUM_BINS; k++) {
+        size_t m = (SPECTRUM_BINS - k) & (SPECTRUM_BINS - 1);
+        int64_t ar = re_[k];
+        int64_t ai = im_[k];
+        int64_t br = re_[m];
+        int64_t bi = im_[m];
+
+        int64_t evenRe = ar + br;
+        int64_t evenIm = ai - bi;
+        int64_t oddRe = ai + bi;
+        int64_t oddIm = br - ar;
+
+        // Multiply by W^k = cos - j sin
+        int64_t c = cos_[k];
+        int64_t s = sin_[k];
+        int64_t xRe = evenRe + ((oddRe * c + oddIm * s) >> Q15_BITS);
+        int64_t xIm = evenIm + ((oddIm * c - oddRe * s) >> Q15_BITS);
+
+        power_[k] += static_cast<uint64_t>(xRe * xRe) + static_cast<uint64_t>(xIm * xIm);
+    }
+    averaged_++;
+
+    if (now - lastPublishMs_ >= SPECTRUM_PUBLISH_MS || averaged_ >= SPECTRUM_MAX_AVERAGED) {
+        publish();
+        lastPublishMs_ = now;
+    }
+}
+
+void SpectrumAnalyzer::fft() {
+    // In-place radix-2 decimation-in-time FFT of re_/im_ (N/2 points)
+    // Reason: Q4 input grows by at most N/2 per frame, so int32_t data
+    // with int64_t products needs no per-stage scaling
+    for (size_t i = 1, j = 0; i < SPECTRUM_BINS; i++) {
+        size_t bit = SPECTRUM_BINS >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            int32_t t = re_[i]; re_[i] = re_[j]; re_[j] = t;
+            t = im_[i]; im_[i] = im_[j]; im_[j] = t;
+        }
+    }
+
+    for (size_t size = 2; size <= SPECTRUM_BINS; size <<= 1) {
+        size_t half = size / 2;
+        size_t step = SPECTRUM_FFT_SIZE / size;  // W_size^k = W_N^(k * N / size)
+
+        for (size_t start = 0; start < SPECTRUM_BINS; start += size) {
+            for (size_t k = 0; k < half; k++) {
+                size_t a = start + k;
+                size_t b = a + half;
+                int64_t c = cos_[k * step];
+                int64_t s = sin_[k * step];
+
+                int32_t tRe = static_cast<int32_t>((re_[b] * c + im_[b] * s) >> Q15_BITS);
+                int32_t tIm = static_cast<int32_t>((im_[b] * c - re_[b] * s) >> Q15_BITS);
+
+                re_[b] = re_[a] - tRe;
+                im_[b] = im_[a] - tIm;
+                re_[a] += tRe;
+                im_[a] += tIm;
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::publish() {
+    SpectrumResult& result = results_.next();
+
+    result.sequence = results_.nextSequence();
+    result.rateHz = static_cast<uint16_t>(averageRateHz_);
+    result.frames = averaged_;
+    result.channel = static_cast<SpectrumChannel>(averageChannel_);
+    for (size_t i = 0; i <= SPECTRUM_BAND_COUNT; i++) {
+        result.bandEdgesHz[i] = bandEdgesHz_[i];
+    }
+
+    // Sine amplitude per bin: |X| = A N / 4 with the Hann window
+    for (size_t k = 0; k < SPECTRUM_BINS; k++) {
+        power_[k] /= averaged_;
+        uint32_t amplitude = k == 0 ? 0 : (isqrt64(power_[k]) * 2) / SPECTRUM_FFT_SIZE;
+        result.bins[k] = static_cast<uint16_t>(amplitude > UINT16_MAX ? UINT16_MAX : amplitude);
+    }
+
+    // Band RMS over the bins inside [low, high] Hz
+    for (size_t band = 0; band < SPECTRUM_BAND_COUNT; band++) {
+        uint32_t first = (static_cast<uint32_t>(bandEdgesHz_[band]) * SPECTRUM_FFT_SIZE + averageRateHz_ - 1)
+                       / averageRateHz_;
+        uint32_t last = (static_cast<uint32_t>(bandEdgesHz_[band + 1]) * SPECTRUM_FFT_SIZE) / averageRateHz_;
+        if (first < 1) {
+            first = 1;
+        }
+        if (last > SPECTRUM_BINS - 1) {
+            last = SPECTRUM_BINS - 1;
+        }
+
+        uint64_t energy = 0;
+        for (uint32_t k = first; k <= last; k++) {
+            energy += power_[k];
+        }
+        result.bandRms[band] = first <= last ? static_cast<int32_t>(isqrt64(energy / SPECTRUM_BAND_DIVISOR)) : 0;
+    }
+
+    // Strongest local maxima, frequency refined by parabolic interpolation
+    result.peakCount = 0;
+    for (size_t k = 1; k + 1 < SPECTRUM_BINS; k++) {
+        uint16_t amp = result.bins[k];
+        if (amp == 0 || amp <= result.bins[k - 1] || amp < result.bins[k + 1]) {
+            continue;
+        }
+
+        size_t slot = result.peakCount;
+        while (slot > 0 && result.peaks[slot - 1].amplitude < amp) {
+            slot--;
+        }
+        if (slot >= SPECTRUM_PEAK_COUNT) {
+            continue;
+        }
+
+        size_t end = result.peakCount < SPECTRUM_PEAK_COUNT ? result.peakCount : SPECTRUM_PEAK_COUNT - 1;
+        for (size_t i = end; i > slot; i--) {
+            result.peaks[i] = result.peaks[i - 1];
+        }
+
+        float left = result.bins[k - 1];
+        float right = result.bins[k + 1];
+        float curvature = left - 2.0f * amp + right;
+        float offset = curvature != 0.0f ? 0.5f * (left - right) / curvature : 0.0f;
+        float frequencyHz = (k + offset) * averageRateHz_ / SPECTRUM_FFT_SIZE;
+
+        result.peaks[slot].frequencyDeciHz = static_cast<uint16_t>(frequencyHz * 10.0f + 0.5f);
+        result.peaks[slot].amplitude = amp;
+        if (result.peakCount < SPECTRUM_PEAK_COUNT) {
+            result.peakCount++;
+        }
+    }
+
+    results_.publish();
+
+    for (size_t k = 0; k < SPECTRUM_BINS; k++) {
+        power_[k] = 0;
+    }
+    averaged_ = 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file spectrum.h
+ * @brief Vibration spectrum: windowed real FFT, peaks and band energies
+ *
+ * The sampler feeds one unfiltered channel into a ring; every half frame
+ * (50% overlap) the newest SPECTRUM_FFT_SIZE samples are handed to a
+ * low-priority task. That task removes the frame mean, applies a Hann
+ * window and runs a fixed-point real FFT (an N/2-point complex FFT plus
+ * a split step, Q15 twiddles, int64 products). Frame powers are averaged
+ * and published with the top peaks and the RMS of each configured band.
+ */
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "sample_ring.h"
+#include "signal_processing.h"
+
+static_assert((SPECTRUM_FFT_SIZE & (SPECTRUM_FFT_SIZE - 1)) == 0, "SPECTRUM_FFT_SIZE must be a power of two");
+
+constexpr size_t SPECTRUM_BINS = SPECTRUM_FFT_SIZE / 2;
+
+/**
+ * @brief Signal the spectrum is computed from
+ */
+enum class SpectrumChannel : uint8_t {
+    X = 0,
+    Y = 1,
+    Z = 2,
+    MAGNITUDE = 3
+};
+
+/**
+ * @brief One spectral peak
+ */
+struct SpectrumPeak {
+    uint16_t frequencyDeciHz;  // Interpolated peak frequency (0.1 Hz)
+    uint16_t amplitude;        // Sine amplitude (Q4 counts, saturating)
+};
+
+/**
+ * @brief One published spectrum
+ */
+struct SpectrumResult {
+    uint32_t sequence;      // Result number since boot (1-based)
+    uint16_t rateHz;        // Sample rate of the frames
+    uint16_t frames;        // Frames averaged into this result
+    SpectrumChannel channel;
+    uint8_t peakCount;      // Valid entries in peaks (strongest first)
+    SpectrumPeak peaks[SPECTRUM_PEAK_COUNT];
+    uint16_t bandEdgesHz[SPECTRUM_BAND_COUNT + 1];
+    int32_t bandRms[SPECTRUM_BAND_COUNT];  // RMS within each band (Q4 counts)
+    uint16_t bins[SPECTRUM_BINS];          // Sine amplitude per bin (Q4 counts, saturating)
+
+    /**
+     * @brief Width of one bin in Hz
+     */
+    float binHz() const { return static_cast<float>(rateHz) / SPECTRUM_FFT_SIZE; }
+};
+
+/**
+ * @brief Spectrum engine and its analysis task
+ *
+ * addSample() belongs to the sampler task. The setters and latest() are
+ * safe from any task: results are published into one of two slots, so a
+ * reader copies the newest while the next is built.
+ */
+class SpectrumAnalyzer {
+public:
+    SpectrumAnalyzer();
+
+    /**
+     * @brief Build the window and twiddle tables and start the task
+     *
+     * @return true if the task was created
+     */
+    bool begin();
+
+    /**
+     * @brief Feed one sample (sampler task only)
+     *
+     * A rate or channel change restarts the frame.
+     *
+     * @param counts Calibrated, unfiltered counts
+     * @param rateHz Current sample rate
+     */
+    void addSample(const RawAccel& counts, uint32_t rateHz);
+
+    /**
+     * @brief Select the analysed channel (thread-safe)
+     */
+    void setChannel(SpectrumChannel channel);
+
+    /**
+     * @brief Get the analysed channel
+     */
+    SpectrumChannel getChannel() const { return static_cast<SpectrumChannel>(channel_.load()); }
+
+    /**
+     * @brief Replace the band edges (thread-safe)
+     *
+     * @param edgesHz SPECTRUM_BAND_COUNT + 1 ascending edges in Hz
+     * @return false if the edges are not ascending
+     */
+    bool setBands(const uint16_t edgesHz[SPECTRUM_BAND_COUNT + 1]);
+
+    /**
+     * @brief Number of results published since boot
+     */
+    uint32_t resultCount() const;
+
+    /**
+     * @brief Copy the newest result
+     *
+     * @param out Destination (large: keep it off small task stacks)
+     * @return true if a result has been published
+     */
+    bool latest(SpectrumResult& out) const;
+
+    /**
+     * @brief Frames skipped because the task was still busy
+     */
+    uint32_t droppedFrames() const { return droppedFrames_.load(); }
+
+private:
+    TaskHandle_t taskHandle_;
+
+    // Lookup tables (built once in begin())
+    int16_t window_[SPECTRUM_FFT_SIZE / 2 + 1];  // Hann, Q15, first half (symmetric)
+    int16_t cos_[SPECTRUM_FFT_SIZE / 2];         // cos(2 pi k / N), Q15
+    int16_t sin_[SPECTRUM_FFT_SIZE / 2];         // sin(2 pi k / N), Q15
+
+    // Input ring (sampler task only)
+    int32_t history_[SPECTRUM_FFT_SIZE];
+    size_t historyHead_;
+    size_t historyCount_;
+    size_t sinceFrame_;
+    uint32_t inputRateHz_;
+    uint8_t inputChannel_;
+
+    // Frame handed to the task
+    int32_t frame_[SPECTRUM_FFT_SIZE];
+    uint32_t frameRateHz_;
+    uint8_t frameChannel_;
+    std::atomic<bool> frameBusy_;
+    std::atomic<uint32_t> droppedFrames_;
+
+    // Analysis state (spectrum task only)
+    int32_t re_[SPECTRUM_BINS];
+    int32_t im_[SPECTRUM_BINS];
+    uint64_t power_[SPECTRUM_BINS];  // Sum of |2X|^2 over averaged frames
+    uint16_t averaged_;
+    uint32_t lastPublishMs_;
+    uint32_t averageRateHz_;
+    uint8_t averageChannel_;
+    uint16_t bandEdgesHz_[SPECTRUM_BAND_COUNT + 1];
+
+    // Settings from other tasks
+    std::atomic<uint8_t> channel_;
+    uint16_t pendingBandEdgesHz_[SPECTRUM_BAND_COUNT + 1];
+    std::atomic<bool> bandsPending_;
+
+    // Published results; the next one is built in results_.next()
+    DoubleBuffered<SpectrumResult> results_;
+
+    static void taskEntry(void* param);
+
+    void run();
+    void analyseFrame();
+    void fft();
+    void publish();
+};
+
+#endif // SPECTRUM_H
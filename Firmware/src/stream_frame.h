@@ -0,0 +1,146 @@
+/**
+ * @file stream_frame.h
+ * @brief Batched binary frame format for raw sample streaming
+ *
+ * One frame carries up to 255 samples as int16 counts with per-sample
+ * time deltas. The same format is used on every binary transport.
+ *
+ * Frame layout (little-endian):
+ *
+ *   Offset  Size  Field
+ *   0       2     Sync word 0xA5 0x5A
+ *   2       1     Format version (STREAM_FRAME_VERSION)
+ *   3       1     Sample count N
+ *   4       2     Sequence number (increments per frame, wraps)
+ *   6       4     Timestamp of first sample (us, see time_sync.h)
+ *   10      2     Sample rate (Hz)
+ *   12      8*N   Samples: dt_us(u16), x(i16), y(i16), z(i16)
+ *   12+8N   2     CRC-16/CCITT-FALSE over bytes 2 .. 11+8N
+ *
+ * dt_us is the time since the previous sample in the frame (0 for the
+ * first). Counts are calibrated, at 49 mg/LSB. A sequence gap means a
+ * frame was lost in transport; a dt larger than the sample period means
+ * samples were dropped before they were framed.
+ */
+
+#ifndef STREAM_FRAME_H
+#define STREAM_FRAME_H
+
+#include <Arduino.h>
+#include "signal_processing.h"
+
+constexpr uint8_t STREAM_FRAME_SYNC_0 = 0xA5;
+constexpr uint8_t STREAM_FRAME_SYNC_1 = 0x5A;
+constexpr uint8_t STREAM_FRAME_VERSION = 1;
+constexpr size_t STREAM_FRAME_HEADER_SIZE = 12;
+constexpr size_t STREAM_FRAME_SAMPLE_SIZE = 8;
+constexpr size_t STREAM_FRAME_CRC_SIZE = 2;
+
+/**
+ * @brief Size in bytes of a frame holding a given number of samples
+ */
+constexpr size_t streamFrameSize(size_t samples) {
+    return STREAM_FRAME_HEADER_SIZE + samples * STREAM_FRAME_SAMPLE_SIZE + STREAM_FRAME_CRC_SIZE;
+}
+
+/**
+ * @brief Number of samples that fit in a frame of a given size
+ */
+constexpr size_t streamFrameCapacity(size_t bytes) {
+    return bytes < streamFrameSize(0) ? 0 :
+        ((bytes - streamFrameSize(0)) / STREAM_FRAME_SAMPLE_SIZE > 255 ? 255 :
+         (bytes - streamFrameSize(0)) / STREAM_FRAME_SAMPLE_SIZE);
+}
+
+/**
+ * @brief Compute CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ *
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc Running CRC (pass the previous result to continue)
+ * @return uint16_t Updated CRC
+ */
+uint16_t crc16Ccitt(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Builds stream frames in place in a caller-owned buffer
+ *
+ * Usage: begin(), add() until it returns false or the batch is complete,
+ * then finish() to get the frame length. The finished frame stays in the
+ * buffer until the next sample is added; call begin() before each frame.
+ */
+class StreamFrameWriter {
+public:
+    /**
+     * @brief Construct a writer over a buffer
+     *
+     * @param buffer Destination buffer
+     * @param capacity Buffer size in bytes (sets the max samples per frame)
+     */
+    StreamFrameWriter(uint8_t* buffer, size_t capacity);
+
+    /**
+     * @brief Limit frames to fewer bytes than the buffer holds
+     *
+     * Used when the transport's packet size is negotiated at runtime
+     * (e.g. BLE ATT MTU). Takes effect from the next sample added.
+     *
+     * @param bytes Max frame size (clamped to the buffer capacity)
+     */
+    void setFrameLimit(size_t bytes);
+
+    /**
+     * @brief Start a new frame
+     *
+     * @param rateHz Sample rate written to the header
+     */
+    void begin(uint16_t rateHz);
+
+    /**
+     * @brief Append a sample
+     *
+     * @param timestampUs Sample time in microseconds
+     * @param counts Calibrated counts
+     * @return false if the frame is full or the time delta does not fit
+     *         (the sample was not added; finish and start a new frame)
+     */
+    bool add(uint32_t timestampUs, const RawAccel& counts);
+
+    /**
+     * @brief Complete the frame (sample count, sequence number, CRC)
+     *
+     * @return size_t Frame length in bytes (0 if the frame is empty)
+     */
+    size_t finish();
+
+    /**
+     * @brief Get the number of samples in the current frame
+     */
+    uint8_t count() const { return count_; }
+
+    /**
+     * @brief Check if the current frame cannot take another sample
+     */
+    bool isFull() const { return count_ >= maxSamples_; }
+
+    /**
+     * @brief Get timestamp of the first sample in the current frame
+     */
+    uint32_t firstTimestamp() const { return firstTimestampUs_; }
+
+    /**
+     * @brief Get the sequence number the next finished frame will carry
+     */
+    uint16_t nextSequence() const { return sequence_; }
+
+private:
+    uint8_t* buffer_;
+    uint8_t capacitySamples_;
+    uint8_t maxSamples_;
+    uint8_t count_;
+    uint16_t sequence_;
+    uint32_t firstTimestampUs_;
+    uint32_t lastTimestampUs_;
+};
+
+#endif // STREAM_FRAME_H
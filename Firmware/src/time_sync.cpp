@@ -0,0 +1,270 @@
+/**
+ * @file time_sync.cpp
+ * @brief Time synchronization implementation
+ */
+
+#include "time_sync.h"
+#include <esp_timer.h>
+
+TimeSync timeSync;
+
+const char* timeSyncStateName(TimeSyncState state) {
+    switch (state) {
+        case TimeSyncState::UNSYNCED: return "unsynced";
+        case TimeSyncState::SYNCED:   return "synced";
+        case TimeSyncState::HELD:     return "held";
+    }
+    return "unknown";
+}
+
+static uint64_t readUint64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static void packUint64(uint8_t* buffer, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static void packUint32(uint8_t* buffer, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static int32_t saturate32(int64_t value) {
+    return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : static_cast<int32_t>(value));
+}
+
+TimeSync::TimeSync()
+    : params_()
+    , window_{}
+    , windowCount_(0)
+    , windowNext_(0)
+    , bucketStartUs_(0)
+    , synced_(false)
+    , driftPpb_(0)
+    , lastDelayUs_(0)
+    , bestDelayUs_(0)
+    , lastErrorUs_(0)
+    , lastExchangeMs_(0)
+    , exchanges_(0)
+    , rejected_(0)
+    , steps_(0)
+    , probeValid_(false)
+    , probeSequence_(0)
+    , probeT1_(0)
+    , probeT2_(0)
+    , probeT3_(0) {
+}
+
+uint64_t TimeSync::localUs() {
+    // Reason: micros() is this counter truncated to 32 bits
+    return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+TimeSync::ClockParams TimeSync::current() const {
+    ClockParams params{};
+    params_.read(params);
+    return params;
+}
+
+void TimeSync::publish(const ClockParams& params) {
+    params_.publish(params);
+}
+
+uint64_t TimeSync::toSyncedUs(uint64_t local) const {
+    ClockParams params = current();
+    if (!params.synced) {
+        return local;
+    }
+    int64_t elapsed = static_cast<int64_t>(local) - params.referenceUs;
+    return static_cast<uint64_t>(static_cast<int64_t>(local) + params.offsetUs
+                                 + elapsed * params.driftPpb / 1000000000LL);
+}
+
+uint32_t TimeSync::toSyncedMs(uint32_t sampleUs) const {
+    uint64_t now = toSyncedUs(localUs());
+    // Reason: a sample is seconds old at most (or a little ahead of a
+    // slewing clock), so the signed 32-bit distance picks the right wrap
+    int32_t ageUs = static_cast<int32_t>(static_cast<uint32_t>(now) - sampleUs);
+    return static_cast<uint32_t>((static_cast<int64_t>(now) - ageUs) / 1000);
+}
+
+size_t TimeSync::handleMessage(const uint8_t* message, size_t length, uint64_t receivedUs, uint8_t* reply) {
+    if (length < TIME_SYNC_REQUEST_SIZE) {
+        return 0;
+    }
+
+    uint8_t type = message[0];
+    uint8_t sequence = message[1];
+    uint64_t hostUs = readUint64(&message[2]);
+
+    if (type == TIME_SYNC_MSG_PROBE) {
+        probeValid_ = true;
+        probeSequence_ = sequence;
+        probeT1_ = hostUs;
+        probeT2_ = receivedUs;
+        // Stamped last so the reply time covers building it
+        probeT3_ = localUs();
+
+        reply[0] = TIME_SYNC_MSG_PROBE;
+        reply[1] = sequence;
+        packUint64(&reply[2], probeT2_);
+        packUint64(&reply[10], probeT3_);
+        return TIME_SYNC_PROBE_REPLY_SIZE;
+    }
+
+    if (type != TIME_SYNC_MSG_RESULT) {
+        return 0;
+    }
+
+    // A result without its probe (lost, or another host's) is not used
+    if (probeValid_ && sequence == probeSequence_) {
+        probeValid_ = false;
+        int64_t t1 = static_cast<int64_t>(probeT1_);
+        int64_t t2 = static_cast<int64_t>(probeT2_);
+        int64_t t3 = static_cast<int64_t>(probeT3_);
+        int64_t t4 = static_cast<int64_t>(hostUs);
+
+        int64_t delay = (t4 - t1) - (t3 - t2);
+        if (delay < 0 || delay > static_cast<int64_t>(TIME_SYNC_MAX_DELAY_US)) {
+            rejected_++;
+        } else {
+            addExchange(t2 + (t3 - t2) / 2, ((t1 - t2) + (t4 - t3)) / 2, static_cast<uint32_t>(delay));
+        }
+    }
+
+    reply[0] = TIME_SYNC_MSG_RESULT;
+    reply[1] = sequence;
+    reply[2] = static_cast<uint8_t>(state(millis()));
+    packUint32(&reply[3], static_cast<uint32_t>(lastErrorUs_));
+    packUint32(&reply[7], lastDelayUs_);
+    packUint32(&reply[11], static_cast<uint32_t>(driftPpb_));
+    return TIME_SYNC_RESULT_REPLY_SIZE;
+}
+
+void TimeSync::addExchange(int64_t localUs, int64_t offsetUs, uint32_t delayUs) {
+    int64_t errorUs = offsetUs;
+    if (synced_) {
+        errorUs = offsetUs - (static_cast<int64_t>(toSyncedUs(localUs)) - localUs);
+    }
+
+    // The true offset is within half the round trip of this one; further
+    // out, the host or its reference clock changed
+    int64_t limitUs = delayUs / 2 + TIME_SYNC_STEP_US;
+    if (!synced_ || errorUs > limitUs || errorUs < -limitUs) {
+        windowCount_ = 0;
+        windowNext_ = 0;
+        steps_++;
+        if (DEBUG_ENABLED) {
+            Serial.printf("Time sync: clock stepped by %lld us\n", static_cast<long long>(errorUs));
+        }
+    }
+
+    // Within a bucket only a shorter round trip replaces the kept exchange
+    if (windowCount_ > 0 && localUs - bucketStartUs_ < static_cast<int64_t>(TIME_SYNC_BUCKET_US)) {
+        Exchange& newest = window_[(windowNext_ + TIME_SYNC_WINDOW - 1) % TIME_SYNC_WINDOW];
+        if (delayUs < newest.delayUs) {
+            newest = {localUs, offsetUs, delayUs};
+        }
+    } else {
+        window_[windowNext_] = {localUs, offsetUs, delayUs};
+        windowNext_ = (windowNext_ + 1) % TIME_SYNC_WINDOW;
+        if (windowCount_ < TIME_SYNC_WINDOW) {
+            windowCount_++;
+        }
+        bucketStartUs_ = localUs;
+    }
+
+    synced_ = true;
+    lastErrorUs_ = saturate32(errorUs);
+    lastDelayUs_ = delayUs;
+    lastExchangeMs_ = millis();
+    exchanges_++;
+    fit();
+}
+
+void TimeSync::fit() {
+    bestDelayUs_ = UINT32_MAX;
+    for (size_t i = 0; i < windowCount_; i++) {
+        if (window_[i].delayUs < bestDelayUs_) {
+            bestDelayUs_ = window_[i].delayUs;
+        }
+    }
+
+    // Reason: queueing only ever adds delay, so the exchanges with the
+    // shortest round trips carry the least asymmetry
+    uint64_t maxDelayUs = static_cast<uint64_t>(bestDelayUs_) * 2;
+
+    // Centre on the oldest exchange so the sums keep their precision
+    const Exchange& origin = window_[windowCount_ < TIME_SYNC_WINDOW ? 0 : windowNext_];
+    size_t n = 0;
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumXX = 0.0;
+    double sumXY = 0.0;
+    int64_t minX = INT64_MAX;
+    int64_t maxX = INT64_MIN;
+    for (size_t i = 0; i < windowCount_; i++) {
+        const Exchange& e = window_[i];
+        if (e.delayUs > maxDelayUs) {
+            continue;
+        }
+        int64_t dx = e.localUs - origin.localUs;
+        double x = static_cast<double>(dx);
+        double y = static_cast<double>(e.offsetUs - origin.offsetUs);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        minX = dx < minX ? dx : minX;
+        maxX = dx > maxX ? dx : maxX;
+        n++;
+    }
+
+    double meanX = sumX / n;
+    double meanY = sumY / n;
+    if (n >= 3 && maxX - minX >= static_cast<int64_t>(TIME_SYNC_MIN_DRIFT_SPAN_US)) {
+        double slope = (sumXY - n * meanX * meanY) / (sumXX - n * meanX * meanX);
+        double ppb = slope * 1e9;
+        if (ppb > TIME_SYNC_MAX_DRIFT_PPB) {
+            ppb = TIME_SYNC_MAX_DRIFT_PPB;
+        } else if (ppb < -TIME_SYNC_MAX_DRIFT_PPB) {
+            ppb = -TIME_SYNC_MAX_DRIFT_PPB;
+        }
+        driftPpb_ = static_cast<int32_t>(ppb);
+    }
+    // Until then the previous drift (0 after boot) is kept
+
+    ClockParams params;
+    params.synced = true;
+    params.referenceUs = origin.localUs + static_cast<int64_t>(meanX);
+    params.offsetUs = origin.offsetUs + static_cast<int64_t>(meanY);
+    params.driftPpb = driftPpb_;
+    publish(params);
+}
+
+void TimeSync::reset() {
+    windowCount_ = 0;
+    windowNext_ = 0;
+    synced_ = false;
+    driftPpb_ = 0;
+    lastDelayUs_ = 0;
+    bestDelayUs_ = 0;
+    lastErrorUs_ = 0;
+    probeValid_ = false;
+    publish(ClockParams{});
+}
+
+TimeSyncState TimeSync::state(uint32_t now) const {
+    if (!synced_) {
+        return TimeSyncState::UNSYNCED;
+    }
+    return now - lastExchangeMs_ >= TIME_SYNC_STALE_MS ? TimeSyncState::HELD : TimeSyncState::SYNCED;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file time_sync.h
+ * @brief Host-referenced clock for aligning captures across devices
+ *
+ * Sample timestamps are rebuilt from the ODR against this clock (see
+ * Accelerometer::readFifo()), so once a host has synced the device every
+ * frame, event summary and log block is stamped in the host's time base
+ * instead of the device's free-running micros(). Several sensors synced
+ * to the same host (or to NTP-disciplined hosts) can then be aligned to
+ * the sample.
+ *
+ * Exchange (NTP-style, the same messages over BLE and Wi-Fi):
+ *
+ *   host  -> device  PROBE   type 0x01, seq(u8), t1(u64 host us)
+ *   device -> host   PROBE   type 0x01, seq(u8), t2(u64), t3(u64)
+ *   host  -> device  RESULT  type 0x02, seq(u8), t4(u64 host us)
+ *   device -> host   RESULT  type 0x02, seq(u8), state(u8),
+ *                            error(i32 us), delay(u32 us), drift(i32 ppb)
+ *
+ * t1/t4 are host send/receive times, t2/t3 device receive/reply times in
+ * local microseconds since boot, all little-endian. The RESULT error is
+ * how far this exchange found the synced clock off (saturated to i32; it
+ * is the whole offset on the first exchange). Over Wi-Fi each message is
+ * one UDP datagram starting with TIME_SYNC_MAGIC.
+ *
+ * Each exchange gives an offset ((t1 - t2) + (t4 - t3)) / 2 that is
+ * exact when both directions take equally long, and a round trip
+ * (t4 - t1) - (t3 - t2) bounding its error. The shortest round trip of
+ * each TIME_SYNC_BUCKET_US is kept for the last TIME_SYNC_WINDOW
+ * buckets; those within twice the shortest of all are fitted with a
+ * line, whose slope is the drift of the local crystal against the host
+ * once the window spans TIME_SYNC_MIN_DRIFT_SPAN_US.
+ *
+ *   synced = local + offset + (local - reference) * drift / 1e9
+ *
+ * The synced clock keeps running on the last fit when the host stops
+ * (state HELD). Before the first exchange it is local time, i.e. what
+ * micros() returns.
+ *
+ * Exchanges are handled by loop() only (BLE writes are handed over by
+ * BleService); nowUs() can be called from any task.
+ */
+
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sample_ring.h"
+
+constexpr uint8_t TIME_SYNC_MSG_PROBE = 0x01;
+constexpr uint8_t TIME_SYNC_MSG_RESULT = 0x02;
+constexpr size_t TIME_SYNC_REQUEST_SIZE = 10;   // Both host messages
+constexpr size_t TIME_SYNC_PROBE_REPLY_SIZE = 18;
+constexpr size_t TIME_SYNC_RESULT_REPLY_SIZE = 15;
+constexpr size_t TIME_SYNC_MAX_MESSAGE = 18;
+
+// Prefix of sync datagrams on the Wi-Fi stream port
+constexpr uint8_t TIME_SYNC_MAGIC[4] = {'G', 'S', 'Y', 'N'};
+constexpr size_t TIME_SYNC_MAGIC_SIZE = sizeof(TIME_SYNC_MAGIC);
+
+/**
+ * @brief Synchronization state reported to hosts
+ */
+enum class TimeSyncState : uint8_t {
+    UNSYNCED = 0,  ///< Local time since boot
+    SYNCED = 1,    ///< Following a host
+    HELD = 2       ///< Synced, but no exchange for TIME_SYNC_STALE_MS
+};
+
+/**
+ * @brief Get a state name for logs
+ */
+const char* timeSyncStateName(TimeSyncState state);
+
+/**
+ * @brief Offset and drift estimator with a lock-free synced clock
+ */
+class TimeSync {
+public:
+    TimeSync();
+
+    /**
+     * @brief Local microseconds since boot, without wrap
+     */
+    static uint64_t localUs();
+
+    /**
+     * @brief Current synced time, low 32 bits (safe from any task)
+     *
+     * Wraps like micros(); hosts unwrap it against their own clock.
+     */
+    uint32_t nowUs() const { return static_cast<uint32_t>(toSyncedUs(localUs())); }
+
+    /**
+     * @brief Convert a local timestamp to synced time (safe from any task)
+     *
+     * @param local Local microseconds since boot
+     * @return uint64_t Host microseconds (local time until synced)
+     */
+    uint64_t toSyncedUs(uint64_t local) const;
+
+    /**
+     * @brief Millisecond time of a recent sample (safe from any task)
+     *
+     * The 32-bit sample time is extended against the 64-bit synced clock
+     * before dividing, so the result wraps like millis() (~49.7 days)
+     * instead of every ~71.6 min with the microseconds.
+     *
+     * @param sampleUs Sample time on the nowUs() base, less than ~35 min away
+     * @return uint32_t Synced milliseconds, low 32 bits
+     */
+    uint32_t toSyncedMs(uint32_t sampleUs) const;
+
+    /**
+     * @brief Answer one host message
+     *
+     * @param message Message without any transport prefix
+     * @param length Message length
+     * @param receivedUs localUs() when the message arrived
+     * @param reply Buffer of TIME_SYNC_MAX_MESSAGE bytes
+     * @return size_t Reply length (0 = malformed, nothing to send)
+     */
+    size_t handleMessage(const uint8_t* message, size_t length, uint64_t receivedUs, uint8_t* reply);
+
+    /**
+     * @brief Forget the host and go back to local time
+     */
+    void reset();
+
+    /**
+     * @brief Get the state for reports
+     *
+     * @param now Current time in milliseconds
+     */
+    TimeSyncState state(uint32_t now) const;
+
+    /**
+     * @brief Check if the clock follows a host (SYNCED or HELD)
+     */
+    bool isSynced() const { return synced_; }
+
+    /**
+     * @brief Fitted drift of the local clock (ppb, positive = local slow)
+     */
+    int32_t driftPpb() const { return driftPpb_; }
+
+    /**
+     * @brief Round trip of the newest accepted exchange
+     */
+    uint32_t lastDelayUs() const { return lastDelayUs_; }
+
+    /**
+     * @brief Shortest round trip in the window (bounds the offset error)
+     */
+    uint32_t bestDelayUs() const { return bestDelayUs_; }
+
+    /**
+     * @brief Clock error found by the newest accepted exchange
+     */
+    int32_t lastErrorUs() const { return lastErrorUs_; }
+
+    /**
+     * @brief Exchanges used since boot
+     */
+    uint32_t exchanges() const { return exchanges_; }
+
+    /**
+     * @brief Exchanges rejected for their round trip since boot
+     */
+    uint32_t rejected() const { return rejected_; }
+
+    /**
+     * @brief Clock steps (first sync or a new reference) since boot
+     */
+    uint32_t steps() const { return steps_; }
+
+private:
+    struct Exchange {
+        int64_t localUs;   // Midpoint of t2 and t3
+        int64_t offsetUs;  // Host minus local
+        uint32_t delayUs;
+    };
+
+    struct ClockParams {
+        bool synced;
+        int64_t referenceUs;  // Local time the offset applies at
+        int64_t offsetUs;
+        int32_t driftPpb;
+    };
+
+    // Published clock
+    DoubleBuffered<ClockParams> params_;
+
+    // Estimator state (loop() only)
+    Exchange window_[TIME_SYNC_WINDOW];
+    size_t windowCount_;
+    size_t windowNext_;
+    int64_t bucketStartUs_;
+    bool synced_;
+    int32_t driftPpb_;
+    uint32_t lastDelayUs_;
+    uint32_t bestDelayUs_;
+    int32_t lastErrorUs_;
+    uint32_t lastExchangeMs_;
+    uint32_t exchanges_;
+    uint32_t rejected_;
+    uint32_t steps_;
+
+    // Newest probe, completed by the matching RESULT
+    bool probeValid_;
+    uint8_t probeSequence_;
+    uint64_t probeT1_;
+    uint64_t probeT2_;
+    uint64_t probeT3_;
+
+    ClockParams current() const;
+    void publish(const ClockParams& params);
+    void addExchange(int64_t localUs, int64_t offsetUs, uint32_t delayUs);
+    void fit();
+};
+
+extern TimeSync timeSync;
+
+#endif // TIME_SYNC_H
@@ -4,6 +4,8 @@
  */
 
 #include "touch.h"
+#include "log.h"
+#include "profiler.h"
 
 // CST816D register addresses
 constexpr uint8_t CST816_REG_GESTURE = 0x01;
@@ -13,26 +15,18 @@ constexpr uint8_t CST816_REG_X_LOW = 0x04;
 constexpr uint8_t CST816_REG_Y_HIGH = 0x05;
 constexpr uint8_t CST816_REG_Y_LOW = 0x06;
 
-// Volatile flag for interrupt handling
-volatile bool touchInterrupt = false;
-
-/**
- * @brief Interrupt handler for touch events
- */
-void IRAM_ATTR touchISR() {
-    touchInterrupt = true;
-}
+TouchManager* TouchManager::instance_ = nullptr;
 
 TouchManager::TouchManager()
     : touchWire_(1)  // Use second I2C bus
-    , currentEvent_{TouchGesture::NONE, 0, 0, 0}
+    , taskHandle_(nullptr)
+    , eventQueue_(nullptr)
     , initialized_(false)
     , touching_(false)
-    , lastTouching_(false)
+    , interruptSeen_(false)
     , touchX_(0)
     , touchY_(0)
-    , touchStartTime_(0)
-    , eventPending_(false) {
+    , touchStartTime_(0) {
 }
 
 bool TouchManager::begin() {
@@ -46,16 +40,12 @@ bool TouchManager::begin() {
     digitalWrite(PIN_TOUCH_RST, HIGH);
     delay(300);  // Longer delay for CST816D to fully initialize
 
-    // Setup interrupt pin
-    pinMode(PIN_TOUCH_INT, INPUT);
-    attachInterrupt(digitalPinToInterrupt(PIN_TOUCH_INT), touchISR, FALLING);
-
     // Verify communication by reading a byte
     touchWire_.beginTransmission(TOUCH_I2C_ADDR);
     uint8_t error = touchWire_.endTransmission();
 
     if (error != 0) {
-        Serial.printf("[Touch] CST816D not found at 0x%02X (error %d)\n", TOUCH_I2C_ADDR, error);
+        LOG_WARN("[Touch] CST816D not found at 0x%02X (error %d)", TOUCH_I2C_ADDR, error);
         initialized_ = false;
         return false;
     }
@@ -66,72 +56,105 @@ bool TouchManager::begin() {
     touchWire_.write(0xFF);  // Disable auto sleep
     touchWire_.endTransmission();
 
-    Serial.println("[Touch] CST816D initialized successfully");
+    eventQueue_ = xQueueCreate(TOUCH_EVENT_QUEUE_LENGTH, sizeof(TouchEvent));
+    if (eventQueue_ == nullptr) {
+        LOG_ERROR("[Touch] Failed to create event queue");
+        return false;
+    }
+
+    instance_ = this;
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        &TouchManager::taskEntry, "touch", TOUCH_TASK_STACK_SIZE,
+        this, TOUCH_TASK_PRIORITY, &taskHandle_, 0);
+
+    if (created != pdPASS) {
+        LOG_ERROR("[Touch] Failed to create touch task");
+        return false;
+    }
+
+    // Setup interrupt pin (the task must exist before the first edge)
+    pinMode(PIN_TOUCH_INT, INPUT);
+    attachInterrupt(digitalPinToInterrupt(PIN_TOUCH_INT), &TouchManager::onInterrupt, FALLING);
+
+    LOG_INFO("[Touch] CST816D initialized successfully");
     initialized_ = true;
     return true;
 }
 
-void TouchManager::update() {
-    // Skip if touch controller not initialized
-    if (!initialized_) {
-        return;
-    }
+void TouchManager::taskEntry(void* param) {
+    static_cast<TouchManager*>(param)->run();
+}
 
-    static uint32_t lastPollTime = 0;
-    uint32_t now = millis();
+void IRAM_ATTR TouchManager::onInterrupt() {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(instance_->taskHandle_, &woken);
+    portYIELD_FROM_ISR(woken);
+}
 
-    // Check for touch interrupt (new touch event)
-    if (touchInterrupt) {
-        Serial.println("[Touch] Interrupt fired!");
-        touchInterrupt = false;
-        readTouch();
-        lastPollTime = now;
-    }
-    // Poll touch state while actively touching to detect release
-    else if (touching_) {
-        readTouch();
-        lastPollTime = now;
-    }
-    // Also poll periodically even without interrupt (every 100ms)
-    // Some CST816 variants don't fire interrupts reliably
-    else if (now - lastPollTime >= 100) {
-        lastPollTime = now;
-        // Check if there's actually a touch happening
-        touchWire_.beginTransmission(TOUCH_I2C_ADDR);
-        touchWire_.write(CST816_REG_FINGER_NUM);
-        if (touchWire_.endTransmission() == 0) {
-            if (touchWire_.requestFrom(TOUCH_I2C_ADDR, (uint8_t)1) == 1) {
-                uint8_t fingerNum = touchWire_.read();
-                if (fingerNum > 0) {
-                    Serial.println("[Touch] Polling detected touch!");
-                    readTouch();
-                }
+void TouchManager::run() {
+    for (;;) {
+        // Idle: sleep until INT fires. Touching: poll to catch the release.
+        // Until INT has been seen, fall back to a slow finger-count poll.
+        TickType_t wait = portMAX_DELAY;
+        if (touching_.load()) {
+            wait = pdMS_TO_TICKS(TOUCH_ACTIVE_POLL_MS);
+        } else if (!interruptSeen_.load() && TOUCH_POLL_FALLBACK_MS > 0) {
+            wait = pdMS_TO_TICKS(TOUCH_POLL_FALLBACK_MS);
+        }
+
+        bool wasTouching = touching_.load();
+
+        if (ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            if (!interruptSeen_.exchange(true)) {
+                LOG_DEBUG("[Touch] Interrupt fired, fallback poll off");
+            }
+            readTouch();
+        } else if (wasTouching) {
+            readTouch();
+        } else {
+            uint8_t fingers = 0;
+            if (readFingerCount(fingers) && fingers > 0) {
+                LOG_DEBUG("[Touch] Polling detected touch");
+                readTouch();
             }
         }
-    }
 
-    // Process gesture when touch ends
-    if (lastTouching_ && !touching_) {
-        Serial.println("[Touch] Touch ended, processing gesture...");
-        processGesture();
+        // Process gesture when touch ends
+        if (wasTouching && !touching_.load()) {
+            processGesture();
+        }
     }
+}
 
-    lastTouching_ = touching_;
+bool TouchManager::readFingerCount(uint8_t& fingers) {
+    touchWire_.beginTransmission(TOUCH_I2C_ADDR);
+    touchWire_.write(CST816_REG_FINGER_NUM);
+    if (touchWire_.endTransmission() != 0) {
+        return false;
+    }
+    if (touchWire_.requestFrom(TOUCH_I2C_ADDR, (uint8_t)1) != 1) {
+        return false;
+    }
+    fingers = touchWire_.read();
+    return true;
 }
 
 bool TouchManager::readTouch() {
+    GSENSOR_PROFILE_SCOPE(TOUCH);
+
     // Read touch data from CST816D
     touchWire_.beginTransmission(TOUCH_I2C_ADDR);
     touchWire_.write(CST816_REG_FINGER_NUM);
     uint8_t err = touchWire_.endTransmission();
     if (err != 0) {
-        Serial.printf("[Touch] I2C write error: %d\n", err);
+        LOG_DEBUG("[Touch] I2C write error: %d", err);
         return false;
     }
 
     uint8_t bytesRead = touchWire_.requestFrom(TOUCH_I2C_ADDR, (uint8_t)5);
     if (bytesRead != 5) {
-        Serial.printf("[Touch] I2C read error: got %d bytes, expected 5\n", bytesRead);
+        LOG_DEBUG("[Touch] I2C read error: got %d bytes, expected 5", bytesRead);
         return false;
     }
 
@@ -147,23 +170,23 @@ bool TouchManager::readTouch() {
 
     bool wasTouch = (fingerNum > 0);
 
-    if (wasTouch && !touching_) {
+    if (wasTouch && !touching_.load()) {
         // Touch started
-        touching_ = true;
+        touching_.store(true);
         touchX_ = x;
         touchY_ = y;
         touchStartTime_ = millis();
-        Serial.printf("[Touch] START at (%d, %d)\n", x, y);
+        LOG_DEBUG("[Touch] START at (%d, %d)", x, y);
     } else if (wasTouch) {
         // Touch continues - update position
         touchX_ = x;
         touchY_ = y;
     } else {
         // Touch ended
-        if (touching_) {
-            Serial.println("[Touch] RELEASE detected");
+        if (touching_.load()) {
+            LOG_DEBUG("[Touch] RELEASE detected");
         }
-        touching_ = false;
+        touching_.store(false);
     }
 
     return true;
@@ -171,36 +194,34 @@ bool TouchManager::readTouch() {
 
 void TouchManager::processGesture() {
     uint32_t duration = millis() - touchStartTime_;
+    TouchEvent event = {TouchGesture::NONE, touchX_, touchY_, millis()};
 
     if (duration >= TOUCH_LONG_PRESS_MS) {
-        currentEvent_.gesture = TouchGesture::LONG_PRESS;
-        Serial.printf("[Touch] LONG_PRESS at (%d, %d), duration=%lu ms\n",
-                      touchX_, touchY_, duration);
+        event.gesture = TouchGesture::LONG_PRESS;
+        LOG_DEBUG("[Touch] LONG_PRESS at (%d, %d), duration=%lu ms",
+                  touchX_, touchY_, (unsigned long)duration);
     } else if (duration >= 50 && duration < TOUCH_TAP_THRESHOLD_MS) {
         // Minimum 50ms to filter out noise
-        currentEvent_.gesture = TouchGesture::TAP;
-        Serial.printf("[Touch] TAP at (%d, %d), duration=%lu ms\n",
-                      touchX_, touchY_, duration);
+        event.gesture = TouchGesture::TAP;
+        LOG_DEBUG("[Touch] TAP at (%d, %d), duration=%lu ms",
+                  touchX_, touchY_, (unsigned long)duration);
     } else {
-        currentEvent_.gesture = TouchGesture::NONE;
-        Serial.printf("[Touch] Ignored touch, duration=%lu ms (too short)\n", duration);
+        LOG_DEBUG("[Touch] Ignored touch, duration=%lu ms", (unsigned long)duration);
         return;
     }
 
-    currentEvent_.x = touchX_;
-    currentEvent_.y = touchY_;
-    currentEvent_.timestamp = millis();
-    eventPending_ = true;
+    // Drop the gesture if the loop has fallen that far behind
+    xQueueSend(eventQueue_, &event, 0);
 }
 
 TouchEvent TouchManager::getEvent() {
-    if (eventPending_) {
-        eventPending_ = false;
-        return currentEvent_;
+    TouchEvent event;
+    if (eventQueue_ != nullptr && xQueueReceive(eventQueue_, &event, 0) == pdTRUE) {
+        return event;
     }
     return {TouchGesture::NONE, 0, 0, 0};
 }
 
 bool TouchManager::isTouching() const {
-    return touching_;
+    return touching_.load();
 }
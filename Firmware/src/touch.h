@@ -10,6 +10,9 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 #include "config.h"
 
 /**
@@ -34,8 +37,12 @@ struct TouchEvent {
 /**
  * @brief Touch controller manager for CST816D
  *
- * Handles I2C communication with the touch controller and
- * provides gesture detection (tap, long press).
+ * A low-priority task sleeps until the INT pin fires, reads the
+ * controller over I2C until the finger lifts, and queues the resulting
+ * gesture (tap, long press). Nothing touches I2C from the main loop.
+ *
+ * Until the first interrupt is seen the task also polls every
+ * TOUCH_POLL_FALLBACK_MS, for CST816 variants whose INT line never fires.
  */
 class TouchManager {
 public:
@@ -44,7 +51,7 @@ public:
     /**
      * @brief Initialize the touch controller
      *
-     * Sets up I2C bus and configures interrupt pin.
+     * Sets up I2C bus and interrupt pin and starts the touch task.
      *
      * Returns:
      *     bool: True if initialization successful.
@@ -57,17 +64,10 @@ public:
     bool isInitialized() const { return initialized_; }
 
     /**
-     * @brief Update touch state (call in main loop)
-     *
-     * Reads touch data when available and updates internal state.
-     */
-    void update();
-
-    /**
-     * @brief Get the latest touch event
+     * @brief Get the next queued touch event (non-blocking)
      *
      * Returns:
-     *     TouchEvent: The touch event (gesture type and coordinates).
+     *     TouchEvent: The touch event, or gesture NONE if none is pending.
      */
     TouchEvent getEvent();
 
@@ -81,16 +81,25 @@ public:
 
 private:
     TwoWire touchWire_;
-    TouchEvent currentEvent_;
+    TaskHandle_t taskHandle_;
+    QueueHandle_t eventQueue_;
 
     bool initialized_;
-    bool touching_;
-    bool lastTouching_;
+    std::atomic<bool> touching_;
+    std::atomic<bool> interruptSeen_;
+
+    // Touch task only
     int16_t touchX_;
     int16_t touchY_;
     uint32_t touchStartTime_;
-    bool eventPending_;
 
+    static TouchManager* instance_;
+
+    static void taskEntry(void* param);
+    static void IRAM_ATTR onInterrupt();
+
+    void run();
+    bool readFingerCount(uint8_t& fingers);
     bool readTouch();
     void processGesture();
 };
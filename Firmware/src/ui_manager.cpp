@@ -8,12 +8,16 @@
 // Touch regions for settings screen (x1, y1, x2, y2, action)
 // Layout based on 240x240 display
 static const TouchRegion settingsRegions[] = {
-    {30, 60, 210, 100, ACTION_TOGGLE_BLE},      // BLE toggle row
-    {30, 110, 210, 150, ACTION_TOGGLE_SERIAL},  // Serial toggle row
+    {30, 52, 210, 86, ACTION_TOGGLE_BLE},       // BLE toggle row
+    {30, 92, 210, 126, ACTION_TOGGLE_SERIAL},   // Serial toggle row
+    {30, 132, 210, 166, ACTION_CYCLE_WIFI},     // Wi-Fi mode row
     {70, 195, 170, 230, ACTION_BACK}            // Back button
 };
 static const size_t NUM_SETTINGS_REGIONS = sizeof(settingsRegions) / sizeof(settingsRegions[0]);
 
+// Main gauge taps below this line (XYZ readout) open the waveform
+constexpr int16_t WAVEFORM_TAP_MIN_Y = 180;
+
 UIManager::UIManager()
     : currentScreen_(UIScreen::MAIN_GAUGE)
     , screenChanged_(true)
@@ -30,6 +34,14 @@ bool UIManager::handleTouch(const TouchEvent& event, Settings& settings) {
             handleMainGaugeTouch(event, settings);
             return true;
 
+        case UIScreen::WAVEFORM:
+            handleWaveformTouch(event, settings);
+            return true;
+
+        case UIScreen::SPECTRUM:
+            handleSpectrumTouch(event, settings);
+            return true;
+
         case UIScreen::SETTINGS:
             handleSettingsTouch(event, settings);
             return true;
@@ -39,8 +51,13 @@ bool UIManager::handleTouch(const TouchEvent& event, Settings& settings) {
 }
 
 void UIManager::handleMainGaugeTouch(const TouchEvent& event, Settings& settings) {
-    if (event.gesture == TouchGesture::TAP) {
-        // Any tap on main gauge opens settings
+    if (event.gesture == TouchGesture::TAP && event.y >= WAVEFORM_TAP_MIN_Y) {
+        // Tap on the XYZ readout opens the waveform
+        currentScreen_ = UIScreen::WAVEFORM;
+        screenChanged_ = true;
+        Serial.println("[UI] Opening waveform");
+    } else if (event.gesture == TouchGesture::TAP) {
+        // Any other tap on main gauge opens settings
         currentScreen_ = UIScreen::SETTINGS;
         screenChanged_ = true;
         Serial.println("[UI] Opening settings");
@@ -51,6 +68,32 @@ void UIManager::handleMainGaugeTouch(const TouchEvent& event, Settings& settings
     }
 }
 
+void UIManager::handleWaveformTouch(const TouchEvent& event, Settings& settings) {
+    if (event.gesture == TouchGesture::TAP) {
+        // Any tap on the waveform moves on to the spectrum
+        currentScreen_ = UIScreen::SPECTRUM;
+        screenChanged_ = true;
+        Serial.println("[UI] Opening spectrum");
+    } else if (event.gesture == TouchGesture::LONG_PRESS) {
+        // Long press resets peak (and the plot scale)
+        peakResetPending_ = true;
+        Serial.println("[UI] Peak reset requested");
+    }
+}
+
+void UIManager::handleSpectrumTouch(const TouchEvent& event, Settings& settings) {
+    if (event.gesture == TouchGesture::TAP) {
+        // Any tap on the spectrum goes back to the gauge
+        currentScreen_ = UIScreen::MAIN_GAUGE;
+        screenChanged_ = true;
+        Serial.println("[UI] Back to main gauge");
+    } else if (event.gesture == TouchGesture::LONG_PRESS) {
+        // Long press resets peak (and the plot scale)
+        peakResetPending_ = true;
+        Serial.println("[UI] Peak reset requested");
+    }
+}
+
 void UIManager::handleSettingsTouch(const TouchEvent& event, Settings& settings) {
     if (event.gesture != TouchGesture::TAP) {
         return;
@@ -69,6 +112,12 @@ void UIManager::handleSettingsTouch(const TouchEvent& event, Settings& settings)
             Serial.printf("[UI] Serial %s\n", settings.serialEnabled ? "enabled" : "disabled");
             break;
 
+        case ACTION_CYCLE_WIFI:
+            settings.wifiMode = settings.wifiMode == WifiMode::OFF ? WifiMode::UDP
+                              : settings.wifiMode == WifiMode::UDP ? WifiMode::TCP : WifiMode::OFF;
+            Serial.printf("[UI] Wi-Fi %s\n", wifiModeName(settings.wifiMode));
+            break;
+
         case ACTION_BACK:
             currentScreen_ = UIScreen::MAIN_GAUGE;
             screenChanged_ = true;
@@ -26,6 +26,7 @@ constexpr uint8_t ACTION_NONE = 0;
 constexpr uint8_t ACTION_TOGGLE_BLE = 1;
 constexpr uint8_t ACTION_TOGGLE_SERIAL = 2;
 constexpr uint8_t ACTION_BACK = 3;
+constexpr uint8_t ACTION_CYCLE_WIFI = 4;
 
 /**
  * @brief UI Manager for screen state and touch handling
@@ -87,6 +88,8 @@ private:
     bool peakResetPending_;
 
     void handleMainGaugeTouch(const TouchEvent& event, Settings& settings);
+    void handleWaveformTouch(const TouchEvent& event, Settings& settings);
+    void handleSpectrumTouch(const TouchEvent& event, Settings& settings);
     void handleSettingsTouch(const TouchEvent& event, Settings& settings);
     uint8_t hitTest(int16_t x, int16_t y) const;
 };
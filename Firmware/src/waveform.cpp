@@ -0,0 +1,61 @@
+/**
+ * @file waveform.cpp
+ * @brief Waveform envelope implementation
+ */
+
+#include "waveform.h"
+
+WaveformBuffer::WaveformBuffer()
+    : columns_{}
+    , columnCount_(0)
+    , minSq_(UINT32_MAX)
+    , maxSq_(0)
+    , samples_(0)
+    , samplesPerColumn_(1)
+    , rateHz_(0) {
+}
+
+void WaveformBuffer::addSample(const RawAccel& counts, uint32_t rateHz) {
+    // A column spans a fixed time, so its sample count follows the rate
+    if (rateHz != rateHz_) {
+        rateHz_ = rateHz;
+        samplesPerColumn_ = (rateHz * WAVEFORM_COLUMN_MS) / 1000;
+        if (samplesPerColumn_ < 1) {
+            samplesPerColumn_ = 1;
+        }
+        samples_ = 0;
+        minSq_ = UINT32_MAX;
+        maxSq_ = 0;
+    }
+
+    // Track squared magnitudes; two roots per column instead of one per sample
+    uint32_t magSq = static_cast<uint32_t>(static_cast<int32_t>(counts.x) * counts.x)
+                   + static_cast<uint32_t>(static_cast<int32_t>(counts.y) * counts.y)
+                   + static_cast<uint32_t>(static_cast<int32_t>(counts.z) * counts.z);
+    if (magSq < minSq_) {
+        minSq_ = magSq;
+    }
+    if (magSq > maxSq_) {
+        maxSq_ = magSq;
+    }
+
+    if (++samples_ < samplesPerColumn_) {
+        return;
+    }
+
+    WaveformColumn& col = columns_[columnCount_ % WAVEFORM_COLUMNS];
+    col.minCounts = static_cast<uint16_t>(isqrt64(minSq_));
+    col.maxCounts = static_cast<uint16_t>(isqrt64(maxSq_));
+    columnCount_++;
+
+    samples_ = 0;
+    minSq_ = UINT32_MAX;
+    maxSq_ = 0;
+}
+
+void WaveformBuffer::reset() {
+    columnCount_ = 0;
+    samples_ = 0;
+    minSq_ = UINT32_MAX;
+    maxSq_ = 0;
+}
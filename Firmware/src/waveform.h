@@ -0,0 +1,76 @@
+/**
+ * @file waveform.h
+ * @brief Min/max envelope decimation for the waveform screen
+ *
+ * Reduces the full-rate sample stream to one column per WAVEFORM_COLUMN_MS
+ * holding the smallest and largest unfiltered magnitude seen in that
+ * interval, so a 1 ms shock at 3200 Hz still reaches the 240 px display.
+ */
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "signal_processing.h"
+
+/**
+ * @brief Magnitude envelope of one plot column
+ */
+struct WaveformColumn {
+    uint16_t minCounts;  // Smallest magnitude (whole counts)
+    uint16_t maxCounts;  // Largest magnitude (whole counts)
+
+    /**
+     * @brief Largest magnitude in g
+     */
+    float maxG() const { return maxCounts * ADXL375_SCALE_FACTOR; }
+};
+
+/**
+ * @brief Ring of decimated columns (loop task only)
+ */
+class WaveformBuffer {
+public:
+    WaveformBuffer();
+
+    /**
+     * @brief Feed one sample
+     *
+     * @param counts Calibrated, unfiltered counts
+     * @param rateHz Current sample rate
+     */
+    void addSample(const RawAccel& counts, uint32_t rateHz);
+
+    /**
+     * @brief Drop all columns and the partial column
+     */
+    void reset();
+
+    /**
+     * @brief Number of columns completed since the last reset
+     *
+     * Columns older than WAVEFORM_COLUMNS have been overwritten.
+     */
+    uint32_t columnCount() const { return columnCount_; }
+
+    /**
+     * @brief Get a column by its number
+     *
+     * @param index Column number, within the last WAVEFORM_COLUMNS
+     */
+    const WaveformColumn& column(uint32_t index) const { return columns_[index % WAVEFORM_COLUMNS]; }
+
+private:
+    WaveformColumn columns_[WAVEFORM_COLUMNS];
+    uint32_t columnCount_;
+
+    // Column being accumulated (squared magnitudes, counts^2)
+    uint32_t minSq_;
+    uint32_t maxSq_;
+    uint32_t samples_;
+    uint32_t samplesPerColumn_;
+    uint32_t rateHz_;
+};
+
+#endif // WAVEFORM_H
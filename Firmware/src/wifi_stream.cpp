@@ -0,0 +1,405 @@
+/**
+ * @file wifi_stream.cpp
+ * @brief Wi-Fi stream implementation
+ */
+
+#include "wifi_stream.h"
+#include <errno.h>
+#include <lwip/sockets.h>
+
+const char* wifiStatusName(WifiStatus status) {
+    switch (status) {
+        case WifiStatus::OFF:            return "off";
+        case WifiStatus::NOT_CONFIGURED: return "no SSID";
+        case WifiStatus::CONNECTING:     return "connecting";
+        case WifiStatus::WAITING:        return "waiting";
+        case WifiStatus::STREAMING:      return "streaming";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Switch a socket to non-blocking operation
+ */
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0;
+}
+
+WifiStreamer::WifiStreamer()
+    : mode_(WifiMode::OFF)
+    , status_(WifiStatus::OFF)
+    , udpSocket_(-1)
+    , listener_(-1)
+    , client_(-1)
+    , peerAddress_(0)
+    , peerPort_(0)
+    , peerHeardMs_(0)
+    , frameBuffer_{}
+    , writer_(frameBuffer_, sizeof(frameBuffer_))
+    , frameStartMs_(0)
+    , pendingLength_(0)
+    , pendingOffset_(0)
+    , framesSent_(0)
+    , framesDropped_(0)
+    , commandRequest_{}
+    , commandRequestLength_(0)
+    , commandAddress_(0)
+    , commandPort_(0) {
+}
+
+void WifiStreamer::setMode(WifiMode mode) {
+    if (mode == mode_) {
+        return;
+    }
+
+    closeSockets();
+    WifiMode previous = mode_;
+    mode_ = mode;
+
+    if (mode == WifiMode::OFF) {
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+        setStatus(WifiStatus::OFF);
+        return;
+    }
+
+    if (WIFI_SSID[0] == '\0') {
+        setStatus(WifiStatus::NOT_CONFIGURED);
+        return;
+    }
+
+    // Switching between UDP and TCP keeps the network connection
+    if (previous == WifiMode::OFF) {
+        WiFi.mode(WIFI_STA);
+        // Reason: modem sleep must stay on while BLE shares the radio
+        WiFi.setSleep(true);
+        WiFi.setAutoReconnect(true);
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    }
+    setStatus(WifiStatus::CONNECTING);
+}
+
+void WifiStreamer::update(uint32_t now) {
+    if (mode_ == WifiMode::OFF || status_ == WifiStatus::NOT_CONFIGURED) {
+        return;
+    }
+
+    if (WiFi.status() != WL_CONNECTED) {
+        // Sockets are bound to the old address; reconnects are automatic
+        if (status_ != WifiStatus::CONNECTING) {
+            closeSockets();
+            setStatus(WifiStatus::CONNECTING);
+        }
+        return;
+    }
+
+    if (status_ == WifiStatus::CONNECTING) {
+        if (!openSockets()) {
+            return;  // Retried on the next pass
+        }
+        setStatus(WifiStatus::WAITING);
+    }
+
+    serviceUdp(now);
+    if (mode_ == WifiMode::TCP) {
+        serviceTcp();
+    }
+}
+
+/**
+ * @brief Open a non-blocking socket bound to the stream port (-1 on failure)
+ */
+static int openBoundSocket(bool udp) {
+    int fd = socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, udp ? IPPROTO_UDP : IPPROTO_TCP);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(WIFI_STREAM_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    bool ok = bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0
+           && (udp || listen(fd, 1) == 0)
+           && setNonBlocking(fd);
+    if (!ok) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool WifiStreamer::openSockets() {
+    // Reason: time sync runs over UDP in both modes
+    udpSocket_ = openBoundSocket(true);
+    if (mode_ == WifiMode::TCP && udpSocket_ >= 0) {
+        listener_ = openBoundSocket(false);
+    }
+
+    if (udpSocket_ < 0 || (mode_ == WifiMode::TCP && listener_ < 0)) {
+        if (DEBUG_ENABLED) {
+            Serial.printf("Wi-Fi: cannot open %s port %u (errno %d)\n",
+                          wifiModeName(mode_), WIFI_STREAM_PORT, errno);
+        }
+        closeSockets();
+        return false;
+    }
+
+    if (DEBUG_ENABLED) {
+        Serial.printf("Wi-Fi: %s stream on %s:%u\n", wifiModeName(mode_),
+                      WiFi.localIP().toString().c_str(), WIFI_STREAM_PORT);
+    }
+    return true;
+}
+
+void WifiStreamer::closeSockets() {
+    closeClient();
+    if (listener_ >= 0) {
+        close(listener_);
+        listener_ = -1;
+    }
+    if (udpSocket_ >= 0) {
+        close(udpSocket_);
+        udpSocket_ = -1;
+    }
+    peerAddress_ = 0;
+    peerPort_ = 0;
+}
+
+void WifiStreamer::closeClient() {
+    if (client_ >= 0) {
+        close(client_);
+        client_ = -1;
+    }
+    pendingLength_ = 0;
+    pendingOffset_ = 0;
+}
+
+void WifiStreamer::serviceUdp(uint32_t now) {
+    // Sync and command datagrams are answered; in UDP mode any other
+    // datagram (re)subscribes its sender and its contents are ignored
+    uint8_t request[COMMAND_MAGIC_SIZE + COMMAND_MAX_MESSAGE];
+    static_assert(sizeof(request) >= TIME_SYNC_MAGIC_SIZE + TIME_SYNC_MAX_MESSAGE,
+                  "request buffer must hold a sync message");
+    struct sockaddr_in from;
+    socklen_t fromLength = sizeof(from);
+    int n;
+    while ((n = recvfrom(udpSocket_, request, sizeof(request), MSG_DONTWAIT,
+                         reinterpret_cast<struct sockaddr*>(&from), &fromLength)) >= 0) {
+        uint64_t receivedUs = TimeSync::localUs();
+        fromLength = sizeof(from);
+
+        if (static_cast<size_t>(n) >= TIME_SYNC_MAGIC_SIZE
+            && memcmp(request, TIME_SYNC_MAGIC, TIME_SYNC_MAGIC_SIZE) == 0) {
+            answerSync(request, n, receivedUs, from.sin_addr.s_addr, from.sin_port);
+            continue;
+        }
+        if (static_cast<size_t>(n) > COMMAND_MAGIC_SIZE
+            && memcmp(request, COMMAND_MAGIC, COMMAND_MAGIC_SIZE) == 0) {
+            if (commandRequestLength_ == 0) {
+                commandRequestLength_ = n - COMMAND_MAGIC_SIZE;
+                memcpy(commandRequest_, request + COMMAND_MAGIC_SIZE, commandRequestLength_);
+                commandAddress_ = from.sin_addr.s_addr;
+                commandPort_ = from.sin_port;
+            }
+            continue;
+        }
+        if (mode_ != WifiMode::UDP) {
+            continue;
+        }
+
+        if (from.sin_addr.s_addr != peerAddress_ || from.sin_port != peerPort_) {
+            peerAddress_ = from.sin_addr.s_addr;
+            peerPort_ = from.sin_port;
+            if (DEBUG_ENABLED) {
+                Serial.printf("Wi-Fi: UDP receiver %s:%u\n",
+                              IPAddress(peerAddress_).toString().c_str(), ntohs(peerPort_));
+            }
+        }
+        peerHeardMs_ = now;
+    }
+
+    if (mode_ != WifiMode::UDP) {
+        return;
+    }
+
+    if (peerAddress_ != 0 && now - peerHeardMs_ >= WIFI_UDP_SUBSCRIBE_TIMEOUT_MS) {
+        peerAddress_ = 0;
+        peerPort_ = 0;
+        if (DEBUG_ENABLED) {
+            Serial.println("Wi-Fi: UDP receiver timed out");
+        }
+    }
+
+    setStatus(peerAddress_ != 0 ? WifiStatus::STREAMING : WifiStatus::WAITING);
+}
+
+void WifiStreamer::answerSync(const uint8_t* datagram, size_t length, uint64_t receivedUs,
+                              uint32_t address, uint16_t port) {
+    uint8_t reply[TIME_SYNC_MAGIC_SIZE + TIME_SYNC_MAX_MESSAGE];
+    size_t replyLength = timeSync.handleMessage(datagram + TIME_SYNC_MAGIC_SIZE, length - TIME_SYNC_MAGIC_SIZE,
+                                                receivedUs, reply + TIME_SYNC_MAGIC_SIZE);
+    if (replyLength == 0) {
+        return;
+    }
+    memcpy(reply, TIME_SYNC_MAGIC, TIME_SYNC_MAGIC_SIZE);
+
+    struct sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = port;
+    to.sin_addr.s_addr = address;
+    sendto(udpSocket_, reply, TIME_SYNC_MAGIC_SIZE + replyLength, MSG_DONTWAIT,
+           reinterpret_cast<struct sockaddr*>(&to), sizeof(to));
+}
+
+bool WifiStreamer::takeCommandRequest(uint8_t* message, size_t& length) {
+    if (commandRequestLength_ == 0) {
+        return false;
+    }
+    memcpy(message, commandRequest_, commandRequestLength_);
+    length = commandRequestLength_;
+    commandRequestLength_ = 0;
+    return true;
+}
+
+void WifiStreamer::sendCommandReply(const uint8_t* message, size_t length) {
+    if (udpSocket_ < 0 || commandAddress_ == 0) {
+        return;
+    }
+
+    uint8_t reply[COMMAND_MAGIC_SIZE + COMMAND_MAX_MESSAGE];
+    length = length < COMMAND_MAX_MESSAGE ? length : COMMAND_MAX_MESSAGE;
+    memcpy(reply, COMMAND_MAGIC, COMMAND_MAGIC_SIZE);
+    memcpy(reply + COMMAND_MAGIC_SIZE, message, length);
+
+    struct sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = commandPort_;
+    to.sin_addr.s_addr = commandAddress_;
+    sendto(udpSocket_, reply, COMMAND_MAGIC_SIZE + length, MSG_DONTWAIT,
+           reinterpret_cast<struct sockaddr*>(&to), sizeof(to));
+}
+
+void WifiStreamer::serviceTcp() {
+    // A newer connection replaces the current receiver
+    int accepted = accept(listener_, nullptr, nullptr);
+    if (accepted >= 0) {
+        closeClient();
+        client_ = accepted;
+        setNonBlocking(client_);
+        // Reason: frames are already batched; Nagle would only add delay
+        int noDelay = 1;
+        setsockopt(client_, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        if (DEBUG_ENABLED) {
+            Serial.println("Wi-Fi: TCP receiver connected");
+        }
+    }
+
+    if (client_ >= 0) {
+        // Receivers send nothing; a read of 0 bytes means they closed
+        uint8_t discard[16];
+        int n = recv(client_, discard, sizeof(discard), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            closeClient();
+            if (DEBUG_ENABLED) {
+                Serial.println("Wi-Fi: TCP receiver disconnected");
+            }
+        } else {
+            sendPending();
+        }
+    }
+
+    setStatus(client_ >= 0 ? WifiStatus::STREAMING : WifiStatus::WAITING);
+}
+
+void WifiStreamer::setStatus(WifiStatus status) {
+    if (status == status_) {
+        return;
+    }
+    // A frame started for the previous receiver (or none) is stale
+    writer_.begin(0);
+    status_ = status;
+}
+
+void WifiStreamer::addSample(uint32_t timestampUs, const RawAccel& counts, uint16_t rateHz) {
+    if (writer_.count() == 0) {
+        writer_.begin(rateHz);
+        frameStartMs_ = millis();
+    }
+
+    // Time gap too large for a delta: close the frame and start anew
+    if (!writer_.add(timestampUs, counts)) {
+        sendFrame();
+        if (pendingLength_ != 0) {
+            // The buffer still holds the unsent frame; the receiver sees
+            // this sample as part of the gap
+            return;
+        }
+        writer_.begin(rateHz);
+        frameStartMs_ = millis();
+        writer_.add(timestampUs, counts);
+    }
+
+    if (writer_.isFull()) {
+        sendFrame();
+    }
+}
+
+void WifiStreamer::flush() {
+    if (writer_.count() > 0 && pendingLength_ == 0 && millis() - frameStartMs_ >= WIFI_BATCH_MAX_LATENCY_MS) {
+        sendFrame();
+    }
+}
+
+void WifiStreamer::sendFrame() {
+    size_t length = writer_.finish();
+    if (length == 0 || !isStreaming()) {
+        return;
+    }
+
+    if (mode_ == WifiMode::UDP) {
+        struct sockaddr_in to = {};
+        to.sin_family = AF_INET;
+        to.sin_port = peerPort_;
+        to.sin_addr.s_addr = peerAddress_;
+        if (sendto(udpSocket_, frameBuffer_, length, MSG_DONTWAIT,
+                   reinterpret_cast<struct sockaddr*>(&to), sizeof(to)) == static_cast<int>(length)) {
+            framesSent_++;
+        } else {
+            framesDropped_++;  // Out of stack buffers; the sequence gap shows it
+        }
+    } else {
+        pendingLength_ = length;
+        pendingOffset_ = 0;
+        sendPending();
+    }
+}
+
+void WifiStreamer::sendPending() {
+    while (pendingOffset_ < pendingLength_) {
+        int n = send(client_, frameBuffer_ + pendingOffset_, pendingLength_ - pendingOffset_, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeClient();
+                setStatus(WifiStatus::WAITING);
+            }
+            return;  // Window full: finish on the next pass
+        }
+        pendingOffset_ += n;
+    }
+
+    if (pendingLength_ != 0) {
+        framesSent_++;
+        pendingLength_ = 0;
+        pendingOffset_ = 0;
+    }
+}
+
+IPAddress WifiStreamer::localIp() const {
+    return status_ == WifiStatus::WAITING || status_ == WifiStatus::STREAMING ? WiFi.localIP() : IPAddress();
+}
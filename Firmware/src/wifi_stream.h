@@ -0,0 +1,198 @@
+/**
+ * @file wifi_stream.h
+ * @brief Wi-Fi transport for the batched raw sample stream
+ *
+ * Sends the same frames as the binary serial stream and the BLE batch
+ * characteristic (see stream_frame.h), sized to one UDP datagram, so a
+ * PC on the network can take the full 3200 Hz stream without a cable.
+ *
+ * - UDP: any datagram sent to WIFI_STREAM_PORT subscribes its sender;
+ *   frames go to the newest subscriber until it has been silent for
+ *   WIFI_UDP_SUBSCRIBE_TIMEOUT_MS. Each datagram is one whole frame, so
+ *   a gap in the frame sequence number is a lost datagram.
+ * - TCP: one receiver connects to WIFI_STREAM_PORT (a newer connection
+ *   replaces it) and reads the frames as a byte stream.
+ *
+ * In both modes UDP datagrams starting with TIME_SYNC_MAGIC are time
+ * sync messages (see time_sync.h) and those starting with COMMAND_MAGIC
+ * are command requests (see command_protocol.h): they are answered to
+ * their sender and do not subscribe it.
+ *
+ * Frames are built in place and handed to the lwIP socket as they are,
+ * with no staging buffer in between. Sends never block: a UDP datagram
+ * the stack cannot take is dropped and counted, while a TCP frame that
+ * only partly fits is finished before more samples are taken, leaving
+ * them in the sample ring.
+ *
+ * Not thread-safe: use it from loop() only.
+ */
+
+#ifndef WIFI_STREAM_H
+#define WIFI_STREAM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+#include "settings.h"
+#include "stream_frame.h"
+#include "time_sync.h"
+#include "command_protocol.h"
+
+/**
+ * @brief Connection state of the Wi-Fi stream
+ */
+enum class WifiStatus : uint8_t {
+    OFF = 0,         ///< WifiMode::OFF
+    NOT_CONFIGURED,  ///< No GSENSOR_WIFI_SSID in this build
+    CONNECTING,      ///< Joining the network
+    WAITING,         ///< On the network, no receiver yet
+    STREAMING        ///< Sending frames to a receiver
+};
+
+/**
+ * @brief Get a status name for display and logs
+ */
+const char* wifiStatusName(WifiStatus status);
+
+/**
+ * @brief Wi-Fi station with a UDP or TCP frame stream
+ */
+class WifiStreamer {
+public:
+    WifiStreamer();
+
+    /**
+     * @brief Select the transport, starting or stopping the radio
+     *
+     * @param mode OFF, UDP or TCP
+     */
+    void setMode(WifiMode mode);
+
+    /**
+     * @brief Get the selected transport
+     */
+    WifiMode getMode() const { return mode_; }
+
+    /**
+     * @brief Check if the radio is in use
+     */
+    bool isEnabled() const { return mode_ != WifiMode::OFF; }
+
+    /**
+     * @brief Follow the network connection, receivers and pending sends
+     *
+     * Call once per loop() pass, before adding samples.
+     *
+     * @param now Current time in milliseconds
+     */
+    void update(uint32_t now);
+
+    /**
+     * @brief Check if a receiver is attached
+     */
+    bool isStreaming() const { return status_ == WifiStatus::STREAMING; }
+
+    /**
+     * @brief Check if addSample() can take a sample now
+     *
+     * False while a TCP frame is still being sent.
+     */
+    bool isReady() const { return isStreaming() && pendingLength_ == 0; }
+
+    /**
+     * @brief Append a raw sample to the current frame
+     *
+     * Sends the frame once it is full. Only call while isReady().
+     *
+     * @param timestampUs Sample time in microseconds
+     * @param counts Calibrated counts
+     * @param rateHz Current sample rate
+     */
+    void addSample(uint32_t timestampUs, const RawAccel& counts, uint16_t rateHz);
+
+    /**
+     * @brief Send a partly filled frame once it is old enough
+     */
+    void flush();
+
+    /**
+     * @brief Take the command request received last
+     *
+     * Requests are handed over rather than run while the socket is read,
+     * as a command may restart the radio. One that arrives before the
+     * previous one is taken is dropped (the host retries).
+     *
+     * @param message Buffer of COMMAND_MAX_MESSAGE bytes, without COMMAND_MAGIC
+     * @param length Set to the message length
+     * @return true if a request was waiting
+     */
+    bool takeCommandRequest(uint8_t* message, size_t& length);
+
+    /**
+     * @brief Answer the request taken last to its sender
+     *
+     * Nothing is sent once the radio has been stopped since.
+     *
+     * @param message Response without COMMAND_MAGIC
+     * @param length Response length (at most COMMAND_MAX_MESSAGE)
+     */
+    void sendCommandReply(const uint8_t* message, size_t length);
+
+    /**
+     * @brief Get the connection state
+     */
+    WifiStatus status() const { return status_; }
+
+    /**
+     * @brief Get the station address (0.0.0.0 until connected)
+     */
+    IPAddress localIp() const;
+
+    /**
+     * @brief Frames handed to the network stack since boot
+     */
+    uint32_t framesSent() const { return framesSent_; }
+
+    /**
+     * @brief UDP frames the network stack could not take since boot
+     */
+    uint32_t framesDropped() const { return framesDropped_; }
+
+private:
+    WifiMode mode_;
+    WifiStatus status_;
+    int udpSocket_;     // UDP stream and time sync (both modes)
+    int listener_;      // TCP listening socket (TCP mode)
+    int client_;        // Accepted TCP connection (-1 = none)
+    uint32_t peerAddress_;  // UDP subscriber (network byte order, 0 = none)
+    uint16_t peerPort_;
+    uint32_t peerHeardMs_;
+
+    uint8_t frameBuffer_[WIFI_FRAME_MAX_BYTES];
+    StreamFrameWriter writer_;
+    uint32_t frameStartMs_;
+    size_t pendingLength_;  // TCP frame bytes not yet sent
+    size_t pendingOffset_;
+
+    uint32_t framesSent_;
+    uint32_t framesDropped_;
+
+    // Command datagram waiting for loop(), and where to answer it
+    uint8_t commandRequest_[COMMAND_MAX_MESSAGE];
+    size_t commandRequestLength_;   // 0 = none waiting
+    uint32_t commandAddress_;
+    uint16_t commandPort_;
+
+    bool openSockets();
+    void closeSockets();
+    void serviceUdp(uint32_t now);
+    void answerSync(const uint8_t* datagram, size_t length, uint64_t receivedUs,
+                    uint32_t address, uint16_t port);
+    void serviceTcp();
+    void closeClient();
+    void setStatus(WifiStatus status);
+    void sendFrame();
+    void sendPending();
+};
+
+#endif // WIFI_STREAM_H
@@ -0,0 +1,136 @@
+/**
+ * @file window_stats.cpp
+ * @brief Window statistics implementation
+ */
+
+#include "window_stats.h"
+
+WindowStats::WindowStats()
+    : history_{}
+    , historyHead_(0)
+    , historyCount_(0)
+    , current_{}
+    , samplesPerBucket_(1)
+    , rateHz_(0)
+    , thresholdQ4_(0)
+    , summaries_() {
+    clearBucket(current_);
+}
+
+void WindowStats::addSample(uint32_t timestampUs, const AccelFixed& filtered, int32_t magnitude,
+                            int32_t thresholdQ4, uint32_t rateHz) {
+    // A bucket spans a fixed time, so its sample count follows the rate
+    if (rateHz != rateHz_) {
+        rateHz_ = rateHz;
+        samplesPerBucket_ = (rateHz * STATS_BUCKET_MS) / 1000;
+        if (samplesPerBucket_ < 1) {
+            samplesPerBucket_ = 1;
+        }
+        reset();
+    }
+    thresholdQ4_ = thresholdQ4;
+
+    const int32_t values[STATS_CHANNELS] = {filtered.x, filtered.y, filtered.z, magnitude};
+    for (uint8_t ch = 0; ch < STATS_CHANNELS; ch++) {
+        int32_t value = values[ch];
+        current_.sum[ch] += value;
+        current_.sumSq[ch] += static_cast<uint64_t>(static_cast<int64_t>(value) * value);
+        if (value < current_.min[ch]) {
+            current_.min[ch] = value;
+        }
+        if (value > current_.max[ch]) {
+            current_.max[ch] = value;
+        }
+        if (value >= thresholdQ4 || value <= -thresholdQ4) {
+            current_.above[ch]++;
+        }
+    }
+    current_.endUs = timestampUs;
+
+    if (++current_.count >= samplesPerBucket_) {
+        finishBucket();
+    }
+}
+
+void WindowStats::reset() {
+    clearBucket(current_);
+    historyHead_ = 0;
+    historyCount_ = 0;
+}
+
+uint32_t WindowStats::summaryCount() const {
+    return summaries_.sequence();
+}
+
+bool WindowStats::latest(StatsWindow window, StatsSummary& out) const {
+    size_t index = window == StatsWindow::LONG ? 1 : 0;
+    return summaries_.read(out, [index](const SummaryPair& pair) -> const StatsSummary& {
+        return pair.window[index];
+    });
+}
+
+void WindowStats::clearBucket(Bucket& bucket) {
+    for (uint8_t ch = 0; ch < STATS_CHANNELS; ch++) {
+        bucket.sum[ch] = 0;
+        bucket.sumSq[ch] = 0;
+        bucket.min[ch] = INT32_MAX;
+        bucket.max[ch] = INT32_MIN;
+        bucket.above[ch] = 0;
+    }
+    bucket.count = 0;
+    bucket.endUs = 0;
+}
+
+void WindowStats::finishBucket() {
+    history_[historyHead_] = current_;
+    historyHead_ = (historyHead_ + 1) % STATS_LONG_BUCKETS;
+    if (historyCount_ < STATS_LONG_BUCKETS) {
+        historyCount_++;
+    }
+
+    // Merge the long window from bucket totals (once per bucket, not per sample)
+    Bucket merged;
+    clearBucket(merged);
+    for (size_t i = 0; i < historyCount_; i++) {
+        const Bucket& bucket = history_[i];
+        for (uint8_t ch = 0; ch < STATS_CHANNELS; ch++) {
+            merged.sum[ch] += bucket.sum[ch];
+            merged.sumSq[ch] += bucket.sumSq[ch];
+            if (bucket.min[ch] < merged.min[ch]) {
+                merged.min[ch] = bucket.min[ch];
+            }
+            if (bucket.max[ch] > merged.max[ch]) {
+                merged.max[ch] = bucket.max[ch];
+            }
+            merged.above[ch] += bucket.above[ch];
+        }
+        merged.count += bucket.count;
+    }
+    merged.endUs = current_.endUs;
+
+    uint32_t sequence = summaries_.nextSequence();
+    SummaryPair& pair = summaries_.next();
+    summarise(current_, sequence, pair.window[0]);
+    summarise(merged, sequence, pair.window[1]);
+    summaries_.publish();
+
+    clearBucket(current_);
+}
+
+void WindowStats::summarise(const Bucket& bucket, uint32_t sequence, StatsSummary& out) const {
+    out.sequence = sequence;
+    out.endUs = bucket.endUs;
+    out.sampleCount = bucket.count;
+    out.windowMs = static_cast<uint32_t>((static_cast<uint64_t>(bucket.count) * 1000) / rateHz_);
+    out.thresholdMagnitude = thresholdQ4_;
+    out.rateHz = static_cast<uint16_t>(rateHz_);
+
+    for (uint8_t ch = 0; ch < STATS_CHANNELS; ch++) {
+        ChannelStats& stats = out.channels[ch];
+        stats.mean = static_cast<int32_t>(bucket.sum[ch] / static_cast<int64_t>(bucket.count));
+        stats.rms = static_cast<int32_t>(isqrt64(bucket.sumSq[ch] / bucket.count));
+        stats.min = bucket.min[ch];
+        stats.max = bucket.max[ch];
+        stats.aboveUs = static_cast<uint32_t>((static_cast<uint64_t>(bucket.above[ch]) * 1000000) / rateHz_);
+    }
+}
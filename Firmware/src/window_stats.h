@@ -0,0 +1,151 @@
+/**
+ * @file window_stats.h
+ * @brief Incremental per-window statistics
+ *
+ * Summarises the filtered axes and magnitude over a short tumbling window
+ * (one bucket of STATS_BUCKET_MS) and a long sliding window (the last
+ * STATS_LONG_BUCKETS buckets). Each sample costs a few adds and
+ * multiplies per channel; the long window is merged from bucket totals
+ * once per bucket, so there is no per-sample history.
+ */
+
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sample_ring.h"
+#include "signal_processing.h"
+
+/**
+ * @brief Channels summarised by WindowStats
+ */
+enum StatsChannel : uint8_t {
+    STATS_X = 0,
+    STATS_Y,
+    STATS_Z,
+    STATS_MAGNITUDE,
+    STATS_CHANNELS
+};
+
+/**
+ * @brief Summary selector
+ */
+enum class StatsWindow : uint8_t {
+    SHORT,  // Last completed bucket
+    LONG    // Last STATS_LONG_BUCKETS buckets
+};
+
+/**
+ * @brief Statistics of one channel over a window (values in Q4 counts)
+ */
+struct ChannelStats {
+    int32_t mean;
+    int32_t rms;
+    int32_t min;
+    int32_t max;
+    uint32_t aboveUs;  // Time with |value| at or above the threshold
+
+    /**
+     * @brief Largest absolute value
+     */
+    int32_t peak() const { return max > -min ? max : -min; }
+
+    /**
+     * @brief Peak over RMS (0 if the RMS is zero)
+     */
+    float crestFactor() const { return rms > 0 ? static_cast<float>(peak()) / rms : 0.0f; }
+};
+
+/**
+ * @brief Statistics of all channels over one window
+ */
+struct StatsSummary {
+    uint32_t sequence;            // Bucket number since boot (1-based)
+    uint32_t endUs;               // Time of the newest sample in the window
+    uint32_t windowMs;            // Time covered (shorter until the long window fills)
+    uint32_t sampleCount;         // Samples in the window
+    int32_t thresholdMagnitude;   // Threshold for aboveUs (Q4 counts)
+    uint16_t rateHz;              // Sample rate during the window
+    ChannelStats channels[STATS_CHANNELS];
+};
+
+/**
+ * @brief Tumbling and sliding window statistics engine
+ *
+ * addSample() and reset() belong to the sampler task. The other methods
+ * are safe from any task: summaries are published into one of two
+ * slots, so a reader copies the newest pair while the next is built.
+ */
+class WindowStats {
+public:
+    WindowStats();
+
+    /**
+     * @brief Feed one processed sample (sampler task only)
+     *
+     * A rate change restarts both windows.
+     *
+     * @param timestampUs Sample time in microseconds
+     * @param filtered Filtered axes (Q4 counts)
+     * @param magnitude Filtered magnitude (Q4 counts)
+     * @param thresholdQ4 Threshold for time-above-threshold (Q4 counts)
+     * @param rateHz Current sample rate
+     */
+    void addSample(uint32_t timestampUs, const AccelFixed& filtered, int32_t magnitude,
+                   int32_t thresholdQ4, uint32_t rateHz);
+
+    /**
+     * @brief Drop the partial bucket and the long window (sampler task only)
+     */
+    void reset();
+
+    /**
+     * @brief Number of buckets completed since boot
+     */
+    uint32_t summaryCount() const;
+
+    /**
+     * @brief Copy the newest summary of a window
+     *
+     * @param window Short or long window
+     * @param out Destination
+     * @return true if a bucket has completed
+     */
+    bool latest(StatsWindow window, StatsSummary& out) const;
+
+private:
+    struct Bucket {
+        int64_t sum[STATS_CHANNELS];
+        uint64_t sumSq[STATS_CHANNELS];
+        int32_t min[STATS_CHANNELS];
+        int32_t max[STATS_CHANNELS];
+        uint32_t above[STATS_CHANNELS];
+        uint32_t count;
+        uint32_t endUs;
+    };
+
+    // Completed buckets for the long window, oldest overwritten
+    Bucket history_[STATS_LONG_BUCKETS];
+    size_t historyHead_;
+    size_t historyCount_;
+
+    // Bucket being accumulated (sampler task only)
+    Bucket current_;
+    uint32_t samplesPerBucket_;
+    uint32_t rateHz_;
+    int32_t thresholdQ4_;
+
+    // Short and long summary of one bucket
+    struct SummaryPair {
+        StatsSummary window[2];
+    };
+
+    DoubleBuffered<SummaryPair> summaries_;
+
+    static void clearBucket(Bucket& bucket);
+    void finishBucket();
+    void summarise(const Bucket& bucket, uint32_t sequence, StatsSummary& out) const;
+};
+
+#endif // WINDOW_STATS_H
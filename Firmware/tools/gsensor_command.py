@@ -0,0 +1,313 @@
+#!/usr/bin/env python3
+"""
+gSENSOR Command
+
+Reads and changes device settings with the binary command protocol
+(command_protocol.h), over USB serial or over Wi-Fi (UDP to the stream
+port). Every setting is answered with its value after the change, and
+errors are reported per setting.
+
+Usage:
+    python gsensor_command.py [--port PORT]                 # print the settings
+    python gsensor_command.py --rate 25 --filter 2 --logging on
+    python gsensor_command.py --wifi 192.168.1.50 --threshold 12.5 --ble-format batched
+"""
+
+import argparse
+import binascii
+import random
+import socket
+import struct
+import sys
+import time
+
+import serial
+
+from serial_plotter import DEFAULT_BAUD, DEFAULT_PORT
+
+# Tags (command_protocol.h)
+TAG_STATUS = 0x01
+TAG_SAMPLE_RATE = 0x02
+TAG_FILTER = 0x03
+TAG_TRIGGER = 0x04
+TAG_STREAM_FORMAT = 0x05
+TAG_LOGGING = 0x06
+TAG_POWER_PROFILE = 0x07
+TAG_RESET = 0x08
+TAG_CALIBRATE = 0x09
+
+STATUS_NAMES = {0: "OK", 1: "UNKNOWN_TAG", 2: "BAD_LENGTH", 3: "BAD_VALUE",
+                4: "UNAVAILABLE", 5: "MALFORMED"}
+
+LINK_SERIAL = 0
+LINK_BLE = 1
+LINK_WIFI = 2
+FORMATS = {
+    LINK_SERIAL: ["csv", "binary", "stats"],
+    LINK_BLE: ["legacy", "batched"],
+    LINK_WIFI: ["off", "udp", "tcp"],
+}
+LINK_NAMES = {LINK_SERIAL: "Serial format", LINK_BLE: "BLE format", LINK_WIFI: "Wi-Fi mode"}
+FILTER_PRESETS = ["raw", "smooth", "lowpass", "vibration"]
+POWER_PROFILES = ["performance", "balanced", "low power"]
+
+FRAME_SYNC = b"\xA5\x43"    # SERIAL_FRAME_SYNC, SerialFrameType::COMMAND
+MAX_MESSAGE = 128           # COMMAND_MAX_MESSAGE
+COMMAND_MAGIC = b"GCMD"
+WIFI_PORT = 5555            # WIFI_STREAM_PORT in config.h
+REPLY_TIMEOUT_S = 0.5
+REQUEST_ATTEMPTS = 3
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE, as crc16Ccitt() in stream_frame.h."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+class SerialLink:
+    """Command messages framed over a serial port."""
+
+    def __init__(self, port: str, baud: int):
+        self.serial = serial.Serial(port, baud, timeout=0.05)
+        self.buffer = bytearray()
+
+    def send(self, message: bytes):
+        body = struct.pack("<H", len(message)) + message
+        self.serial.write(FRAME_SYNC + body + struct.pack("<H", crc16(body)))
+
+    def receive(self, timeout: float):
+        """Return the next good message, or None on timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            message = self._parse()
+            if message is not None:
+                return message
+            if time.monotonic() >= deadline:
+                return None
+            self.buffer += self.serial.read(max(1, self.serial.in_waiting))
+
+    def _parse(self):
+        # Sample lines and debug output are skipped up to the next sync word
+        while True:
+            start = self.buffer.find(FRAME_SYNC)
+            if start < 0:
+                del self.buffer[:max(0, len(self.buffer) - 1)]
+                return None
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                return None
+            (length,) = struct.unpack_from("<H", self.buffer, 2)
+            if length == 0 or length > MAX_MESSAGE:
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < 6 + length:
+                return None
+            body = bytes(self.buffer[2:4 + length])
+            (crc,) = struct.unpack_from("<H", self.buffer, 4 + length)
+            if crc16(body) == crc:
+                del self.buffer[:6 + length]
+                return body[2:]
+            del self.buffer[:1]
+
+    def close(self):
+        self.serial.close()
+
+
+class WifiLink:
+    """Command messages as UDP datagrams to the stream port."""
+
+    def __init__(self, host: str, port: int):
+        self.address = (host, port)
+        self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    def send(self, message: bytes):
+        self.socket.sendto(COMMAND_MAGIC + message, self.address)
+
+    def receive(self, timeout: float):
+        """Return the next command response, or None on timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.socket.settimeout(remaining)
+            try:
+                data, _ = self.socket.recvfrom(2048)
+            except socket.timeout:
+                return None
+            if data.startswith(COMMAND_MAGIC):
+                return data[len(COMMAND_MAGIC):]
+
+    def close(self):
+        self.socket.close()
+
+
+def run(link, records):
+    """
+    Send records and collect their answers.
+
+    Records the device did not run (its response was full) are sent again
+    in the next request.
+
+    Returns:
+        List of (tag, status, value) in request order, or None on timeout.
+    """
+    answers = []
+    seq = random.randrange(256)
+    while records:
+        seq = (seq + 1) & 0xFF
+        request = bytes([seq]) + b"".join(bytes([tag, len(value)]) + value for tag, value in records)
+        response = None
+        for _ in range(REQUEST_ATTEMPTS):
+            link.send(request)
+            deadline = time.monotonic() + REPLY_TIMEOUT_S
+            while response is None and time.monotonic() < deadline:
+                message = link.receive(deadline - time.monotonic())
+                if message and message[0] == seq:
+                    response = message
+            if response is not None:
+                break
+        if response is None:
+            return None
+
+        pos = 1
+        done = 0
+        while pos + 3 <= len(response):
+            tag, status, length = response[pos:pos + 3]
+            answers.append((tag, status, bytes(response[pos + 3:pos + 3 + length])))
+            pos += 3 + length
+            done += 1
+        if done == 0:
+            return None  # A response too small for a single record
+        records = records[done:]
+    return answers
+
+
+def describe(tag: int, value: bytes) -> str:
+    """Format an answer's value for printing."""
+    if tag == TAG_STATUS and len(value) >= 6:
+        version, flags, uptime = struct.unpack_from("<BBI", value)
+        names = ["logging", "shock wake", "BLE client", "Wi-Fi host", "time synced"]
+        active = [name for bit, name in enumerate(names) if flags & (1 << bit)]
+        return f"Protocol v{version}, up {uptime / 1000:.0f} s, {', '.join(active) or 'idle'}"
+    if tag == TAG_SAMPLE_RATE and len(value) >= 2:
+        return f"Sample rate: {struct.unpack_from('<H', value)[0]} Hz"
+    if tag == TAG_FILTER and len(value) >= 8:
+        preset, dc, hp, lp, avg = struct.unpack_from("<BBHHH", value)
+        name = FILTER_PRESETS[preset] if preset < len(FILTER_PRESETS) else "custom"
+        return f"Filter: {name} (DC block {'on' if dc else 'off'}, HP {hp} Hz, LP {lp} Hz, average {avg} ms)"
+    if tag == TAG_TRIGGER and len(value) >= 3:
+        threshold, wake = struct.unpack_from("<HB", value)
+        return f"Impact threshold: {threshold / 10:.1f} g, shock wake {'on' if wake else 'off'}"
+    if tag == TAG_STREAM_FORMAT and len(value) >= 2:
+        link, fmt = value[0], value[1]
+        names = FORMATS.get(link, [])
+        return f"{LINK_NAMES.get(link, 'Link %d' % link)}: {names[fmt] if fmt < len(names) else fmt}"
+    if tag == TAG_LOGGING and len(value) >= 9:
+        logging, blocks, capacity = struct.unpack_from("<BII", value)
+        return f"Logging: {'on' if logging else 'off'}, {blocks}/{capacity} blocks"
+    if tag == TAG_POWER_PROFILE and len(value) >= 1:
+        return f"Power profile: {POWER_PROFILES[value[0]] if value[0] < len(POWER_PROFILES) else value[0]}"
+    if tag == TAG_RESET:
+        return "Reset"
+    if tag == TAG_CALIBRATE:
+        return "Calibrating: keep the sensor still"
+    return f"Tag 0x{tag:02x}: {value.hex()}"
+
+
+def on_off(text: str) -> int:
+    if text not in ("on", "off"):
+        raise argparse.ArgumentTypeError("use on or off")
+    return 1 if text == "on" else 0
+
+
+def build_records(args):
+    """Turn the command line into request records (reads when nothing is set)."""
+    records = []
+    if args.rate is not None:
+        records.append((TAG_SAMPLE_RATE, struct.pack("<H", args.rate)))
+    if args.filter is not None:
+        parts = [int(p) for p in args.filter.split(",")]
+        if len(parts) == 1:
+            records.append((TAG_FILTER, bytes(parts)))
+        elif len(parts) == 4:
+            records.append((TAG_FILTER, struct.pack("<BHHH", *parts)))
+        else:
+            sys.exit("--filter takes a preset or dc,hp,lp,average")
+    if args.threshold is not None or args.shock_wake is not None:
+        if args.threshold is None:
+            sys.exit("--shock-wake needs --threshold")
+        value = struct.pack("<H", int(round(args.threshold * 10)))
+        if args.shock_wake is not None:
+            value += bytes([args.shock_wake])
+        records.append((TAG_TRIGGER, value))
+    for link, option in ((LINK_SERIAL, args.serial_format), (LINK_BLE, args.ble_format),
+                         (LINK_WIFI, args.wifi_mode)):
+        if option is not None:
+            records.append((TAG_STREAM_FORMAT, bytes([link, FORMATS[link].index(option)])))
+    if args.logging is not None:
+        records.append((TAG_LOGGING, bytes([args.logging])))
+    if args.power is not None:
+        records.append((TAG_POWER_PROFILE, bytes([args.power])))
+    reset = (1 if args.reset_peak else 0) | (2 if args.reset_filters else 0)
+    if reset:
+        records.append((TAG_RESET, bytes([reset])))
+    if args.calibrate:
+        records.append((TAG_CALIBRATE, b""))
+
+    if not records:
+        records = [(TAG_STATUS, b""), (TAG_SAMPLE_RATE, b""), (TAG_FILTER, b""), (TAG_TRIGGER, b""),
+                   (TAG_STREAM_FORMAT, bytes([LINK_SERIAL])), (TAG_STREAM_FORMAT, bytes([LINK_BLE])),
+                   (TAG_STREAM_FORMAT, bytes([LINK_WIFI])), (TAG_LOGGING, b""), (TAG_POWER_PROFILE, b"")]
+    return records
+
+
+def main():
+    """Main entry point."""
+    parser = argparse.ArgumentParser(description="gSENSOR settings over the command protocol")
+    parser.add_argument("--port", "-p", default=DEFAULT_PORT,
+                        help=f"Serial port (default: {DEFAULT_PORT})")
+    parser.add_argument("--baud", "-b", type=int, default=DEFAULT_BAUD,
+                        help=f"Baud rate (default: {DEFAULT_BAUD})")
+    parser.add_argument("--wifi", metavar="HOST", help="Talk to the device over Wi-Fi instead of serial")
+    parser.add_argument("--rate", type=int, help="Sample rate: 25, 50, 100, 200, 400, 800, 1600, 3200 Hz")
+    parser.add_argument("--filter", help="Preset 0-3, or dc,hp,lp,average (Hz, Hz, ms)")
+    parser.add_argument("--threshold", type=float, help="Impact threshold in g")
+    parser.add_argument("--shock-wake", type=on_off, help="on or off (with --threshold)")
+    parser.add_argument("--serial-format", choices=FORMATS[LINK_SERIAL])
+    parser.add_argument("--ble-format", choices=FORMATS[LINK_BLE])
+    parser.add_argument("--wifi-mode", choices=FORMATS[LINK_WIFI])
+    parser.add_argument("--logging", type=on_off, help="on or off")
+    parser.add_argument("--power", type=int, choices=range(3), help="0 performance, 1 balanced, 2 low power")
+    parser.add_argument("--reset-peak", action="store_true")
+    parser.add_argument("--reset-filters", action="store_true")
+    parser.add_argument("--calibrate", action="store_true", help="Zero-g calibration (sensor still)")
+    args = parser.parse_args()
+
+    records = build_records(args)
+    try:
+        link = WifiLink(args.wifi, WIFI_PORT) if args.wifi else SerialLink(args.port, args.baud)
+    except (serial.SerialException, OSError) as e:
+        print(f"Cannot open the link: {e}")
+        sys.exit(1)
+
+    try:
+        answers = run(link, records)
+    finally:
+        link.close()
+
+    if answers is None:
+        print("No reply from the device (firmware without the command protocol?)")
+        sys.exit(1)
+    failed = False
+    for tag, status, value in answers:
+        text = describe(tag, value) if value or status == 0 else f"Tag 0x{tag:02x}"
+        if status != 0:
+            failed = True
+            text += f" [{STATUS_NAMES.get(status, status)}]"
+        print(text)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,393 @@
+#!/usr/bin/env python3
+"""
+gSENSOR Log Download
+
+Downloads the flash log over USB serial with the log transfer protocol
+(log_transfer.h) and can save the samples as CSV.
+
+Usage:
+    python log_download.py OUTPUT.bin [--port PORT] [--window N] [--csv FILE] [--restart]
+    python log_download.py OUTPUT.bin --convert --csv FILE
+    python log_download.py --info [--port PORT]
+
+OUTPUT.bin holds one block per 4 KB sector, as in the log partition (the
+32-byte header and its samples, padded with 0xFF), so the native replay
+tool reads it like a partition dump. When it already holds part of the
+same log, the download resumes after its last block; run it again after
+an interrupted transfer. --convert only turns an existing file into CSV.
+
+CSV timestamps are microseconds in the device time base (host time if the
+device was synced while logging), values are calibrated g.
+"""
+
+import argparse
+import binascii
+import os
+import struct
+import sys
+import time
+
+import serial
+
+from serial_plotter import ADXL375_SCALE_FACTOR, DEFAULT_BAUD, DEFAULT_PORT
+
+# Messages (log_transfer.h)
+OP_INFO = 0x01
+OP_READ = 0x02
+OP_ACK = 0x03
+OP_ABORT = 0x04
+MSG_INFO = 0x81
+MSG_STATUS = 0x82
+MSG_DATA = 0x83
+
+STATUS_OK = 0
+STATUS_DONE = 1
+STATUS_ABORTED = 2
+STATUS_LOG_CHANGED = 3
+STATUS_OUT_OF_RANGE = 4
+STATUS_BUSY = 5
+STATUS_BAD_BLOCK = 6
+STATUS_NO_LOG = 7
+STATUS_NAMES = {0: "OK", 1: "DONE", 2: "ABORTED", 3: "LOG_CHANGED", 4: "OUT_OF_RANGE",
+                5: "BUSY", 6: "BAD_BLOCK", 7: "NO_LOG", 8: "MALFORMED"}
+
+FRAME_SYNC = b"\xA5\x4C"
+MAX_MESSAGE = 244           # LOG_TRANSFER_MAX_MESSAGE
+DEFAULT_WINDOW = 4          # LOG_TRANSFER_DEFAULT_WINDOW
+MAX_WINDOW = 8              # LOG_TRANSFER_MAX_WINDOW
+REPLY_TIMEOUT_S = 1.0
+REQUEST_ATTEMPTS = 3
+STALL_TIMEOUT_S = 0.5       # Well inside LOG_TRANSFER_TIMEOUT_MS
+
+INFO = struct.Struct("<BBBIIIIHH")
+STATUS = struct.Struct("<BBI")
+DATA_HEADER = struct.Struct("<BIH")
+# LogBlockHeader (flash_logger.h)
+BLOCK_HEADER = struct.Struct("<IHHIIIHhhhHH")
+BLOCK_MAGIC = 0x474C5347
+SECTOR_SIZE = 4096          # LOG_BLOCK_SIZE
+SAMPLE = struct.Struct("<hhh")
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE, as crc16Ccitt() in stream_frame.h."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def parse_block(block: bytes):
+    """
+    Check one block and return its header fields.
+
+    Returns:
+        Header tuple, or None if the block is short or fails its CRC.
+    """
+    if len(block) < BLOCK_HEADER.size:
+        return None
+    header = BLOCK_HEADER.unpack_from(block)
+    magic, count, crc = header[0], header[2], header[11]
+    length = BLOCK_HEADER.size + count * SAMPLE.size
+    if magic != BLOCK_MAGIC or len(block) != length:
+        return None
+    # Reason: the stored CRC covers the header before it, then the samples
+    if crc16(block[:BLOCK_HEADER.size - 2] + block[BLOCK_HEADER.size:]) != crc:
+        return None
+    return header
+
+
+def read_blocks(path: str):
+    """Yield (header, block bytes) for each block of a download file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    for pos in range(0, len(data) - BLOCK_HEADER.size + 1, SECTOR_SIZE):
+        count = BLOCK_HEADER.unpack_from(data, pos)[2]
+        end = pos + BLOCK_HEADER.size + count * SAMPLE.size
+        header = parse_block(data[pos:end])
+        if header is None:
+            break  # A partial write at the end of an interrupted download
+        yield header, data[pos:end]
+
+
+class LogLink:
+    """Log transfer messages framed over a serial port."""
+
+    def __init__(self, port: str, baud: int):
+        self.serial = serial.Serial(port, baud, timeout=0.05)
+        self.buffer = bytearray()
+
+    def send(self, message: bytes):
+        body = struct.pack("<H", len(message)) + message
+        self.serial.write(FRAME_SYNC + body + struct.pack("<H", crc16(body)))
+
+    def receive(self, timeout: float):
+        """Return the next good message, or None on timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            message = self._parse()
+            if message is not None:
+                return message
+            if time.monotonic() >= deadline:
+                return None
+            self.buffer += self.serial.read(max(1, self.serial.in_waiting))
+
+    def _parse(self):
+        # Sample lines and debug output are skipped up to the next sync word
+        while True:
+            start = self.buffer.find(FRAME_SYNC)
+            if start < 0:
+                del self.buffer[:max(0, len(self.buffer) - 1)]
+                return None
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                return None
+            (length,) = struct.unpack_from("<H", self.buffer, 2)
+            if length == 0 or length > MAX_MESSAGE:
+                del self.buffer[:1]  # Sync bytes inside other output
+                continue
+            if len(self.buffer) < 6 + length:
+                return None
+            body = bytes(self.buffer[2:4 + length])
+            (crc,) = struct.unpack_from("<H", self.buffer, 4 + length)
+            if crc16(body) == crc:
+                del self.buffer[:6 + length]
+                return body[2:]
+            del self.buffer[:1]  # Not a frame after all
+
+    def request(self, message: bytes, reply_type: int):
+        """Send a request and wait for its reply (None on timeout)."""
+        self.send(message)
+        deadline = time.monotonic() + REPLY_TIMEOUT_S
+        while time.monotonic() < deadline:
+            reply = self.receive(deadline - time.monotonic())
+            if reply is not None and reply[0] == reply_type:
+                return reply
+        return None
+
+    def close(self):
+        self.serial.close()
+
+
+def get_info(link: LogLink):
+    """Ask for the log range; returns the INFO fields or None."""
+    for _ in range(REQUEST_ATTEMPTS):
+        reply = link.request(bytes([OP_INFO]), MSG_INFO)
+        if reply is not None and len(reply) >= INFO.size:
+            return INFO.unpack_from(reply)
+    return None
+
+
+def download(link: LogLink, path: str, log_start: int, first: int, last: int,
+             window: int, restart: bool) -> bool:
+    """
+    Fetch blocks first..last into path, resuming after the blocks it holds.
+
+    Returns:
+        True once the device reported DONE.
+    """
+    expected = first
+    if not restart and os.path.exists(path):
+        blocks = list(read_blocks(path))
+        if blocks and blocks[0][0][4] != log_start:
+            print(f"{path} holds another log (start {blocks[0][0][4]}); use --restart")
+            return False
+        if blocks:
+            expected = max(first, blocks[-1][0][3] + 1)
+            print(f"Resuming after block {blocks[-1][0][3]} ({len(blocks)} blocks on disk)")
+        # Drop a partial block left by an interrupted download
+        with open(path, "r+b") as f:
+            f.truncate(len(blocks) * SECTOR_SIZE)
+    else:
+        open(path, "wb").close()
+
+    if expected > last:
+        print("Already complete")
+        return True
+
+    total = last - expected + 1
+    received = 0
+    received_bytes = 0
+    retries = 0
+    stalls = 0
+    bad_blocks = []
+    start_time = time.monotonic()
+    out = open(path, "ab")
+
+    def start_read(sequence):
+        # A new READ also replaces the transfer in progress
+        link.send(struct.pack("<BIIIB", OP_READ, log_start, sequence, 0, window))
+
+    try:
+        start_read(expected)
+        # Chunks already in flight when a READ goes out are not a new loss
+        awaiting_ok = True
+        block = bytearray()
+        last_activity = time.monotonic()
+        while True:
+            message = link.receive(0.05)
+            now = time.monotonic()
+            if message is None:
+                if now - last_activity >= STALL_TIMEOUT_S:
+                    start_read(expected)
+                    awaiting_ok = True
+                    block.clear()
+                    stalls += 1
+                    last_activity = now
+                continue
+            last_activity = now
+
+            if message[0] == MSG_STATUS and len(message) >= STATUS.size:
+                _, status, sequence = STATUS.unpack_from(message)
+                if status == STATUS_OK:
+                    awaiting_ok = False
+                elif status == STATUS_DONE:
+                    break
+                elif status == STATUS_BAD_BLOCK:
+                    # Counted as sent by the device; the file just skips it
+                    if sequence == expected:
+                        bad_blocks.append(sequence)
+                        expected += 1
+                        link.send(struct.pack("<BI", OP_ACK, expected))
+                elif status == STATUS_OUT_OF_RANGE and sequence > expected:
+                    print(f"Blocks {expected}-{sequence - 1} were overwritten, skipping")
+                    expected = sequence
+                    start_read(expected)
+                    awaiting_ok = True
+                else:
+                    print(f"Transfer failed: {STATUS_NAMES.get(status, status)}")
+                    return False
+                continue
+
+            if message[0] != MSG_DATA or len(message) < DATA_HEADER.size:
+                continue
+            # Chunks of the expected block are good from either transfer
+            # around a READ; only the chunk order matters
+            _, sequence, offset = DATA_HEADER.unpack_from(message)
+            if sequence != expected:
+                continue
+            if offset == 0:
+                block.clear()
+                awaiting_ok = False  # Covers a lost OK
+            elif offset != len(block):
+                # A chunk went missing: fetch the block again
+                block.clear()
+                if not awaiting_ok:
+                    start_read(expected)
+                    awaiting_ok = True
+                    retries += 1
+                continue
+            block += message[DATA_HEADER.size:]
+            if len(block) < BLOCK_HEADER.size:
+                continue
+            length = BLOCK_HEADER.size + BLOCK_HEADER.unpack_from(block)[2] * SAMPLE.size
+            if len(block) < length:
+                continue
+
+            if parse_block(bytes(block)) is None:
+                start_read(expected)
+                awaiting_ok = True
+                retries += 1
+            else:
+                out.write(block + b"\xFF" * (SECTOR_SIZE - len(block)))
+                received += 1
+                received_bytes += len(block)
+                expected += 1
+                link.send(struct.pack("<BI", OP_ACK, expected))
+                if received % 16 == 0 or expected > last:
+                    rate = received_bytes / 1024 / max(now - start_time, 1e-3)
+                    print(f"  {received}/{total} blocks, {rate:.1f} KB/s")
+            block.clear()
+    except KeyboardInterrupt:
+        link.send(bytes([OP_ABORT]))
+        print("Interrupted; run again to resume")
+        return False
+    finally:
+        out.close()
+
+    if bad_blocks:
+        print(f"Blocks failing their CRC on the device: {bad_blocks}")
+    print(f"Downloaded {received} blocks in {time.monotonic() - start_time:.1f} s "
+          f"({retries} blocks fetched again, {stalls} stalls)")
+    return True
+
+
+def export_csv(path: str, csv_path: str) -> int:
+    """Write the samples of a download file as CSV; returns the sample count."""
+    count = 0
+    base_us = None
+    previous_start = 0
+    with open(csv_path, "w") as out:
+        out.write("timestamp_us,x,y,z\n")
+        for header, block in read_blocks(path):
+            samples, start_us, rate = header[2], header[5], header[6]
+            offsets = header[7:10]
+            # Block start times are 32-bit and wrap like micros()
+            if base_us is None:
+                base_us = start_us
+            else:
+                base_us += (start_us - previous_start) & 0xFFFFFFFF
+            previous_start = start_us
+            for i in range(samples):
+                x, y, z = SAMPLE.unpack_from(block, BLOCK_HEADER.size + i * SAMPLE.size)
+                t_us = base_us + i * 1000000 // rate
+                out.write(f"{t_us},{(x - offsets[0]) * ADXL375_SCALE_FACTOR:.3f},"
+                          f"{(y - offsets[1]) * ADXL375_SCALE_FACTOR:.3f},"
+                          f"{(z - offsets[2]) * ADXL375_SCALE_FACTOR:.3f}\n")
+            count += samples
+    return count
+
+
+def main():
+    """Main entry point."""
+    parser = argparse.ArgumentParser(description="gSENSOR flash log download")
+    parser.add_argument("output", nargs="?", help="Block file to write (resumed if it exists)")
+    parser.add_argument("--port", "-p", default=DEFAULT_PORT,
+                        help=f"Serial port (default: {DEFAULT_PORT})")
+    parser.add_argument("--baud", "-b", type=int, default=DEFAULT_BAUD,
+                        help=f"Baud rate (default: {DEFAULT_BAUD})")
+    parser.add_argument("--window", "-w", type=int, default=DEFAULT_WINDOW,
+                        help=f"Blocks in flight, 1-{MAX_WINDOW} (default: {DEFAULT_WINDOW})")
+    parser.add_argument("--csv", help="Also save the samples to this file (timestamp_us,x,y,z in g)")
+    parser.add_argument("--restart", action="store_true", help="Discard OUTPUT and download from the start")
+    parser.add_argument("--convert", action="store_true", help="Only convert OUTPUT to CSV, no device")
+    parser.add_argument("--info", action="store_true", help="Print the log range and exit")
+    args = parser.parse_args()
+
+    if not args.info and not args.output:
+        parser.error("OUTPUT is required")
+    if args.convert:
+        if not args.csv:
+            parser.error("--convert needs --csv")
+        print(f"Wrote {export_csv(args.output, args.csv)} samples to {args.csv}")
+        return
+
+    try:
+        link = LogLink(args.port, args.baud)
+    except serial.SerialException as e:
+        print(f"Cannot open {args.port}: {e}")
+        sys.exit(1)
+
+    try:
+        info = get_info(link)
+        if info is None:
+            print("No reply from the device (firmware without log transfer?)")
+            sys.exit(1)
+        _, status, logging, log_start, first, last, capacity, per_block, _ = info
+        if status == STATUS_NO_LOG:
+            print("Nothing logged on the device")
+            sys.exit(1)
+        print(f"Log blocks {first}-{last} ({last - first + 1} of {capacity}, "
+              f"{per_block} samples each){', still logging' if logging else ''}")
+        if args.info:
+            return
+
+        window = min(max(args.window, 1), MAX_WINDOW)
+        if not download(link, args.output, log_start, first, last, window, args.restart):
+            sys.exit(1)
+    finally:
+        link.close()
+
+    if args.csv:
+        print(f"Wrote {export_csv(args.output, args.csv)} samples to {args.csv}")
+
+
+if __name__ == "__main__":
+    main()
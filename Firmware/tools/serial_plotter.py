@@ -5,13 +5,15 @@ gSENSOR Serial Plotter
 Real-time plotting of accelerometer data from gSENSOR device.
 
 Usage:
-    python serial_plotter.py [--port PORT] [--baud BAUD] [--duration SECONDS]
+    python serial_plotter.py [--port PORT] [--baud BAUD] [--duration SECONDS] [--binary]
 
 Requirements:
     pip install pyserial matplotlib numpy
 """
 
 import argparse
+import binascii
+import struct
 import sys
 import time
 from collections import deque
@@ -41,9 +43,92 @@ SAMPLE_RATES = {
     2: 200,   # s2 - recommended for recording at 115200 baud
     3: 400,   # s3 - may cause buffer overflow
     4: 800,   # s4 - requires higher baud rate
+    5: 1600,  # s5 - CSV output cannot keep up
+    6: 3200,  # s6 - CSV output cannot keep up
 }
 DEFAULT_DISPLAY_RATE = 1   # 100 Hz for normal display
 DEFAULT_RECORDING_RATE = 2  # 200 Hz - safe for 115200 baud
+BINARY_RECORDING_RATE = 4   # 800 Hz - binary frames fit easily over USB-CDC
+
+# Binary stream frame format (must match firmware stream_frame.h)
+FRAME_SYNC = b"\xa5\x5a"
+FRAME_VERSION = 1
+FRAME_HEADER = struct.Struct("<BBHIH")  # version, count, seq, t0_us, rate_hz
+FRAME_SAMPLE = struct.Struct("<Hhhh")   # dt_us, x, y, z
+FRAME_CRC = struct.Struct("<H")
+ADXL375_SCALE_FACTOR = 0.049  # g per LSB
+
+
+class BinaryFrameDecoder:
+    """
+    Incremental decoder for the firmware's binary sample frames.
+
+    Resynchronises on the sync word after garbage (e.g. interleaved text)
+    and counts CRC failures and sequence gaps.
+    """
+
+    def __init__(self):
+        """Initialize an empty decoder."""
+        self.buffer = bytearray()
+        self.next_seq = None
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost_frames = 0
+
+    def feed(self, data: bytes) -> list:
+        """
+        Add received bytes and decode every complete frame.
+
+        Args:
+            data: Bytes read from the serial port
+
+        Returns:
+            List of (timestamp_us, x, y, z) tuples with counts in LSB.
+        """
+        self.buffer.extend(data)
+        samples = []
+        header_end = len(FRAME_SYNC) + FRAME_HEADER.size
+
+        while True:
+            start = self.buffer.find(FRAME_SYNC)
+            if start < 0:
+                # Keep a trailing 0xA5 in case it starts the next sync word
+                del self.buffer[:-1]
+                return samples
+            if start > 0:
+                del self.buffer[:start]
+
+            if len(self.buffer) < header_end:
+                return samples
+
+            version, count, seq, t0, _rate = FRAME_HEADER.unpack_from(self.buffer, 2)
+            frame_len = header_end + count * FRAME_SAMPLE.size + FRAME_CRC.size
+            if version != FRAME_VERSION or count == 0:
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < frame_len:
+                return samples
+
+            (crc,) = FRAME_CRC.unpack_from(self.buffer, frame_len - FRAME_CRC.size)
+            if binascii.crc_hqx(bytes(self.buffer[2:frame_len - FRAME_CRC.size]), 0xFFFF) != crc:
+                self.crc_errors += 1
+                del self.buffer[:1]
+                continue
+
+            if self.next_seq is not None:
+                gap = (seq - self.next_seq) & 0xFFFF
+                if gap < 0x8000:  # Ignore repeats/reordering
+                    self.lost_frames += gap
+            self.next_seq = (seq + 1) & 0xFFFF
+            self.frames += 1
+
+            t = t0
+            for i in range(count):
+                dt, x, y, z = FRAME_SAMPLE.unpack_from(self.buffer, header_end + i * FRAME_SAMPLE.size)
+                t = (t + dt) & 0xFFFFFFFF
+                samples.append((t, x, y, z))
+
+            del self.buffer[:frame_len]
 
 
 class GsensorPlotter:
@@ -53,7 +138,8 @@ class GsensorPlotter:
     Reads CSV data from serial port and displays live plots.
     """
 
-    def __init__(self, port: str, baud: int, window_size: int = WINDOW_SIZE):
+    def __init__(self, port: str, baud: int, window_size: int = WINDOW_SIZE,
+                 binary: bool = False):
         """
         Initialize the plotter.
 
@@ -61,10 +147,14 @@ class GsensorPlotter:
             port: Serial port path
             baud: Baud rate
             window_size: Number of samples to display in the plot
+            binary: Use the binary frame stream instead of CSV
         """
         self.port = port
         self.baud = baud
         self.window_size = window_size
+        self.binary = binary
+        self.decoder = BinaryFrameDecoder() if binary else None
+        self.host_peak = 0.0
 
         # Data buffers
         self.timestamps = deque(maxlen=window_size)
@@ -96,7 +186,7 @@ class GsensorPlotter:
 
         # Sample rate settings
         self.display_rate = DEFAULT_DISPLAY_RATE
-        self.recording_rate = DEFAULT_RECORDING_RATE
+        self.recording_rate = BINARY_RECORDING_RATE if binary else DEFAULT_RECORDING_RATE
         self.current_rate = self.display_rate
 
     def connect(self) -> bool:
@@ -114,6 +204,12 @@ class GsensorPlotter:
             self.serial.reset_input_buffer()
             time.sleep(0.5)
 
+            if self.binary:
+                # Firmware switches to binary frames on 'b'
+                self.send_command("b")
+                print("Binary stream requested")
+                return True
+
             # Read a few lines to verify data is coming through
             print("Waiting for data...")
             for _ in range(20):
@@ -138,6 +234,8 @@ class GsensorPlotter:
     def disconnect(self):
         """Close the serial connection."""
         if self.serial and self.serial.is_open:
+            if self.binary:
+                self.send_command("a")  # Leave the device in CSV mode
             self.serial.close()
             print("Disconnected from serial port")
 
@@ -165,42 +263,72 @@ class GsensorPlotter:
             mag = float(parts[4])
             peak = float(parts[5])
 
-            # Convert timestamp to seconds from start
-            if self.start_time is None:
-                self.start_time = timestamp
+            self.add_sample(timestamp, x, y, z, mag, peak)
+            return True
+
+        except (ValueError, IndexError):
+            return False
 
-            t = (timestamp - self.start_time) / 1000.0
+    def add_sample(self, timestamp: float, x: float, y: float, z: float,
+                   mag: float, peak: float):
+        """
+        Append one sample to the plot buffers (and recording).
 
-            self.timestamps.append(t)
-            self.x_data.append(x)
-            self.y_data.append(y)
-            self.z_data.append(z)
-            self.mag_data.append(mag)
-            self.peak_data.append(peak)
+        Args:
+            timestamp: Sample time in milliseconds
+            x, y, z: Acceleration in g
+            mag: Magnitude in g
+            peak: Peak magnitude in g
+        """
+        # Convert timestamp to seconds from start
+        if self.start_time is None:
+            self.start_time = timestamp
 
-            self.sample_count += 1
+        t = (timestamp - self.start_time) / 1000.0
 
-            # Store data if recording
-            if self.recording:
-                self.recorded_data.append({
-                    "timestamp_ms": timestamp,
-                    "x": x,
-                    "y": y,
-                    "z": z,
-                    "magnitude": mag,
-                    "peak": peak,
-                })
+        self.timestamps.append(t)
+        self.x_data.append(x)
+        self.y_data.append(y)
+        self.z_data.append(z)
+        self.mag_data.append(mag)
+        self.peak_data.append(peak)
 
-            return True
+        self.sample_count += 1
 
-        except (ValueError, IndexError):
-            return False
+        # Store data if recording
+        if self.recording:
+            self.recorded_data.append({
+                "timestamp_ms": timestamp,
+                "x": x,
+                "y": y,
+                "z": z,
+                "magnitude": mag,
+                "peak": peak,
+            })
+
+    def read_binary(self):
+        """Decode available binary frames (raw counts) from the serial port."""
+        data = self.serial.read(self.serial.in_waiting)
+        for t_us, cx, cy, cz in self.decoder.feed(data):
+            x = cx * ADXL375_SCALE_FACTOR
+            y = cy * ADXL375_SCALE_FACTOR
+            z = cz * ADXL375_SCALE_FACTOR
+            mag = (x * x + y * y + z * z) ** 0.5
+            self.host_peak = max(self.host_peak, mag)
+            self.add_sample(t_us / 1000.0, x, y, z, mag, self.host_peak)
 
     def read_data(self):
         """Read and parse available data from serial port."""
         if not self.serial or not self.serial.is_open:
             return
 
+        if self.binary:
+            try:
+                self.read_binary()
+            except OSError as e:
+                print(f"Serial error: {e}")
+            return
+
         try:
             while self.serial.in_waiting > 0:
                 try:
@@ -351,6 +479,11 @@ class GsensorPlotter:
                 rec_hz = SAMPLE_RATES[self.recording_rate]
                 self.status_text.set_text(f"REC {rec_hz}Hz: {rec_count}")
                 self.status_text.set_color("#ff4444")
+            elif self.binary:
+                self.status_text.set_text(
+                    f"Lost frames: {self.decoder.lost_frames} | CRC: {self.decoder.crc_errors}"
+                )
+                self.status_text.set_color("#888888")
             else:
                 self.status_text.set_text("Space: Record")
                 self.status_text.set_color("#888888")
@@ -400,7 +533,7 @@ class GsensorPlotter:
         Set the sensor sample rate.
 
         Args:
-            rate_key: Rate key (1=100Hz, 2=200Hz, 3=400Hz, 4=800Hz)
+            rate_key: Rate key (1=100Hz ... 6=3200Hz)
         """
         if rate_key not in SAMPLE_RATES:
             print(f"Invalid rate key: {rate_key}")
@@ -521,6 +654,7 @@ class GsensorPlotter:
         self.recorded_data = []
         self.sample_count = 0
         self.start_time = None
+        self.host_peak = 0.0
         print("Data cleared.")
 
     def reset_peak(self, event=None):
@@ -531,6 +665,7 @@ class GsensorPlotter:
             event: Button click event (unused).
         """
         self.send_command("r")
+        self.host_peak = 0.0
         print("Peak reset command sent.")
 
     def on_key(self, event):
@@ -586,6 +721,11 @@ def main():
         action="store_true",
         help="List available serial ports",
     )
+    parser.add_argument(
+        "--binary",
+        action="store_true",
+        help="Use the binary frame stream (raw counts, up to 3200 Hz)",
+    )
     parser.add_argument(
         "--duration",
         "-d",
@@ -604,12 +744,14 @@ def main():
     print("=" * 40)
     print(f"Port: {args.port}")
     print(f"Baud: {args.baud}")
-    print(f"Recording rate: {SAMPLE_RATES[DEFAULT_RECORDING_RATE]} Hz")
+    rec_rate = BINARY_RECORDING_RATE if args.binary else DEFAULT_RECORDING_RATE
+    print(f"Format: {'binary frames' if args.binary else 'CSV'}")
+    print(f"Recording rate: {SAMPLE_RATES[rec_rate]} Hz")
     print("Keyboard: Space=Record, S=Save, C=Clear, R=Reset")
     print("Press Ctrl+C to stop")
     print("=" * 40)
 
-    plotter = GsensorPlotter(args.port, args.baud)
+    plotter = GsensorPlotter(args.port, args.baud, binary=args.binary)
     plotter.run(args.duration)
 
 
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+gSENSOR Wi-Fi Stream Receiver
+
+Receives the batched binary frames sent over Wi-Fi (settings screen or
+serial n1/n2), prints throughput and loss once per second and can save
+the samples as CSV.
+
+Usage:
+    python wifi_receiver.py HOST [--tcp] [--port PORT] [--duration SECONDS] [--csv FILE] [--sync]
+
+UDP (default) subscribes by sending a datagram to the device and repeats
+it well inside the firmware's 10 s timeout. TCP connects to the device.
+
+--sync runs a time sync exchange once a second, so the device stamps its
+samples with this computer's clock; CSV timestamps are then microseconds
+since the Unix epoch, and several devices recorded this way line up.
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+from serial_plotter import ADXL375_SCALE_FACTOR, BinaryFrameDecoder
+
+DEFAULT_PORT = 5555         # WIFI_STREAM_PORT in config.h
+SUBSCRIBE_INTERVAL_S = 2.0  # Well inside WIFI_UDP_SUBSCRIBE_TIMEOUT_MS
+
+# Time sync (time_sync.h)
+SYNC_MAGIC = b"GSYN"
+SYNC_PROBE = 0x01
+SYNC_RESULT = 0x02
+SYNC_INTERVAL_S = 1.0
+SYNC_REPLY_TIMEOUT_S = 0.25
+SYNC_SETTLE_S = 0.2         # Frames already in flight carry the old clock
+SYNC_STATES = {0: "unsynced", 1: "synced", 2: "held"}
+
+
+def host_us() -> int:
+    """Host reference time in microseconds since the Unix epoch."""
+    return time.time_ns() // 1000
+
+
+def unwrap_us(timestamp_us: int, now_us: int) -> int:
+    """
+    Extend a 32-bit synced device timestamp to a full host time.
+
+    Valid for samples less than about 71 minutes old.
+    """
+    return now_us - ((now_us - timestamp_us) & 0xFFFFFFFF)
+
+
+class TimeSyncClient:
+    """Runs the four-timestamp exchange against one device over UDP."""
+
+    def __init__(self, host: str, port: int):
+        self.address = (host, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sequence = 0
+        self.synced_at = None   # time.monotonic() of the first good result
+        self.state = 0
+        self.error_us = 0
+        self.delay_us = 0
+        self.drift_ppb = 0
+
+    def _request(self, message: bytes):
+        """Send one message and return the reply payload (None on timeout)."""
+        self.sock.sendto(SYNC_MAGIC + message, self.address)
+        deadline = time.monotonic() + SYNC_REPLY_TIMEOUT_S
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.sock.settimeout(remaining)
+            try:
+                reply = self.sock.recv(64)
+            except socket.timeout:
+                return None
+            # Replies to an earlier, timed-out exchange carry an old sequence
+            if reply[:4] == SYNC_MAGIC and len(reply) > 5 and reply[4] == message[0] \
+                    and reply[5] == message[1]:
+                return reply[4:]
+
+    def exchange(self) -> bool:
+        """Run one PROBE/RESULT exchange; returns True if the device replied."""
+        self.sequence = (self.sequence + 1) & 0xFF
+        t1 = host_us()
+        if self._request(struct.pack("<BBQ", SYNC_PROBE, self.sequence, t1)) is None:
+            return False
+        t4 = host_us()
+        result = self._request(struct.pack("<BBQ", SYNC_RESULT, self.sequence, t4))
+        if result is None or len(result) < 15:
+            return False
+        _, _, self.state, self.error_us, self.delay_us, self.drift_ppb = \
+            struct.unpack("<BBBiIi", result[:15])
+        if self.state != 0 and self.synced_at is None:
+            self.synced_at = time.monotonic()
+        return True
+
+    def settled(self) -> bool:
+        """True once new samples are stamped with host time."""
+        return self.synced_at is not None and time.monotonic() - self.synced_at >= SYNC_SETTLE_S
+
+    def describe(self) -> str:
+        return (f"sync {SYNC_STATES.get(self.state, '?')}, error {self.error_us} us, "
+                f"delay {self.delay_us} us, drift {self.drift_ppb / 1000:.2f} ppm")
+
+    def close(self):
+        self.sock.close()
+
+
+def open_stream(host: str, port: int, tcp: bool) -> socket.socket:
+    """
+    Connect (TCP) or subscribe (UDP) to the device.
+
+    Args:
+        host: Device address shown on the settings screen
+        port: Stream port
+        tcp: Use TCP instead of UDP
+
+    Returns:
+        Socket to read frames from.
+    """
+    if tcp:
+        sock = socket.create_connection((host, port), timeout=5.0)
+    else:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+        sock.sendto(b"gsensor", (host, port))
+    sock.settimeout(0.5)
+    return sock
+
+
+def main():
+    """Main entry point."""
+    parser = argparse.ArgumentParser(description="gSENSOR Wi-Fi stream receiver")
+    parser.add_argument("host", help="Device IP address (shown on the settings screen)")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT,
+                        help=f"Stream port (default: {DEFAULT_PORT})")
+    parser.add_argument("--tcp", action="store_true", help="Connect over TCP (device set to n2)")
+    parser.add_argument("--duration", "-d", type=float, default=None,
+                        help="Stop after this many seconds (default: indefinite)")
+    parser.add_argument("--csv", help="Save samples to this file (timestamp_us,x,y,z in g)")
+    parser.add_argument("--sync", action="store_true",
+                        help="Sync the device clock to this computer (CSV times become Unix us)")
+    args = parser.parse_args()
+
+    try:
+        sock = open_stream(args.host, args.port, args.tcp)
+    except OSError as e:
+        print(f"Cannot reach {args.host}:{args.port}: {e}")
+        sys.exit(1)
+
+    decoder = BinaryFrameDecoder()
+    sync = TimeSyncClient(args.host, args.port) if args.sync else None
+    out = open(args.csv, "w") if args.csv else None
+    if out:
+        out.write("timestamp_us,x,y,z\n")
+
+    start = time.monotonic()
+    last_report = start
+    last_subscribe = start
+    last_sync = start - SYNC_INTERVAL_S
+    window_samples = 0
+    total_samples = 0
+
+    try:
+        while args.duration is None or time.monotonic() - start < args.duration:
+            now = time.monotonic()
+            if not args.tcp and now - last_subscribe >= SUBSCRIBE_INTERVAL_S:
+                sock.sendto(b"gsensor", (args.host, args.port))
+                last_subscribe = now
+            if sync and now - last_sync >= SYNC_INTERVAL_S:
+                sync.exchange()
+                last_sync = now
+
+            try:
+                data = sock.recv(65536)
+                if args.tcp and not data:
+                    print("Connection closed by the device")
+                    break
+            except socket.timeout:
+                data = b""
+            samples = decoder.feed(data) if data else []
+            if sync:
+                # Samples stamped before the first exchange are on device time
+                if not sync.settled():
+                    samples = []
+                else:
+                    received_us = host_us()
+                    samples = [(unwrap_us(t_us, received_us), x, y, z) for t_us, x, y, z in samples]
+
+            window_samples += len(samples)
+            total_samples += len(samples)
+            if out:
+                for t_us, x, y, z in samples:
+                    out.write(f"{t_us},{x * ADXL375_SCALE_FACTOR:.3f},"
+                              f"{y * ADXL375_SCALE_FACTOR:.3f},{z * ADXL375_SCALE_FACTOR:.3f}\n")
+
+            if now - last_report >= 1.0:
+                rate = window_samples / (now - last_report)
+                line = (f"{rate:8.0f} samples/s | frames {decoder.frames} | "
+                        f"lost {decoder.lost_frames} | CRC errors {decoder.crc_errors}")
+                if sync:
+                    line += " | " + sync.describe()
+                print(line)
+                window_samples = 0
+                last_report = now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+        if sync:
+            sync.close()
+        if out:
+            out.close()
+
+    print(f"Received {total_samples} samples in {decoder.frames} frames, "
+          f"{decoder.lost_frames} frames lost")
+
+
+if __name__ == "__main__":
+    main()